@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/audit_query.dir/tools/audit_query.cpp.o"
+  "CMakeFiles/audit_query.dir/tools/audit_query.cpp.o.d"
+  "audit_query"
+  "audit_query.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/audit_query.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
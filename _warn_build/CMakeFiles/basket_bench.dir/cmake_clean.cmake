@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basket_bench.dir/benchmarks/basket_bench.cpp.o"
+  "CMakeFiles/basket_bench.dir/benchmarks/basket_bench.cpp.o.d"
+  "basket_bench"
+  "basket_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basket_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
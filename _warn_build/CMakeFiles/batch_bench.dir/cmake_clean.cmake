@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/batch_bench.dir/benchmarks/batch_bench.cpp.o"
+  "CMakeFiles/batch_bench.dir/benchmarks/batch_bench.cpp.o.d"
+  "batch_bench"
+  "batch_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/batch_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
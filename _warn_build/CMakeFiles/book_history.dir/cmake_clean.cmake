@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/book_history.dir/tools/book_history.cpp.o"
+  "CMakeFiles/book_history.dir/tools/book_history.cpp.o.d"
+  "book_history"
+  "book_history.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/book_history.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/contention_bench.dir/benchmarks/contention_bench.cpp.o"
+  "CMakeFiles/contention_bench.dir/benchmarks/contention_bench.cpp.o.d"
+  "contention_bench"
+  "contention_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/contention_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/drop_copy_bench.dir/benchmarks/drop_copy_bench.cpp.o"
+  "CMakeFiles/drop_copy_bench.dir/benchmarks/drop_copy_bench.cpp.o.d"
+  "drop_copy_bench"
+  "drop_copy_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/drop_copy_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
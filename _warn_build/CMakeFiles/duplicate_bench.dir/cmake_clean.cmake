@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/duplicate_bench.dir/benchmarks/duplicate_bench.cpp.o"
+  "CMakeFiles/duplicate_bench.dir/benchmarks/duplicate_bench.cpp.o.d"
+  "duplicate_bench"
+  "duplicate_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/duplicate_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/handoff_bench.dir/benchmarks/handoff_bench.cpp.o"
+  "CMakeFiles/handoff_bench.dir/benchmarks/handoff_bench.cpp.o.d"
+  "handoff_bench"
+  "handoff_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/handoff_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/history_bench.dir/benchmarks/history_bench.cpp.o"
+  "CMakeFiles/history_bench.dir/benchmarks/history_bench.cpp.o.d"
+  "history_bench"
+  "history_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/history_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ingress_bench.dir/benchmarks/ingress_bench.cpp.o"
+  "CMakeFiles/ingress_bench.dir/benchmarks/ingress_bench.cpp.o.d"
+  "ingress_bench"
+  "ingress_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ingress_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/journal_bench.dir/benchmarks/journal_bench.cpp.o"
+  "CMakeFiles/journal_bench.dir/benchmarks/journal_bench.cpp.o.d"
+  "journal_bench"
+  "journal_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/journal_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/market_data_bench.dir/benchmarks/market_data_bench.cpp.o"
+  "CMakeFiles/market_data_bench.dir/benchmarks/market_data_bench.cpp.o.d"
+  "market_data_bench"
+  "market_data_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/market_data_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,44 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/core/book_replica.cpp" "CMakeFiles/matching_engine.dir/src/core/book_replica.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/book_replica.cpp.o.d"
+  "/root/repo/src/core/duplicate_filter.cpp" "CMakeFiles/matching_engine.dir/src/core/duplicate_filter.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/duplicate_filter.cpp.o.d"
+  "/root/repo/src/core/engine_shard.cpp" "CMakeFiles/matching_engine.dir/src/core/engine_shard.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/engine_shard.cpp.o.d"
+  "/root/repo/src/core/ingress_queue.cpp" "CMakeFiles/matching_engine.dir/src/core/ingress_queue.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/ingress_queue.cpp.o.d"
+  "/root/repo/src/core/matching_engine.cpp" "CMakeFiles/matching_engine.dir/src/core/matching_engine.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/matching_engine.cpp.o.d"
+  "/root/repo/src/core/order.cpp" "CMakeFiles/matching_engine.dir/src/core/order.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/order.cpp.o.d"
+  "/root/repo/src/core/order_book.cpp" "CMakeFiles/matching_engine.dir/src/core/order_book.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/order_book.cpp.o.d"
+  "/root/repo/src/core/output_sequencer.cpp" "CMakeFiles/matching_engine.dir/src/core/output_sequencer.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/output_sequencer.cpp.o.d"
+  "/root/repo/src/core/parent_order.cpp" "CMakeFiles/matching_engine.dir/src/core/parent_order.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/parent_order.cpp.o.d"
+  "/root/repo/src/core/pooled_order_book.cpp" "CMakeFiles/matching_engine.dir/src/core/pooled_order_book.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/pooled_order_book.cpp.o.d"
+  "/root/repo/src/core/risk_budget.cpp" "CMakeFiles/matching_engine.dir/src/core/risk_budget.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/risk_budget.cpp.o.d"
+  "/root/repo/src/core/shard_scheduler.cpp" "CMakeFiles/matching_engine.dir/src/core/shard_scheduler.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/shard_scheduler.cpp.o.d"
+  "/root/repo/src/core/trade.cpp" "CMakeFiles/matching_engine.dir/src/core/trade.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/core/trade.cpp.o.d"
+  "/root/repo/src/network/client.cpp" "CMakeFiles/matching_engine.dir/src/network/client.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/client.cpp.o.d"
+  "/root/repo/src/network/drop_copy.cpp" "CMakeFiles/matching_engine.dir/src/network/drop_copy.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/drop_copy.cpp.o.d"
+  "/root/repo/src/network/handoff.cpp" "CMakeFiles/matching_engine.dir/src/network/handoff.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/handoff.cpp.o.d"
+  "/root/repo/src/network/market_data.cpp" "CMakeFiles/matching_engine.dir/src/network/market_data.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/market_data.cpp.o.d"
+  "/root/repo/src/network/protocol.cpp" "CMakeFiles/matching_engine.dir/src/network/protocol.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/protocol.cpp.o.d"
+  "/root/repo/src/network/server.cpp" "CMakeFiles/matching_engine.dir/src/network/server.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/server.cpp.o.d"
+  "/root/repo/src/network/viewer_gateway.cpp" "CMakeFiles/matching_engine.dir/src/network/viewer_gateway.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/network/viewer_gateway.cpp.o.d"
+  "/root/repo/src/storage/audit_store.cpp" "CMakeFiles/matching_engine.dir/src/storage/audit_store.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/storage/audit_store.cpp.o.d"
+  "/root/repo/src/storage/book_history.cpp" "CMakeFiles/matching_engine.dir/src/storage/book_history.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/storage/book_history.cpp.o.d"
+  "/root/repo/src/storage/journal.cpp" "CMakeFiles/matching_engine.dir/src/storage/journal.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/storage/journal.cpp.o.d"
+  "/root/repo/src/storage/reference_data.cpp" "CMakeFiles/matching_engine.dir/src/storage/reference_data.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/storage/reference_data.cpp.o.d"
+  "/root/repo/src/storage/snapshot.cpp" "CMakeFiles/matching_engine.dir/src/storage/snapshot.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/storage/snapshot.cpp.o.d"
+  "/root/repo/src/storage/uring_journal.cpp" "CMakeFiles/matching_engine.dir/src/storage/uring_journal.cpp.o" "gcc" "CMakeFiles/matching_engine.dir/src/storage/uring_journal.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,61 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/matching_engine.dir/src/core/book_replica.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/book_replica.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/duplicate_filter.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/duplicate_filter.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/engine_shard.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/engine_shard.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/ingress_queue.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/ingress_queue.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/matching_engine.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/matching_engine.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/order.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/order.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/order_book.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/order_book.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/output_sequencer.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/output_sequencer.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/parent_order.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/parent_order.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/pooled_order_book.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/pooled_order_book.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/risk_budget.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/risk_budget.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/shard_scheduler.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/shard_scheduler.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/core/trade.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/core/trade.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/client.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/client.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/drop_copy.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/drop_copy.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/handoff.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/handoff.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/market_data.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/market_data.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/protocol.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/protocol.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/server.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/server.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/network/viewer_gateway.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/network/viewer_gateway.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/storage/audit_store.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/storage/audit_store.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/storage/book_history.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/storage/book_history.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/storage/journal.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/storage/journal.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/storage/reference_data.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/storage/reference_data.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/storage/snapshot.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/storage/snapshot.cpp.o.d"
+  "CMakeFiles/matching_engine.dir/src/storage/uring_journal.cpp.o"
+  "CMakeFiles/matching_engine.dir/src/storage/uring_journal.cpp.o.d"
+  "libmatching_engine.a"
+  "libmatching_engine.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/matching_engine.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/memory_bench.dir/benchmarks/memory_bench.cpp.o"
+  "CMakeFiles/memory_bench.dir/benchmarks/memory_bench.cpp.o.d"
+  "memory_bench"
+  "memory_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/memory_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/oco_bench.dir/benchmarks/oco_bench.cpp.o"
+  "CMakeFiles/oco_bench.dir/benchmarks/oco_bench.cpp.o.d"
+  "oco_bench"
+  "oco_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/oco_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
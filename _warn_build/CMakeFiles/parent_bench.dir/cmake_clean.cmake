@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/parent_bench.dir/benchmarks/parent_bench.cpp.o"
+  "CMakeFiles/parent_bench.dir/benchmarks/parent_bench.cpp.o.d"
+  "parent_bench"
+  "parent_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/parent_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
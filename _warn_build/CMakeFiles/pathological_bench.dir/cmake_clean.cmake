@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pathological_bench.dir/benchmarks/pathological_bench.cpp.o"
+  "CMakeFiles/pathological_bench.dir/benchmarks/pathological_bench.cpp.o.d"
+  "pathological_bench"
+  "pathological_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pathological_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/reference_bench.dir/benchmarks/reference_bench.cpp.o"
+  "CMakeFiles/reference_bench.dir/benchmarks/reference_bench.cpp.o.d"
+  "reference_bench"
+  "reference_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/reference_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/replica_bench.dir/benchmarks/replica_bench.cpp.o"
+  "CMakeFiles/replica_bench.dir/benchmarks/replica_bench.cpp.o.d"
+  "replica_bench"
+  "replica_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/replica_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/risk_bench.dir/benchmarks/risk_bench.cpp.o"
+  "CMakeFiles/risk_bench.dir/benchmarks/risk_bench.cpp.o.d"
+  "risk_bench"
+  "risk_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/risk_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
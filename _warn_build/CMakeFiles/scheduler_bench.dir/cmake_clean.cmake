@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/scheduler_bench.dir/benchmarks/scheduler_bench.cpp.o"
+  "CMakeFiles/scheduler_bench.dir/benchmarks/scheduler_bench.cpp.o.d"
+  "scheduler_bench"
+  "scheduler_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/scheduler_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
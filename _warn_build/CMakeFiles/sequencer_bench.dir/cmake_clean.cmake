@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sequencer_bench.dir/benchmarks/sequencer_bench.cpp.o"
+  "CMakeFiles/sequencer_bench.dir/benchmarks/sequencer_bench.cpp.o.d"
+  "sequencer_bench"
+  "sequencer_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sequencer_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
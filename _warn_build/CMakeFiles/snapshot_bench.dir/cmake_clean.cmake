@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/snapshot_bench.dir/benchmarks/snapshot_bench.cpp.o"
+  "CMakeFiles/snapshot_bench.dir/benchmarks/snapshot_bench.cpp.o.d"
+  "snapshot_bench"
+  "snapshot_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/snapshot_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
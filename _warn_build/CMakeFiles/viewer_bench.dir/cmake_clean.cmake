@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/viewer_bench.dir/benchmarks/viewer_bench.cpp.o"
+  "CMakeFiles/viewer_bench.dir/benchmarks/viewer_bench.cpp.o.d"
+  "viewer_bench"
+  "viewer_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/viewer_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/wire_latency_bench.dir/benchmarks/wire_latency_bench.cpp.o"
+  "CMakeFiles/wire_latency_bench.dir/benchmarks/wire_latency_bench.cpp.o.d"
+  "wire_latency_bench"
+  "wire_latency_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/wire_latency_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
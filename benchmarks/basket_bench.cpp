@@ -0,0 +1,127 @@
+// Per-order cost of basket submission: Client::submitOrder per order vs Client::submitOrders.
+//
+// A Client and a Server share one io_context on loopback (one thread, so the run is
+// deterministic). The server decodes every ORDER frame with decodeSubmitOrders and applies it
+// with one MatchingEngine::processCommands call. Each mode sends --orders limit orders around
+// 100.00 (some crossing) to a fresh engine: one submitOrder call per order, then submitOrders
+// baskets of 10, 100 and 1000. Reported per mode: client-side encode + queue time per order, wall
+// time per order until the engine has applied the last one, frames on the wire, and orders the
+// engine accepted.
+//
+// Usage:
+//   basket_bench [--orders N] [--csv FILE]
+
+#include "matching_engine/client.hpp"
+#include "matching_engine/server.hpp"
+#include "bench_common.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "basket,orders,frames,encode_ns_per_order,end_to_end_ns_per_order,accepted";
+
+std::vector<Order> makeOrders(size_t count) {
+    FastRandom random(3);
+    std::vector<Order> orders;
+    orders.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        OrderSide side = random.below(2) ? OrderSide::SELL : OrderSide::BUY;
+        double offset = 0.01 * static_cast<double>(random.below(20)) - 0.05;
+        Price price = side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset;
+        orders.emplace_back(i + 1, "BENCH", side, OrderType::LIMIT, price, 1 + random.below(200));
+    }
+    return orders;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t order_count = std::max<uint64_t>(1, args.getUint("--orders", 200000));
+    std::vector<Order> orders = makeOrders(order_count);
+
+    std::unique_ptr<MatchingEngine> engine;
+    size_t applied = 0;
+    size_t accepted = 0;
+    size_t frames = 0;
+    std::vector<EngineCommand> commands;
+    std::vector<CommandResult> results;
+
+    boost::asio::io_context io_context;
+    Server server(io_context, 0, [&](const Message& msg, std::shared_ptr<boost::asio::ip::tcp::socket>) {
+        if (msg.type != MessageType::ORDER) return;
+        commands.clear();
+        results.clear();
+        try {
+            if (!decodeSubmitOrders(msg.payload, 1, commands)) return;
+        } catch (const std::exception& e) {
+            std::cerr << "Bad order frame: " << e.what() << std::endl;
+            return;
+        }
+        frames++;
+        applied += engine->processCommands(commands, results);
+        for (const auto& result : results) {
+            accepted += result.status == CommandStatus::ACCEPTED;
+        }
+    });
+    server.start();
+
+    Client client(io_context);
+    client.connect("127.0.0.1", server.getPort());
+    while (!client.isConnected() && io_context.run_one()) {
+    }
+
+    std::vector<std::string> rows;
+    for (size_t basket : {size_t{1}, size_t{10}, size_t{100}, size_t{1000}}) {
+        EngineConfig config;
+        config.enable_logging = false;
+        engine = std::make_unique<MatchingEngine>(config);
+        engine->start();
+        engine->addSymbol("BENCH");
+        applied = accepted = frames = 0;
+
+        // Everything is encoded and queued before the io_context runs, so the two costs separate
+        auto start = Clock::now();
+        if (basket == 1) {
+            for (const auto& order : orders) {
+                client.submitOrder(order);
+            }
+        } else {
+            for (size_t sent = 0; sent < orders.size(); sent += basket) {
+                client.submitOrders(orders.data() + sent, std::min(basket, orders.size() - sent));
+            }
+        }
+        uint64_t encode_nanos = nanosSince(start);
+        while (applied < orders.size() && io_context.run_one()) {
+        }
+        uint64_t total_nanos = nanosSince(start);
+
+        double encode_per_order = static_cast<double>(encode_nanos) / static_cast<double>(orders.size());
+        double total_per_order = static_cast<double>(total_nanos) / static_cast<double>(orders.size());
+        std::cout << (basket == 1 ? "submitOrder       " : "submitOrders x") << std::left << std::setw(4)
+                  << (basket == 1 ? "" : std::to_string(basket)) << std::right << std::setw(9) << orders.size()
+                  << " orders " << std::setw(7) << frames << " frames  encode " << std::fixed << std::setprecision(0)
+                  << std::setw(5) << encode_per_order << " ns/order  end to end " << std::setw(6) << total_per_order
+                  << " ns/order  accepted " << accepted << std::endl;
+        std::ostringstream row;
+        row << basket << "," << orders.size() << "," << frames << "," << encode_per_order << "," << total_per_order << ","
+            << accepted;
+        rows.push_back(row.str());
+    }
+
+    client.disconnect();
+    server.stop();
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Matcher batch sizing under a quiet / burst / quiet load.
+//
+// A load generator thread pushes new limit orders and cancels into an EngineShard open loop:
+// --quiet commands paced at --rate per second, then --burst commands as fast as it can, then
+// --quiet paced commands again. The same schedule runs against fixed drain batches (1, 64 and
+// 1024 commands) and against adaptive batching with a --budget-us latency budget. Reported per
+// mode: push -> result latency percentiles before, during and after the burst, time to clear
+// the burst, and the batch sizes the matcher actually took.
+//
+// Usage:
+//   batch_bench [--quiet N] [--rate N] [--burst N] [--budget-us N] [--csv FILE]
+
+#include "matching_engine/engine_shard.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,quiet_p50_ns,quiet_p99_ns,burst_p50_ns,burst_p99_ns,after_p50_ns,after_p99_ns,burst_clear_us,"
+                         "batch_p50,batch_p99,batch_max,limit_raises,limit_cuts";
+
+struct Mode {
+    std::string name;
+    size_t batch_size;
+    bool adaptive;
+};
+
+struct Schedule {
+    size_t quiet;
+    uint64_t rate;
+    size_t burst;
+};
+
+class LoadGenerator {
+    private:
+        FastRandom random_{41};
+        OrderId next_id_ = 1;
+        std::vector<OrderId> live_;
+
+    public:
+        // 70% new orders around 100.00, 30% cancels of earlier ones
+        EngineCommand next() {
+            if (!live_.empty() && random_.below(10) < 3) {
+                size_t pick = random_.below(live_.size());
+                OrderId id = live_[pick];
+                live_[pick] = live_.back();
+                live_.pop_back();
+                return EngineCommand::cancel(1, id, "BENCH");
+            }
+            OrderSide side = random_.below(2) ? OrderSide::SELL : OrderSide::BUY;
+            double offset = 0.01 * static_cast<double>(random_.below(20)) - 0.05; // negative offsets cross
+            Price price = side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset;
+            Order order(next_id_++, "BENCH", side, OrderType::LIMIT, price, 1 + random_.below(200));
+            order.setSession(1);
+            live_.push_back(order.getId());
+            return EngineCommand::newOrder(order);
+        }
+};
+
+struct Outcome {
+    LatencyRecorder quiet;
+    LatencyRecorder burst;
+    LatencyRecorder after;
+    uint64_t burst_clear_nanos = 0;
+    ShardStatistics stats{};
+    uint64_t batch_p50 = 0;
+    uint64_t batch_p99 = 0;
+    uint64_t batch_max = 0;
+};
+
+Outcome runMode(const Mode& mode, const Schedule& schedule, std::chrono::microseconds budget) {
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("BENCH");
+
+    ShardOptions options;
+    options.coalesce = false; // measure batching alone
+    options.batch_size = mode.batch_size;
+    options.adaptive_batching = mode.adaptive;
+    options.latency_budget = budget;
+    EngineShard shard(engine, options);
+
+    // Commands are numbered in push order; results come back in the same order
+    size_t total = schedule.quiet * 2 + schedule.burst;
+    size_t burst_begin = schedule.quiet;
+    size_t burst_end = schedule.quiet + schedule.burst;
+    Outcome outcome{LatencyRecorder(schedule.quiet), LatencyRecorder(schedule.burst), LatencyRecorder(schedule.quiet)};
+    std::atomic<size_t> reported{0};
+    int64_t burst_start_ns = 0;
+    int64_t burst_cleared_ns = 0;
+    size_t index = 0;
+    shard.setResultCallback([&](const CommandResult& result) {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        uint64_t latency = now > result.enqueue_ns ? static_cast<uint64_t>(now - result.enqueue_ns) : 0;
+        if (index < burst_begin) {
+            outcome.quiet.record(latency);
+        } else if (index < burst_end) {
+            outcome.burst.record(latency);
+            if (index + 1 == burst_end) burst_cleared_ns = now;
+        } else {
+            outcome.after.record(latency);
+        }
+        index++;
+        reported.store(index, std::memory_order_release);
+    });
+    shard.start();
+
+    LoadGenerator generator;
+    auto paced = [&](size_t count) {
+        auto interval = std::chrono::nanoseconds(1000000000ULL / std::max<uint64_t>(1, schedule.rate));
+        auto due = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            due += interval;
+            shard.submit(generator.next());
+            std::this_thread::sleep_until(due);
+        }
+    };
+    paced(schedule.quiet);
+    burst_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    for (size_t i = 0; i < schedule.burst; ++i) {
+        shard.submit(generator.next());
+    }
+    paced(schedule.quiet);
+
+    while (reported.load(std::memory_order_acquire) < total) {
+        std::this_thread::yield();
+    }
+    shard.stop();
+    outcome.burst_clear_nanos = burst_cleared_ns > burst_start_ns ? static_cast<uint64_t>(burst_cleared_ns - burst_start_ns) : 0;
+    outcome.stats = shard.getStatistics();
+    const ShardLatency& latency = shard.getLatency();
+    outcome.batch_p50 = latency.batch_size.percentile(50);
+    outcome.batch_p99 = latency.batch_size.percentile(99);
+    outcome.batch_max = latency.batch_size.max();
+    return outcome;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    Schedule schedule{args.getUint("--quiet", 5000), args.getUint("--rate", 10000), args.getUint("--burst", 20000)};
+    std::chrono::microseconds budget(std::max<uint64_t>(1, args.getUint("--budget-us", 100)));
+
+    std::cout << schedule.quiet << " commands at " << schedule.rate << "/s, burst of " << schedule.burst << ", then "
+              << schedule.quiet << " at " << schedule.rate << "/s; adaptive budget " << budget.count() << " us\n";
+
+    std::vector<Mode> modes = {{"fixed-1", 1, false}, {"fixed-64", 64, false}, {"fixed-1024", 1024, false},
+                               {"adaptive", 64, true}};
+    std::vector<std::string> rows;
+    for (const auto& mode : modes) {
+        Outcome outcome = runMode(mode, schedule, budget);
+        double clear_us = static_cast<double>(outcome.burst_clear_nanos) / 1000.0;
+        std::cout << std::left << std::setw(11) << mode.name << std::right << "  quiet p50/p99 "
+                  << outcome.quiet.percentile(50) << "/" << outcome.quiet.percentile(99) << " ns  burst p50/p99 "
+                  << outcome.burst.percentile(50) << "/" << outcome.burst.percentile(99) << " ns  after p50/p99 "
+                  << outcome.after.percentile(50) << "/" << outcome.after.percentile(99) << " ns  burst cleared in "
+                  << std::fixed << std::setprecision(0) << clear_us << " us  batch p50/p99/max " << outcome.batch_p50
+                  << "/" << outcome.batch_p99 << "/" << outcome.batch_max;
+        if (mode.adaptive) {
+            std::cout << "  limit raises " << outcome.stats.batch_limit_raises << " cuts " << outcome.stats.batch_limit_cuts;
+        }
+        std::cout << "\n";
+
+        std::ostringstream row;
+        row << mode.name << "," << outcome.quiet.percentile(50) << "," << outcome.quiet.percentile(99) << ","
+            << outcome.burst.percentile(50) << "," << outcome.burst.percentile(99) << "," << outcome.after.percentile(50)
+            << "," << outcome.after.percentile(99) << "," << clear_us << ","
+            << outcome.batch_p50 << "," << outcome.batch_p99 << "," << outcome.batch_max << ","
+            << outcome.stats.batch_limit_raises << "," << outcome.stats.batch_limit_cuts;
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline uint64_t nanosSince(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+/**
+ * @brief Latency samples for one thread/scenario, summarised as percentiles
+ */
+class LatencyRecorder {
+    private:
+        std::vector<uint64_t> samples_;
+        bool sorted_ = false;
+
+    public:
+        explicit LatencyRecorder(size_t expected_samples = 0) { samples_.reserve(expected_samples); }
+
+        void record(uint64_t nanos) { samples_.push_back(nanos); sorted_ = false; }
+
+        void merge(const LatencyRecorder& other) {
+            samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+            sorted_ = false;
+        }
+
+        size_t count() const { return samples_.size(); }
+
+        /**
+         * @brief Get a percentile of the recorded samples
+         * @param p Percentile in [0, 100]
+         * @return Latency in nanoseconds (0 if nothing was recorded)
+         */
+        uint64_t percentile(double p) {
+            if (samples_.empty()) return 0;
+            if (!sorted_) {
+                std::sort(samples_.begin(), samples_.end());
+                sorted_ = true;
+            }
+            size_t index = static_cast<size_t>(p / 100.0 * (samples_.size() - 1) + 0.5);
+            return samples_[std::min(index, samples_.size() - 1)];
+        }
+
+        uint64_t max() { return percentile(100.0); }
+};
+
+/**
+ * @brief Minimal "--name value" / "--flag" command line reader shared by the benchmarks
+ */
+class Args {
+    private:
+        std::vector<std::string> args_;
+
+    public:
+        Args(int argc, char** argv) : args_(argv + 1, argv + argc) {}
+
+        bool has(const std::string& name) const {
+            return std::find(args_.begin(), args_.end(), name) != args_.end();
+        }
+
+        std::string get(const std::string& name, const std::string& fallback) const {
+            auto it = std::find(args_.begin(), args_.end(), name);
+            if (it == args_.end() || it + 1 == args_.end()) return fallback;
+            return *(it + 1);
+        }
+
+        uint64_t getUint(const std::string& name, uint64_t fallback) const {
+            auto value = get(name, "");
+            return value.empty() ? fallback : std::strtoull(value.c_str(), nullptr, 10);
+        }
+};
+
+/**
+ * @brief Deterministic xorshift generator so runs are repeatable across machines
+ */
+class FastRandom {
+    private:
+        uint64_t state_;
+
+    public:
+        explicit FastRandom(uint64_t seed) : state_(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+        uint64_t next() {
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 7;
+            state_ ^= state_ << 17;
+            return state_;
+        }
+
+        uint64_t below(uint64_t bound) { return next() % bound; }
+};
+
+} // namespace bench
+} // namespace matching_engine
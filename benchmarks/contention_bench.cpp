@@ -0,0 +1,234 @@
+// Multi-threaded contention benchmark for MatchingEngine's engine_mutex_.
+//
+// M writer threads submit and cancel orders while R reader threads poll
+// getBestBid / getMarketDepth / getStatistics across N symbols. Each run reports
+// throughput, per-thread latency percentiles and the lock wait recorded by the
+// engine itself, and can append a CSV row so later engine modes can be compared
+// against benchmarks/results/contention_baseline.csv.
+//
+// Usage:
+//   contention_bench [--writers M] [--readers R] [--symbols N] [--duration-ms D]
+//                    [--resting K] [--mode LABEL] [--csv FILE] [--sweep] [--max-threads T]
+
+#include "matching_engine/matching_engine.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <deque>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+struct RunConfig {
+    size_t writers = 2;
+    size_t readers = 2;
+    size_t symbols = 4;
+    uint64_t duration_ms = 2000;
+    size_t resting_per_writer = 1000;
+    std::string mode = "shared_mutex";
+};
+
+struct ThreadResult {
+    std::string role;
+    size_t index = 0;
+    uint64_t operations = 0;
+    LatencyRecorder latencies;
+};
+
+std::string symbolName(size_t i) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "SYM%04zu", i);
+    return buffer;
+}
+
+void writerLoop(MatchingEngine& engine, const std::vector<std::string>& symbols, const RunConfig& config,
+                size_t writer_index, std::atomic<bool>& go, std::atomic<bool>& stop, ThreadResult& result) {
+    FastRandom rng(writer_index * 7919 + 17);
+    std::deque<std::pair<OrderId, size_t>> resting; // (order id, symbol index), oldest first
+    OrderId next_id = (static_cast<OrderId>(writer_index) + 1) << 40;
+
+    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        bool cancel = !resting.empty() && (resting.size() >= config.resting_per_writer || rng.below(100) < 20);
+        auto start = Clock::now();
+        if (cancel) {
+            auto [id, symbol_index] = resting.front();
+            resting.pop_front();
+            engine.cancelOrder(id, symbols[symbol_index]);
+        } else {
+            size_t symbol_index = rng.below(symbols.size());
+            OrderSide side = rng.below(2) ? OrderSide::BUY : OrderSide::SELL;
+            // Bids in [99.00, 100.00], asks in [100.00, 101.00]: only the touch crosses
+            Price price = (side == OrderSide::BUY) ? 99.00 + rng.below(101) * 0.01 : 100.00 + rng.below(101) * 0.01;
+            Order order(++next_id, symbols[symbol_index], side, OrderType::LIMIT, price, 1 + rng.below(500));
+            engine.submitOrder(order);
+            resting.emplace_back(next_id, symbol_index);
+        }
+        result.latencies.record(nanosSince(start));
+        result.operations++;
+    }
+}
+
+void readerLoop(MatchingEngine& engine, const std::vector<std::string>& symbols, size_t reader_index,
+                std::atomic<bool>& go, std::atomic<bool>& stop, ThreadResult& result) {
+    FastRandom rng(reader_index * 104729 + 3);
+    uint64_t sink = 0;
+
+    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        const auto& symbol = symbols[rng.below(symbols.size())];
+        auto start = Clock::now();
+        switch (result.operations % 3) {
+            case 0: sink += engine.getBestBid(symbol).has_value(); break;
+            case 1: sink += engine.getMarketDepth(symbol, 5).bids.size(); break;
+            default: sink += engine.getStatistics().total_orders_processed; break;
+        }
+        result.latencies.record(nanosSince(start));
+        result.operations++;
+    }
+    if (sink == 42) std::cout << ""; // keep the reads observable
+}
+
+void printThread(ThreadResult& r, double seconds) {
+    std::cout << "  " << std::left << std::setw(7) << r.role << std::right << std::setw(2) << r.index
+              << "  ops/s " << std::setw(10) << static_cast<uint64_t>(r.operations / seconds)
+              << "  p50 " << std::setw(7) << r.latencies.percentile(50)
+              << "  p99 " << std::setw(8) << r.latencies.percentile(99)
+              << "  p99.9 " << std::setw(8) << r.latencies.percentile(99.9)
+              << "  max " << std::setw(9) << r.latencies.max() << " ns" << std::endl;
+}
+
+std::string runOnce(const RunConfig& config) {
+    EngineConfig engine_config;
+    engine_config.enable_logging = false;
+    MatchingEngine engine(engine_config);
+    engine.start();
+
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < config.symbols; ++i) {
+        symbols.push_back(symbolName(i));
+        engine.addSymbol(symbols.back());
+    }
+
+    size_t expected = config.duration_ms * 500; // rough pre-size, grows if needed
+    std::vector<ThreadResult> results(config.writers + config.readers);
+    std::vector<std::thread> threads;
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+
+    for (size_t i = 0; i < config.writers; ++i) {
+        results[i].role = "writer";
+        results[i].index = i;
+        results[i].latencies = LatencyRecorder(expected);
+        threads.emplace_back(writerLoop, std::ref(engine), std::cref(symbols), std::cref(config), i,
+                             std::ref(go), std::ref(stop), std::ref(results[i]));
+    }
+    for (size_t i = 0; i < config.readers; ++i) {
+        auto& result = results[config.writers + i];
+        result.role = "reader";
+        result.index = i;
+        result.latencies = LatencyRecorder(expected);
+        threads.emplace_back(readerLoop, std::ref(engine), std::cref(symbols), i,
+                             std::ref(go), std::ref(stop), std::ref(result));
+    }
+
+    engine.resetStatistics();
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.duration_ms));
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    double seconds = nanosSince(start) / 1e9;
+    auto stats = engine.getStatistics();
+
+    LatencyRecorder write_all, read_all;
+    uint64_t write_ops = 0, read_ops = 0;
+    std::cout << "\n[" << config.mode << "] writers=" << config.writers << " readers=" << config.readers
+              << " symbols=" << config.symbols << " duration=" << config.duration_ms << "ms" << std::endl;
+    for (auto& r : results) {
+        printThread(r, seconds);
+        if (r.role == "writer") { write_all.merge(r.latencies); write_ops += r.operations; }
+        else { read_all.merge(r.latencies); read_ops += r.operations; }
+    }
+
+    double excl_wait_per_op = write_ops ? static_cast<double>(stats.exclusive_lock_wait_nanoseconds) / write_ops : 0.0;
+    double shared_wait_per_op = read_ops ? static_cast<double>(stats.shared_lock_wait_nanoseconds) / read_ops : 0.0;
+    std::cout << "  total   write ops/s " << static_cast<uint64_t>(write_ops / seconds)
+              << "  read ops/s " << static_cast<uint64_t>(read_ops / seconds) << std::endl;
+    std::cout << "  lock    exclusive waits " << stats.exclusive_lock_contentions
+              << " (" << std::fixed << std::setprecision(1) << excl_wait_per_op << " ns/write op)"
+              << "  shared waits " << stats.shared_lock_contentions
+              << " (" << shared_wait_per_op << " ns/read op)" << std::endl;
+
+    std::ostringstream row;
+    row << config.mode << "," << config.writers << "," << config.readers << "," << config.symbols << ","
+        << config.duration_ms << "," << static_cast<uint64_t>(write_ops / seconds) << ","
+        << static_cast<uint64_t>(read_ops / seconds) << ","
+        << write_all.percentile(50) << "," << write_all.percentile(99) << "," << write_all.percentile(99.9) << ","
+        << write_all.max() << ","
+        << read_all.percentile(50) << "," << read_all.percentile(99) << "," << read_all.percentile(99.9) << ","
+        << read_all.max() << ","
+        << stats.exclusive_lock_contentions << "," << std::fixed << std::setprecision(1) << excl_wait_per_op << ","
+        << stats.shared_lock_contentions << "," << shared_wait_per_op;
+    return row.str();
+}
+
+const char* CSV_HEADER =
+    "mode,writers,readers,symbols,duration_ms,write_ops_per_sec,read_ops_per_sec,"
+    "write_p50_ns,write_p99_ns,write_p999_ns,write_max_ns,read_p50_ns,read_p99_ns,read_p999_ns,read_max_ns,"
+    "exclusive_waits,exclusive_wait_ns_per_op,shared_waits,shared_wait_ns_per_op";
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    RunConfig base;
+    base.writers = args.getUint("--writers", base.writers);
+    base.readers = args.getUint("--readers", base.readers);
+    base.symbols = std::max<uint64_t>(1, args.getUint("--symbols", base.symbols));
+    base.duration_ms = args.getUint("--duration-ms", base.duration_ms);
+    base.resting_per_writer = std::max<uint64_t>(1, args.getUint("--resting", base.resting_per_writer));
+    base.mode = args.get("--mode", base.mode);
+
+    std::vector<RunConfig> runs;
+    if (args.has("--sweep")) {
+        // Scale writers and readers together with the core count, on one symbol and on N symbols
+        size_t max_threads = args.getUint("--max-threads", std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t symbols : {size_t{1}, base.symbols}) {
+            for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+                RunConfig run = base;
+                run.writers = threads;
+                run.readers = threads;
+                run.symbols = symbols;
+                runs.push_back(run);
+            }
+            if (base.symbols == 1) break;
+        }
+    } else {
+        runs.push_back(base);
+    }
+
+    std::vector<std::string> rows;
+    for (const auto& run : runs) {
+        rows.push_back(runOnce(run));
+    }
+
+    std::cout << "\n" << CSV_HEADER << std::endl;
+    for (const auto& row : rows) std::cout << row << std::endl;
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
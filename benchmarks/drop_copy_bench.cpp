@@ -0,0 +1,167 @@
+// Cost of feeding back-office consumers every execution: from the engine's own callbacks
+// versus through the drop-copy service.
+//
+// The same crossing order flow (--orders orders over --accounts accounts, grouped into --firms
+// firms) runs three times and submitOrder latency is recorded:
+//   none      - no execution consumers
+//   callbacks - --consumers trade callbacks, each building a text TRADE message per execution
+//               under the engine lock (how a back-office session is fed today)
+//   drop-copy - one event callback enqueueing into DropCopyService; --consumers subscribers
+//               per firm receive binary packets on the service thread
+// For the drop copy the bytes per execution are reported, every firm's feed is decoded and
+// checked to be gapless, and a recovery from sequence 1 must return the same executions.
+//
+// Usage:
+//   drop_copy_bench [--orders N] [--accounts N] [--firms N] [--consumers N] [--batch N] [--csv FILE]
+
+#include "matching_engine/drop_copy.hpp"
+#include "matching_engine/matching_engine.hpp"
+#include "matching_engine/protocol.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,orders,consumers,firms,p50_ns,p99_ns,p999_ns,executions,bytes_per_execution";
+
+struct Run {
+    LatencyRecorder latency;
+    uint64_t trades = 0;
+};
+
+template <typename Setup>
+Run runFlow(size_t orders, size_t accounts, Setup setup) {
+    EngineConfig config;
+    config.enable_logging = false;
+    config.max_order_quantity = 1000000;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("BENCH");
+    setup(engine);
+
+    Run run{LatencyRecorder(orders)};
+    FastRandom random(17);
+    for (size_t i = 0; i < orders; ++i) {
+        OrderSide side = random.below(2) ? OrderSide::BUY : OrderSide::SELL;
+        // Prices straddle the mid so roughly half the orders trade
+        Price price = 100.0 + (side == OrderSide::BUY ? 1.0 : -1.0) * (static_cast<double>(random.below(10)) - 4.5) * 0.01;
+        Order order(i + 1, "BENCH", side, OrderType::LIMIT, price, 1 + random.below(100));
+        order.setAccount(1 + random.below(accounts));
+        auto start = Clock::now();
+        run.trades += engine.submitOrder(order).size();
+        run.latency.record(nanosSince(start));
+    }
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t orders = args.getUint("--orders", 300000);
+    size_t accounts = std::max<uint64_t>(1, args.getUint("--accounts", 64));
+    size_t firms = std::max<uint64_t>(1, args.getUint("--firms", 8));
+    size_t consumers = args.getUint("--consumers", 4);
+    size_t batch = std::max<uint64_t>(1, args.getUint("--batch", 64));
+
+    std::vector<std::string> rows;
+    auto report = [&](const char* mode, Run& run, uint64_t executions, double bytes_per_execution) {
+        std::cout << std::left << std::setw(10) << mode << std::right << "  p50 " << std::setw(6)
+                  << run.latency.percentile(50) << " ns  p99 " << std::setw(7) << run.latency.percentile(99)
+                  << " ns  p99.9 " << std::setw(7) << run.latency.percentile(99.9) << " ns";
+        if (bytes_per_execution > 0) {
+            std::cout << "  " << std::fixed << std::setprecision(1) << bytes_per_execution << " B/execution";
+        }
+        std::cout << "\n";
+        std::ostringstream row;
+        row << mode << "," << orders << "," << consumers << "," << firms << "," << run.latency.percentile(50) << ","
+            << run.latency.percentile(99) << "," << run.latency.percentile(99.9) << "," << executions << ","
+            << bytes_per_execution;
+        rows.push_back(row.str());
+    };
+
+    std::cout << orders << " orders, " << accounts << " accounts in " << firms << " firms, " << consumers
+              << " consumers\n";
+
+    Run none = runFlow(orders, accounts, [](MatchingEngine&) {});
+    report("none", none, none.trades * 2, 0);
+
+    uint64_t text_bytes = 0; // callbacks run under the engine lock
+    Run callbacks = runFlow(orders, accounts, [&](MatchingEngine& engine) {
+        for (size_t c = 0; c < consumers; ++c) {
+            engine.registerTradeCallback([&text_bytes](const Trade& trade) {
+                Message message{MessageType::TRADE, trade.toString()};
+                text_bytes += serializeMessage(message).size();
+            });
+        }
+    });
+    report("callbacks", callbacks, callbacks.trades * 2, 0);
+
+    // Drop copy: firm f owns accounts f+1, f+1+firms, ...
+    DropCopyOptions options;
+    options.max_batch = batch;
+    options.retained_packets = SIZE_MAX;
+    DropCopyService drop_copy(options);
+    for (AccountId account = 1; account <= accounts; ++account) {
+        drop_copy.setFirm(account, static_cast<FirmId>((account - 1) % firms));
+    }
+    std::map<FirmId, std::vector<DropCopyExecution>> received;
+    std::atomic<uint64_t> decode_errors{0};
+    for (FirmId firm = 0; firm < firms; ++firm) {
+        for (size_t c = 0; c < consumers; ++c) {
+            drop_copy.subscribe(firm, [&received, &decode_errors, c](FirmId firm, const std::string& packet) {
+                if (c != 0) return; // one consumer per firm keeps what it got for the checks below
+                DropCopyPacketHeader header;
+                try {
+                    decodeDropCopyPacket(packet.data(), packet.size(), header, received[firm]);
+                } catch (const std::exception&) {
+                    decode_errors++;
+                }
+            });
+        }
+    }
+    Run drop = runFlow(orders, accounts, [&drop_copy](MatchingEngine& engine) {
+        engine.registerEventCallback([&drop_copy](const OrderEvent& event) { drop_copy.enqueue(event); });
+    });
+    drop_copy.flush();
+    uint64_t executions = 0;
+    for (const auto& [firm, list] : received) executions += list.size();
+    report("drop-copy", drop, executions,
+           executions ? static_cast<double>(drop_copy.getByteCount()) / static_cast<double>(executions) : 0);
+
+    // Every fill side reached its firm, in a gapless sequence, and recovery replays the same feed
+    bool ok = decode_errors == 0 && executions == drop.trades * 2;
+    for (const auto& [firm, list] : received) {
+        for (size_t i = 0; i < list.size() && ok; ++i) {
+            ok = list[i].sequence == i + 1 && (list[i].account - 1) % firms == firm;
+        }
+        std::vector<std::string> packets;
+        std::vector<DropCopyExecution> recovered;
+        ok = ok && drop_copy.recover(firm, 1, packets);
+        for (const auto& packet : packets) {
+            DropCopyPacketHeader header;
+            decodeDropCopyPacket(packet.data(), packet.size(), header, recovered);
+        }
+        ok = ok && recovered.size() == list.size() &&
+             std::equal(recovered.begin(), recovered.end(), list.begin(), [](const auto& a, const auto& b) {
+                 return a.sequence == b.sequence && a.trade_id == b.trade_id && a.order_id == b.order_id;
+             });
+    }
+    std::cout << drop_copy.getPacketCount() << " packets, feeds " << (ok ? "gapless and recoverable" : "INCONSISTENT")
+              << "\n";
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return ok ? 0 : 1;
+}
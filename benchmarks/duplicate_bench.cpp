@@ -0,0 +1,154 @@
+// Cost of per-session duplicate order id detection.
+//
+// 1. DuplicateOrderFilter on its own: ns per check for fresh ids and for resubmitted ids inside
+//    the window, and that every resubmission inside the window is caught while ids two
+//    windows old are forgotten.
+// 2. MatchingEngine::submitOrder latency with the per-session check on and off, on the same
+//    order flow, plus the filter memory per session as reported by getMemoryUsage().
+//
+// Usage:
+//   duplicate_bench [--window N] [--ids N] [--orders N] [--sessions N] [--csv FILE]
+
+#include "matching_engine/duplicate_filter.hpp"
+#include "matching_engine/matching_engine.hpp"
+#include "bench_common.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "scenario,window,operations,ns_per_op,p50_ns,p99_ns,bytes_per_session";
+
+struct FilterResult {
+    double fresh_ns = 0;
+    double repeat_ns = 0;
+    size_t missed_duplicates = 0;
+    size_t stale_hits = 0;
+};
+
+FilterResult benchFilter(size_t window, size_t ids) {
+    FilterResult result;
+    DuplicateOrderFilter filter(window);
+    FastRandom random(7);
+
+    // Fresh ids: random 64-bit values (clients rarely number orders densely across sessions)
+    std::vector<OrderId> fresh(ids);
+    for (auto& id : fresh) id = random.next() | 1;
+    auto start = Clock::now();
+    for (OrderId id : fresh) {
+        filter.checkAndInsert(id);
+    }
+    result.fresh_ns = static_cast<double>(nanosSince(start)) / ids;
+
+    // Resubmissions of ids still inside the window must all be caught
+    size_t window_ids = filter.getWindow();
+    start = Clock::now();
+    for (size_t i = 0; i < ids; ++i) {
+        OrderId id = fresh[ids - 1 - (i % window_ids)];
+        result.missed_duplicates += !filter.checkAndInsert(id);
+    }
+    result.repeat_ns = static_cast<double>(nanosSince(start)) / ids;
+
+    // Ids more than two windows old have certainly been forgotten
+    for (size_t i = 0; i + 2 * window_ids < ids && i < 10000; ++i) {
+        result.stale_hits += filter.contains(fresh[i]);
+    }
+
+    return result;
+}
+
+struct EngineResult {
+    LatencyRecorder latency;
+    size_t bytes_per_session = 0;
+};
+
+EngineResult benchEngine(size_t window, size_t orders, size_t sessions) {
+    EngineConfig config;
+    config.enable_logging = false;
+    config.duplicate_order_window = window;
+    config.max_order_quantity = 1000000;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("BENCH");
+
+    EngineResult result{LatencyRecorder(orders)};
+    FastRandom random(11);
+    std::vector<OrderId> live;
+    live.reserve(orders);
+    for (size_t i = 0; i < orders; ++i) {
+        OrderId id = i + 1;
+        OrderSide side = random.below(2) ? OrderSide::BUY : OrderSide::SELL;
+        Price price = 100.0 + (side == OrderSide::BUY ? -1.0 : 1.0) * (1 + random.below(50)) * 0.01;
+        Order order(id, "BENCH", side, OrderType::LIMIT, price, 1 + random.below(100));
+        order.setSession(1 + i % sessions);
+        auto start = Clock::now();
+        engine.submitOrder(order);
+        result.latency.record(nanosSince(start));
+        live.push_back(id);
+        // Keep the book at a steady size so both runs do the same matching work
+        if (live.size() > 5000) {
+            engine.cancelOrder(live[live.size() - 5001], "BENCH");
+        }
+    }
+    if (window > 0) {
+        result.bytes_per_session = engine.getMemoryUsage().getBytes(MemoryCategory::SESSION_FILTERS) / sessions;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t window = args.getUint("--window", EngineConfig{}.duplicate_order_window);
+    size_t ids = args.getUint("--ids", 1000000);
+    size_t orders = args.getUint("--orders", 500000);
+    size_t sessions = args.getUint("--sessions", 16);
+    std::vector<std::string> rows;
+
+    auto filter = benchFilter(window, ids);
+    DuplicateOrderFilter sizing(window);
+    std::cout << "DuplicateOrderFilter, window " << sizing.getWindow() << " ids, "
+              << sizing.getMemoryBytes() << " bytes\n"
+              << std::fixed << std::setprecision(1)
+              << "  fresh id check+insert   " << std::setw(7) << filter.fresh_ns << " ns\n"
+              << "  repeated id check       " << std::setw(7) << filter.repeat_ns << " ns\n"
+              << "  missed duplicates       " << std::setw(7) << filter.missed_duplicates << "\n"
+              << "  stale ids still flagged " << std::setw(7) << filter.stale_hits << "\n";
+    {
+        std::ostringstream row;
+        row << "filter_fresh," << sizing.getWindow() << "," << ids << "," << filter.fresh_ns << ",,," << sizing.getMemoryBytes();
+        rows.push_back(row.str());
+        row.str("");
+        row << "filter_repeat," << sizing.getWindow() << "," << ids << "," << filter.repeat_ns << ",,," << sizing.getMemoryBytes();
+        rows.push_back(row.str());
+    }
+
+    std::cout << "\nsubmitOrder, " << orders << " orders over " << sessions << " sessions\n";
+    for (size_t w : {size_t{0}, window}) {
+        auto result = benchEngine(w, orders, sessions);
+        const char* label = w == 0 ? "check off" : "check on";
+        std::cout << "  " << std::left << std::setw(10) << label << std::right
+                  << "  p50 " << std::setw(6) << result.latency.percentile(50) << " ns"
+                  << "  p99 " << std::setw(6) << result.latency.percentile(99) << " ns"
+                  << "  p99.9 " << std::setw(7) << result.latency.percentile(99.9) << " ns";
+        if (w > 0) std::cout << "  " << result.bytes_per_session << " B/session";
+        std::cout << "\n";
+        std::ostringstream row;
+        row << (w == 0 ? "engine_off," : "engine_on,") << w << "," << orders << ",,"
+            << result.latency.percentile(50) << "," << result.latency.percentile(99) << "," << result.bytes_per_session;
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return filter.missed_duplicates == 0 && filter.stale_hits == 0 ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+// Live handoff of a running engine to a new process.
+//
+// The outgoing process rests --orders orders over --symbols books, serves them on a loopback
+// Server and keeps --sessions client connections open, one of them holding half a line. It
+// then starts a successor (this binary again, with --successor), which connects over a Unix
+// socket; the engine is frozen, its books go to the successor in a shared memory region and
+// the listener and connections follow with SCM_RIGHTS. Reported: time to export and send on
+// the outgoing side and, from the successor, the trading pause from the freeze until it is
+// serving the inherited sockets. The clients then check that the successor answers on every
+// old connection (including the split line) and on a new one, and that no order was lost.
+//
+// Usage:
+//   handoff_bench [--orders N] [--symbols N] [--sessions N] [--csv FILE]
+
+#include "matching_engine/handoff.hpp"
+#include "bench_common.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "orders,symbols,sessions,region_bytes,export_us,send_us,pause_us";
+
+// "SUBMIT_ORDER|id,symbol,side,type,price,quantity" as written by Client::submitOrder
+bool parseSubmit(const std::string& payload, Order& order) {
+    const std::string prefix = "SUBMIT_ORDER|";
+    if (payload.compare(0, prefix.size(), prefix) != 0) return false;
+    std::istringstream in(payload.substr(prefix.size()));
+    std::string id, symbol, side, type, price, quantity;
+    if (!std::getline(in, id, ',') || !std::getline(in, symbol, ',') || !std::getline(in, side, ',') ||
+        !std::getline(in, type, ',') || !std::getline(in, price, ',') || !std::getline(in, quantity)) {
+        return false;
+    }
+    order = Order(std::stoull(id), symbol, static_cast<OrderSide>(std::stoi(side)), static_cast<OrderType>(std::stoi(type)),
+                  std::stod(price), std::stoull(quantity));
+    return true;
+}
+
+std::string symbolName(size_t index) {
+    return "S" + std::to_string(index);
+}
+
+std::string submitLine(OrderId id, const std::string& symbol, OrderSide side, Price price) {
+    std::ostringstream line;
+    line << "ORDER|SUBMIT_ORDER|" << id << "," << symbol << "," << static_cast<int>(side) << ","
+         << static_cast<int>(OrderType::LIMIT) << "," << price << ",10\n";
+    return line.str();
+}
+
+size_t restingOrders(const MatchingEngine& engine) {
+    MarketSnapshot snapshot(1);
+    engine.getMarketSnapshot(snapshot);
+    size_t total = 0;
+    for (size_t i = 0; i < snapshot.size(); ++i) total += snapshot[i].total_orders;
+    return total;
+}
+
+// Orders are acked with the serving process id, so the clients can tell who answered
+Server::MessageHandler gateway(MatchingEngine& engine, boost::asio::io_context& io_context) {
+    return [&engine, &io_context](const Message& msg, std::shared_ptr<boost::asio::ip::tcp::socket> socket) {
+        if (msg.type == MessageType::CANCEL && msg.payload == "STOP") {
+            io_context.stop();
+            return;
+        }
+        Order order(1, "S0", OrderSide::BUY, OrderType::LIMIT, 1.0, 1);
+        if (msg.type != MessageType::ORDER || !parseSubmit(msg.payload, order)) return;
+        engine.submitOrder(order);
+        std::string ack = "TRADE|ACK " + std::to_string(order.getId()) + " " + std::to_string(::getpid()) + "\n";
+        boost::system::error_code ec;
+        boost::asio::write(*socket, boost::asio::buffer(ack), ec);
+    };
+}
+
+int connectTo(unsigned short port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Read one ack line; returns the pid that sent it (0 on failure)
+long readAck(int fd) {
+    std::string line;
+    char c;
+    while (::read(fd, &c, 1) == 1 && c != '\n') line += c;
+    auto space = line.rfind(' ');
+    return space == std::string::npos ? 0 : std::stol(line.substr(space + 1));
+}
+
+// The new process: take over, report, serve until told to stop
+int runSuccessor(const std::string& path, size_t expected_orders) {
+    int channel = connectToPredecessor(path);
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    boost::asio::io_context io_context;
+
+    HandoffState state(channel);
+    size_t books = state.resume(engine);
+    boost::asio::ip::tcp::acceptor listener(io_context, boost::asio::ip::tcp::v4(), state.getListeners().at(0));
+    Server server(io_context, std::move(listener), gateway(engine, io_context));
+    for (const auto& session : state.getSessions()) {
+        server.adoptSession(session.fd, session.pending);
+    }
+    server.start();
+    int64_t pause_ns = Server::nowNanos() - state.getFrozenAt();
+    acknowledgeHandoff(channel);
+    ::close(channel);
+
+    size_t orders = restingOrders(engine);
+    std::cout << "successor " << ::getpid() << ": " << books << " books, " << orders << " orders, "
+              << state.getSessions().size() << " sessions, event sequence " << state.getEventSequence()
+              << ", trading pause " << std::fixed << std::setprecision(0) << pause_ns / 1000.0 << " us" << std::endl;
+    std::cout << "PAUSE_US " << pause_ns / 1000.0 << std::endl;
+    io_context.run();
+    return orders == expected_orders ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    std::string successor_path = args.get("--successor", "");
+    if (!successor_path.empty()) {
+        return runSuccessor(successor_path, args.getUint("--expect-orders", 0));
+    }
+    size_t orders = args.getUint("--orders", 100000);
+    size_t symbols = std::max<uint64_t>(3, args.getUint("--symbols", 50)); // the clients use S0..S2
+    size_t sessions = std::max<uint64_t>(1, args.getUint("--sessions", 16));
+
+    EngineConfig config;
+    config.enable_logging = false;
+    config.max_symbols = std::max(config.max_symbols, symbols);
+    MatchingEngine engine(config);
+    engine.start();
+    for (size_t s = 0; s < symbols; ++s) {
+        engine.addSymbol(symbolName(s));
+    }
+    FastRandom random(11);
+    for (size_t i = 0; i < orders; ++i) {
+        OrderSide side = i % 2 ? OrderSide::SELL : OrderSide::BUY;
+        Price price = 100.0 + (side == OrderSide::BUY ? -0.01 : 0.01) * static_cast<double>(1 + random.below(100));
+        engine.submitOrder(Order(i + 1, symbolName(i % symbols), side, OrderType::LIMIT, price, 1 + random.below(100)));
+    }
+    OrderId next_id = orders + 1;
+
+    boost::asio::io_context io_context;
+    Server server(io_context, 0, gateway(engine, io_context));
+    server.start();
+    std::thread io_thread([&io_context] { io_context.run(); });
+
+    // Clients: each places one order with the outgoing process, then one leaves half a line
+    std::vector<int> clients;
+    for (size_t i = 0; i < sessions; ++i) {
+        int fd = connectTo(server.getPort());
+        if (fd < 0) {
+            std::cerr << "connect failed\n";
+            return 1;
+        }
+        std::string line = submitLine(next_id++, "S0", OrderSide::BUY, 90.0);
+        ::write(fd, line.data(), line.size());
+        if (readAck(fd) != ::getpid()) {
+            std::cerr << "no ack from the outgoing process\n";
+            return 1;
+        }
+        clients.push_back(fd);
+    }
+    std::string split = submitLine(next_id++, "S0", OrderSide::SELL, 110.0);
+    ::write(clients[0], split.data(), split.size() / 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let the server read the first half
+    size_t expected = restingOrders(engine);
+
+    // Start the successor and hand over
+    std::string path = "/tmp/handoff_bench." + std::to_string(::getpid()) + ".sock";
+    int listener = listenForSuccessor(path);
+    int out[2];
+    if (::pipe(out) != 0) {
+        std::cerr << "pipe failed\n";
+        return 1;
+    }
+    std::string expect_arg = std::to_string(expected);
+    pid_t child = ::fork();
+    if (child == 0) {
+        ::dup2(out[1], STDOUT_FILENO);
+        ::close(out[0]);
+        ::close(out[1]);
+        ::execl("/proc/self/exe", argv[0], "--successor", path.c_str(), "--expect-orders", expect_arg.c_str(),
+                static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+    ::close(out[1]);
+    int channel = acceptSuccessor(listener);
+
+    io_context.stop(); // nothing may read the sockets once their state is exported
+    io_thread.join();
+    HandoffReport report = handOver(channel, engine, server.getListenerHandle(), server.getSessionHandles());
+    ::close(channel);
+    ::close(listener);
+    ::unlink(path.c_str());
+    if (!report.accepted) {
+        std::cerr << "successor did not take over\n";
+        return 1;
+    }
+
+    // Every old connection, the split line and a new connection must reach the successor
+    bool served = true;
+    ::write(clients[0], split.data() + split.size() / 2, split.size() - split.size() / 2);
+    long successor = readAck(clients[0]);
+    served = successor > 0 && successor != ::getpid();
+    for (size_t i = 1; i < clients.size(); ++i) {
+        std::string line = submitLine(next_id++, "S1", OrderSide::BUY, 80.0);
+        ::write(clients[i], line.data(), line.size());
+        served = served && readAck(clients[i]) == successor;
+    }
+    int fresh = connectTo(server.getPort());
+    std::string line = submitLine(next_id++, "S2", OrderSide::BUY, 80.0);
+    served = served && fresh >= 0 && ::write(fresh, line.data(), line.size()) > 0 && readAck(fresh) == successor;
+    std::string stop = "CANCEL|STOP\n";
+    ::write(fresh, stop.data(), stop.size());
+
+    std::string output;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(out[0], buffer, sizeof(buffer))) > 0) output.append(buffer, static_cast<size_t>(n));
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    for (int fd : clients) ::close(fd);
+    if (fresh >= 0) ::close(fresh);
+
+    double pause_us = 0;
+    std::istringstream lines(output);
+    for (std::string text; std::getline(lines, text);) {
+        if (text.rfind("PAUSE_US ", 0) == 0) {
+            pause_us = std::stod(text.substr(9));
+        } else {
+            std::cout << text << "\n";
+        }
+    }
+    bool complete = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    double export_us = report.export_nanos / 1000.0;
+    double send_us = report.send_nanos / 1000.0;
+    std::cout << "outgoing " << ::getpid() << ": " << report.books << " books, " << expected << " orders, "
+              << report.sessions << " sessions, " << report.region_bytes << " byte region, exported in " << std::fixed
+              << std::setprecision(0) << export_us << " us, sent in " << send_us << " us\n";
+    std::cout << "trading pause " << pause_us << " us; successor served every session: " << (served ? "yes" : "NO")
+              << "; all orders carried over: " << (complete ? "yes" : "NO") << "\n";
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        csv << orders << "," << symbols << "," << sessions << "," << report.region_bytes << "," << export_us << ","
+            << send_us << "," << pause_us << "\n";
+    }
+    return served && complete ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// Point-in-time reconstruction cost and correctness.
+//
+// Drives a MatchingEngine with a random order flow (limit/market/cancel/modify over S
+// symbols) while it writes a command journal, recording each symbol's full depth at random
+// sequence numbers along the way. Then builds checkpoints every I commands and:
+// - checks that BookHistory::bookAtSequence reproduces every recorded depth exactly
+// - times random point-in-time queries (by sequence and by wall-clock time)
+//
+// Usage:
+//   history_bench [--commands N] [--symbols S] [--interval I] [--queries Q] [--dir DIR]
+
+#include "matching_engine/matching_engine.hpp"
+#include "matching_engine/book_history.hpp"
+#include "bench_common.hpp"
+#include <filesystem>
+#include <map>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+struct Expected {
+    uint64_t sequence;
+    std::string symbol;
+    std::vector<std::pair<Price, Quantity>> bids;
+    std::vector<std::pair<Price, Quantity>> asks;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    uint64_t commands = args.getUint("--commands", 1000000);
+    size_t symbol_count = args.getUint("--symbols", 4);
+    uint64_t interval = args.getUint("--interval", 100000);
+    size_t queries = args.getUint("--queries", 200);
+    std::string dir = args.get("--dir", "history_bench.tmp");
+
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string journal_path = dir + "/commands.journal";
+
+    // ---- Record --------------------------------------------------------------
+    EngineConfig config;
+    config.enable_logging = false;
+    config.max_orders_per_symbol = SIZE_MAX;
+    MatchingEngine engine(config);
+    auto journal = JournalWriter::open(journal_path);
+    engine.setCommandJournal(journal);
+    engine.start();
+
+    std::vector<std::string> symbols;
+    for (size_t s = 0; s < symbol_count; ++s) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "SYM%zu", s);
+        symbols.push_back(name);
+        engine.addSymbol(name);
+    }
+
+    FastRandom rng(42);
+    std::vector<std::vector<OrderId>> live(symbol_count);
+    std::vector<Expected> expected;
+    OrderId next_id = 1;
+    auto record_start = Clock::now();
+    for (uint64_t i = 0; i < commands; ++i) {
+        size_t s = rng.below(symbol_count);
+        const std::string& symbol = symbols[s];
+        uint64_t action = rng.below(100);
+        if (action < 60 || live[s].empty()) {
+            OrderSide side = rng.below(2) ? OrderSide::BUY : OrderSide::SELL;
+            Price price = 100.0 + (static_cast<double>(rng.below(41)) - 20.0) * 0.05;
+            engine.submitOrder(Order(next_id, symbol, side, OrderType::LIMIT, price, 1 + rng.below(500)));
+            live[s].push_back(next_id++);
+        } else if (action < 65) {
+            OrderSide side = rng.below(2) ? OrderSide::BUY : OrderSide::SELL;
+            engine.submitOrder(Order(next_id++, symbol, side, 1 + rng.below(300)));
+        } else if (action < 90) {
+            size_t pick = rng.below(live[s].size());
+            engine.cancelOrder(live[s][pick], symbol);
+            live[s][pick] = live[s].back();
+            live[s].pop_back();
+        } else {
+            OrderId id = live[s][rng.below(live[s].size())];
+            Price price = 100.0 + (static_cast<double>(rng.below(41)) - 20.0) * 0.05;
+            engine.modifyOrder(id, symbol, price, 1 + rng.below(500));
+        }
+
+        if (rng.below(commands / 50 + 1) == 0) {
+            auto depth = engine.getMarketDepth(symbol, SIZE_MAX);
+            expected.push_back({journal->getLastSequence(), symbol, depth.bids, depth.asks});
+        }
+    }
+    engine.stop();
+    double record_seconds = nanosSince(record_start) / 1e9;
+    uint64_t last_sequence = journal->getLastSequence();
+    std::cout << "Recorded " << last_sequence << " journal records in " << std::fixed << std::setprecision(2)
+              << record_seconds << " s (" << std::filesystem::file_size(journal_path) / (1024 * 1024) << " MiB)" << std::endl;
+
+    // ---- Build checkpoints --------------------------------------------------
+    CheckpointOptions options;
+    options.interval_commands = interval;
+    auto build_start = Clock::now();
+    size_t checkpoints = BookHistory::buildCheckpoints(journal_path, dir + "/history", options);
+    std::cout << "Built " << checkpoints << " checkpoints (every " << interval << " commands) in "
+              << nanosSince(build_start) / 1000000 << " ms" << std::endl;
+
+    BookHistory history(journal_path, dir + "/history");
+
+    // ---- Verify -------------------------------------------------------------
+    size_t mismatches = 0;
+    for (const auto& want : expected) {
+        auto got = history.bookAtSequence(want.symbol, want.sequence);
+        if (got.book->getBidLevels(SIZE_MAX) != want.bids || got.book->getAskLevels(SIZE_MAX) != want.asks) {
+            if (mismatches++ < 5) {
+                std::cerr << "MISMATCH " << want.symbol << " at sequence " << want.sequence << std::endl;
+            }
+        }
+    }
+    std::cout << "Verified " << expected.size() << " recorded books: " << mismatches << " mismatches" << std::endl;
+
+    // ---- Query latency ------------------------------------------------------
+    JournalReader reader(journal_path);
+    JournalRecord first, last;
+    reader.read(1, &first, 1);
+    reader.read(last_sequence, &last, 1);
+
+    LatencyRecorder by_sequence(queries), by_time(queries);
+    uint64_t replayed = 0;
+    for (size_t q = 0; q < queries; ++q) {
+        const std::string& symbol = symbols[rng.below(symbol_count)];
+        auto start = Clock::now();
+        auto result = history.bookAtSequence(symbol, 1 + rng.below(last_sequence));
+        by_sequence.record(nanosSince(start));
+        replayed += result.replayed_commands;
+
+        int64_t when = first.timestamp_ns + static_cast<int64_t>(rng.below(static_cast<uint64_t>(last.timestamp_ns - first.timestamp_ns) + 1));
+        start = Clock::now();
+        history.bookAtTime(symbol, when);
+        by_time.record(nanosSince(start));
+    }
+
+    auto report = [](const char* label, LatencyRecorder& latencies) {
+        std::cout << "  " << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(3)
+                  << " p50 " << std::setw(8) << latencies.percentile(50) / 1e6 << " ms"
+                  << "  p99 " << std::setw(8) << latencies.percentile(99) / 1e6 << " ms"
+                  << "  max " << std::setw(8) << latencies.max() / 1e6 << " ms" << std::endl;
+    };
+    std::cout << "Point-in-time queries (" << queries << " each, avg " << replayed / std::max<size_t>(1, queries)
+              << " journal records replayed):" << std::endl;
+    report("by sequence", by_sequence);
+    report("by time", by_time);
+
+    std::filesystem::remove_all(dir);
+    return mismatches == 0 ? 0 : 1;
+}
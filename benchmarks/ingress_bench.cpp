@@ -0,0 +1,150 @@
+// Effect of ingress coalescing on a quoting burst.
+//
+// --sessions market makers each rest --quotes quotes, then the burst is queued before the
+// matcher looks at it: every quote is amended --amends times, a --cancel-pct share of the
+// quotes is then cancelled, and each session also sends --flickers new orders that it
+// cancels straight away. The burst is applied by an EngineShard once with coalescing off
+// (plain FIFO) and once with it on. Reported per mode: commands that reached the engine, time
+// to apply the whole burst, and the coalescing counters. Quotes never cross, so both modes
+// must end with the same books; this is checked.
+//
+// Usage:
+//   ingress_bench [--sessions N] [--quotes N] [--amends N] [--cancel-pct N] [--flickers N] [--csv FILE]
+
+#include "matching_engine/engine_shard.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,commands_pushed,commands_applied,book_commands,amends_coalesced,orders_annihilated,burst_us";
+
+struct Result {
+    IngressStatistics ingress;
+    uint64_t book_commands = 0;   // results that touched a book
+    uint64_t burst_nanos = 0;
+    MarketDepth depth;
+};
+
+Result runBurst(bool coalesce, size_t sessions, size_t quotes, size_t amends, size_t cancel_pct, size_t flickers) {
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("BENCH");
+
+    // Resting quotes, straight into the engine: bids below 100, asks above, never crossing
+    auto quotePrice = [](OrderSide side, uint64_t level) {
+        return 100.0 + (side == OrderSide::BUY ? -0.01 : 0.01) * static_cast<double>(1 + level % 50);
+    };
+    OrderId next_id = 1;
+    std::vector<Order> resting;
+    for (size_t s = 0; s < sessions; ++s) {
+        for (size_t q = 0; q < quotes; ++q) {
+            OrderSide side = q % 2 ? OrderSide::SELL : OrderSide::BUY;
+            Order order(next_id++, "BENCH", side, OrderType::LIMIT, quotePrice(side, q), 100);
+            order.setSession(s + 1);
+            engine.submitOrder(order);
+            resting.push_back(order);
+        }
+    }
+
+    ShardOptions options;
+    options.coalesce = coalesce;
+    EngineShard shard(engine, options);
+    std::atomic<uint64_t> book_commands{0};
+    std::atomic<uint64_t> results{0};
+    shard.setResultCallback([&](const CommandResult& result) {
+        if (result.status != CommandStatus::ANNIHILATED && result.status != CommandStatus::SUPERSEDED) book_commands++;
+        results++;
+    });
+
+    // Queue the whole burst first: the matcher is behind
+    FastRandom random(23);
+    uint64_t pushed = 0;
+    for (const auto& quote : resting) {
+        SessionId session = quote.getSession();
+        for (size_t a = 0; a < amends; ++a) {
+            shard.amendOrder(session, quote.getId(), "BENCH", quotePrice(quote.getSide(), random.below(50)), 1 + random.below(500));
+            pushed++;
+        }
+        if (random.below(100) < cancel_pct) {
+            shard.cancelOrder(session, quote.getId(), "BENCH");
+            pushed++;
+        }
+    }
+    for (size_t s = 0; s < sessions; ++s) {
+        for (size_t f = 0; f < flickers; ++f) {
+            OrderSide side = f % 2 ? OrderSide::SELL : OrderSide::BUY;
+            Order order(next_id++, "BENCH", side, OrderType::LIMIT, quotePrice(side, f), 10);
+            order.setSession(s + 1);
+            shard.submitOrder(order);
+            shard.cancelOrder(s + 1, order.getId(), "BENCH");
+            pushed += 2;
+        }
+    }
+
+    auto start = Clock::now();
+    shard.start();
+    uint64_t expected = pushed; //folded commands are acknowledged too
+    while (results.load() < expected) {
+        std::this_thread::yield();
+    }
+    Result result;
+    result.burst_nanos = nanosSince(start);
+    shard.stop();
+    result.ingress = shard.getStatistics().ingress;
+    result.book_commands = book_commands;
+    result.depth = engine.getMarketDepth("BENCH", SIZE_MAX);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t sessions = std::max<uint64_t>(1, args.getUint("--sessions", 8));
+    size_t quotes = args.getUint("--quotes", 200);
+    size_t amends = args.getUint("--amends", 4);
+    size_t cancel_pct = args.getUint("--cancel-pct", 25);
+    size_t flickers = args.getUint("--flickers", 100);
+
+    std::cout << sessions << " sessions x " << quotes << " quotes, " << amends << " amends each, " << cancel_pct
+              << "% cancelled, " << flickers << " new+cancel per session\n";
+
+    std::vector<std::string> rows;
+    Result plain = runBurst(false, sessions, quotes, amends, cancel_pct, flickers);
+    Result folded = runBurst(true, sessions, quotes, amends, cancel_pct, flickers);
+    for (auto [mode, result] : {std::make_pair("fifo", &plain), std::make_pair("coalesce", &folded)}) {
+        double burst_us = static_cast<double>(result->burst_nanos) / 1000.0;
+        std::cout << std::left << std::setw(9) << mode << std::right << "  pushed " << result->ingress.commands_pushed
+                  << "  applied " << result->ingress.commands_drained << "  book commands " << result->book_commands
+                  << "  amends coalesced " << result->ingress.amends_coalesced << "  orders annihilated "
+                  << result->ingress.orders_annihilated << "  burst " << std::fixed << std::setprecision(1) << burst_us
+                  << " us\n";
+        std::ostringstream row;
+        row << mode << "," << result->ingress.commands_pushed << "," << result->ingress.commands_drained << ","
+            << result->book_commands << "," << result->ingress.amends_coalesced << "," << result->ingress.orders_annihilated
+            << "," << burst_us;
+        rows.push_back(row.str());
+    }
+
+    bool same = plain.depth.bids == folded.depth.bids && plain.depth.asks == folded.depth.asks &&
+                plain.depth.total_orders == folded.depth.total_orders;
+    std::cout << "final books " << (same ? "identical" : "DIFFER") << "\n";
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return same ? 0 : 1;
+}
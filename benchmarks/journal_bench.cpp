@@ -0,0 +1,180 @@
+// Durable commit cost of the journal backends: write + fdatasync vs group commit through io_uring.
+//
+// Every command appends one record and asks for durability with JournalWriter::commitAsync;
+// its ack is the callback that says the record is on disk. Backends: FileJournalStorage
+// (write(2) + fdatasync(2) per commit, blocking the writer), UringJournalStorage with O_DIRECT
+// and no group window, and the same with a --window-us group window. Each runs on a local disk
+// directory (--dir) and on tmpfs (--tmpfs-dir), once flat out and once paced at --rate commits/s
+// (latency measured from each command's scheduled time, so a writer that falls behind pays).
+// Reported: commits acknowledged per second, durable MB/s, I/O system calls per commit (write,
+// fdatasync, io_uring_enter; futex wakeups are not counted), append -> ack latency, and the
+// record count read back from the file afterwards.
+//
+// Usage:
+//   journal_bench [--dir PATH] [--tmpfs-dir PATH] [--seconds N] [--rate N] [--window-us N] [--csv FILE]
+
+#include "matching_engine/journal.hpp"
+#include "matching_engine/latency_histogram.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "fs,backend,mode,commits,commits_per_sec,mb_per_sec,syscalls_per_commit,ack_p50_ns,ack_p99_ns,ack_p999_ns,read_back";
+
+enum class Backend { FILE, URING, URING_WINDOW };
+
+const char* backendName(Backend backend) {
+    switch (backend) {
+        case Backend::FILE: return "write+fdatasync";
+        case Backend::URING: return "io_uring";
+        case Backend::URING_WINDOW: return "io_uring+window";
+    }
+    return "?";
+}
+
+// Counts the system calls FileJournalStorage makes (one per write() / sync())
+class CountingStorage : public JournalStorage {
+    private:
+        FileJournalStorage inner_;
+
+    public:
+        uint64_t calls = 0;
+
+        explicit CountingStorage(const std::string& path) : inner_(path) {}
+        void write(const void* data, size_t size) override {
+            calls++;
+            inner_.write(data, size);
+        }
+        void sync() override {
+            calls++;
+            inner_.sync();
+        }
+};
+
+struct RunResult {
+    uint64_t commits = 0;
+    double seconds = 0;
+    double syscalls_per_commit = 0;
+    uint64_t ack_p50 = 0;
+    uint64_t ack_p99 = 0;
+    uint64_t ack_p999 = 0;
+    uint64_t read_back = 0;
+};
+
+RunResult run(Backend backend, const std::string& dir, bool paced, uint64_t rate, double seconds, uint64_t window_us) {
+    std::string path = dir + "/journal_bench.mej";
+    ::unlink(path.c_str());
+    CountingStorage* counting = nullptr;
+    UringJournalStorage* uring = nullptr;
+    auto writer = JournalWriter::open(path, [&](const std::string& file) -> std::unique_ptr<JournalStorage> {
+        if (backend == Backend::FILE) {
+            auto storage = std::make_unique<CountingStorage>(file);
+            counting = storage.get();
+            return storage;
+        }
+        UringJournalOptions options;
+        if (backend == Backend::URING_WINDOW) {
+            options.group_window = std::chrono::microseconds(window_us);
+        }
+        auto storage = std::make_unique<UringJournalStorage>(file, options);
+        uring = storage.get();
+        return storage;
+    });
+    writer->commit(); //the header
+    uint64_t calls_before = counting ? counting->calls : uring->getStatistics().enters;
+    uint64_t commits_before = uring ? uring->getStatistics().commits : 0;
+
+    auto ack = std::make_unique<LatencyHistogram>();
+    std::atomic<uint64_t> acked{0};
+    auto interval = std::chrono::nanoseconds(1000000000 / std::max<uint64_t>(1, rate));
+    auto start = Clock::now();
+    auto until = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    uint64_t commits = 0;
+    for (auto now = start; now < until; now = Clock::now()) {
+        auto scheduled = now;
+        if (paced) {
+            scheduled = start + interval * commits;
+            while (Clock::now() < scheduled) {
+                std::this_thread::yield();
+            }
+        }
+        JournalRecord record;
+        record.order_id = commits + 1;
+        record.price = 100.0;
+        record.quantity = 100;
+        record.setSymbol("BENCH");
+        writer->append(record);
+        writer->commitAsync([&ack, &acked, scheduled](uint64_t) {
+            ack->record(nanosSince(scheduled));
+            acked.fetch_add(1, std::memory_order_release);
+        });
+        commits++;
+    }
+    while (acked.load(std::memory_order_acquire) < commits) {
+        std::this_thread::yield();
+    }
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.commits = commits;
+    uint64_t calls = counting ? counting->calls - calls_before : uring->getStatistics().enters - calls_before;
+    uint64_t counted = uring ? uring->getStatistics().commits - commits_before : commits;
+    result.syscalls_per_commit = counted ? static_cast<double>(calls) / static_cast<double>(counted) : 0.0;
+    result.ack_p50 = ack->percentile(50);
+    result.ack_p99 = ack->percentile(99);
+    result.ack_p999 = ack->percentile(99.9);
+    writer.reset(); //closes the storage (trimming direct I/O padding)
+    result.read_back = JournalReader(path).getRecordCount();
+    ::unlink(path.c_str());
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    std::string dir = args.get("--dir", "/tmp");
+    std::string tmpfs_dir = args.get("--tmpfs-dir", "/dev/shm");
+    double seconds = static_cast<double>(std::max<uint64_t>(1, args.getUint("--seconds", 1)));
+    uint64_t rate = std::max<uint64_t>(1, args.getUint("--rate", 5000));
+    uint64_t window_us = args.getUint("--window-us", 200);
+
+    std::vector<std::string> rows;
+    for (const auto& [fs, path] : {std::pair<std::string, std::string>{"disk", dir}, {"tmpfs", tmpfs_dir}}) {
+        for (Backend backend : {Backend::FILE, Backend::URING, Backend::URING_WINDOW}) {
+            for (bool paced : {false, true}) {
+                RunResult result = run(backend, path, paced, rate, seconds, window_us);
+                double per_second = static_cast<double>(result.commits) / result.seconds;
+                double mb = per_second * sizeof(JournalRecord) / 1e6;
+                std::cout << std::left << std::setw(6) << fs << std::setw(17) << backendName(backend) << std::setw(7)
+                          << (paced ? "paced" : "flat") << std::right << std::fixed << std::setprecision(0) << std::setw(9)
+                          << per_second << " commits/s " << std::setprecision(2) << std::setw(7) << mb << " MB/s "
+                          << std::setw(6) << result.syscalls_per_commit << " syscalls/commit  ack p50 " << std::setw(9)
+                          << result.ack_p50 << " ns  p99 " << std::setw(9) << result.ack_p99 << " ns  p99.9 " << std::setw(9)
+                          << result.ack_p999 << " ns  read back " << result.read_back << "/" << result.commits << std::endl;
+                std::ostringstream row;
+                row << fs << "," << backendName(backend) << "," << (paced ? "paced" : "flat") << "," << result.commits << ","
+                    << per_second << "," << mb << "," << result.syscalls_per_commit << "," << result.ack_p50 << ","
+                    << result.ack_p99 << "," << result.ack_p999 << "," << result.read_back;
+                rows.push_back(row.str());
+            }
+        }
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Compact vs fixed-layout market-data encoding.
+//
+// Builds a realistic stream of price level updates by running a random order flow through
+// one OrderBook per symbol and diffing the top --depth levels of the touched book after each
+// command. The stream is cut into packets of --batch updates and encoded both ways; the
+// report gives bytes per update and encode/decode ns per update for each format, and every
+// decoded packet is checked against the original updates.
+//
+// Usage:
+//   market_data_bench [--commands N] [--symbols N] [--depth N] [--batch N] [--rounds N] [--csv FILE]
+
+#include "matching_engine/market_data.hpp"
+#include "matching_engine/order_book.hpp"
+#include "bench_common.hpp"
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "format,updates,batch,bytes_per_update,encode_ns_per_update,decode_ns_per_update";
+
+using Levels = std::vector<std::pair<Price, Quantity>>;
+
+// Level changes between two top-of-book views of one side
+void diffLevels(const Levels& before, const Levels& after, SymbolId symbol, OrderSide side,
+                std::vector<MarketDataUpdate>& updates) {
+    std::map<Price, Quantity> old_levels(before.begin(), before.end());
+    for (const auto& [price, quantity] : after) {
+        auto it = old_levels.find(price);
+        if (it == old_levels.end() || it->second != quantity) {
+            updates.push_back(MarketDataUpdate{updates.size() + 1, symbol, side, price, quantity});
+        }
+        if (it != old_levels.end()) old_levels.erase(it);
+    }
+    for (const auto& [price, quantity] : old_levels) {
+        updates.push_back(MarketDataUpdate{updates.size() + 1, symbol, side, price, 0});
+    }
+}
+
+std::vector<MarketDataUpdate> generateUpdates(size_t commands, size_t symbols, size_t depth) {
+    std::vector<std::unique_ptr<OrderBook>> books;
+    std::vector<Price> mids;
+    for (size_t s = 0; s < symbols; ++s) {
+        books.push_back(std::make_unique<OrderBook>());
+        mids.push_back(20.0 + 37.0 * s);
+    }
+    std::vector<std::vector<OrderId>> live(symbols);
+    std::vector<MarketDataUpdate> updates;
+    FastRandom random(3);
+    OrderId next_id = 1;
+
+    for (size_t c = 0; c < commands; ++c) {
+        size_t s = random.below(symbols);
+        OrderBook& book = *books[s];
+        Levels bids = book.getBidLevels(depth);
+        Levels asks = book.getAskLevels(depth);
+
+        uint64_t action = random.below(10);
+        if (action < 3 && !live[s].empty()) {
+            size_t pick = random.below(live[s].size());
+            book.cancelOrder(live[s][pick]);
+            live[s][pick] = live[s].back();
+            live[s].pop_back();
+        } else {
+            // Limit orders cluster around a slowly walking mid; some cross and trade
+            if (random.below(50) == 0) mids[s] += (random.below(2) ? 0.01 : -0.01);
+            OrderSide side = random.below(2) ? OrderSide::BUY : OrderSide::SELL;
+            int64_t offset = static_cast<int64_t>(random.below(12)) - 2;
+            Price price = std::round((mids[s] + (side == OrderSide::BUY ? -offset : offset) * 0.01) * 100.0) / 100.0;
+            Quantity quantity = 100 * (1 + random.below(20));
+            OrderId id = next_id++;
+            book.addOrder(Order(id, "SYM", side, OrderType::LIMIT, price, quantity));
+            live[s].push_back(id);
+        }
+
+        diffLevels(bids, book.getBidLevels(depth), static_cast<SymbolId>(s), OrderSide::BUY, updates);
+        diffLevels(asks, book.getAskLevels(depth), static_cast<SymbolId>(s), OrderSide::SELL, updates);
+    }
+    return updates;
+}
+
+struct FormatResult {
+    double bytes_per_update = 0;
+    double encode_ns = 0;
+    double decode_ns = 0;
+    size_t mismatches = 0;
+};
+
+FormatResult benchFixed(const std::vector<MarketDataUpdate>& updates, size_t batch, size_t rounds) {
+    FormatResult result;
+    std::vector<std::string> packets((updates.size() + batch - 1) / batch);
+    uint64_t encode_ns = 0, decode_ns = 0;
+    size_t bytes = 0;
+    std::vector<MarketDataUpdate> decoded;
+    decoded.reserve(batch);
+    for (size_t round = 0; round < rounds; ++round) {
+        auto start = Clock::now();
+        for (size_t p = 0; p < packets.size(); ++p) {
+            packets[p].clear();
+            size_t first = p * batch;
+            encodeFixedUpdates(&updates[first], std::min(batch, updates.size() - first), packets[p]);
+        }
+        encode_ns += nanosSince(start);
+
+        start = Clock::now();
+        for (const auto& packet : packets) {
+            decoded.clear();
+            decodeFixedUpdates(packet.data(), packet.size(), decoded);
+        }
+        decode_ns += nanosSince(start);
+    }
+    for (size_t p = 0; p < packets.size(); ++p) {
+        bytes += packets[p].size();
+        decoded.clear();
+        decodeFixedUpdates(packets[p].data(), packets[p].size(), decoded);
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            result.mismatches += !(decoded[i] == updates[p * batch + i]);
+        }
+    }
+    double total = static_cast<double>(updates.size());
+    result.bytes_per_update = bytes / total;
+    result.encode_ns = encode_ns / (total * rounds);
+    result.decode_ns = decode_ns / (total * rounds);
+    return result;
+}
+
+FormatResult benchCompact(const std::vector<MarketDataUpdate>& updates, size_t batch, size_t rounds) {
+    FormatResult result;
+    std::vector<std::string> packets((updates.size() + batch - 1) / batch);
+    uint64_t encode_ns = 0, decode_ns = 0;
+    size_t bytes = 0;
+    std::vector<MarketDataUpdate> decoded;
+    decoded.reserve(batch);
+    for (size_t round = 0; round < rounds; ++round) {
+        MarketDataEncoder encoder; // a fresh stream each round, starting with a reset packet
+        auto start = Clock::now();
+        for (size_t p = 0; p < packets.size(); ++p) {
+            packets[p].clear();
+            size_t first = p * batch;
+            encoder.encodePacket(&updates[first], std::min(batch, updates.size() - first), packets[p]);
+        }
+        encode_ns += nanosSince(start);
+
+        MarketDataDecoder decoder;
+        start = Clock::now();
+        for (const auto& packet : packets) {
+            decoded.clear();
+            decoder.decodePacket(packet.data(), packet.size(), decoded);
+        }
+        decode_ns += nanosSince(start);
+    }
+    MarketDataDecoder decoder;
+    for (size_t p = 0; p < packets.size(); ++p) {
+        bytes += packets[p].size();
+        decoded.clear();
+        decoder.decodePacket(packets[p].data(), packets[p].size(), decoded);
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            result.mismatches += !(decoded[i] == updates[p * batch + i]);
+        }
+    }
+    double total = static_cast<double>(updates.size());
+    result.bytes_per_update = bytes / total;
+    result.encode_ns = encode_ns / (total * rounds);
+    result.decode_ns = decode_ns / (total * rounds);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t commands = args.getUint("--commands", 500000);
+    size_t symbols = std::max<uint64_t>(1, args.getUint("--symbols", 16));
+    size_t depth = std::max<uint64_t>(1, args.getUint("--depth", 10));
+    size_t batch = std::max<uint64_t>(1, args.getUint("--batch", 32));
+    size_t rounds = std::max<uint64_t>(1, args.getUint("--rounds", 5));
+
+    auto updates = generateUpdates(commands, symbols, depth);
+    if (updates.empty()) {
+        std::cerr << "No updates generated\n";
+        return 1;
+    }
+    std::cout << updates.size() << " level updates from " << commands << " commands over " << symbols
+              << " symbols (top " << depth << " levels), " << batch << " updates per packet\n";
+
+    std::vector<std::string> rows;
+    size_t mismatches = 0;
+    for (const char* format : {"fixed", "compact"}) {
+        bool compact = std::string(format) == "compact";
+        auto result = compact ? benchCompact(updates, batch, rounds) : benchFixed(updates, batch, rounds);
+        mismatches += result.mismatches;
+        std::cout << "  " << std::left << std::setw(8) << format << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(7) << result.bytes_per_update << " B/update"
+                  << "  encode " << std::setw(6) << result.encode_ns << " ns"
+                  << "  decode " << std::setw(6) << result.decode_ns << " ns"
+                  << "  mismatches " << result.mismatches << "\n";
+        std::ostringstream row;
+        row << format << "," << updates.size() << "," << batch << "," << result.bytes_per_update << ","
+            << result.encode_ns << "," << result.decode_ns;
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Memory cost of resting orders, per book representation.
+//
+// Fills a fresh book with N non-crossing limit orders spread over L price levels per side,
+// for N = 1k, 10k, ... up to --max-orders, and reports the allocator-level usage by
+// category (OrderBook::getMemoryUsage) as bytes per resting order. The resident set growth
+// is printed next to it as a cross-check that includes malloc overhead.
+//
+// Usage:
+//   memory_bench [--max-orders N] [--levels L] [--csv FILE]
+
+#include "matching_engine/order_book.hpp"
+#include "matching_engine/pooled_order_book.hpp"
+#include "bench_common.hpp"
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <unistd.h>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0, resident_pages = 0;
+    statm >> total_pages >> resident_pages;
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+const char* CSV_HEADER =
+    "representation,orders,levels_per_side,order_storage_bytes,level_index_bytes,order_index_bytes,"
+    "event_buffer_bytes,total_bytes,allocations,bytes_per_order,rss_bytes_per_order";
+
+template <typename Book>
+std::string measure(const char* representation, size_t orders, size_t levels) {
+    size_t rss_before = residentBytes();
+    auto book = std::make_unique<Book>();
+
+    // Bids below 100.00, asks from 100.01 up: nothing crosses, everything rests
+    for (size_t i = 0; i < orders; ++i) {
+        size_t level = (i / 2) % levels;
+        if (i % 2 == 0) {
+            book->addOrder(Order(i + 1, "BENCH", OrderSide::BUY, OrderType::LIMIT, 100.00 - level * 0.01, 100));
+        } else {
+            book->addOrder(Order(i + 1, "BENCH", OrderSide::SELL, OrderType::LIMIT, 100.01 + level * 0.01, 100));
+        }
+    }
+
+    auto usage = book->getMemoryUsage();
+    size_t rss_after = residentBytes();
+    double per_order = static_cast<double>(usage.totalBytes()) / orders;
+    double rss_per_order = rss_after > rss_before ? static_cast<double>(rss_after - rss_before) / orders : 0.0;
+
+    std::cout << "  " << std::left << std::setw(10) << representation << std::right
+              << std::setw(10) << orders << " orders"
+              << "  storage " << std::setw(12) << usage.getBytes(MemoryCategory::ORDER_STORAGE)
+              << "  levels " << std::setw(9) << usage.getBytes(MemoryCategory::LEVEL_INDEX)
+              << "  index " << std::setw(11) << usage.getBytes(MemoryCategory::ORDER_INDEX)
+              << "  " << std::fixed << std::setprecision(1) << std::setw(7) << per_order << " B/order"
+              << "  (rss " << std::setw(7) << rss_per_order << ")  "
+              << std::string(static_cast<size_t>(per_order / 8), '#') << std::endl;
+
+    std::ostringstream row;
+    row << representation << "," << orders << "," << levels << ","
+        << usage.getBytes(MemoryCategory::ORDER_STORAGE) << ","
+        << usage.getBytes(MemoryCategory::LEVEL_INDEX) << ","
+        << usage.getBytes(MemoryCategory::ORDER_INDEX) << ","
+        << usage.getBytes(MemoryCategory::EVENT_BUFFERS) << ","
+        << usage.totalBytes() << "," << usage.totalAllocations() << ","
+        << std::fixed << std::setprecision(2) << per_order << "," << rss_per_order;
+    return row.str();
+}
+
+template <typename Book>
+void sweep(const char* representation, size_t max_orders, size_t levels, std::vector<std::string>& rows) {
+    std::cout << "\n" << representation << " (sizeof book " << sizeof(Book) << " B, sizeof Order "
+              << sizeof(Order) << " B, " << levels << " levels per side)" << std::endl;
+    for (size_t orders = 1000; orders <= max_orders; orders *= 10) {
+        rows.push_back(measure<Book>(representation, orders, levels));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t max_orders = args.getUint("--max-orders", 10000000);
+    size_t levels = std::max<uint64_t>(1, args.getUint("--levels", 100));
+
+    std::vector<std::string> rows;
+    sweep<OrderBook>("OrderBook", max_orders, levels, rows);
+    sweep<PooledOrderBook>("Pooled", max_orders, levels, rows);
+
+    std::cout << "\n" << CSV_HEADER << std::endl;
+    for (const auto& row : rows) std::cout << row << std::endl;
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+// One-cancels-other groups in the book vs clients cancelling the sibling themselves.
+//
+// Flow runs: the same random crossing flow (--orders commands on one OrderBook) with no
+// links, and with every fourth resting order placed as an OCO pair (a limit plus a stop).
+// Reported: nanoseconds per command (a linked command adds two orders, one of them a stop).
+//
+// Race runs: --pairs pairs of sell orders (two price levels above the market) face buy flow.
+// Without links, the client cancels the other leg once it sees a fill, --delay commands later
+// (its round trip); with addLinkedOrders the book cancels it in the same matching step.
+// Reported: pairs where both legs traded (over-fills).
+//
+// Usage:
+//   oco_bench [--orders N] [--pairs N] [--delay N] [--csv FILE]
+
+#include "matching_engine/order_book.hpp"
+#include "bench_common.hpp"
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,orders,ns_per_command,pairs,overfilled_pairs";
+
+Order limitOrder(OrderId id, OrderSide side, Price price, Quantity quantity) {
+    return Order(id, "BENCH", side, OrderType::LIMIT, price, quantity);
+}
+
+double runFlow(size_t orders, bool linked) {
+    OrderBook book;
+    FastRandom random(17);
+    OrderId next_id = 1;
+    auto start = Clock::now();
+    for (size_t i = 0; i < orders; ++i) {
+        OrderSide side = random.below(2) ? OrderSide::SELL : OrderSide::BUY;
+        double offset = 0.01 * static_cast<double>(random.below(20)) - 0.05; // negative offsets cross
+        Price price = side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset;
+        Quantity quantity = 1 + random.below(200);
+        if (linked && i % 4 == 0) {
+            // Take-profit limit plus a protective stop well away from the flow
+            Price stop = side == OrderSide::BUY ? 200.0 : 1.0;
+            Order leg(next_id + 1, "BENCH", side, quantity);
+            book.addLinkedOrders({{limitOrder(next_id, side, price, quantity), 0}, {leg, stop}});
+            next_id += 2;
+        } else {
+            book.addOrder(limitOrder(next_id++, side, price, quantity));
+        }
+    }
+    return static_cast<double>(nanosSince(start)) / static_cast<double>(orders);
+}
+
+// Pairs: legs at 100.01 + k and 100.02 + k; buyers lift one level at a time
+size_t runRace(size_t pairs, size_t delay, bool linked) {
+    OrderBook book;
+    OrderId next_id = 1;
+    std::unordered_map<OrderId, OrderId> sibling;
+    for (size_t k = 0; k < pairs; ++k) {
+        Price base = 100.0 + 0.02 * static_cast<double>(k);
+        Order first = limitOrder(next_id, OrderSide::SELL, base + 0.01, 10);
+        Order second = limitOrder(next_id + 1, OrderSide::SELL, base + 0.02, 10);
+        if (linked) {
+            book.addLinkedOrders({{first, 0}, {second, 0}});
+        } else {
+            book.addOrder(first);
+            book.addOrder(second);
+        }
+        sibling[next_id] = next_id + 1;
+        sibling[next_id + 1] = next_id;
+        next_id += 2;
+    }
+
+    std::unordered_map<OrderId, bool> traded;
+    std::deque<std::pair<size_t, OrderId>> cancels; // (due at command, order), the client's pending cancels
+    size_t commands = 0;
+    while (book.getAskLevelCount() > 0) {
+        while (!cancels.empty() && cancels.front().first <= commands) {
+            book.cancelOrder(cancels.front().second);
+            cancels.pop_front();
+            commands++;
+        }
+        if (book.getAskLevelCount() == 0) {
+            break;
+        }
+        auto trades = book.addOrder(limitOrder(next_id++, OrderSide::BUY, *book.getBestAsk(), 10));
+        commands++;
+        for (const auto& trade : trades) {
+            OrderId leg = trade.sell_order_id;
+            if (!traded[leg] && !linked) {
+                cancels.push_back({commands + delay, sibling[leg]});
+            }
+            traded[leg] = true;
+        }
+    }
+    size_t overfilled = 0;
+    for (OrderId id = 1; id < 2 * pairs; id += 2) {
+        overfilled += traded[id] && traded[id + 1];
+    }
+    return overfilled;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t orders = std::max<uint64_t>(1, args.getUint("--orders", 1000000));
+    size_t pairs = std::max<uint64_t>(1, args.getUint("--pairs", 10000));
+    size_t delay = args.getUint("--delay", 2);
+
+    std::vector<std::string> rows;
+    for (bool linked : {false, true}) {
+        double ns = runFlow(orders, linked);
+        const char* name = linked ? "flow, 1 in 4 linked" : "flow, unlinked";
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1) << std::setw(8)
+                  << ns << " ns/command over " << orders << " commands\n";
+        std::ostringstream row;
+        row << (linked ? "flow_linked" : "flow_unlinked") << "," << orders << "," << ns << ",0,0";
+        rows.push_back(row.str());
+    }
+    for (bool linked : {false, true}) {
+        size_t overfilled = runRace(pairs, delay, linked);
+        const char* name = linked ? "race, book OCO" : "race, client cancel";
+        std::cout << std::left << std::setw(20) << name << std::right << "  " << overfilled << " of " << pairs
+                  << " pairs filled on both legs";
+        if (!linked) std::cout << " (cancel " << delay << " commands after the fill)";
+        std::cout << "\n";
+        std::ostringstream row;
+        row << (linked ? "race_linked" : "race_client") << ",0,0," << pairs << "," << overfilled;
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
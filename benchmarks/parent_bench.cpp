@@ -0,0 +1,237 @@
+// Cost and behaviour of engine-resident parent orders on an EngineShard.
+//
+// Load runs: a generator pushes --commands new orders and cancels (crossing flow over --symbols
+// books) into a shard as fast as it can, first with no parent orders and then with --parents
+// working parents (half TWAP, half POV, resting away from the market so they don't take the
+// flow's liquidity). Reported: matcher throughput, push -> result latency and the children
+// released; the parents only add work when one of them is due, so throughput should barely move.
+//
+// Schedule run: one TWAP parent (10 slices over --twap-ms) and one POV parent (10%) on a
+// symbol with paced flow. Reported: when each TWAP child was released, and the POV parent's
+// released quantity against the flow's traded volume.
+//
+// Usage:
+//   parent_bench [--commands N] [--symbols N] [--parents N] [--twap-ms N] [--csv FILE]
+
+#include "matching_engine/engine_shard.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "parents,commands,commands_per_sec,result_p50_ns,result_p99_ns,result_p999_ns,children";
+
+std::string symbolName(size_t index) {
+    return "S" + std::to_string(index);
+}
+
+// 70% new orders around 100.00 (some crossing), 30% cancels of earlier ones
+class FlowGenerator {
+    private:
+        FastRandom random_{41};
+        size_t symbols_;
+        OrderId next_id_ = 1;
+        std::vector<std::pair<OrderId, size_t>> live_;
+
+    public:
+        explicit FlowGenerator(size_t symbols) : symbols_(symbols) {}
+
+        EngineCommand next() {
+            if (!live_.empty() && random_.below(10) < 3) {
+                size_t pick = random_.below(live_.size());
+                auto [id, symbol] = live_[pick];
+                live_[pick] = live_.back();
+                live_.pop_back();
+                return EngineCommand::cancel(1, id, symbolName(symbol));
+            }
+            size_t symbol = random_.below(symbols_);
+            OrderSide side = random_.below(2) ? OrderSide::SELL : OrderSide::BUY;
+            double offset = 0.01 * static_cast<double>(random_.below(20)) - 0.05; // negative offsets cross
+            Price price = side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset;
+            Order order(next_id_++, symbolName(symbol), side, OrderType::LIMIT, price, 1 + random_.below(200));
+            order.setSession(1);
+            live_.push_back({order.getId(), symbol});
+            return EngineCommand::newOrder(order);
+        }
+};
+
+struct LoadResult {
+    double seconds = 0;
+    LatencyRecorder result{1 << 21};
+    uint64_t children = 0;
+};
+
+LoadResult runLoad(size_t commands, size_t symbols, size_t parents) {
+    EngineConfig config;
+    config.enable_logging = false;
+    config.max_symbols = std::max(config.max_symbols, symbols);
+    MatchingEngine engine(config);
+    engine.start();
+    for (size_t s = 0; s < symbols; ++s) {
+        engine.addSymbol(symbolName(s));
+    }
+
+    LoadResult outcome;
+    std::atomic<size_t> reported{0};
+    ShardOptions options;
+    options.coalesce = false; // one result per pushed command
+    EngineShard shard(engine, options);
+    shard.setResultCallback([&](const CommandResult& result) {
+        if (result.order_id < ParentOrderScheduler::DEFAULT_FIRST_CHILD_ID) {
+            int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+            outcome.result.record(now > result.enqueue_ns ? static_cast<uint64_t>(now - result.enqueue_ns) : 0);
+            reported.fetch_add(1, std::memory_order_release);
+        }
+    });
+    shard.start();
+
+    // Parents rest a dollar away from the flow; TWAP slices every 100 ms, POV a child per 100k traded
+    for (size_t p = 0; p < parents; ++p) {
+        ParentOrderSpec spec;
+        spec.id = p + 1;
+        spec.symbol = symbolName(p % symbols);
+        spec.side = p % 4 < 2 ? OrderSide::BUY : OrderSide::SELL;
+        spec.limit_price = spec.side == OrderSide::BUY ? 99.0 : 101.0;
+        spec.quantity = 1000000;
+        spec.session = 2;
+        if (p % 2 == 0) {
+            spec.algo = ParentAlgo::TWAP;
+            spec.duration = std::chrono::seconds(100);
+            spec.slices = 1000;
+        } else {
+            spec.algo = ParentAlgo::POV;
+            spec.participation = 0.001;
+            spec.min_child_quantity = 100;
+        }
+        shard.submitParentOrder(spec);
+    }
+    while (shard.getStatistics().parent_orders < parents) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint64_t children_before = shard.getStatistics().child_orders;
+
+    FlowGenerator flow(symbols);
+    auto start = Clock::now();
+    for (size_t i = 0; i < commands; ++i) {
+        shard.submit(flow.next());
+    }
+    while (reported.load(std::memory_order_acquire) < commands) {
+        std::this_thread::yield();
+    }
+    outcome.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    outcome.children = shard.getStatistics().child_orders - children_before;
+    shard.stop();
+    return outcome;
+}
+
+void runSchedule(uint64_t twap_ms) {
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("S0");
+
+    std::mutex mutex;
+    std::vector<double> twap_release_ms;
+    Quantity flow_volume = 0;
+    ParentOrderState pov;
+    auto start = Clock::now();
+    ShardOptions options;
+    options.idle_wait = std::chrono::microseconds(200);
+    EngineShard shard(engine, options);
+    shard.setResultCallback([&](const CommandResult& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& trade : result.trades) {
+            if (trade.buy_order_id < ParentOrderScheduler::DEFAULT_FIRST_CHILD_ID &&
+                trade.sell_order_id < ParentOrderScheduler::DEFAULT_FIRST_CHILD_ID) {
+                flow_volume += trade.quantity;
+            }
+        }
+    });
+    shard.setParentCallback([&](const ParentOrderState& state) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (state.algo == ParentAlgo::POV) {
+            pov = state;
+        } else if (state.children > twap_release_ms.size()) {
+            twap_release_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+    });
+    shard.start();
+
+    ParentOrderSpec twap;
+    twap.id = 1;
+    twap.symbol = "S0";
+    twap.side = OrderSide::BUY;
+    twap.limit_price = 99.0; // rests: the slices are visible in the book
+    twap.quantity = 1000;
+    twap.duration = std::chrono::milliseconds(twap_ms);
+    twap.slices = 10;
+    ParentOrderSpec pov_spec = twap;
+    pov_spec.id = 2;
+    pov_spec.algo = ParentAlgo::POV;
+    pov_spec.limit_price = 98.0;
+    pov_spec.quantity = 1000000;
+    pov_spec.participation = 0.1;
+    pov_spec.min_child_quantity = 50;
+    start = Clock::now();
+    shard.submitParentOrder(twap);
+    shard.submitParentOrder(pov_spec);
+
+    // Paced flow for the TWAP's duration and a little more
+    FlowGenerator flow(1);
+    auto until = start + std::chrono::milliseconds(twap_ms + twap_ms / 5);
+    while (Clock::now() < until) {
+        shard.submit(flow.next());
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    shard.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << "TWAP 1000 in 10 slices over " << twap_ms << " ms, children released at ms:";
+    for (double ms : twap_release_ms) std::cout << " " << std::fixed << std::setprecision(1) << ms;
+    std::cout << "\nPOV 10%: released " << pov.released << " of " << flow_volume << " traded by others ("
+              << std::setprecision(1) << (flow_volume ? 100.0 * static_cast<double>(pov.released) / static_cast<double>(flow_volume) : 0.0)
+              << "%) in " << pov.children << " children\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t commands = std::max<uint64_t>(1, args.getUint("--commands", 200000));
+    size_t symbols = std::max<uint64_t>(1, args.getUint("--symbols", 8));
+    size_t parents = args.getUint("--parents", 10000);
+    uint64_t twap_ms = std::max<uint64_t>(10, args.getUint("--twap-ms", 200));
+
+    std::cout << commands << " commands over " << symbols << " symbols\n";
+    std::vector<std::string> rows;
+    for (size_t count : {size_t{0}, parents}) {
+        LoadResult result = runLoad(commands, symbols, count);
+        double rate = static_cast<double>(commands) / result.seconds;
+        std::cout << std::setw(6) << count << " parents  " << std::fixed << std::setprecision(0) << std::setw(9) << rate
+                  << " commands/s  result p50 " << std::setw(9) << result.result.percentile(50) << " ns  p99 " << std::setw(10)
+                  << result.result.percentile(99) << " ns  p99.9 " << std::setw(10) << result.result.percentile(99.9)
+                  << " ns  children " << result.children << std::endl;
+        std::ostringstream row;
+        row << count << "," << commands << "," << rate << "," << result.result.percentile(50) << ","
+            << result.result.percentile(99) << "," << result.result.percentile(99.9) << "," << result.children;
+        rows.push_back(row.str());
+    }
+    runSchedule(twap_ms);
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,279 @@
+// Worst-case book shapes, run against every book implementation.
+//
+// Named scenarios (each timed per operation after building its book):
+//   one_level_cancels  --orders orders resting at one price, then --cancels random cancels
+//   sparse_levels      --levels levels (at most 180000), one order each and ten ticks apart, then --ops random
+//                      cancel + re-add pairs spread over the whole range
+//   touch_storm        a book 100 levels deep, then rounds of --storm orders joining the best bid
+//                      and all of them cancelled again (--ops orders in total)
+//   deep_sweep         --sweep-levels ask levels of five orders swept by one market buy, 20 times
+//   many_symbols       --symbols books with one order each (one operation = build a book and add)
+//   bbo_oscillation    --ops orders alternately improving the bid and the ask by a tick and
+//                      cancelled at once, creating and erasing a level node each time
+// Reported per scenario and implementation: operations per second, p50 / p99 / max latency of
+// one operation, and the peak allocator-level memory (getMemoryUsage, plus the book objects for
+// many_symbols).
+//
+// Usage:
+//   pathological_bench [--only SCENARIO] [--orders N] [--cancels N] [--levels N] [--ops N]
+//                      [--storm N] [--sweep-levels N] [--symbols N] [--csv FILE]
+
+#include "matching_engine/order_book.hpp"
+#include "matching_engine/pooled_order_book.hpp"
+#include "bench_common.hpp"
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "scenario,implementation,operations,ops_per_sec,p50_ns,p99_ns,max_ns,peak_bytes";
+
+constexpr Price TICK = 0.01;
+
+struct Sizes {
+    size_t orders;
+    size_t cancels;
+    size_t levels;
+    size_t ops;
+    size_t storm;
+    size_t sweep_levels;
+    size_t symbols;
+};
+
+struct ScenarioResult {
+    LatencyRecorder latency;
+    uint64_t nanos = 0;       // sum of the timed operations
+    size_t peak_bytes = 0;
+};
+
+Order limitOrder(OrderId id, OrderSide side, Price price, Quantity quantity = 100) {
+    return Order(id, "BENCH", side, OrderType::LIMIT, price, quantity);
+}
+
+// Times one operation into the result
+template <typename Operation>
+void timed(ScenarioResult& result, Operation&& operation) {
+    auto start = Clock::now();
+    operation();
+    uint64_t elapsed = nanosSince(start);
+    result.latency.record(elapsed);
+    result.nanos += elapsed;
+}
+
+template <typename Book>
+void notePeak(const Book& book, ScenarioResult& result) {
+    result.peak_bytes = std::max(result.peak_bytes, book.getMemoryUsage().totalBytes());
+}
+
+// =============================================================================
+// Scenarios
+// =============================================================================
+
+template <typename Book>
+ScenarioResult oneLevelCancels(const Sizes& sizes) {
+    ScenarioResult result;
+    auto book = std::make_unique<Book>();
+    for (size_t i = 0; i < sizes.orders; ++i) {
+        book->addOrder(limitOrder(i + 1, OrderSide::BUY, 100.00));
+    }
+    notePeak(*book, result);
+    FastRandom random(11);
+    for (size_t i = 0; i < std::min(sizes.cancels, sizes.orders); ++i) {
+        OrderId id = 1 + random.below(sizes.orders);
+        timed(result, [&] { book->cancelOrder(id); });
+    }
+    return result;
+}
+
+template <typename Book>
+ScenarioResult sparseLevels(const Sizes& sizes) {
+    ScenarioResult result;
+    auto book = std::make_unique<Book>();
+    // Bids from 10000.00 down and asks from 10000.01 up, ten ticks between levels
+    auto priceOf = [](OrderSide side, size_t level) {
+        double offset = static_cast<double>(level * 10) * TICK;
+        return side == OrderSide::BUY ? 10000.00 - offset : 10000.01 + offset;
+    };
+    size_t per_side = std::max<size_t>(1, sizes.levels / 2);
+    std::vector<std::pair<OrderId, OrderSide>> resting;
+    OrderId next_id = 1;
+    for (size_t level = 0; level < per_side; ++level) {
+        for (OrderSide side : {OrderSide::BUY, OrderSide::SELL}) {
+            book->addOrder(limitOrder(next_id, side, priceOf(side, level)));
+            resting.push_back({next_id++, side});
+        }
+    }
+    notePeak(*book, result);
+    FastRandom random(13);
+    for (size_t i = 0; i < sizes.ops; ++i) {
+        size_t pick = random.below(resting.size());
+        auto [id, side] = resting[pick];
+        timed(result, [&] { book->cancelOrder(id); });
+        Order order = limitOrder(next_id, side, priceOf(side, random.below(per_side)));
+        timed(result, [&] { book->addOrder(order); });
+        resting[pick] = {next_id++, side};
+    }
+    notePeak(*book, result);
+    return result;
+}
+
+template <typename Book>
+ScenarioResult touchStorm(const Sizes& sizes) {
+    ScenarioResult result;
+    auto book = std::make_unique<Book>();
+    OrderId next_id = 1;
+    for (size_t level = 0; level < 100; ++level) {
+        for (int k = 0; k < 10; ++k) {
+            book->addOrder(limitOrder(next_id++, OrderSide::BUY, 100.00 - static_cast<double>(level) * TICK));
+            book->addOrder(limitOrder(next_id++, OrderSide::SELL, 100.01 + static_cast<double>(level) * TICK));
+        }
+    }
+    size_t storm = std::max<size_t>(1, sizes.storm);
+    FastRandom random(17);
+    std::vector<OrderId> joined;
+    for (size_t done = 0; done < sizes.ops; done += storm) {
+        joined.clear();
+        for (size_t k = 0; k < storm; ++k) {
+            Order order = limitOrder(next_id, OrderSide::BUY, 100.00);
+            timed(result, [&] { book->addOrder(order); });
+            joined.push_back(next_id++);
+        }
+        notePeak(*book, result);
+        // Pulled in random order, as quotes are
+        for (size_t k = joined.size(); k > 1; --k) {
+            std::swap(joined[k - 1], joined[random.below(k)]);
+        }
+        for (OrderId id : joined) {
+            timed(result, [&] { book->cancelOrder(id); });
+        }
+    }
+    return result;
+}
+
+template <typename Book>
+ScenarioResult deepSweep(const Sizes& sizes) {
+    ScenarioResult result;
+    OrderId next_id = 1;
+    for (int round = 0; round < 20; ++round) {
+        auto book = std::make_unique<Book>();
+        Quantity total = 0;
+        for (size_t level = 0; level < sizes.sweep_levels; ++level) {
+            for (int k = 0; k < 5; ++k) {
+                book->addOrder(limitOrder(next_id++, OrderSide::SELL, 100.01 + static_cast<double>(level) * TICK));
+                total += 100;
+            }
+        }
+        notePeak(*book, result);
+        Order sweep(next_id++, "BENCH", OrderSide::BUY, total);
+        timed(result, [&] { book->addOrder(sweep); });
+    }
+    return result;
+}
+
+template <typename Book>
+ScenarioResult manySymbols(const Sizes& sizes) {
+    ScenarioResult result;
+    std::vector<std::unique_ptr<Book>> books;
+    books.reserve(sizes.symbols);
+    for (size_t s = 0; s < sizes.symbols; ++s) {
+        timed(result, [&] {
+            books.push_back(std::make_unique<Book>());
+            books.back()->addOrder(limitOrder(s + 1, OrderSide::BUY, 100.00));
+        });
+    }
+    size_t bytes = sizes.symbols * sizeof(Book);
+    for (const auto& book : books) {
+        bytes += book->getMemoryUsage().totalBytes();
+    }
+    result.peak_bytes = bytes;
+    return result;
+}
+
+template <typename Book>
+ScenarioResult bboOscillation(const Sizes& sizes) {
+    ScenarioResult result;
+    auto book = std::make_unique<Book>();
+    book->addOrder(limitOrder(1, OrderSide::BUY, 99.00));
+    book->addOrder(limitOrder(2, OrderSide::SELL, 101.00));
+    OrderId next_id = 3;
+    for (size_t i = 0; i < sizes.ops; ++i) {
+        // A tick inside the spread on alternating sides: a new best level, then gone again
+        bool bid = i % 2 == 0;
+        Order order = limitOrder(next_id, bid ? OrderSide::BUY : OrderSide::SELL, bid ? 99.01 : 100.99);
+        timed(result, [&] { book->addOrder(order); });
+        OrderId id = next_id++;
+        timed(result, [&] { book->cancelOrder(id); });
+    }
+    notePeak(*book, result);
+    return result;
+}
+
+// =============================================================================
+// Driver
+// =============================================================================
+
+struct Scenario {
+    const char* name;
+    ScenarioResult (*order_book)(const Sizes&);
+    ScenarioResult (*pooled)(const Sizes&);
+};
+
+const Scenario SCENARIOS[] = {
+    {"one_level_cancels", oneLevelCancels<OrderBook>, oneLevelCancels<PooledOrderBook>},
+    {"sparse_levels", sparseLevels<OrderBook>, sparseLevels<PooledOrderBook>},
+    {"touch_storm", touchStorm<OrderBook>, touchStorm<PooledOrderBook>},
+    {"deep_sweep", deepSweep<OrderBook>, deepSweep<PooledOrderBook>},
+    {"many_symbols", manySymbols<OrderBook>, manySymbols<PooledOrderBook>},
+    {"bbo_oscillation", bboOscillation<OrderBook>, bboOscillation<PooledOrderBook>},
+};
+
+std::string report(const char* scenario, const char* implementation, ScenarioResult& result) {
+    size_t operations = result.latency.count();
+    double rate = result.nanos ? static_cast<double>(operations) * 1e9 / static_cast<double>(result.nanos) : 0.0;
+    std::cout << std::left << std::setw(19) << scenario << std::setw(17) << implementation << std::right << std::setw(9)
+              << operations << " ops " << std::fixed << std::setprecision(0) << std::setw(11) << rate << " ops/s  p50 "
+              << std::setw(9) << result.latency.percentile(50) << " ns  p99 " << std::setw(10) << result.latency.percentile(99)
+              << " ns  max " << std::setw(11) << result.latency.max() << " ns  peak " << std::setw(11) << result.peak_bytes
+              << " B" << std::endl;
+    std::ostringstream row;
+    row << scenario << "," << implementation << "," << operations << "," << rate << "," << result.latency.percentile(50)
+        << "," << result.latency.percentile(99) << "," << result.latency.max() << "," << result.peak_bytes;
+    return row.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    Sizes sizes;
+    sizes.orders = std::max<uint64_t>(1, args.getUint("--orders", 1000000));
+    sizes.cancels = args.getUint("--cancels", 200);
+    sizes.levels = std::min<uint64_t>(180000, std::max<uint64_t>(2, args.getUint("--levels", 100000))); //bids stay above 0.01
+    sizes.ops = args.getUint("--ops", 200000);
+    sizes.storm = std::max<uint64_t>(1, args.getUint("--storm", 2000));
+    sizes.sweep_levels = std::max<uint64_t>(1, args.getUint("--sweep-levels", 1000));
+    sizes.symbols = std::max<uint64_t>(1, args.getUint("--symbols", 10000));
+    std::string only = args.get("--only", "");
+
+    std::vector<std::string> rows;
+    for (const auto& scenario : SCENARIOS) {
+        if (!only.empty() && only != scenario.name) continue;
+        ScenarioResult order_book = scenario.order_book(sizes);
+        rows.push_back(report(scenario.name, "OrderBook", order_book));
+        ScenarioResult pooled = scenario.pooled(sizes);
+        rows.push_back(report(scenario.name, "PooledOrderBook", pooled));
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
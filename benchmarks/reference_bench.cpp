@@ -0,0 +1,149 @@
+// Engine start to ready for a large symbol universe: addSymbol per symbol vs one reference data load.
+//
+// Writes a reference data file of --symbols symbols (tick 0.01, lot 10, a price band around
+// 100.00) to --dir, then times, each on a fresh engine:
+//   add_symbol - start() plus one addSymbol call per symbol (a lock and an OrderBook each)
+//   reference  - start() plus loadReferenceData (mapping, checks and one contiguous copy)
+// Reported: time to ready, the engine's allocator-level memory and allocation count once ready,
+// then the cost of a listed symbol's first order (which builds its book) against an order on a
+// symbol whose book exists. The reference engine also has to reject an off-tick, an odd-lot and
+// an out-of-band order.
+//
+// Usage:
+//   reference_bench [--symbols N] [--orders N] [--dir PATH] [--csv FILE]
+
+#include "matching_engine/matching_engine.hpp"
+#include "bench_common.hpp"
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,symbols,ready_us,memory_bytes,allocations,first_order_p50_ns,first_order_p99_ns,next_order_p50_ns";
+
+// Eight characters, letters and digits: S0000000, S0000001, ...
+std::string symbolName(size_t index) {
+    static const char DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string symbol(8, '0');
+    symbol[0] = 'S';
+    for (size_t position = 7; position > 0 && index > 0; --position, index /= 36) {
+        symbol[position] = DIGITS[index % 36];
+    }
+    return symbol;
+}
+
+struct RunResult {
+    uint64_t ready_nanos = 0;
+    MemoryUsage memory;
+    uint64_t first_p50 = 0;
+    uint64_t first_p99 = 0;
+    uint64_t next_p50 = 0;
+};
+
+// One order each on `orders` distinct symbols (the first on that symbol), then one more on each
+void timeOrders(MatchingEngine& engine, size_t symbols, size_t orders, RunResult& result) {
+    LatencyRecorder first;
+    LatencyRecorder next;
+    OrderId id = 1;
+    for (LatencyRecorder* recorder : {&first, &next}) {
+        for (size_t i = 0; i < orders; ++i) {
+            Order order(id++, symbolName(i * (symbols / orders)), OrderSide::BUY, OrderType::LIMIT, 99.50, 100);
+            auto start = Clock::now();
+            engine.submitOrder(order);
+            recorder->record(nanosSince(start));
+        }
+    }
+    result.first_p50 = first.percentile(50);
+    result.first_p99 = first.percentile(99);
+    result.next_p50 = next.percentile(50);
+}
+
+EngineConfig quietConfig() {
+    EngineConfig config;
+    config.enable_logging = false;
+    return config;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t symbols = std::max<uint64_t>(1, args.getUint("--symbols", 200000));
+    size_t orders = std::min<uint64_t>(symbols, std::max<uint64_t>(1, args.getUint("--orders", 10000)));
+    std::string path = args.get("--dir", "/tmp") + "/reference_bench.ref";
+
+    std::vector<ReferenceRecord> records(symbols);
+    for (size_t i = 0; i < symbols; ++i) {
+        records[i].setSymbol(symbolName(i));
+        records[i].tick_size = 0.01;
+        records[i].lot_size = 10;
+        records[i].band_low = 50.00;
+        records[i].band_high = 150.00;
+    }
+    writeReferenceData(path, std::move(records));
+
+    std::vector<std::string> rows;
+    auto print = [&](const char* mode, const RunResult& result) {
+        std::cout << std::left << std::setw(11) << mode << std::right << std::setw(8) << symbols << " symbols  ready "
+                  << std::setw(9) << result.ready_nanos / 1000 << " us  memory " << std::setw(11) << result.memory.totalBytes()
+                  << " B in " << std::setw(7) << result.memory.totalAllocations() << " allocations  first order p50 "
+                  << std::setw(6) << result.first_p50 << " ns  p99 " << std::setw(7) << result.first_p99
+                  << " ns  next order p50 " << std::setw(5) << result.next_p50 << " ns" << std::endl;
+        std::ostringstream row;
+        row << mode << "," << symbols << "," << result.ready_nanos / 1000 << "," << result.memory.totalBytes() << ","
+            << result.memory.totalAllocations() << "," << result.first_p50 << "," << result.first_p99 << "," << result.next_p50;
+        rows.push_back(row.str());
+    };
+
+    {
+        RunResult result;
+        MatchingEngine engine(quietConfig());
+        auto start = Clock::now();
+        engine.start();
+        for (size_t i = 0; i < symbols; ++i) {
+            engine.addSymbol(symbolName(i));
+        }
+        result.ready_nanos = nanosSince(start);
+        result.memory = engine.getMemoryUsage();
+        timeOrders(engine, symbols, orders, result);
+        print("add_symbol", result);
+    }
+
+    {
+        RunResult result;
+        MatchingEngine engine(quietConfig());
+        auto start = Clock::now();
+        engine.start();
+        size_t listed = engine.loadReferenceData(path);
+        result.ready_nanos = nanosSince(start);
+        result.memory = engine.getMemoryUsage();
+        timeOrders(engine, symbols, orders, result);
+        print("reference", result);
+
+        size_t rejected = 0;
+        OrderId id = 1000000000;
+        for (auto [price, quantity] : {std::pair<Price, Quantity>{99.505, 100}, {99.50, 105}, {160.00, 100}}) {
+            try {
+                engine.submitOrder(Order(id++, symbolName(0), OrderSide::SELL, OrderType::LIMIT, price, quantity));
+            } catch (const std::invalid_argument&) {
+                rejected++;
+            }
+        }
+        std::cout << "  " << listed << " symbols listed, " << engine.getStatistics().total_symbols_active << " books built, "
+                  << rejected << "/3 rule-breaking orders rejected" << std::endl;
+    }
+    ::unlink(path.c_str());
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
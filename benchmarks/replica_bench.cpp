@@ -0,0 +1,174 @@
+// Matcher latency with full-depth readers on the engine vs on a BookReplica.
+//
+// One matcher thread submits and cancels limit orders on --symbols books (kept --depth levels
+// deep) for --seconds; --readers threads meanwhile query the full depth of random symbols in a
+// loop. Three runs: no readers, readers calling MatchingEngine::getMarketDepth, and readers
+// calling BookReplica::getMarketDepth. Reported: the matcher's submitOrder latency, reader
+// queries per second and, for the replica, how far behind the engine it was when sampled.
+// The replica run ends by checking that the replica's books equal the engine's.
+//
+// Usage:
+//   replica_bench [--symbols N] [--depth N] [--readers N] [--seconds N] [--cpu N] [--csv FILE]
+
+#include "matching_engine/book_replica.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,readers,submit_p50_ns,submit_p99_ns,submit_p999_ns,queries_per_sec,lag_p50,lag_max";
+
+enum class ReadFrom { NONE, ENGINE, REPLICA };
+
+struct Result {
+    LatencyRecorder submit;
+    uint64_t queries = 0;
+    double seconds = 0;
+    LatencyRecorder lag;          // events behind, sampled by the readers
+    bool replica_matches = true;
+};
+
+Result run(ReadFrom mode, size_t symbols, size_t depth, size_t readers, double seconds, int cpu) {
+    EngineConfig config;
+    config.enable_logging = false;
+    config.max_symbols = std::max(config.max_symbols, symbols);
+    MatchingEngine engine(config);
+    engine.start();
+    std::vector<std::string> names;
+    for (size_t s = 0; s < symbols; ++s) {
+        names.push_back("S" + std::to_string(s));
+        engine.addSymbol(names.back());
+    }
+
+    // Deep books to read: depth levels a side, a few orders each
+    OrderId next_id = 1;
+    FastRandom random(3);
+    for (const auto& name : names) {
+        for (size_t level = 0; level < depth; ++level) {
+            for (int k = 0; k < 4; ++k) {
+                engine.submitOrder(Order(next_id++, name, OrderSide::BUY, OrderType::LIMIT, 100.0 - 0.01 * (1 + level), 10));
+                engine.submitOrder(Order(next_id++, name, OrderSide::SELL, OrderType::LIMIT, 100.0 + 0.01 * (1 + level), 10));
+            }
+        }
+    }
+
+    std::unique_ptr<BookReplica> replica;
+    if (mode == ReadFrom::REPLICA) {
+        ReplicaOptions options;
+        options.cpu = cpu;
+        replica = std::make_unique<BookReplica>(engine, options);
+    }
+
+    Result result{LatencyRecorder(1 << 20), 0, 0, LatencyRecorder(1 << 16)};
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> levels_read{0}; // keeps the queries from being optimised away
+    std::vector<std::thread> threads;
+    std::vector<LatencyRecorder> lags(readers);
+    for (size_t r = 0; mode != ReadFrom::NONE && r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            FastRandom pick(100 + r);
+            uint64_t mine = 0;
+            size_t levels = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const std::string& name = names[pick.below(names.size())];
+                if (mode == ReadFrom::ENGINE) {
+                    levels += engine.getMarketDepth(name, SIZE_MAX).bids.size();
+                } else {
+                    levels += replica->getMarketDepth(name, SIZE_MAX).bids.size();
+                    if (mine % 64 == 0) lags[r].record(replica->getLag());
+                }
+                mine++;
+            }
+            queries += mine;
+            levels_read += levels;
+        });
+    }
+
+    // Matcher: new orders inside the book, cancelled a few commands later
+    std::vector<std::pair<OrderId, size_t>> live;
+    auto start = Clock::now();
+    auto until = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    while (Clock::now() < until) {
+        size_t s = random.below(names.size());
+        OrderSide side = random.below(2) ? OrderSide::BUY : OrderSide::SELL;
+        Price price = 100.0 + (side == OrderSide::BUY ? -0.01 : 0.01) * static_cast<double>(1 + random.below(depth));
+        auto begin = Clock::now();
+        engine.submitOrder(Order(next_id, names[s], side, OrderType::LIMIT, price, 1 + random.below(20)));
+        result.submit.record(nanosSince(begin));
+        live.push_back({next_id++, s});
+        if (live.size() > 64) {
+            size_t k = random.below(live.size());
+            engine.cancelOrder(live[k].first, names[live[k].second]);
+            live[k] = live.back();
+            live.pop_back();
+        }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    done = true;
+    for (auto& thread : threads) thread.join();
+    result.queries = queries;
+    for (auto& lag : lags) result.lag.merge(lag);
+
+    if (replica) {
+        replica->waitForSequence(engine.getEventSequence(), std::chrono::seconds(5));
+        for (const auto& name : names) {
+            MarketDepth primary = engine.getMarketDepth(name, SIZE_MAX);
+            MarketDepth copy = replica->getMarketDepth(name, SIZE_MAX);
+            result.replica_matches = result.replica_matches && primary.bids == copy.bids && primary.asks == copy.asks &&
+                                     primary.total_orders == copy.total_orders;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t symbols = std::max<uint64_t>(1, args.getUint("--symbols", 20));
+    size_t depth = std::max<uint64_t>(1, args.getUint("--depth", 200));
+    size_t readers = args.getUint("--readers", 2);
+    double seconds = static_cast<double>(std::max<uint64_t>(1, args.getUint("--seconds", 1)));
+    int cpu = args.has("--cpu") ? static_cast<int>(args.getUint("--cpu", 0)) : -1;
+
+    std::cout << symbols << " symbols, " << depth << " levels a side, " << readers << " full-depth readers, " << seconds
+              << " s per run\n";
+    std::vector<std::string> rows;
+    bool matches = true;
+    for (auto [mode, name] : {std::make_pair(ReadFrom::NONE, "no readers"), std::make_pair(ReadFrom::ENGINE, "engine"),
+                              std::make_pair(ReadFrom::REPLICA, "replica")}) {
+        Result result = run(mode, symbols, depth, readers, seconds, cpu);
+        double qps = static_cast<double>(result.queries) / result.seconds;
+        std::cout << std::left << std::setw(11) << name << std::right << "  submit p50 " << std::setw(7)
+                  << result.submit.percentile(50) << " ns  p99 " << std::setw(8) << result.submit.percentile(99)
+                  << " ns  p99.9 " << std::setw(9) << result.submit.percentile(99.9) << " ns  reader queries/s "
+                  << std::fixed << std::setprecision(0) << qps;
+        if (mode == ReadFrom::REPLICA) {
+            std::cout << "  lag p50 " << result.lag.percentile(50) << " max " << result.lag.max() << " events"
+                      << "  books " << (result.replica_matches ? "match" : "DIFFER");
+            matches = result.replica_matches;
+        }
+        std::cout << "\n";
+        std::ostringstream row;
+        row << name << "," << (mode == ReadFrom::NONE ? 0 : readers) << "," << result.submit.percentile(50) << ","
+            << result.submit.percentile(99) << "," << result.submit.percentile(99.9) << "," << qps << ","
+            << result.lag.percentile(50) << "," << result.lag.max();
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// Account risk checks from many matching threads: one shared counter per account versus
+// shard-local budget slices.
+//
+// --shards threads each play a matching shard. Every operation picks one of --accounts
+// accounts, reserves an order's notional and releases it again --hold operations later (a
+// cancel), so the accounts stay busy without running out. Modes:
+//   central - every reserve/release is a CAS/fetch_add on the account's one shared counter
+//   sharded - ShardRiskBudget per thread, refilled from a RiskBudgetPool with the rebalancer on
+// Reports ns per operation, pool refills and rejections, and checks afterwards that every
+// account's full limit is available again.
+//
+// Usage:
+//   risk_bench [--shards N] [--accounts N] [--ops N] [--hold N] [--chunk N] [--csv FILE]
+
+#include "matching_engine/risk_budget.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,shards,accounts,ops_per_shard,ns_per_op,refills,rejections";
+
+constexpr Notional ACCOUNT_LIMIT = 1000000000;
+
+struct alignas(64) CentralAccount {
+    std::atomic<Notional> available{ACCOUNT_LIMIT};
+};
+
+struct Held {
+    AccountId account;
+    Notional notional;
+};
+
+// Runs body(shard) on one thread per shard and returns the wall time
+template <typename Body>
+uint64_t runShards(size_t shards, Body body) {
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t s = 0; s < shards; ++s) {
+        threads.emplace_back(body, s);
+    }
+    for (auto& thread : threads) thread.join();
+    return nanosSince(start);
+}
+
+// One shard's order flow: reserve, then release what was reserved hold operations ago
+template <typename Reserve, typename Release>
+uint64_t orderFlow(size_t shard, size_t accounts, size_t ops, size_t hold, Reserve reserve, Release release) {
+    FastRandom random(shard + 1);
+    std::deque<Held> held;
+    uint64_t rejections = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        AccountId account = 1 + random.below(accounts);
+        Notional notional = toNotional(100.0 + static_cast<double>(random.below(100)) * 0.01, 1 + random.below(500));
+        if (reserve(account, notional)) {
+            held.push_back(Held{account, notional});
+        } else {
+            rejections++;
+        }
+        if (held.size() > hold) {
+            release(held.front().account, held.front().notional);
+            held.pop_front();
+        }
+    }
+    for (const auto& h : held) release(h.account, h.notional);
+    return rejections;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t shards = std::max<uint64_t>(1, args.getUint("--shards", 4));
+    size_t accounts = std::max<uint64_t>(1, args.getUint("--accounts", 8));
+    size_t ops = args.getUint("--ops", 2000000);
+    size_t hold = args.getUint("--hold", 64);
+    Notional chunk = static_cast<Notional>(args.getUint("--chunk", 50000000));
+
+    std::vector<std::string> rows;
+    auto report = [&](const char* mode, uint64_t nanos, uint64_t refills, uint64_t rejections) {
+        double ns_per_op = static_cast<double>(nanos) / static_cast<double>(ops); // shards run side by side
+        std::cout << std::left << std::setw(8) << mode << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << ns_per_op << " ns/op  refills " << refills << "  rejections " << rejections << "\n";
+        std::ostringstream row;
+        row << mode << "," << shards << "," << accounts << "," << ops << "," << ns_per_op << "," << refills << ","
+            << rejections;
+        rows.push_back(row.str());
+    };
+
+    std::cout << shards << " shards, " << accounts << " accounts, " << ops << " ops per shard, hold " << hold << "\n";
+
+    // Central: one counter per account shared by every shard
+    {
+        std::vector<CentralAccount> central(accounts + 1);
+        std::atomic<uint64_t> rejections{0};
+        uint64_t nanos = runShards(shards, [&](size_t shard) {
+            rejections += orderFlow(shard, accounts, ops, hold,
+                [&](AccountId account, Notional notional) {
+                    auto& available = central[account].available;
+                    Notional current = available.load(std::memory_order_relaxed);
+                    while (current >= notional) {
+                        if (available.compare_exchange_weak(current, current - notional, std::memory_order_relaxed)) return true;
+                    }
+                    return false;
+                },
+                [&](AccountId account, Notional notional) {
+                    central[account].available.fetch_add(notional, std::memory_order_relaxed);
+                });
+        });
+        report("central", nanos, 0, rejections);
+    }
+
+    // Sharded: per-shard slices, pool touched only on refills
+    {
+        RiskBudgetPool pool(shards, chunk);
+        for (AccountId account = 1; account <= accounts; ++account) {
+            pool.setAccountLimit(account, ACCOUNT_LIMIT);
+        }
+        pool.startRebalancer(std::chrono::milliseconds(10));
+        std::atomic<uint64_t> rejections{0};
+        uint64_t nanos = runShards(shards, [&](size_t shard) {
+            ShardRiskBudget& budget = pool.getShard(shard);
+            rejections += orderFlow(shard, accounts, ops, hold,
+                [&budget](AccountId account, Notional notional) { return budget.tryReserve(account, notional); },
+                [&budget](AccountId account, Notional notional) { budget.release(account, notional); });
+        });
+        pool.stopRebalancer();
+        uint64_t refills = 0;
+        for (size_t s = 0; s < shards; ++s) refills += pool.getShard(s).getRefillCount();
+        report("sharded", nanos, refills, rejections);
+
+        for (AccountId account = 1; account <= accounts; ++account) {
+            if (pool.getAvailable(account) != ACCOUNT_LIMIT) {
+                std::cerr << "account " << account << " has " << pool.getAvailable(account) << " available, expected "
+                          << ACCOUNT_LIMIT << "\n";
+                return 1;
+            }
+        }
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,262 @@
+// Command latency of an EngineShard while background work shares its core.
+//
+// A producer paces --rate orders per second (crossing limit orders around 100.00, a third of
+// them cancelled) into one shard for --seconds. Meanwhile a "compaction" job of --units CPU
+// work units (a few microseconds each) is released every --period-ms, and a small "stats"
+// task reads the engine statistics every 10 ms. Modes:
+//   none      - no background work (the baseline)
+//   inline    - both run from the shard's tick callback, each job in one go
+//   thread    - both run on their own thread, competing with the matcher for the core
+//   scheduler - both are ShardScheduler tasks (compaction: 50 us quantum, 20 ms budget;
+//               stats: 20 us quantum, 2 ms budget) that check shouldYield between units
+// Reported: push -> result latency percentiles, jobs completed and their release -> done time,
+// and for the scheduler the slices, the CPU they used, overruns and budget misses.
+//
+// Usage:
+//   scheduler_bench [--rate N] [--seconds N] [--units N] [--period-ms N] [--csv FILE]
+
+#include "matching_engine/engine_shard.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,rate,commands,result_p50_ns,result_p99_ns,result_p999_ns,result_max_ns,jobs,job_avg_us,job_max_us,"
+                         "slices,background_cpu_us,overruns,budget_misses";
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+// Compaction stand-in: jobs of `units` CPU-bound steps released every `period`
+class Compaction {
+    private:
+        size_t units_;
+        uint64_t period_ns_;
+        uint64_t next_release_ns_;
+        uint64_t release_ns_ = 0;      // of the job in hand
+        size_t remaining_ = 0;
+        uint64_t state_ = 0x9E3779B97F4A7C15ULL;
+
+    public:
+        std::atomic<uint64_t> jobs{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint64_t> sink{0};
+
+        Compaction(size_t units, std::chrono::milliseconds period)
+            : units_(units), period_ns_(static_cast<uint64_t>(std::chrono::nanoseconds(period).count())),
+              next_release_ns_(nowNanos() + period_ns_) {}
+
+        uint64_t nextRelease() const { return next_release_ns_; }
+        bool active() const { return remaining_ > 0; }
+
+        // Take the next job if one has been released
+        bool start(uint64_t now) {
+            if (remaining_ > 0 || now < next_release_ns_) {
+                return remaining_ > 0;
+            }
+            release_ns_ = next_release_ns_;
+            next_release_ns_ += period_ns_;
+            remaining_ = units_;
+            return true;
+        }
+
+        // One unit of the job in hand; false once it is done
+        bool unit() {
+            for (int i = 0; i < 1000; ++i) {
+                state_ ^= state_ << 13;
+                state_ ^= state_ >> 7;
+                state_ ^= state_ << 17;
+            }
+            sink.store(state_, std::memory_order_relaxed);
+            if (--remaining_ > 0) {
+                return true;
+            }
+            uint64_t took = nowNanos() - release_ns_;
+            jobs.fetch_add(1, std::memory_order_relaxed);
+            total_ns.fetch_add(took, std::memory_order_relaxed);
+            if (took > max_ns.load(std::memory_order_relaxed)) max_ns.store(took, std::memory_order_relaxed);
+            return false;
+        }
+};
+
+struct RunResult {
+    uint64_t commands = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+    uint64_t jobs = 0;
+    uint64_t job_avg_us = 0;
+    uint64_t job_max_us = 0;
+    uint64_t slices = 0;
+    uint64_t cpu_us = 0;
+    uint64_t overruns = 0;
+    uint64_t budget_misses = 0;
+};
+
+RunResult run(const std::string& mode, uint64_t rate, uint64_t seconds, size_t units, std::chrono::milliseconds period) {
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("AAPL");
+
+    ShardOptions options;
+    options.coalesce = false;
+    EngineShard shard(engine, options);
+    Compaction compaction(units, period);
+    std::atomic<uint64_t> stats_reads{0};
+    const uint64_t stats_period_ns = 10000000;
+    uint64_t next_stats_ns = nowNanos() + stats_period_ns;
+    std::atomic<bool> done{false};
+    std::thread worker;
+
+    if (mode == "inline") {
+        shard.setTickCallback([&](bool) {
+            uint64_t now = nowNanos();
+            if (now >= next_stats_ns) {
+                stats_reads += engine.getStatistics().total_orders_processed > 0;
+                next_stats_ns = now + stats_period_ns;
+            }
+            if (compaction.start(now)) {
+                while (compaction.unit()) {}
+            }
+        });
+    } else if (mode == "thread") {
+        worker = std::thread([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                uint64_t now = nowNanos();
+                if (now >= next_stats_ns) {
+                    stats_reads += engine.getStatistics().total_orders_processed > 0;
+                    next_stats_ns = now + stats_period_ns;
+                }
+                if (compaction.start(now)) {
+                    while (compaction.unit()) {}
+                    continue;
+                }
+                uint64_t wake = std::min(next_stats_ns, compaction.nextRelease());
+                std::this_thread::sleep_for(std::chrono::nanoseconds(wake > now ? wake - now : 0));
+            }
+        });
+    } else if (mode == "scheduler") {
+        ShardScheduler& scheduler = shard.getScheduler();
+        size_t bulk = scheduler.addClass(TaskClass{"compaction", std::chrono::microseconds(50), std::chrono::microseconds(20000)});
+        size_t quick = scheduler.addClass(TaskClass{"stats", std::chrono::microseconds(20), std::chrono::microseconds(2000)});
+        scheduler.addTask(quick, "stats", [&](TaskSlice&) {
+            stats_reads += engine.getStatistics().total_orders_processed > 0;
+            return false;
+        }, std::chrono::microseconds(stats_period_ns / 1000));
+        scheduler.addTask(bulk, "compaction", [&](TaskSlice& slice) {
+            if (!compaction.start(nowNanos())) {
+                return false;
+            }
+            while (compaction.unit()) {
+                if (slice.shouldYield()) {
+                    return true;
+                }
+            }
+            return false;
+        }, std::chrono::duration_cast<std::chrono::microseconds>(period));
+    }
+    shard.start();
+
+    // Paced producer: everything due by now goes out, then sleep to the next send time
+    uint64_t total = rate * seconds;
+    uint64_t interval_ns = 1000000000 / std::max<uint64_t>(1, rate);
+    FastRandom random(7);
+    std::vector<OrderId> resting;
+    uint64_t start = nowNanos();
+    for (uint64_t sent = 0; sent < total;) {
+        uint64_t now = nowNanos();
+        for (; sent < total && start + sent * interval_ns <= now; ++sent) {
+            if (!resting.empty() && random.below(3) == 0) {
+                size_t pick = random.below(resting.size());
+                shard.cancelOrder(1, resting[pick], "AAPL");
+                resting[pick] = resting.back();
+                resting.pop_back();
+                continue;
+            }
+            OrderSide side = random.below(2) ? OrderSide::SELL : OrderSide::BUY;
+            double offset = 0.01 * static_cast<double>(random.below(20)) - 0.05;
+            Order order(sent + 1, "AAPL", side, OrderType::LIMIT, side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset,
+                        1 + random.below(200));
+            order.setSession(1);
+            shard.submitOrder(order);
+            resting.push_back(order.getId());
+        }
+        uint64_t next = start + sent * interval_ns;
+        if (sent < total && next > now) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(next - now));
+        }
+    }
+    shard.stop();
+    done = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    RunResult result;
+    const ShardLatency& latency = shard.getLatency();
+    result.commands = latency.result.count();
+    result.p50 = latency.result.percentile(50);
+    result.p99 = latency.result.percentile(99);
+    result.p999 = latency.result.percentile(99.9);
+    result.max = latency.result.max();
+    result.jobs = compaction.jobs.load();
+    result.job_avg_us = result.jobs ? compaction.total_ns.load() / result.jobs / 1000 : 0;
+    result.job_max_us = compaction.max_ns.load() / 1000;
+    for (const auto& group : shard.getScheduler().getClassStatistics()) {
+        result.overruns += group.overruns;
+        result.budget_misses += group.budget_misses;
+    }
+    ShardStatistics stats = shard.getStatistics();
+    result.slices = stats.background_slices;
+    result.cpu_us = stats.background_cpu_nanos / 1000;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    uint64_t rate = std::max<uint64_t>(1, args.getUint("--rate", 10000));
+    uint64_t seconds = std::max<uint64_t>(1, args.getUint("--seconds", 2));
+    size_t units = std::max<uint64_t>(1, args.getUint("--units", 2000));
+    std::chrono::milliseconds period(std::max<uint64_t>(1, args.getUint("--period-ms", 50)));
+
+    std::vector<std::string> rows;
+    for (const char* mode : {"none", "inline", "thread", "scheduler"}) {
+        RunResult result = run(mode, rate, seconds, units, period);
+        std::cout << std::left << std::setw(10) << mode << std::right << std::setw(8) << result.commands << " commands  result p50 "
+                  << std::setw(7) << result.p50 << " ns  p99 " << std::setw(8) << result.p99 << " ns  p999 " << std::setw(8)
+                  << result.p999 << " ns  max " << std::setw(8) << result.max << " ns  jobs " << std::setw(3) << result.jobs
+                  << " avg " << std::setw(6) << result.job_avg_us << " us  max " << std::setw(6) << result.job_max_us << " us";
+        if (result.slices > 0) {
+            std::cout << "  slices " << result.slices << " cpu " << result.cpu_us << " us  overruns " << result.overruns
+                      << "  budget misses " << result.budget_misses;
+        }
+        std::cout << std::endl;
+        std::ostringstream row;
+        row << mode << "," << rate << "," << result.commands << "," << result.p50 << "," << result.p99 << "," << result.p999 << ","
+            << result.max << "," << result.jobs << "," << result.job_avg_us << "," << result.job_max_us << "," << result.slices << ","
+            << result.cpu_us << "," << result.overruns << "," << result.budget_misses;
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
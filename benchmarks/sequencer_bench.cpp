@@ -0,0 +1,263 @@
+// Throughput and added delay of the OutputSequencer merging per-shard event streams.
+//
+// Ring runs: 1, 8 and --shards producer threads each publish --events events (commands of one
+// to three events, stamped when published) into their own input. Reported: events sequenced per
+// second and the event timestamp -> delivery delay.
+//
+// Engine run: --shards EngineShards, each with its own MatchingEngine and attached with
+// OutputSequencer::attach, take --commands crossing orders and cancels spread over their
+// symbols. Reported: commands applied and events sequenced per second and the delay. The
+// recorded per-shard streams are then replayed through a fresh sequencer, which must reproduce
+// the global order exactly.
+//
+// Every run checks that the output sequence has no gaps, that event times never go backwards
+// and that each shard's events come out in shard sequence order.
+//
+// Usage:
+//   sequencer_bench [--shards N] [--events N] [--commands N] [--csv FILE]
+
+#include "matching_engine/output_sequencer.hpp"
+#include "matching_engine/journal.hpp"
+#include "bench_common.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "mode,shards,events,events_per_sec,delay_p50_ns,delay_p99_ns,delay_p999_ns,ordered";
+
+// Output checks, on the sequencer thread
+class OrderCheck {
+    private:
+        uint64_t next_sequence_ = 1;
+        int64_t last_time_ = INT64_MIN;
+        std::vector<uint64_t> last_shard_sequence_;
+        bool ordered_ = true;
+
+    public:
+        explicit OrderCheck(size_t inputs) : last_shard_sequence_(inputs, 0) {}
+
+        void check(const SequencedEvent* events, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                const SequencedEvent& e = events[i];
+                ordered_ &= e.sequence == next_sequence_++;
+                ordered_ &= e.event.timestamp_ns >= last_time_;
+                ordered_ &= e.event.sequence > last_shard_sequence_[e.input];
+                last_time_ = e.event.timestamp_ns;
+                last_shard_sequence_[e.input] = e.event.sequence;
+            }
+        }
+
+        bool ordered() const { return ordered_; }
+        uint64_t count() const { return next_sequence_ - 1; }
+};
+
+struct RunResult {
+    uint64_t events = 0;
+    double seconds = 0;
+    uint64_t delay_p50 = 0;
+    uint64_t delay_p99 = 0;
+    uint64_t delay_p999 = 0;
+    bool ordered = true;
+    uint64_t stalls = 0;
+};
+
+void readDelay(const OutputSequencer& sequencer, RunResult& result) {
+    result.delay_p50 = sequencer.getDelay().percentile(50);
+    result.delay_p99 = sequencer.getDelay().percentile(99);
+    result.delay_p999 = sequencer.getDelay().percentile(99.9);
+    result.stalls = sequencer.getStatistics().producer_stalls;
+}
+
+RunResult runRings(size_t shards, size_t events_per_shard) {
+    OutputSequencer sequencer;
+    OrderCheck check(shards);
+    sequencer.setEventCallback([&](const SequencedEvent* events, size_t count) { check.check(events, count); });
+    std::vector<OutputSequencer::Input*> inputs;
+    for (size_t s = 0; s < shards; ++s) {
+        inputs.push_back(&sequencer.addInput());
+    }
+    sequencer.start();
+
+    auto start = Clock::now();
+    std::vector<std::thread> producers;
+    for (size_t s = 0; s < shards; ++s) {
+        producers.emplace_back([&, s] {
+            FastRandom random(s + 1);
+            OrderEvent command[3];
+            uint64_t sequence = 0;
+            for (size_t sent = 0; sent < events_per_shard;) {
+                size_t count = std::min<size_t>(1 + random.below(3), events_per_shard - sent);
+                int64_t now = wallClockNanos();
+                for (size_t i = 0; i < count; ++i) {
+                    command[i].sequence = ++sequence;
+                    command[i].timestamp_ns = now;
+                    command[i].order_id = sequence;
+                }
+                inputs[s]->publish(command, count);
+                sent += count;
+            }
+            inputs[s]->close();
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    sequencer.stop();
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.events = check.count();
+    result.ordered = check.ordered() && result.events == shards * events_per_shard;
+    readDelay(sequencer, result);
+    return result;
+}
+
+RunResult runEngines(size_t shards, size_t commands, bool& replay_matches) {
+    const size_t symbols_per_shard = 4;
+    std::vector<std::unique_ptr<MatchingEngine>> engines;
+    std::vector<std::unique_ptr<EngineShard>> engine_shards;
+    OutputSequencer sequencer;
+    OrderCheck check(shards);
+    std::vector<std::vector<OrderEvent>> streams(shards);    // per shard, as sequenced
+    std::vector<std::pair<uint32_t, uint64_t>> merged;       // (input, shard sequence) in global order
+    sequencer.setEventCallback([&](const SequencedEvent* events, size_t count) {
+        check.check(events, count);
+        for (size_t i = 0; i < count; ++i) {
+            streams[events[i].input].push_back(events[i].event);
+            merged.push_back({events[i].input, events[i].event.sequence});
+        }
+    });
+    for (size_t s = 0; s < shards; ++s) {
+        EngineConfig config;
+        config.enable_logging = false;
+        engines.push_back(std::make_unique<MatchingEngine>(config));
+        engines.back()->start();
+        for (size_t k = 0; k < symbols_per_shard; ++k) {
+            engines.back()->addSymbol("S" + std::to_string(s * symbols_per_shard + k));
+        }
+        ShardOptions options;
+        options.coalesce = false;
+        options.idle_wait = std::chrono::microseconds(200);
+        engine_shards.push_back(std::make_unique<EngineShard>(*engines.back(), options));
+        sequencer.attach(*engine_shards.back());
+    }
+    sequencer.start();
+    for (auto& shard : engine_shards) {
+        shard->start();
+    }
+
+    // 70% orders around 100.00 (some crossing), 30% cancels of earlier ones
+    FastRandom random(7);
+    std::vector<std::pair<OrderId, size_t>> live;
+    auto start = Clock::now();
+    for (size_t i = 0; i < commands; ++i) {
+        if (!live.empty() && random.below(10) < 3) {
+            size_t pick = random.below(live.size());
+            auto [id, symbol] = live[pick];
+            live[pick] = live.back();
+            live.pop_back();
+            engine_shards[symbol / symbols_per_shard]->cancelOrder(1, id, "S" + std::to_string(symbol));
+            continue;
+        }
+        size_t symbol = random.below(shards * symbols_per_shard);
+        OrderSide side = random.below(2) ? OrderSide::SELL : OrderSide::BUY;
+        double offset = 0.01 * static_cast<double>(random.below(20)) - 0.05;
+        Price price = side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset;
+        Order order(i + 1, "S" + std::to_string(symbol), side, OrderType::LIMIT, price, 1 + random.below(200));
+        order.setSession(1);
+        live.push_back({order.getId(), symbol});
+        engine_shards[symbol / symbols_per_shard]->submitOrder(order);
+    }
+    for (auto& shard : engine_shards) {
+        shard->stop();
+    }
+    sequencer.stop();
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.events = check.count();
+    result.ordered = check.ordered();
+    readDelay(sequencer, result);
+
+    // Replay the recorded shard streams: the merge must come out the same
+    SequencerOptions replay_options;
+    for (const auto& stream : streams) {
+        replay_options.ring_capacity = std::max(replay_options.ring_capacity, stream.size()); //fed one input at a time
+    }
+    OutputSequencer replay(replay_options);
+    std::vector<std::pair<uint32_t, uint64_t>> replayed;
+    replay.setEventCallback([&](const SequencedEvent* events, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            replayed.push_back({events[i].input, events[i].event.sequence});
+        }
+    });
+    std::vector<OutputSequencer::Input*> inputs;
+    for (size_t s = 0; s < shards; ++s) {
+        inputs.push_back(&replay.addInput());
+    }
+    replay.start();
+    for (size_t s = shards; s-- > 0;) { //feed in a different order than the shards ran
+        for (const auto& event : streams[s]) {
+            inputs[s]->publish(&event, 1);
+        }
+        inputs[s]->close();
+    }
+    replay.stop();
+    replay_matches = replayed == merged;
+    return result;
+}
+
+void print(const char* mode, size_t shards, const RunResult& result) {
+    std::cout << std::left << std::setw(8) << mode << std::right << std::setw(4) << shards << " shards  " << std::fixed
+              << std::setprecision(0) << std::setw(10) << static_cast<double>(result.events) / result.seconds
+              << " events/s  delay p50 " << std::setw(8) << result.delay_p50 << " ns  p99 " << std::setw(9) << result.delay_p99
+              << " ns  p99.9 " << std::setw(9) << result.delay_p999 << " ns  stalls " << result.stalls
+              << (result.ordered ? "  ordered" : "  OUT OF ORDER") << std::endl;
+}
+
+std::string csvRow(const char* mode, size_t shards, const RunResult& result) {
+    std::ostringstream row;
+    row << mode << "," << shards << "," << result.events << "," << static_cast<double>(result.events) / result.seconds << ","
+        << result.delay_p50 << "," << result.delay_p99 << "," << result.delay_p999 << "," << (result.ordered ? 1 : 0);
+    return row.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t shards = std::max<uint64_t>(1, args.getUint("--shards", 16));
+    size_t events = std::max<uint64_t>(1, args.getUint("--events", 500000));
+    size_t commands = std::max<uint64_t>(1, args.getUint("--commands", 400000));
+
+    std::vector<std::string> rows;
+    std::vector<size_t> ring_counts{1};
+    if (shards > 8) ring_counts.push_back(8);
+    if (shards > 1) ring_counts.push_back(shards);
+    for (size_t count : ring_counts) {
+        RunResult result = runRings(count, events);
+        print("rings", count, result);
+        rows.push_back(csvRow("rings", count, result));
+    }
+    bool replay_matches = false;
+    RunResult result = runEngines(shards, commands, replay_matches);
+    print("engines", shards, result);
+    std::cout << "  " << commands << " commands in " << std::setprecision(2) << result.seconds << " s, replay of the shard streams "
+              << (replay_matches ? "reproduced" : "DID NOT reproduce") << " the global order\n";
+    rows.push_back(csvRow("engines", shards, result));
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Cost of taking a market-wide BBO + top-K snapshot.
+//
+// Populates --symbols books with --orders resting orders each, then captures every symbol:
+//   per-symbol  - one getMarketDepth() call per symbol (a lock, vectors and strings each time)
+//   bulk        - one getMarketSnapshot() into a reused MarketSnapshot
+//   bulk-all    - getMarketSnapshot() over every active symbol
+//   bulk-N      - as bulk-all, filled by --threads threads (only if --threads > 1)
+// and reports the wall time per full snapshot and per symbol. The bulk records are checked
+// against getMarketDepth() before timing.
+//
+// Usage:
+//   snapshot_bench [--symbols N] [--orders N] [--depth N] [--rounds N] [--threads N] [--csv FILE]
+
+#include "matching_engine/matching_engine.hpp"
+#include "bench_common.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "method,symbols,depth,threads,rounds,p50_us,p99_us,ns_per_symbol";
+
+bool sameAsDepth(const MatchingEngine& engine, const MarketSnapshot& snapshot, size_t index) {
+    const SymbolSnapshot& record = snapshot[index];
+    MarketDepth depth = engine.getMarketDepth(record.getSymbol(), snapshot.getDepth());
+    if (record.bid_levels != depth.bids.size() || record.ask_levels != depth.asks.size()) return false;
+    if (record.total_orders != depth.total_orders) return false;
+    if (record.best_bid != depth.best_bid.value_or(0) || record.best_ask != depth.best_ask.value_or(0)) return false;
+    for (size_t i = 0; i < depth.bids.size(); ++i) {
+        const DepthLevel& level = snapshot.getBids(index)[i];
+        if (level.price != depth.bids[i].first || level.quantity != depth.bids[i].second) return false;
+    }
+    for (size_t i = 0; i < depth.asks.size(); ++i) {
+        const DepthLevel& level = snapshot.getAsks(index)[i];
+        if (level.price != depth.asks[i].first || level.quantity != depth.asks[i].second) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t symbol_count = args.getUint("--symbols", 2000);
+    size_t orders = args.getUint("--orders", 50);
+    size_t depth = args.getUint("--depth", 5);
+    size_t rounds = args.getUint("--rounds", 200);
+    size_t threads = std::max<uint64_t>(1, args.getUint("--threads", 1));
+
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    engine.start();
+
+    std::vector<std::string> symbols;
+    FastRandom random(13);
+    OrderId next_id = 1;
+    for (size_t s = 0; s < symbol_count; ++s) {
+        symbols.push_back("S" + std::to_string(s));
+        engine.addSymbol(symbols.back());
+        for (size_t i = 0; i < orders; ++i) {
+            OrderSide side = random.below(2) ? OrderSide::BUY : OrderSide::SELL;
+            Price price = 100.0 + (side == OrderSide::BUY ? -0.01 : 0.01) * static_cast<double>(1 + random.below(20));
+            engine.submitOrder(Order(next_id++, symbols.back(), side, OrderType::LIMIT, price, 1 + random.below(100)));
+        }
+    }
+
+    MarketSnapshot snapshot(depth);
+    engine.getMarketSnapshot(symbols, snapshot);
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        if (!snapshot[i].found || !sameAsDepth(engine, snapshot, i)) {
+            std::cerr << "snapshot record for " << symbols[i] << " differs from getMarketDepth\n";
+            return 1;
+        }
+    }
+
+    std::vector<std::string> rows;
+    auto run = [&](const char* method, size_t method_threads, auto&& capture) {
+        LatencyRecorder latency(rounds);
+        size_t captured = 0;
+        for (size_t r = 0; r < rounds; ++r) {
+            auto start = Clock::now();
+            captured = capture();
+            latency.record(nanosSince(start));
+        }
+        double p50_us = latency.percentile(50) / 1000.0;
+        double p99_us = latency.percentile(99) / 1000.0;
+        double per_symbol = static_cast<double>(latency.percentile(50)) / std::max<size_t>(1, captured);
+        std::cout << std::left << std::setw(12) << method << std::right << "  p50 " << std::setw(9) << std::fixed
+                  << std::setprecision(1) << p50_us << " us  p99 " << std::setw(9) << p99_us << " us  "
+                  << std::setw(7) << per_symbol << " ns/symbol\n";
+        std::ostringstream row;
+        row << method << "," << captured << "," << depth << "," << method_threads << "," << rounds << "," << p50_us
+            << "," << p99_us << "," << per_symbol;
+        rows.push_back(row.str());
+    };
+
+    std::cout << symbol_count << " symbols, " << orders << " orders each, top " << depth << " levels\n";
+    size_t resting = 0; // keeps the per-symbol results observable
+    run("per-symbol", 1, [&] {
+        for (const auto& symbol : symbols) {
+            resting += engine.getMarketDepth(symbol, depth).total_orders;
+        }
+        return symbols.size();
+    });
+    run("bulk", 1, [&] { return engine.getMarketSnapshot(symbols, snapshot); });
+    run("bulk-all", 1, [&] { return engine.getMarketSnapshot(snapshot); });
+    if (threads > 1) {
+        std::string name = "bulk-" + std::to_string(threads);
+        run(name.c_str(), threads, [&] { return engine.getMarketSnapshot(snapshot, threads); });
+    }
+
+    if (resting == 0) std::cout << "(no resting orders)\n";
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Cost of serving UI viewers from the ViewerGateway, seen from the matching path.
+//
+// A generator submits --orders orders (crossing limit orders and cancels over --symbols books)
+// straight into a MatchingEngine with a BookReplica, as fast as it can. Runs:
+//   none        - no gateway (the baseline)
+//   json        - a gateway with --viewers WebSocket viewers following every symbol as JSON
+//   binary      - the same viewers on binary frames
+//   slow_binary - binary viewers plus one that stops reading (4 KB receive buffer) until the end
+// Viewers run on their own client thread in the same process. Reported: orders per second and
+// submit latency, frames and bytes received per viewer and per frame, and frames the gateway
+// conflated. After the flow stops every binary viewer, the slow one included, must hold the
+// replica's final book for every symbol.
+//
+// Usage:
+//   viewer_bench [--orders N] [--symbols N] [--viewers N] [--interval-ms N] [--csv FILE]
+
+#include "matching_engine/viewer_gateway.hpp"
+#include "bench_common.hpp"
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace beast = boost::beast;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+const char* CSV_HEADER = "mode,viewers,orders,orders_per_sec,submit_p50_ns,submit_p99_ns,frames_per_viewer,bytes_per_frame,conflated,consistent";
+
+const size_t DEPTH = 10;
+
+std::string symbolName(size_t index) {
+    return "S" + std::to_string(index);
+}
+
+// One WebSocket viewer, read on the client io_context's thread
+struct BenchViewer {
+    websocket::stream<tcp::socket> ws;
+    beast::flat_buffer buffer;
+    bool binary;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    std::map<std::string, ViewerFrame> books;   // binary only: latest book per symbol
+
+    BenchViewer(boost::asio::io_context& io_context, bool binary_frames) : ws(io_context), binary(binary_frames) {}
+
+    void connect(unsigned short port, bool small_buffer) {
+        ws.next_layer().open(tcp::v4());
+        if (small_buffer) {
+            ws.next_layer().set_option(boost::asio::socket_base::receive_buffer_size(4096));
+        }
+        ws.next_layer().connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+        ws.handshake("127.0.0.1", binary ? "/ws?symbols=*&format=binary" : "/ws?symbols=*&format=json");
+    }
+
+    void read() {
+        ws.async_read(buffer, [this](const boost::system::error_code& error, size_t size) {
+            if (error) return;
+            frames++;
+            bytes += size;
+            if (binary) {
+                ViewerFrame frame;
+                std::string data = beast::buffers_to_string(buffer.data());
+                decodeViewerFrame(data.data(), data.size(), frame);
+                if (frame.kind == ViewerFrame::BOOK) books[frame.symbol] = std::move(frame);
+            }
+            buffer.consume(buffer.size());
+            read();
+        });
+    }
+};
+
+struct RunResult {
+    double seconds = 0;
+    uint64_t submit_p50 = 0;
+    uint64_t submit_p99 = 0;
+    uint64_t frames_per_viewer = 0;
+    uint64_t bytes_per_frame = 0;
+    uint64_t conflated = 0;
+    uint64_t slow_frames = 0;
+    bool consistent = true;
+};
+
+RunResult run(const std::string& mode, size_t orders, size_t symbols, size_t viewer_count, std::chrono::milliseconds interval) {
+    EngineConfig config;
+    config.enable_logging = false;
+    config.max_orders_per_symbol = orders;
+    MatchingEngine engine(config);
+    engine.start();
+    for (size_t s = 0; s < symbols; ++s) {
+        engine.addSymbol(symbolName(s));
+    }
+    BookReplica replica(engine);
+
+    std::unique_ptr<ViewerGateway> gateway;
+    boost::asio::io_context client_io;
+    std::vector<std::unique_ptr<BenchViewer>> viewers;
+    std::unique_ptr<BenchViewer> slow;
+    std::thread client_thread;
+    bool binary = mode != "json";
+    if (mode != "none") {
+        ViewerGatewayOptions options;
+        options.address = "127.0.0.1";
+        options.interval = interval;
+        options.depth = DEPTH;
+        gateway = std::make_unique<ViewerGateway>(engine, replica, options);
+        gateway->start();
+        for (size_t v = 0; v < viewer_count; ++v) {
+            viewers.push_back(std::make_unique<BenchViewer>(client_io, binary));
+            viewers.back()->connect(gateway->getPort(), false);
+            viewers.back()->read();
+        }
+        if (mode == "slow_binary") {
+            slow = std::make_unique<BenchViewer>(client_io, true);
+            slow->connect(gateway->getPort(), true);
+        }
+        client_thread = std::thread([&client_io] {
+            auto work = boost::asio::make_work_guard(client_io);
+            client_io.run();
+        });
+    }
+
+    FastRandom random(17);
+    std::vector<std::pair<OrderId, size_t>> resting;
+    LatencyRecorder submit(orders);
+    auto start = Clock::now();
+    for (size_t i = 0; i < orders; ++i) {
+        auto sent = Clock::now();
+        if (!resting.empty() && random.below(10) < 3) {
+            size_t pick = random.below(resting.size());
+            engine.cancelOrder(resting[pick].first, symbolName(resting[pick].second));
+            resting[pick] = resting.back();
+            resting.pop_back();
+        } else {
+            size_t symbol = random.below(symbols);
+            OrderSide side = random.below(2) ? OrderSide::SELL : OrderSide::BUY;
+            double offset = 0.01 * static_cast<double>(random.below(20)) - 0.05; // negative offsets cross
+            Order order(i + 1, symbolName(symbol), side, OrderType::LIMIT, side == OrderSide::BUY ? 100.0 - offset : 100.0 + offset,
+                        1 + random.below(200));
+            engine.submitOrder(order);
+            resting.push_back({order.getId(), symbol});
+        }
+        submit.record(nanosSince(sent));
+    }
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.submit_p50 = submit.percentile(50);
+    result.submit_p99 = submit.percentile(99);
+    if (!gateway) {
+        return result;
+    }
+
+    // Let the replica and then the gateway catch up, and the slow viewer drain its backlog
+    replica.waitForSequence(replica.getStatistics().published_sequence, std::chrono::seconds(10));
+    if (slow) {
+        boost::asio::post(client_io, [&slow] { slow->read(); });
+    }
+    std::this_thread::sleep_for(interval * 6);
+    client_io.stop();
+    client_thread.join();
+
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    for (const auto& viewer : viewers) {
+        frames += viewer->frames;
+        bytes += viewer->bytes;
+    }
+    result.frames_per_viewer = viewers.empty() ? 0 : frames / viewers.size();
+    result.bytes_per_frame = frames ? bytes / frames : 0;
+    result.conflated = gateway->getStatistics().frames_conflated;
+    if (binary) {
+        if (slow) {
+            viewers.push_back(std::move(slow));
+            result.slow_frames = viewers.back()->frames;
+        }
+        for (size_t s = 0; s < symbols; ++s) {
+            MarketDepth depth = replica.getMarketDepth(symbolName(s), DEPTH);
+            for (const auto& viewer : viewers) {
+                auto it = viewer->books.find(symbolName(s));
+                result.consistent &= it != viewer->books.end() && it->second.bids == depth.bids && it->second.asks == depth.asks;
+            }
+        }
+    }
+    gateway->stop();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t orders = std::max<uint64_t>(1, args.getUint("--orders", 200000));
+    size_t symbols = std::max<uint64_t>(1, args.getUint("--symbols", 8));
+    size_t viewers = std::max<uint64_t>(1, args.getUint("--viewers", 50));
+    std::chrono::milliseconds interval(std::max<uint64_t>(1, args.getUint("--interval-ms", 50)));
+
+    std::vector<std::string> rows;
+    for (const char* mode : {"none", "json", "binary", "slow_binary"}) {
+        RunResult result = run(mode, orders, symbols, viewers, interval);
+        size_t shown_viewers = std::string(mode) == "none" ? 0 : viewers;
+        double per_second = static_cast<double>(orders) / result.seconds;
+        std::cout << std::left << std::setw(12) << mode << std::right << std::setw(4) << shown_viewers << " viewers  "
+                  << std::setw(9) << static_cast<uint64_t>(per_second) << " orders/s  submit p50 " << std::setw(6)
+                  << result.submit_p50 << " ns  p99 " << std::setw(7) << result.submit_p99 << " ns";
+        if (shown_viewers > 0) {
+            std::cout << "  " << std::setw(5) << result.frames_per_viewer << " frames/viewer  " << std::setw(4)
+                      << result.bytes_per_frame << " B/frame  conflated " << result.conflated;
+            if (result.slow_frames > 0) std::cout << "  slow viewer " << result.slow_frames << " frames";
+            if (std::string(mode) != "json") std::cout << (result.consistent ? "  consistent" : "  INCONSISTENT");
+        }
+        std::cout << std::endl;
+        std::ostringstream row;
+        row << mode << "," << shown_viewers << "," << orders << "," << static_cast<uint64_t>(per_second) << "," << result.submit_p50
+            << "," << result.submit_p99 << "," << result.frames_per_viewer << "," << result.bytes_per_frame << ","
+            << result.conflated << "," << (result.consistent ? 1 : 0);
+        rows.push_back(row.str());
+    }
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
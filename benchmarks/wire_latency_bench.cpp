@@ -0,0 +1,160 @@
+// Wire-to-match and wire-to-ack latency through the TCP gateway, measured from the kernel
+// receive timestamp.
+//
+// A Server on loopback feeds SUBMIT_ORDER lines (the Client wire format) into a MatchingEngine
+// and acks each one. A sender thread writes orders in bursts of --burst lines every --gap-us
+// microseconds; bursts pile up in the socket buffer, which is exactly the queueing the
+// kernel timestamps expose. Reported from Message::receive_timestamp_ns:
+//   socket queue  - until the server's handler starts (time spent waiting for the io_context)
+//   wire-to-match - until submitOrder returns
+//   wire-to-ack   - until the ack has been written back to the socket
+//
+// Usage:
+//   wire_latency_bench [--orders N] [--burst N] [--gap-us N] [--csv FILE]
+
+#include "matching_engine/matching_engine.hpp"
+#include "matching_engine/server.hpp"
+#include "bench_common.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace matching_engine;
+using namespace matching_engine::bench;
+
+namespace {
+
+const char* CSV_HEADER = "metric,kernel_timestamps,orders,burst,p50_ns,p99_ns,p999_ns,max_ns";
+
+// "SUBMIT_ORDER|id,symbol,side,type,price,quantity" as written by Client::submitOrder
+bool parseSubmit(const std::string& payload, Order& order) {
+    const std::string prefix = "SUBMIT_ORDER|";
+    if (payload.compare(0, prefix.size(), prefix) != 0) return false;
+    std::istringstream in(payload.substr(prefix.size()));
+    std::string id, symbol, side, type, price, quantity;
+    if (!std::getline(in, id, ',') || !std::getline(in, symbol, ',') || !std::getline(in, side, ',') ||
+        !std::getline(in, type, ',') || !std::getline(in, price, ',') || !std::getline(in, quantity)) {
+        return false;
+    }
+    order = Order(std::stoull(id), symbol, static_cast<OrderSide>(std::stoi(side)), static_cast<OrderType>(std::stoi(type)),
+                  std::stod(price), std::stoull(quantity));
+    return true;
+}
+
+void report(const char* metric, const LatencyHistogram& histogram, bool kernel, size_t orders, size_t burst,
+            std::vector<std::string>& rows) {
+    std::cout << "  " << std::left << std::setw(14) << metric << std::right
+              << "  p50 " << std::setw(8) << histogram.percentile(50) << " ns"
+              << "  p99 " << std::setw(8) << histogram.percentile(99) << " ns"
+              << "  p99.9 " << std::setw(8) << histogram.percentile(99.9) << " ns"
+              << "  max " << std::setw(9) << histogram.max() << " ns\n";
+    std::ostringstream row;
+    row << metric << "," << (kernel ? 1 : 0) << "," << orders << "," << burst << "," << histogram.percentile(50) << ","
+        << histogram.percentile(99) << "," << histogram.percentile(99.9) << "," << histogram.max();
+    rows.push_back(row.str());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args(argc, argv);
+    size_t orders = args.getUint("--orders", 100000);
+    size_t burst = std::max<uint64_t>(1, args.getUint("--burst", 8));
+    uint64_t gap_us = args.getUint("--gap-us", 50);
+
+    EngineConfig config;
+    config.enable_logging = false;
+    MatchingEngine engine(config);
+    engine.start();
+    engine.addSymbol("BENCH");
+
+    LatencyHistogram wire_to_match;
+    LatencyHistogram wire_to_ack;
+    std::atomic<bool> kernel_timestamps{false};
+    std::atomic<size_t> handled{0};
+
+    boost::asio::io_context io_context;
+    Server server(io_context, 0, [&](const Message& msg, std::shared_ptr<boost::asio::ip::tcp::socket> socket) {
+        Order order(1, "BENCH", OrderSide::BUY, OrderType::LIMIT, 1.0, 1);
+        if (msg.type != MessageType::ORDER || !parseSubmit(msg.payload, order)) return;
+        engine.submitOrder(order);
+        wire_to_match.record(static_cast<uint64_t>(Server::nowNanos() - msg.receive_timestamp_ns));
+
+        std::string ack = "TRADE|ACK " + std::to_string(order.getId()) + "\n";
+        boost::system::error_code ec;
+        boost::asio::write(*socket, boost::asio::buffer(ack), ec);
+        wire_to_ack.record(static_cast<uint64_t>(Server::nowNanos() - msg.receive_timestamp_ns));
+        kernel_timestamps = msg.kernel_timestamp;
+        handled++;
+    });
+    server.start();
+    std::thread io_thread([&io_context] { io_context.run(); });
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(server.getPort());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "connect failed\n";
+        return 1;
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // Drain acks so the server's writes never block
+    std::thread ack_reader([fd] {
+        char buffer[65536];
+        while (::read(fd, buffer, sizeof(buffer)) > 0) {
+        }
+    });
+
+    FastRandom random(5);
+    for (size_t sent = 0; sent < orders;) {
+        std::string lines;
+        for (size_t i = 0; i < burst && sent < orders; ++i, ++sent) {
+            OrderSide side = random.below(2) ? OrderSide::BUY : OrderSide::SELL;
+            Price price = 100.0 + (side == OrderSide::BUY ? -1.0 : 1.0) * static_cast<double>(random.below(20)) * 0.01;
+            std::ostringstream line;
+            line << "ORDER|SUBMIT_ORDER|" << sent + 1 << ",BENCH," << static_cast<int>(side) << ","
+                 << static_cast<int>(OrderType::LIMIT) << "," << price << "," << 1 + random.below(100) << "\n";
+            lines += line.str();
+        }
+        ::write(fd, lines.data(), lines.size()); // one write per burst: the lines arrive together
+        auto until = Clock::now() + std::chrono::microseconds(gap_us);
+        while (Clock::now() < until) {
+        }
+    }
+    while (handled.load() < orders) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ::shutdown(fd, SHUT_RDWR);
+    ack_reader.join();
+    ::close(fd);
+    server.stop();
+    io_context.stop();
+    io_thread.join();
+
+    std::cout << orders << " orders in bursts of " << burst << " every " << gap_us << " us, receive timestamps from "
+              << (kernel_timestamps ? "the kernel (SO_TIMESTAMPING)" : "user space (SO_TIMESTAMPING unavailable)") << "\n";
+    std::vector<std::string> rows;
+    report("socket queue", server.getLatency().socket_queue, kernel_timestamps, orders, burst, rows);
+    report("wire-to-match", wire_to_match, kernel_timestamps, orders, burst, rows);
+    report("wire-to-ack", wire_to_ack, kernel_timestamps, orders, burst, rows);
+
+    auto csv_path = args.get("--csv", "");
+    if (!csv_path.empty()) {
+        bool write_header = !std::ifstream(csv_path).good();
+        std::ofstream csv(csv_path, std::ios::app);
+        if (write_header) csv << CSV_HEADER << "\n";
+        for (const auto& row : rows) csv << row << "\n";
+    }
+    return 0;
+}
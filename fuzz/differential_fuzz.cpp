@@ -0,0 +1,323 @@
+// Differential fuzz harness: candidate books vs. the reference OrderBook.
+//
+// Every input is decoded into a sequence of book commands (passive and aggressive limit
+// adds, cancels, modifies as cancel + re-add, and market sweeps) that is applied to the
+// reference OrderBook and to each candidate implementation. After every command the
+// harness requires identical trades (id, symbol, price, quantity, both order ids), cancel
+// results, BBO, level/order counts and full depth, and checks a few matching invariants
+// (plus the incrementally maintained top-of-book snapshot) on the reference itself. Any
+// difference prints the command log and aborts.
+//
+// Built as a libFuzzer target with -DMATCHING_ENGINE_LIBFUZZER=ON under clang; otherwise
+// it is a standalone driver:
+//   differential_fuzz [--runs N] [--commands C] [--seed S]   random cases
+//   differential_fuzz --soak-seconds T [--seed S]            long soak until T seconds pass
+//   differential_fuzz --replay FILE                          rerun a saved failing input
+
+#include "matching_engine/order_book.hpp"
+#include "matching_engine/pooled_order_book.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace matching_engine;
+
+namespace {
+
+const std::string FUZZ_SYMBOL = "FUZZ";
+
+// Input of the case being run, so a failure can be saved for --replay
+const uint8_t* current_input = nullptr;
+size_t current_input_size = 0;
+
+class ByteReader {
+    private:
+        const uint8_t* data_;
+        size_t size_;
+        size_t pos_ = 0;
+
+    public:
+        ByteReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+        bool done() const { return pos_ >= size_; }
+        uint8_t next() { return pos_ < size_ ? data_[pos_++] : 0; }
+        uint16_t next16() { uint16_t lo = next(); return static_cast<uint16_t>(lo | (next() << 8)); }
+};
+
+template <typename Reference, typename Candidate>
+class DifferentialRunner {
+    private:
+        const char* candidate_name_;
+        Reference reference_;
+        Candidate candidate_;
+        std::vector<std::pair<OrderId, OrderSide>> submitted_; // every id handed to the books
+        OrderId next_id_ = 1;
+        TradeId last_trade_id_ = 0;
+        uint64_t last_top_sequence_ = 0;
+        std::vector<std::string> log_;
+
+        [[noreturn]] void fail(const std::string& what) {
+            std::cerr << "\n*** DIFFERENCE vs " << candidate_name_ << ": " << what << "\n";
+            std::cerr << "Command log (" << log_.size() << " commands):\n";
+            size_t first = log_.size() > 50 ? log_.size() - 50 : 0;
+            for (size_t i = first; i < log_.size(); ++i) {
+                std::cerr << "  #" << i << " " << log_[i] << "\n";
+            }
+            std::cerr << "Reference book:\n" << reference_.toString(10)
+                      << "Candidate book:\n" << candidate_.toString(10) << std::flush;
+            if (current_input) {
+                std::ofstream out("differential-failure.bin", std::ios::binary);
+                out.write(reinterpret_cast<const char*>(current_input), static_cast<std::streamsize>(current_input_size));
+                std::cerr << "Input saved to differential-failure.bin (rerun with --replay)\n";
+            }
+            std::abort();
+        }
+
+        static Price tickPrice(int ticks) {
+            // 100.00 +/- ticks * 0.05, built from integers so both books see the same double
+            return (10000 + ticks * 5) / 100.0;
+        }
+
+        static std::string describe(const Trade& t) {
+            std::ostringstream oss;
+            oss << "{id=" << t.trade_id << " " << t.symbol << " px=" << t.price << " qty=" << t.quantity
+                << " buy=" << t.buy_order_id << " sell=" << t.sell_order_id << "}";
+            return oss.str();
+        }
+
+        void compareTrades(const std::vector<Trade>& expected, const std::vector<Trade>& actual) {
+            if (expected.size() != actual.size()) {
+                fail("trade count " + std::to_string(expected.size()) + " vs " + std::to_string(actual.size()));
+            }
+            for (size_t i = 0; i < expected.size(); ++i) {
+                const Trade& e = expected[i];
+                const Trade& a = actual[i];
+                if (e.trade_id != a.trade_id || e.symbol != a.symbol || e.price != a.price || e.quantity != a.quantity ||
+                    e.buy_order_id != a.buy_order_id || e.sell_order_id != a.sell_order_id) {
+                    fail("trade " + std::to_string(i) + " " + describe(e) + " vs " + describe(a));
+                }
+            }
+        }
+
+        void compareBooks() {
+            if (reference_.getBestBid() != candidate_.getBestBid()) fail("best bid");
+            if (reference_.getBestAsk() != candidate_.getBestAsk()) fail("best ask");
+            if (reference_.getBestBidQuantity() != candidate_.getBestBidQuantity()) fail("best bid quantity");
+            if (reference_.getBestAskQuantity() != candidate_.getBestAskQuantity()) fail("best ask quantity");
+            if (reference_.getOrderCount() != candidate_.getOrderCount()) {
+                fail("order count " + std::to_string(reference_.getOrderCount()) + " vs " + std::to_string(candidate_.getOrderCount()));
+            }
+            if (reference_.getBidLevelCount() != candidate_.getBidLevelCount()) fail("bid level count");
+            if (reference_.getAskLevelCount() != candidate_.getAskLevelCount()) fail("ask level count");
+            if (reference_.getBidLevels(SIZE_MAX) != candidate_.getBidLevels(SIZE_MAX)) fail("bid depth");
+            if (reference_.getAskLevels(SIZE_MAX) != candidate_.getAskLevels(SIZE_MAX)) fail("ask depth");
+
+            auto bid = reference_.getBestBid();
+            auto ask = reference_.getBestAsk();
+            if (bid && ask && *bid >= *ask) fail("reference book is crossed");
+
+            checkTopOfBook();
+        }
+
+        // The incrementally maintained snapshot must match what the depth queries say
+        void checkTopOfBook() {
+            TopOfBook top = reference_.getTopOfBook();
+            size_t k = reference_.getAnalyticsDepth();
+            auto bids = reference_.getBidLevels(k);
+            auto asks = reference_.getAskLevels(k);
+
+            Quantity bid_depth = 0, ask_depth = 0;
+            for (const auto& [price, qty] : bids) bid_depth += qty;
+            for (const auto& [price, qty] : asks) ask_depth += qty;
+
+            if (top.best_bid != (bids.empty() ? 0 : bids[0].first) ||
+                top.best_ask != (asks.empty() ? 0 : asks[0].first)) fail("snapshot BBO is stale");
+            if (top.best_bid_quantity != reference_.getBestBidQuantity() ||
+                top.best_ask_quantity != reference_.getBestAskQuantity()) fail("snapshot BBO quantity is stale");
+            if (top.bid_depth_quantity != bid_depth || top.ask_depth_quantity != ask_depth) {
+                fail("snapshot top-" + std::to_string(k) + " depth " + std::to_string(top.bid_depth_quantity) + "/" +
+                     std::to_string(top.ask_depth_quantity) + " vs " + std::to_string(bid_depth) + "/" + std::to_string(ask_depth));
+            }
+            if (top.sequence < last_top_sequence_) fail("snapshot sequence went backwards");
+            last_top_sequence_ = top.sequence;
+        }
+
+        // Matching invariants that hold for any correct book, checked on the reference output
+        void checkTrades(const Order& incoming, const std::vector<Trade>& trades) {
+            Quantity traded = 0;
+            Price previous_price = 0;
+            for (const auto& t : trades) {
+                if (t.trade_id != ++last_trade_id_) fail("trade ids not consecutive at " + describe(t));
+                if (t.quantity == 0) fail("zero quantity trade " + describe(t));
+                if (t.symbol != FUZZ_SYMBOL) fail("wrong symbol " + describe(t));
+                OrderId aggressor = incoming.isBuyOrder() ? t.buy_order_id : t.sell_order_id;
+                OrderId passive = incoming.isBuyOrder() ? t.sell_order_id : t.buy_order_id;
+                if (aggressor != incoming.getId()) fail("aggressor id mismatch " + describe(t));
+                if (passive == incoming.getId() || passive == INVALID_ORDER_ID || passive >= next_id_) {
+                    fail("unknown passive order " + describe(t));
+                }
+                if (incoming.isLimitOrder()) {
+                    bool within_limit = incoming.isBuyOrder() ? t.price <= incoming.getPrice() : t.price >= incoming.getPrice();
+                    if (!within_limit) fail("trade through the limit " + describe(t));
+                }
+                if (previous_price != 0) {
+                    bool monotonic = incoming.isBuyOrder() ? t.price >= previous_price : t.price <= previous_price;
+                    if (!monotonic) fail("sweep improved on a worse level " + describe(t));
+                }
+                previous_price = t.price;
+                traded += t.quantity;
+            }
+            if (traded > incoming.getQuantity()) fail("overfilled order " + std::to_string(incoming.getId()));
+        }
+
+        void submit(const Order& order) {
+            log_.push_back(order.toString());
+            submitted_.emplace_back(order.getId(), order.getSide());
+            auto expected = reference_.addOrder(order);
+            auto actual = candidate_.addOrder(order);
+            checkTrades(order, expected);
+            compareTrades(expected, actual);
+        }
+
+        OrderId pickId(ByteReader& in) {
+            uint16_t pick = in.next16();
+            // Roughly 1 in 16 targets an id that was never submitted
+            if (submitted_.empty() || pick % 16 == 0) return next_id_ + pick;
+            return submitted_[pick % submitted_.size()].first;
+        }
+
+    public:
+        explicit DifferentialRunner(const char* candidate_name) : candidate_name_(candidate_name) {}
+
+        void step(ByteReader& in) {
+            uint8_t op = in.next() % 16;
+            OrderSide side = (in.next() & 1) ? OrderSide::SELL : OrderSide::BUY;
+
+            if (op < 7) {
+                // Passive-leaning limit: bids at or below 100, asks at or above, some overlap
+                int ticks = static_cast<int>(in.next() % 24) - 2;
+                Price price = side == OrderSide::BUY ? tickPrice(-ticks) : tickPrice(ticks);
+                submit(Order(next_id_++, FUZZ_SYMBOL, side, OrderType::LIMIT, price, 1 + in.next16() % 1000));
+            } else if (op < 10) {
+                // Aggressive limit reaching well into the other side
+                int ticks = static_cast<int>(in.next() % 24);
+                Price price = side == OrderSide::BUY ? tickPrice(ticks) : tickPrice(-ticks);
+                submit(Order(next_id_++, FUZZ_SYMBOL, side, OrderType::LIMIT, price, 1 + in.next16() % 3000));
+            } else if (op < 13) {
+                OrderId id = pickId(in);
+                log_.push_back("CANCEL " + std::to_string(id));
+                bool expected = reference_.cancelOrder(id);
+                bool actual = candidate_.cancelOrder(id);
+                if (expected != actual) fail("cancel result for " + std::to_string(id));
+            } else if (op < 15) {
+                // Modify = cancel and re-add with the same id and side (as MatchingEngine does)
+                OrderId id = pickId(in);
+                int ticks = static_cast<int>(in.next() % 41) - 20;
+                Quantity quantity = 1 + in.next16() % 1000;
+                log_.push_back("MODIFY " + std::to_string(id));
+                auto expected = reference_.removeOrder(id);
+                auto actual = candidate_.removeOrder(id);
+                if (expected.has_value() != actual.has_value()) fail("modify lookup for " + std::to_string(id));
+                if (expected) {
+                    if (expected->getRemainingQuantity() != actual->getRemainingQuantity() ||
+                        expected->getPrice() != actual->getPrice() || expected->getSide() != actual->getSide()) {
+                        fail("removed order differs: " + expected->toString() + " vs " + actual->toString());
+                    }
+                    submit(Order(id, FUZZ_SYMBOL, expected->getSide(), OrderType::LIMIT, tickPrice(ticks), quantity));
+                }
+            } else {
+                submit(Order(next_id_++, FUZZ_SYMBOL, side, 1 + in.next16() % 5000));
+            }
+
+            compareBooks();
+        }
+};
+
+int runInput(const uint8_t* data, size_t size) {
+    current_input = data;
+    current_input_size = size;
+
+    // One runner per candidate implementation
+    {
+        DifferentialRunner<OrderBook, PooledOrderBook> runner("PooledOrderBook");
+        ByteReader in(data, size);
+        while (!in.done()) runner.step(in);
+    }
+    return 0;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    return runInput(data, size);
+}
+
+#ifndef MATCHING_ENGINE_LIBFUZZER
+
+namespace {
+
+std::string argValue(int argc, char** argv, const std::string& name, const std::string& fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) return argv[i + 1];
+    }
+    return fallback;
+}
+
+std::vector<uint8_t> randomInput(uint64_t& state, size_t bytes) {
+    std::vector<uint8_t> input(bytes);
+    for (auto& b : input) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        b = static_cast<uint8_t>(state >> 24);
+    }
+    return input;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto replay = argValue(argc, argv, "--replay", "");
+    if (!replay.empty()) {
+        std::ifstream in(replay, std::ios::binary);
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        runInput(input.data(), input.size());
+        std::cout << "Replayed " << input.size() << " bytes: no differences" << std::endl;
+        return 0;
+    }
+
+    uint64_t seed = std::strtoull(argValue(argc, argv, "--seed", "1").c_str(), nullptr, 10);
+    uint64_t runs = std::strtoull(argValue(argc, argv, "--runs", "1000").c_str(), nullptr, 10);
+    uint64_t commands = std::strtoull(argValue(argc, argv, "--commands", "2000").c_str(), nullptr, 10);
+    uint64_t soak_seconds = std::strtoull(argValue(argc, argv, "--soak-seconds", "0").c_str(), nullptr, 10);
+
+    uint64_t state = seed ? seed : 1;
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    uint64_t cases = 0;
+
+    auto elapsed = [&] { return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count(); };
+
+    while (soak_seconds ? static_cast<uint64_t>(elapsed()) < soak_seconds : cases < runs) {
+        // Vary case length so both short and long-lived books are covered
+        size_t bytes = (1 + cases % commands) * 5;
+        auto input = randomInput(state, bytes);
+        runInput(input.data(), input.size());
+        cases++;
+
+        if (std::chrono::steady_clock::now() - last_report > std::chrono::seconds(10)) {
+            last_report = std::chrono::steady_clock::now();
+            std::cout << "  " << cases << " cases, " << elapsed() << "s" << std::endl;
+        }
+    }
+
+    std::cout << "Seed " << seed << ": " << cases << " cases without differences" << std::endl;
+    return 0;
+}
+
+#endif
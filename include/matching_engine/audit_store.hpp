@@ -0,0 +1,180 @@
+#pragma once
+
+#include <matching_engine/order_event.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief One index entry: an order id or account and the position of an event in events.log
+ */
+struct AuditIndexEntry {
+    uint64_t key;
+    uint64_t event;
+
+    bool operator<(const AuditIndexEntry& other) const {
+        return key != other.key ? key < other.key : event < other.event;
+    }
+};
+static_assert(sizeof(AuditIndexEntry) == 16, "AuditIndexEntry is an on-disk format");
+
+struct AuditStoreOptions {
+    size_t segment_events = 65536;                          ///< Events per index segment
+    std::chrono::milliseconds flush_interval{50};           ///< Max delay before queued events hit events.log
+};
+
+/**
+ * @brief Background writer of the order lifecycle audit store
+ *
+ * The store is an append-only directory:
+ * - events.log: OrderEvent records back to back, event N at byte N * sizeof(OrderEvent)
+ * - order-<n>.idx / account-<n>.idx: sorted AuditIndexEntry runs (order id / account -> event);
+ *   events with account 0 are not in the account index
+ * - MANIFEST: live segment files and how many events they cover, replaced atomically
+ *
+ * Events beyond the indexed count (at most about one segment's worth) are found by scanning
+ * the tail of events.log. Segments of similar size are merged as they accumulate, so each
+ * index stays a logarithmic number of files.
+ *
+ * enqueue() only copies the event into a queue; a dedicated thread appends to events.log,
+ * writes index segments and maintains the manifest. Typical wiring:
+ *
+ *   engine.registerEventCallback([&writer](const OrderEvent& e) { writer.enqueue(e); });
+ */
+class AuditStoreWriter {
+    private:
+        struct Segment {
+            uint64_t id;
+            uint64_t entries;
+        };
+
+        std::string dir_;
+        AuditStoreOptions options_;
+        int events_fd_;
+
+        // Shared with the writer thread
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable flushed_;
+        std::vector<OrderEvent> queue_;
+        uint64_t enqueued_ = 0;      // events handed to enqueue()
+        uint64_t indexed_ = 0;       // events on disk and covered by index segments
+        bool flush_requested_ = false;
+        bool stopping_ = false;
+        std::string error_;          // set if the writer thread died on an I/O error
+
+        // Owned by the writer thread
+        uint64_t written_ = 0;       // events in events.log
+        uint64_t next_segment_id_ = 1;
+        std::vector<AuditIndexEntry> pending_orders_;
+        std::vector<AuditIndexEntry> pending_accounts_;
+        std::vector<Segment> order_segments_;
+        std::vector<Segment> account_segments_;
+
+        std::thread thread_;
+
+        void run();
+        void appendEvents(const std::vector<OrderEvent>& events);
+        void writeSegments();
+        Segment writeSegment(const char* kind, std::vector<AuditIndexEntry>& entries);
+        void mergeSegments(const char* kind, std::vector<Segment>& segments, std::vector<std::string>& obsolete);
+        void writeManifest(uint64_t indexed_events);
+        void recover();
+
+    public:
+        /**
+         * @brief Open (or create) a store directory and start the writer thread
+         *
+         * Events already in events.log but not yet indexed (e.g. after a crash) are indexed
+         * before the thread starts.
+         * @throws std::runtime_error if the directory can't be used
+         */
+        AuditStoreWriter(const std::string& dir, const AuditStoreOptions& options = AuditStoreOptions{});
+
+        /**
+         * @brief Flush everything queued and stop the writer thread
+         */
+        ~AuditStoreWriter();
+
+        AuditStoreWriter(const AuditStoreWriter&) = delete;
+        AuditStoreWriter& operator=(const AuditStoreWriter&) = delete;
+
+        /**
+         * @brief Queue an event for writing (thread safe, never touches disk)
+         */
+        void enqueue(const OrderEvent& event);
+
+        /**
+         * @brief Block until every event queued so far is on disk and indexed
+         * @throws std::runtime_error if the writer thread hit an I/O error
+         */
+        void flush();
+};
+
+/**
+ * @brief Memory-mapped reader over an AuditStore directory
+ *
+ * Can run in a different process from the writer; refresh() picks up what was written since.
+ */
+class AuditStoreReader {
+    private:
+        struct Mapping {
+            const char* data = nullptr;
+            size_t size = 0;
+        };
+
+        std::string dir_;
+        Mapping events_;
+        std::vector<Mapping> order_segments_;
+        std::vector<Mapping> account_segments_;
+        uint64_t indexed_events_ = 0;
+        uint64_t event_count_ = 0;
+
+        static Mapping map(const std::string& path);
+        static void unmap(Mapping& mapping);
+        void unmapAll();
+
+        std::vector<OrderEvent> lookup(const std::vector<Mapping>& segments, uint64_t key, bool by_account, size_t max_events) const;
+        const OrderEvent* eventAt(uint64_t index) const;
+
+    public:
+        /**
+         * @param dir Store directory written by AuditStoreWriter
+         * @throws std::runtime_error if the directory doesn't hold a store
+         */
+        explicit AuditStoreReader(const std::string& dir);
+        ~AuditStoreReader();
+
+        AuditStoreReader(const AuditStoreReader&) = delete;
+        AuditStoreReader& operator=(const AuditStoreReader&) = delete;
+
+        /**
+         * @brief Remap the store to see events written since construction or the last refresh
+         */
+        void refresh();
+
+        /**
+         * @brief Every event of one order, oldest first
+         */
+        std::vector<OrderEvent> getOrderHistory(OrderId order_id) const;
+
+        /**
+         * @brief Events of one account, oldest first
+         * @param account The account
+         * @param max_events Keep only the most recent max_events
+         */
+        std::vector<OrderEvent> getAccountHistory(AccountId account, size_t max_events = SIZE_MAX) const;
+
+        /**
+         * @brief Number of events visible to this reader
+         */
+        uint64_t getEventCount() const { return event_count_; }
+};
+
+} // namespace matching_engine
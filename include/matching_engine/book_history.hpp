@@ -0,0 +1,127 @@
+#pragma once
+
+#include <matching_engine/journal.hpp>
+#include <matching_engine/order_book.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief One checkpoint in the index: where its snapshot lives and what it covers
+ */
+struct CheckpointIndexEntry {
+    uint64_t sequence;       ///< Last journal sequence applied before the checkpoint
+    int64_t timestamp_ns;    ///< Journal timestamp of that command
+    uint64_t offset;         ///< Byte offset of the snapshot image in checkpoints.dat
+    uint64_t size;           ///< Size of the snapshot image
+};
+static_assert(sizeof(CheckpointIndexEntry) == 32, "CheckpointIndexEntry is an on-disk format");
+
+/**
+ * @brief How often the builder takes a checkpoint (whichever comes first)
+ */
+struct CheckpointOptions {
+    uint64_t interval_commands = 100000; ///< Journal records between checkpoints (0 = off)
+    int64_t interval_ns = 0;             ///< Journal time between checkpoints (0 = off)
+    size_t analytics_depth = 5;          ///< K for the books built during replay
+};
+
+/**
+ * @brief Result of a point-in-time query
+ */
+struct HistoricalBook {
+    std::unique_ptr<OrderBook> book;
+    uint64_t sequence = 0;              ///< Last journal sequence reflected in the book (0 = before the journal)
+    int64_t timestamp_ns = 0;           ///< Journal timestamp of that command (0 if none applied)
+    uint64_t checkpoint_sequence = 0;   ///< Checkpoint the query started from (0 = journal start)
+    uint64_t replayed_commands = 0;     ///< Journal records scanned after the checkpoint
+};
+
+/**
+ * @brief Point-in-time order book reconstruction from the command journal
+ *
+ * A history directory next to the journal holds:
+ * - checkpoints.dat: snapshot images of every book (see snapshot.hpp), appended periodically
+ * - checkpoints.idx: CheckpointIndexEntry per image, ordered by sequence and time
+ *
+ * A query binary-searches the index for the last checkpoint at or before the target, restores
+ * only the requested symbol's book from it and replays the journal records between the
+ * checkpoint and the target through OrderBook. Cost is bounded by the checkpoint interval
+ * rather than by how far back the target is.
+ */
+class BookHistory {
+    private:
+        std::string journal_path_;
+        std::string history_dir_;
+        std::vector<CheckpointIndexEntry> index_;
+        const char* checkpoints_ = nullptr; // mmap of checkpoints.dat
+        size_t checkpoints_size_ = 0;
+        size_t analytics_depth_;
+
+        void unmap();
+
+        /**
+         * @brief Restore from the checkpoint at index_[position - 1] (or an empty book if position is 0) and replay
+         */
+        HistoricalBook replay(const std::string& symbol, size_t position, uint64_t max_sequence, int64_t max_timestamp_ns) const;
+
+    public:
+        /**
+         * @brief Open a journal and its history directory for queries
+         * @param journal_path Command journal written by the engine
+         * @param history_dir Directory populated by buildCheckpoints (may be empty or missing)
+         * @param analytics_depth K for the returned books
+         * @throws std::runtime_error if the journal or checkpoint files are unreadable
+         */
+        BookHistory(const std::string& journal_path, const std::string& history_dir, size_t analytics_depth = 5);
+        ~BookHistory();
+
+        BookHistory(const BookHistory&) = delete;
+        BookHistory& operator=(const BookHistory&) = delete;
+
+        /**
+         * @brief Bring checkpoints.dat/.idx up to date with the journal
+         *
+         * Resumes from the newest existing checkpoint, so it can be rerun periodically as the
+         * journal grows.
+         * @param journal_path Command journal
+         * @param history_dir Output directory (created if missing)
+         * @param options Checkpoint spacing
+         * @return Number of checkpoints written by this call
+         */
+        static size_t buildCheckpoints(const std::string& journal_path, const std::string& history_dir,
+                                       const CheckpointOptions& options = CheckpointOptions{});
+
+        /**
+         * @brief Apply one journal command to a book, the same way the engine did
+         * @param book The symbol's book
+         * @param record The command
+         */
+        static void applyRecord(OrderBook& book, const JournalRecord& record);
+
+        /**
+         * @brief Re-read the index and remap checkpoints after buildCheckpoints has run again
+         */
+        void reload();
+
+        /**
+         * @brief Book as it was after the last command at or before a wall-clock time
+         * @param symbol The symbol to reconstruct
+         * @param timestamp_ns Nanoseconds since the Unix epoch
+         */
+        HistoricalBook bookAtTime(const std::string& symbol, int64_t timestamp_ns) const;
+
+        /**
+         * @brief Book as it was right after a journal sequence number was applied
+         * @param symbol The symbol to reconstruct
+         * @param sequence Journal sequence (values past the end mean "latest")
+         */
+        HistoricalBook bookAtSequence(const std::string& symbol, uint64_t sequence) const;
+
+        const std::vector<CheckpointIndexEntry>& getCheckpoints() const { return index_; }
+};
+
+} // namespace matching_engine
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "matching_engine/matching_engine.hpp"
+#include "matching_engine/order_event.hpp"
+#include "matching_engine/top_of_book.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Tuning for BookReplica
+ */
+struct ReplicaOptions {
+    int cpu = -1;    ///< Core to pin the replica thread to (-1 leaves it to the scheduler)
+};
+
+/**
+ * @brief Progress of a BookReplica
+ */
+struct ReplicaStatistics {
+    uint64_t applied_sequence = 0;     ///< Last engine event reflected in the replica
+    uint64_t published_sequence = 0;   ///< Last engine event handed to the replica
+    uint64_t events_applied = 0;
+    uint64_t commands_applied = 0;
+    uint64_t apply_passes = 0;         ///< Times the replica thread took the inbox (one exclusive lock each)
+};
+
+/**
+ * @brief Price-level copy of every book, kept by its own thread from the engine's event stream
+ *
+ * Full-depth readers (UIs, risk, surveillance) query the replica instead of the engine, so
+ * they never take engine_mutex_ or touch the matcher's book memory. The engine only appends
+ * each command's events to the replica's inbox (registerEventBatchCallback); the replica
+ * thread applies whole commands, so a query never sees half a command. Every answer carries
+ * the event sequence it reflects, and getLag() is the number of events still in the inbox.
+ * Best bid/ask are the exception: they are read lock-free from the primary's
+ * TopOfBookSnapshot and are therefore at least as fresh as the levels.
+ *
+ * The replica is seeded from MatchingEngine::exportSnapshot when constructed and follows
+ * the stream from there. It may be destroyed before the engine (it unregisters from the
+ * stream), not after it.
+ */
+class BookReplica {
+    private:
+        struct Level {
+            Quantity quantity = 0;
+            uint32_t orders = 0;
+        };
+
+        struct ReplicaOrder {
+            OrderSide side;
+            Price price;
+            Quantity remaining;
+            bool resting;    // counted in a level (false while its own command is still matching)
+        };
+
+        struct Book {
+            std::map<Price, Level, std::greater<Price>> bids;   // highest first
+            std::map<Price, Level> asks;                        // lowest first
+            std::unordered_map<OrderId, ReplicaOrder> orders;
+            size_t resting_orders = 0;
+            std::shared_ptr<const TopOfBookSnapshot> top;       // the primary's BBO
+        };
+
+        // Filled on the engine's dispatch under its lock
+        struct Inbox {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::vector<OrderEvent> events;
+            std::vector<size_t> command_ends;    // events[previous end, end) is one command
+            bool closed = false;
+            std::atomic<uint64_t> published{0};  // last sequence appended
+        };
+
+        MatchingEngine& engine_;
+        ReplicaOptions options_;
+        std::shared_ptr<Inbox> inbox_;
+        CallbackId callback_id_ = 0;   // our registerEventBatchCallback, dropped by the destructor
+
+        mutable std::shared_mutex state_mutex_;
+        std::map<std::string, Book> books_;
+        uint64_t seed_sequence_ = 0;                // events up to here are already in the seed
+        std::atomic<uint64_t> applied_sequence_{0};
+        std::atomic<uint64_t> events_applied_{0};
+        std::atomic<uint64_t> commands_applied_{0};
+        std::atomic<uint64_t> apply_passes_{0};
+
+        mutable std::mutex progress_mutex_;
+        mutable std::condition_variable progress_;
+
+        std::thread thread_;
+
+        void run();
+        Book& bookFor(const std::string& symbol);
+        void applyCommand(const OrderEvent* events, size_t count);
+        static void addToLevel(Book& book, OrderSide side, Price price, Quantity quantity);
+        static void takeFromLevel(Book& book, OrderSide side, Price price, Quantity quantity, bool last);
+        static void removeResting(Book& book, OrderId order_id);
+
+    public:
+        /**
+         * @brief Seed from the engine and start following its event stream
+         * @throws std::runtime_error if the thread can't be pinned to options.cpu
+         */
+        explicit BookReplica(MatchingEngine& engine, const ReplicaOptions& options = ReplicaOptions{});
+
+        /**
+         * @brief Stop the replica thread and detach from the stream
+         */
+        ~BookReplica();
+
+        BookReplica(const BookReplica&) = delete;
+        BookReplica& operator=(const BookReplica&) = delete;
+
+        /**
+         * @brief Market depth served from the replica (best bid/ask from the primary)
+         * @param symbol The symbol to query
+         * @param levels Price levels per side (SIZE_MAX for the full book)
+         * @param sequence If given, receives the event sequence the levels reflect
+         */
+        MarketDepth getMarketDepth(const std::string& symbol, size_t levels = 5, uint64_t* sequence = nullptr) const;
+
+        /**
+         * @brief Same text as MatchingEngine::getOrderBookState, from the replica
+         */
+        std::string getOrderBookState(const std::string& symbol, size_t max_levels = 5, uint64_t* sequence = nullptr) const;
+
+        std::vector<std::string> getSymbols() const;
+
+        /**
+         * @brief Last engine event sequence reflected in the replica
+         */
+        uint64_t getSequence() const { return applied_sequence_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Events the engine has published that the replica hasn't applied yet
+         */
+        uint64_t getLag() const;
+
+        /**
+         * @brief Wait until the replica reflects at least event sequence (e.g. one a client just caused)
+         * @return false on timeout
+         */
+        bool waitForSequence(uint64_t sequence, std::chrono::microseconds timeout) const;
+
+        ReplicaStatistics getStatistics() const;
+};
+
+} // namespace matching_engine
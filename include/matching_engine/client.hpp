@@ -28,6 +28,16 @@ public:
 
     // Order operations
     std::vector<Trade> submitOrder(const Order& order);
+
+    /**
+     * @brief Send a basket of new orders as one SUBMIT_ORDERS frame: one encode, one write
+     *
+     * The server applies the whole basket with one MatchingEngine::processCommands call.
+     * @return Number of orders sent (0 for an empty basket, which sends nothing)
+     * @throws std::runtime_error if not connected
+     */
+    size_t submitOrders(const Order* orders, size_t count);
+    size_t submitOrders(const std::vector<Order>& orders) { return submitOrders(orders.data(), orders.size()); }
     bool cancelOrder(OrderId order_id, const std::string& symbol);
     bool modifyOrder(OrderId order_id, const std::string& symbol, Price new_price, Quantity new_quantity);
 
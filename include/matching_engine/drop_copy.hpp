@@ -0,0 +1,202 @@
+#pragma once
+
+#include "matching_engine/types.hpp"
+#include "matching_engine/order_event.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Firm (clearing/back-office owner) a group of accounts belongs to
+ */
+using FirmId = uint32_t;
+
+/**
+ * @brief One execution as carried on the drop-copy feed
+ */
+struct DropCopyExecution {
+    uint64_t sequence = 0;          ///< Position in the firm's feed (gapless from 1)
+    uint64_t engine_sequence = 0;   ///< OrderEvent::sequence of the fill
+    int64_t timestamp_ns = 0;
+    OrderId order_id = 0;
+    TradeId trade_id = 0;
+    AccountId account = 0;
+    Price price = 0;
+    Quantity quantity = 0;
+    Quantity remaining_quantity = 0;
+    std::string symbol;
+    OrderSide side = OrderSide::BUY;
+};
+
+/**
+ * @brief Header of a decoded drop-copy packet
+ */
+struct DropCopyPacketHeader {
+    FirmId firm = 0;
+    uint64_t first_sequence = 0;    ///< Sequence of the first execution in the packet
+    uint64_t count = 0;
+};
+
+/**
+ * @brief Decode one drop-copy packet
+ *
+ * Packet layout (integers are LEB128 varints unless noted):
+ *   magic 0xDC (1 byte), version (1 byte), firm, first sequence, count, first engine sequence,
+ *   first timestamp
+ *   per execution:
+ *     flags (1 byte): bit 0 sell, bit 1 fully filled (no remaining quantity follows),
+ *                     bit 2 same symbol as the previous execution
+ *     engine sequence delta, zigzag timestamp delta (both from the previous execution),
+ *     order id, trade id, account, price (8 bytes, IEEE double), quantity,
+ *     [remaining quantity], [symbol length (1 byte) + symbol bytes]
+ * @param data Packet bytes
+ * @param size Packet size
+ * @param header Receives the packet header
+ * @param out Executions are appended here, with their feed sequence filled in
+ * @throws std::runtime_error if the packet is truncated or malformed
+ */
+void decodeDropCopyPacket(const char* data, size_t size, DropCopyPacketHeader& header, std::vector<DropCopyExecution>& out);
+
+/**
+ * @brief Tuning for DropCopyService
+ */
+struct DropCopyOptions {
+    size_t max_batch = 64;                            ///< Executions per packet
+    std::chrono::microseconds max_delay{200};         ///< Longest an execution waits for its batch to fill
+    size_t retained_packets = 4096;                   ///< Packets kept per firm for recovery
+};
+
+/**
+ * @brief Drop-copy execution feed for back-office and risk consumers
+ *
+ * Fed from the engine's event stream, which it only copies into a queue; a dedicated thread
+ * routes every fill to its account's firm, batches each firm's executions into compact
+ * binary packets (see decodeDropCopyPacket) and hands them to the firm's subscribers. Each
+ * firm's feed has its own gapless sequence, and recent packets are retained so a consumer
+ * that missed some can ask for everything from a sequence on. Typical wiring:
+ *
+ *   engine.registerEventCallback([&drop_copy](const OrderEvent& e) { drop_copy.enqueue(e); });
+ *
+ * Accounts that were never mapped to a firm are reported under firm 0.
+ */
+class DropCopyService {
+    public:
+        /**
+         * @brief Receives a firm's packets on the service thread, in sequence order
+         */
+        using PacketSink = std::function<void(FirmId firm, const std::string& packet)>;
+
+    private:
+        using Packet = std::shared_ptr<const std::string>;
+        using Sinks = std::shared_ptr<const std::vector<PacketSink>>;
+
+        struct Firm {
+            uint64_t next_sequence = 1;
+            std::vector<OrderEvent> pending;                   // executions not yet in a packet
+            std::chrono::steady_clock::time_point oldest;      // when the first pending one arrived
+            std::deque<std::pair<uint64_t, Packet>> retained;  // (first sequence, packet)
+            Sinks sinks;                                       // replaced, never modified, on subscribe
+        };
+
+        struct Delivery {
+            FirmId firm;
+            Packet packet;
+            Sinks sinks;
+        };
+
+        DropCopyOptions options_;
+
+        // Shared with the service thread
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable flushed_;
+        std::vector<OrderEvent> queue_;
+        uint64_t enqueued_ = 0;
+        uint64_t published_ = 0;       // executions in packets handed to sinks
+        bool flush_requested_ = false;
+        bool stopping_ = false;
+
+        // Firms, account mapping and retained packets (service thread writes, anyone reads)
+        mutable std::mutex firms_mutex_;
+        std::unordered_map<AccountId, FirmId> account_firms_;
+        std::unordered_map<FirmId, Firm> firms_;
+        uint64_t packets_ = 0;
+        uint64_t bytes_ = 0;
+
+        // Service thread only
+        std::vector<uint8_t> packet_;     // encode buffer
+        std::vector<Delivery> outbox_;    // packets made under firms_mutex_, delivered after it
+
+        std::thread thread_;
+
+        void run();
+        uint64_t route(const std::vector<OrderEvent>& events, bool everything); // returns executions published
+        uint64_t publish(FirmId firm_id, Firm& firm);
+        bool nextDeadline(std::chrono::steady_clock::time_point& deadline) const;
+
+    public:
+        explicit DropCopyService(const DropCopyOptions& options = DropCopyOptions{});
+
+        /**
+         * @brief Publish everything queued and stop the service thread
+         */
+        ~DropCopyService();
+
+        DropCopyService(const DropCopyService&) = delete;
+        DropCopyService& operator=(const DropCopyService&) = delete;
+
+        /**
+         * @brief Report an account's executions under a firm (takes effect for executions not yet routed)
+         */
+        void setFirm(AccountId account, FirmId firm);
+
+        /**
+         * @brief Add a consumer of a firm's feed
+         *
+         * Packets are delivered from the service thread; a slow sink delays every firm, so
+         * sinks should write to a socket or queue rather than do heavy work.
+         * @param firm The firm
+         * @param sink Called with each new packet
+         * @return The sequence the sink's first packet will start at, or later
+         */
+        uint64_t subscribe(FirmId firm, PacketSink sink);
+
+        /**
+         * @brief Queue an order event (thread safe; anything but fills is ignored)
+         */
+        void enqueue(const OrderEvent& event);
+
+        /**
+         * @brief Publish everything queued so far, without waiting for full batches, and wait for it
+         */
+        void flush();
+
+        /**
+         * @brief Retained packets holding a firm's executions from a sequence on
+         * @param firm The firm
+         * @param from_sequence First sequence the consumer is missing
+         * @param packets Receives the packets, oldest first (the first may start before from_sequence)
+         * @return false if from_sequence is older than anything retained
+         */
+        bool recover(FirmId firm, uint64_t from_sequence, std::vector<std::string>& packets) const;
+
+        /**
+         * @brief Sequence the firm's next execution will get
+         */
+        uint64_t getNextSequence(FirmId firm) const;
+
+        uint64_t getPacketCount() const;
+        uint64_t getByteCount() const;
+};
+
+} // namespace matching_engine
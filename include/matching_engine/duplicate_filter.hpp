@@ -0,0 +1,82 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Remembers the most recent client order ids of one session and flags resubmissions
+ *
+ * Ids are kept in two generations. New ids go into the current generation; once it holds
+ * `window` ids the older generation is wiped and reused as the current one, so between them
+ * the generations always cover at least the last `window` ids (and at most 2 x window).
+ * Each generation has:
+ * - a bloom filter (8 bits per id, 4 probes), so a fresh id is ruled out by a few bit tests
+ *   in a small array that stays in cache;
+ * - an exact open-addressing table of the ids themselves, only probed when the bloom filter
+ *   says "maybe", so bloom false positives never reject an order.
+ *
+ * Everything is sized at construction and generations are recycled rather than grown, so
+ * memory per session is fixed. INVALID_ORDER_ID is never remembered.
+ */
+class DuplicateOrderFilter {
+    private:
+        static constexpr size_t BLOOM_HASHES = 4;
+        static constexpr size_t BLOOM_BITS_PER_ID = 8; // ~2.4% false positives for a full generation
+
+        struct Generation {
+            std::vector<uint64_t> bloom;     // bit array
+            std::vector<OrderId> table;      // open addressing, INVALID_ORDER_ID = empty, load <= 0.5
+        };
+
+        size_t window_;                      // ids per generation (power of two)
+        size_t bloom_mask_;                  // bit index mask
+        size_t table_mask_;                  // slot index mask
+        Generation generations_[2];
+        size_t current_ = 0;                 // generation receiving new ids
+        size_t current_size_ = 0;            // ids in the current generation
+
+        static uint64_t mix(OrderId id) noexcept;
+        bool generationContains(const Generation& generation, OrderId id, uint64_t hash) const noexcept;
+
+    public:
+        /**
+         * @param window Number of most recent ids guaranteed to be remembered (rounded up to a power of two)
+         * @throws std::invalid_argument if window is 0
+         */
+        explicit DuplicateOrderFilter(size_t window);
+
+        /**
+         * @brief Check an id against the window and remember it if it is new
+         * @param id Client order id
+         * @return true if the id was already seen within the window (it is not inserted again)
+         */
+        bool checkAndInsert(OrderId id);
+
+        /**
+         * @brief Check an id against the window without remembering it
+         */
+        bool contains(OrderId id) const noexcept;
+
+        /**
+         * @brief Forget every id
+         */
+        void clear() noexcept;
+
+        size_t getWindow() const noexcept { return window_; }
+
+        /**
+         * @brief Heap bytes held by the filter (constant for its lifetime)
+         */
+        size_t getMemoryBytes() const noexcept;
+
+        /**
+         * @brief Heap blocks behind getMemoryBytes() (not counting the filter object itself)
+         */
+        size_t getAllocationCount() const noexcept;
+};
+
+} // namespace matching_engine
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "matching_engine/types.hpp"
+#include "matching_engine/order.hpp"
+#include "matching_engine/trade.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Kind of command travelling from a session to the matcher
+ */
+enum class CommandType : uint8_t {
+    NEW_ORDER = 0,
+    CANCEL = 1,
+    AMEND = 2
+};
+
+/**
+ * @brief One session command as queued for the matcher
+ *
+ * NEW_ORDER carries the order itself; CANCEL and AMEND name the order by id and symbol,
+ * AMEND with the replacement price and quantity.
+ */
+struct EngineCommand {
+    CommandType type = CommandType::NEW_ORDER;
+    SessionId session = 0;
+    OrderId order_id = 0;
+    std::string symbol;
+    Price price = 0;              ///< AMEND only
+    Quantity quantity = 0;        ///< AMEND only
+    std::optional<Order> order;   ///< NEW_ORDER only
+    bool annihilated = false;     ///< NEW_ORDER cancelled before it left the queue, and that CANCEL: nothing to do in the book
+    bool superseded = false;      ///< AMEND replaced by a later amend or cancel while queued: nothing to do in the book
+    int64_t enqueue_ns = 0;       ///< steady_clock nanoseconds when queued (for queueing latency)
+
+    static EngineCommand newOrder(const Order& order) {
+        EngineCommand command;
+        command.type = CommandType::NEW_ORDER;
+        command.session = order.getSession();
+        command.order_id = order.getId();
+        command.symbol = order.getSymbol();
+        command.order = order;
+        return command;
+    }
+
+    static EngineCommand cancel(SessionId session, OrderId order_id, const std::string& symbol) {
+        EngineCommand command;
+        command.type = CommandType::CANCEL;
+        command.session = session;
+        command.order_id = order_id;
+        command.symbol = symbol;
+        return command;
+    }
+
+    static EngineCommand amend(SessionId session, OrderId order_id, const std::string& symbol, Price price, Quantity quantity) {
+        EngineCommand command;
+        command.type = CommandType::AMEND;
+        command.session = session;
+        command.order_id = order_id;
+        command.symbol = symbol;
+        command.price = price;
+        command.quantity = quantity;
+        return command;
+    }
+};
+
+/**
+ * @brief What became of a command
+ */
+enum class CommandStatus : uint8_t {
+    ACCEPTED = 0,      ///< Applied to the book
+    REJECTED = 1,      ///< Refused (validation, duplicate id, risk, unknown symbol); see error
+    NOT_FOUND = 2,     ///< Cancel or amend for an order that isn't resting
+    ANNIHILATED = 3,   ///< New order and the cancel that met it in the queue; neither reached the book
+    SUPERSEDED = 4     ///< Amend replaced by a later amend or cancel of the same order before it left the queue
+};
+
+/**
+ * @brief Outcome of one command applied by MatchingEngine::processCommands
+ */
+struct CommandResult {
+    CommandType type = CommandType::NEW_ORDER;
+    CommandStatus status = CommandStatus::ACCEPTED;
+    SessionId session = 0;
+    OrderId order_id = 0;
+    std::vector<Trade> trades;    ///< Trades the command made (new orders and amends)
+    std::string error;            ///< REJECTED only
+    int64_t enqueue_ns = 0;       ///< Copied from the command
+};
+
+} // namespace matching_engine
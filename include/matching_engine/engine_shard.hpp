@@ -0,0 +1,213 @@
+#pragma once
+
+#include "matching_engine/matching_engine.hpp"
+#include "matching_engine/ingress_queue.hpp"
+#include "matching_engine/latency_histogram.hpp"
+#include "matching_engine/parent_order.hpp"
+#include "matching_engine/shard_scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace matching_engine {
+
+/**
+ * @brief Tuning for EngineShard
+ */
+struct ShardOptions {
+    size_t batch_size = 64;                         ///< Most commands applied per engine lock acquisition (initial limit if adaptive)
+    std::chrono::microseconds idle_wait{1000};      ///< Longest the matcher sleeps waiting for commands (also the parent order timer's resolution)
+    bool coalesce = true;                           ///< Fold superseded amends and annihilate in-queue cancels
+
+    // Adaptive batching: the batch limit moves between min and max batch size
+    bool adaptive_batching = false;                 ///< Let the matcher size its batches (batch_size is the starting point)
+    size_t min_batch_size = 1;
+    size_t max_batch_size = 4096;
+    std::chrono::microseconds latency_budget{100};  ///< Longest a batch may take to apply, i.e. the wait it adds to its first command
+};
+
+/**
+ * @brief Counters of an EngineShard
+ */
+struct ShardStatistics {
+    IngressStatistics ingress;
+    uint64_t batches = 0;                ///< processCommands calls
+    uint64_t commands_applied = 0;       ///< Commands processed (including annihilated and superseded ones)
+    size_t batch_limit = 0;              ///< Current largest batch the matcher drains
+    uint64_t batch_limit_raises = 0;     ///< Times the adaptive limit grew (backlog behind a batch)
+    uint64_t batch_limit_cuts = 0;       ///< Times it shrank (over budget, or idle)
+    size_t parent_orders = 0;            ///< Parent orders working
+    uint64_t child_orders = 0;           ///< Children released by parent orders
+    uint64_t background_slices = 0;      ///< Slices given to ShardScheduler tasks
+    uint64_t background_cpu_nanos = 0;   ///< Thread CPU time those slices used
+};
+
+/**
+ * @brief Distributions recorded by an EngineShard's matcher (thread safe to read)
+ */
+struct ShardLatency {
+    LatencyHistogram batch_size;     // commands per batch (a count, not nanoseconds)
+    LatencyHistogram batch_apply;    // processCommands time per batch
+    LatencyHistogram queue_wait;     // push -> batch drained, per command
+    LatencyHistogram result;         // push -> result reported, per command
+};
+
+/**
+ * @brief A matching thread fed by an IngressQueue
+ *
+ * Sessions push commands from any thread; the shard's thread drains them in batches and
+ * applies each batch with MatchingEngine::processCommands, then reports every result, in
+ * queue order, to the result callback (on the shard thread).
+ *
+ * With adaptive batching the drain limit follows the load: after each batch the matcher
+ * estimates the cost per command and caps the limit at what fits the latency budget; it
+ * doubles the limit while a backlog at least as large is waiting behind the batch (amortising
+ * the engine lock and wakeups over a burst) and halves it when the queue runs dry with the
+ * batch under half full, so a burst after a quiet period starts with small, quick batches.
+ *
+ * The shard also works TWAP / POV parent orders (ParentOrderScheduler): its timer runs
+ * after every batch and every idle wait, its trade hook sees every result, and the child
+ * orders they release are applied at once on the matcher thread and reported like any
+ * other result. Parent orders stop being worked when the shard stops; their resting
+ * children stay in the book.
+ *
+ * Other background work (snapshots, compaction, stats aggregation...) goes to the shard's
+ * ShardScheduler, which runs on the matcher thread after every batch and idle wait: the
+ * matcher sleeps no longer than the next periodic task is due, and tasks yield as soon as
+ * commands are queued, so a batch waits at most one slice for a task that is past its
+ * latency budget. Tasks still runnable when the shard stops are not run again.
+ */
+class EngineShard {
+    public:
+        using ResultCallback = std::function<void(const CommandResult&)>;
+        using ParentCallback = ParentOrderScheduler::StateCallback;
+        using TickCallback = std::function<void(bool stopping)>;
+
+    private:
+        MatchingEngine& engine_;
+        ShardOptions options_;
+        IngressQueue queue_;
+        ResultCallback on_result_;
+        TickCallback on_tick_;
+        std::thread thread_;
+        std::atomic<uint64_t> batches_{0};
+        std::atomic<uint64_t> commands_applied_{0};
+        std::atomic<size_t> batch_limit_;
+        std::atomic<uint64_t> batch_limit_raises_{0};
+        std::atomic<uint64_t> batch_limit_cuts_{0};
+        double nanos_per_command_ = 0.0;     // moving average of processCommands cost, matcher thread only
+        std::unique_ptr<ShardLatency> latency_; // histograms are large and must not move
+        ShardScheduler scheduler_;
+
+        // Parent orders: requests from any thread, worked by the matcher thread
+        struct ParentRequest {
+            ParentOrderSpec spec;
+            bool cancel = false;
+        };
+        std::mutex parent_mutex_;
+        std::vector<ParentRequest> parent_requests_;
+        std::atomic<bool> parent_requests_pending_{false};
+        ParentOrderScheduler parents_;
+        ParentCallback on_parent_;
+        std::atomic<size_t> parent_orders_{0};
+        std::atomic<uint64_t> child_orders_{0};
+
+        void run();
+        void adaptBatchLimit(size_t taken, uint64_t apply_nanos);
+        void reportResults(const std::vector<CommandResult>& results);
+        void workParentOrders(const std::vector<CommandResult>& results);
+        void tick(bool stopping);
+
+    public:
+        /**
+         * @param engine Engine the shard applies commands to (must outlive the shard)
+         * @param options Batch size, idle wait and coalescing
+         */
+        explicit EngineShard(MatchingEngine& engine, const ShardOptions& options = ShardOptions{});
+
+        /**
+         * @brief Stops the shard, applying everything still queued
+         */
+        ~EngineShard();
+
+        EngineShard(const EngineShard&) = delete;
+        EngineShard& operator=(const EngineShard&) = delete;
+
+        /**
+         * @brief Set the callback receiving each command's result (call before start())
+         */
+        void setResultCallback(ResultCallback callback) { on_result_ = std::move(callback); }
+
+        /**
+         * @brief Set the callback receiving parent order state changes (call before start())
+         */
+        void setParentCallback(ParentCallback callback) { on_parent_ = std::move(callback); }
+
+        /**
+         * @brief Set a callback run on the matcher thread after every batch and idle wait (call before start())
+         *
+         * Everything the shard applied so far has been reported when it runs. It runs once
+         * more with stopping = true just before the matcher thread exits.
+         */
+        void setTickCallback(TickCallback callback) { on_tick_ = std::move(callback); }
+
+        /**
+         * @brief Start the matching thread
+         */
+        void start();
+
+        /**
+         * @brief Refuse new commands, apply the ones queued and join the matching thread
+         */
+        void stop();
+
+        /**
+         * @brief Queue a command (thread safe)
+         * @return false once the shard is stopping
+         * @throws std::invalid_argument for a new order whose id is in the range kept for parent
+         *         order children (ParentOrderScheduler::DEFAULT_FIRST_CHILD_ID and up)
+         */
+        bool submit(EngineCommand command);
+
+        bool submitOrder(const Order& order) { return submit(EngineCommand::newOrder(order)); }
+        bool cancelOrder(SessionId session, OrderId order_id, const std::string& symbol) {
+            return submit(EngineCommand::cancel(session, order_id, symbol));
+        }
+        bool amendOrder(SessionId session, OrderId order_id, const std::string& symbol, Price price, Quantity quantity) {
+            return submit(EngineCommand::amend(session, order_id, symbol, price, quantity));
+        }
+
+        /**
+         * @brief Hand a TWAP / POV parent order to the matcher (thread safe)
+         *
+         * Picked up after the current batch or idle wait. Children are limit orders with ids
+         * from ParentOrderScheduler::DEFAULT_FIRST_CHILD_ID up; submit() refuses client orders there.
+         * @return false once the shard is stopping
+         * @throws std::invalid_argument if the spec is invalid
+         */
+        bool submitParentOrder(const ParentOrderSpec& spec);
+
+        /**
+         * @brief Cancel a parent order and its working children (thread safe)
+         * @return false once the shard is stopping
+         */
+        bool cancelParentOrder(OrderId parent_id);
+
+        /**
+         * @brief Background work run on the matcher thread between batches (add classes and tasks from any thread)
+         */
+        ShardScheduler& getScheduler() { return scheduler_; }
+
+        MatchingEngine& getEngine() { return engine_; }
+        ShardStatistics getStatistics() const;
+
+        /**
+         * @brief Batch size, apply time and per-command latency distributions
+         */
+        const ShardLatency& getLatency() const { return *latency_; }
+};
+
+} // namespace matching_engine
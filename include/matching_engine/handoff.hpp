@@ -0,0 +1,131 @@
+#pragma once
+
+#include "matching_engine/matching_engine.hpp"
+#include "matching_engine/server.hpp"
+#include "matching_engine/snapshot.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Control message of a handoff, sent with the descriptors over the Unix socket
+ *
+ * The descriptors follow in one SCM_RIGHTS message: the state region, then listener_count
+ * listening sockets, then session_count connections. The state region is a memfd holding
+ * the snapshot image (snapshot_size bytes) followed, per session, by a uint32_t length and
+ * the partial line already read from that connection.
+ */
+struct HandoffHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t listener_count;
+    uint32_t session_count;
+    uint32_t reserved;
+    uint64_t snapshot_size;
+    uint64_t region_size;
+    uint64_t event_sequence;    ///< Last OrderEvent sequence of the outgoing engine
+    int64_t frozen_at_ns;       ///< When intake stopped (CLOCK_REALTIME, Server::nowNanos())
+};
+
+static_assert(sizeof(HandoffHeader) == 56, "HandoffHeader is a wire format");
+
+/**
+ * @brief What the outgoing process reports once its successor has taken over
+ */
+struct HandoffReport {
+    bool accepted = false;      ///< The successor acknowledged; false means intake was resumed here
+    size_t books = 0;
+    size_t sessions = 0;
+    size_t region_bytes = 0;
+    uint64_t export_nanos = 0;  ///< Freeze to state region written
+    uint64_t send_nanos = 0;    ///< Freeze to descriptors sent
+};
+
+/**
+ * @brief Listen on a Unix socket for the process that will take over (replaces a stale socket file)
+ * @return Listening descriptor
+ * @throws std::runtime_error on failure
+ */
+int listenForSuccessor(const std::string& path);
+
+/**
+ * @brief Wait for the successor to connect
+ * @return Connected descriptor
+ * @throws std::runtime_error on failure
+ */
+int acceptSuccessor(int listener);
+
+/**
+ * @brief Connect to the running process to take over from it
+ * @return Connected descriptor
+ * @throws std::runtime_error on failure
+ */
+int connectToPredecessor(const std::string& path);
+
+/**
+ * @brief Hand the engine and its sockets to the successor on channel
+ *
+ * Stops intake (engine.stop()), exports the books into a shared memory region, sends the
+ * region, the listener and the sessions with SCM_RIGHTS and waits for the successor's
+ * acknowledgement. If the successor goes away instead, the engine is started again and
+ * the report says so; the sockets were never closed here, so service simply continues.
+ * The io_context driving the sockets must be stopped before the call.
+ * @param channel Connection from acceptSuccessor()
+ * @param engine The engine to hand over
+ * @param listener Listening socket (Server::getListenerHandle()), -1 for none
+ * @param sessions Open connections (Server::getSessionHandles())
+ */
+HandoffReport handOver(int channel, MatchingEngine& engine, int listener, const std::vector<SessionHandle>& sessions);
+
+/**
+ * @brief The successor's side of a handoff: the mapped state and the inherited sockets
+ */
+class HandoffState {
+    private:
+        HandoffHeader header_;
+        const char* region_ = nullptr;
+        size_t region_size_ = 0;
+        std::vector<int> listeners_;
+        std::vector<SessionHandle> sessions_;
+
+    public:
+        /**
+         * @brief Receive a handoff on channel and map its state region
+         * @throws std::runtime_error if the message is malformed or the region can't be mapped
+         */
+        explicit HandoffState(int channel);
+        ~HandoffState();
+
+        HandoffState(const HandoffState&) = delete;
+        HandoffState& operator=(const HandoffState&) = delete;
+
+        /**
+         * @brief The books, read in place from the shared region (valid while this object lives)
+         */
+        SnapshotView getSnapshot() const { return SnapshotView(region_, header_.snapshot_size); }
+
+        uint64_t getEventSequence() const { return header_.event_sequence; }
+        int64_t getFrozenAt() const { return header_.frozen_at_ns; }
+
+        /**
+         * @brief Inherited descriptors; ownership passes to whoever adopts them
+         */
+        const std::vector<int>& getListeners() const { return listeners_; }
+        const std::vector<SessionHandle>& getSessions() const { return sessions_; }
+
+        /**
+         * @brief Load the books into engine (see MatchingEngine::importSnapshot) and start it
+         * @return Number of books restored
+         */
+        size_t resume(MatchingEngine& engine) const;
+};
+
+/**
+ * @brief Tell the outgoing process the handoff succeeded; it may exit
+ * @throws std::runtime_error if the predecessor can't be told
+ */
+void acknowledgeHandoff(int channel);
+
+} // namespace matching_engine
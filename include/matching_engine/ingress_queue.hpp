@@ -0,0 +1,125 @@
+#pragma once
+
+#include "matching_engine/engine_command.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Counters of an IngressQueue
+ */
+struct IngressStatistics {
+    uint64_t commands_pushed = 0;       ///< Commands handed to push()
+    uint64_t commands_drained = 0;      ///< Commands handed to the matcher
+    uint64_t amends_coalesced = 0;      ///< Queued amends superseded by a later amend or cancel
+    uint64_t orders_annihilated = 0;    ///< New orders cancelled before they left the queue
+    size_t depth = 0;                   ///< Commands queued right now
+};
+
+/**
+ * @brief Command queue between sessions and the matcher that folds superseded commands
+ *
+ * Any number of threads push; one matcher drains. While commands wait, the queue keeps
+ * per-order bookkeeping (per session: only a session's own commands are folded) so that:
+ * - an amend supersedes an amend for the same order that is still queued (the new one is
+ *   queued at the back), so a burst of amends costs one replace;
+ * - a cancel supersedes the order's queued amend, and if the order's NEW_ORDER is itself
+ *   still queued (and is the only one queued for that id), annihilates the pair.
+ * Folded commands are not dropped but marked (superseded / annihilated) and still reach the
+ * matcher, which acknowledges each of them (SUPERSEDED / ANNIHILATED) without touching the
+ * OrderBook. The queue can't see the book, so the matcher makes the final call on an
+ * annihilated pair: if the id turns out to be resting already, the new order is rejected as a
+ * duplicate and the cancel applied as usual. Commands are never reordered, so every session's
+ * commands reach the matcher, and its acknowledgements come back, in the order they were pushed.
+ */
+class IngressQueue {
+    private:
+        static constexpr uint64_t NONE = UINT64_MAX;
+
+        // Queued commands of one order, as absolute queue positions
+        struct Pending {
+            uint64_t new_order = NONE;
+            uint64_t amend = NONE;
+            bool repeated = false;   // more than one NEW_ORDER queued for the id: a cancel annihilates none of them
+        };
+
+        // Client order ids are only unique within a session, so one session never folds another's commands
+        struct OrderKey {
+            SessionId session;
+            OrderId order_id;
+            std::string symbol;
+            bool operator==(const OrderKey& other) const {
+                return session == other.session && order_id == other.order_id && symbol == other.symbol;
+            }
+        };
+
+        struct OrderKeyHash {
+            size_t operator()(const OrderKey& key) const {
+                return std::hash<OrderId>()(key.order_id) ^ (std::hash<std::string>()(key.symbol) << 1) ^
+                       (std::hash<SessionId>()(key.session) << 2);
+            }
+        };
+
+        bool coalesce_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<EngineCommand> entries_;
+        uint64_t head_position_ = 0;        // absolute position of entries_.front()
+        std::atomic<size_t> size_hint_{0};  // copy of entries_.size() for hasPending(), stored under the lock
+        std::unordered_map<OrderKey, Pending, OrderKeyHash> pending_;
+        IngressStatistics stats_;
+        bool closed_ = false;
+
+        EngineCommand& at(uint64_t position) { return entries_[position - head_position_]; }
+        void forget(const EngineCommand& command, uint64_t position);
+
+    public:
+        /**
+         * @param coalesce Fold superseded amends and annihilate cancelled new orders (false = plain FIFO)
+         */
+        explicit IngressQueue(bool coalesce = true) : coalesce_(coalesce) {}
+
+        /**
+         * @brief Queue a command (thread safe)
+         * @return false if the queue has been closed
+         */
+        bool push(EngineCommand command);
+
+        /**
+         * @brief Move up to max_commands commands to out, in queue order
+         * @param out Commands are appended here
+         * @param max_commands Largest batch to take
+         * @param timeout How long to wait for a first command if the queue is empty
+         * @return Number of commands taken (0 on timeout or once closed and empty)
+         */
+        size_t drain(std::vector<EngineCommand>& out, size_t max_commands, std::chrono::microseconds timeout);
+
+        /**
+         * @brief Refuse further pushes and wake a waiting drain()
+         */
+        void close();
+
+        bool isClosed() const;
+
+        /**
+         * @brief Commands currently queued
+         */
+        size_t depth() const;
+
+        /**
+         * @brief Lock-free check for queued commands, cheap enough to poll between small steps
+         */
+        bool hasPending() const { return size_hint_.load(std::memory_order_relaxed) > 0; }
+
+        IngressStatistics getStatistics() const;
+};
+
+} // namespace matching_engine
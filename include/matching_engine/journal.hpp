@@ -0,0 +1,315 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Commands recorded in the journal
+ */
+enum class JournalCommand : uint8_t {
+    NEW_ORDER = 1,
+    CANCEL_ORDER = 2,
+    MODIFY_ORDER = 3
+};
+
+/**
+ * @brief One fixed-size journal entry, written in the order the engine applied the commands
+ *
+ * Sequences start at 1 and have no gaps, so record N lives at a fixed offset in the file.
+ * Timestamps are wall-clock nanoseconds since the Unix epoch. Trailing records with
+ * sequence 0 are block padding left by direct I/O and are not part of the journal.
+ */
+struct JournalRecord {
+    uint64_t sequence = 0;
+    int64_t timestamp_ns = 0;
+    OrderId order_id = 0;
+    Price price = 0;          ///< Limit price (new/modify), 0 for market orders and cancels
+    Quantity quantity = 0;    ///< Order quantity (new/modify)
+    AccountId account = 0;
+    char symbol[8] = {};      ///< Not null-terminated when the symbol is 8 characters
+    JournalCommand command = JournalCommand::NEW_ORDER;
+    OrderSide side = OrderSide::BUY;
+    OrderType order_type = OrderType::LIMIT;
+    uint8_t reserved[5] = {};
+
+    std::string getSymbol() const;
+    void setSymbol(const std::string& value);
+};
+static_assert(sizeof(JournalRecord) == 64, "JournalRecord is an on-disk format");
+
+/**
+ * @brief Current wall-clock time in nanoseconds since the Unix epoch
+ */
+int64_t wallClockNanos();
+
+/**
+ * @brief Where journal bytes go
+ *
+ * write() appends; sync() returns once everything written so far is durable. syncAsync()
+ * asks for the same without waiting and calls on_durable once it holds; backends without
+ * a commit thread simply sync first.
+ */
+class JournalStorage {
+    public:
+        virtual ~JournalStorage() = default;
+        virtual void write(const void* data, size_t size) = 0;
+        virtual void sync() = 0;
+        virtual void syncAsync(std::function<void()> on_durable) {
+            sync();
+            on_durable();
+        }
+};
+
+/**
+ * @brief Plain file backend: write(2) to an O_APPEND file, fdatasync(2) on sync()
+ */
+class FileJournalStorage : public JournalStorage {
+    private:
+        int fd_;
+
+    public:
+        /**
+         * @param path Journal file, created if missing
+         * @throws std::runtime_error if the file can't be opened
+         */
+        explicit FileJournalStorage(const std::string& path);
+        ~FileJournalStorage() override;
+
+        FileJournalStorage(const FileJournalStorage&) = delete;
+        FileJournalStorage& operator=(const FileJournalStorage&) = delete;
+
+        void write(const void* data, size_t size) override;
+        void sync() override;
+};
+
+/**
+ * @brief Tuning for UringJournalStorage
+ */
+struct UringJournalOptions {
+    bool direct = true;                          ///< Open with O_DIRECT (falls back to the page cache where unsupported)
+    size_t buffer_bytes = 1 << 20;               ///< Staging buffer; write() waits while a full one is being committed
+    std::chrono::microseconds group_window{0};   ///< How long a group waits for more commits after its first (0: only while the previous group is in flight)
+    size_t group_bytes = 256 << 10;              ///< Commit a group early once it holds this many bytes
+};
+
+/**
+ * @brief Counters of a UringJournalStorage
+ */
+struct UringJournalStatistics {
+    uint64_t groups = 0;          ///< Write + fdatasync pairs committed
+    uint64_t commits = 0;         ///< sync() / syncAsync() requests acknowledged
+    uint64_t enters = 0;          ///< io_uring_enter calls (one per group)
+    uint64_t bytes = 0;           ///< Journal bytes made durable
+    uint64_t device_bytes = 0;    ///< Bytes submitted, with block padding and rewritten tail blocks
+    uint64_t buffer_waits = 0;    ///< Times write() found the staging buffer full
+};
+
+/**
+ * @brief Group-committing file backend: aligned O_DIRECT writes and fdatasync through io_uring
+ *
+ * write() only copies into an aligned staging buffer. A commit thread takes everything
+ * staged as one group, submits its write linked to an fdatasync with a single
+ * io_uring_enter (which also waits for both), then releases the group's syncAsync()
+ * callbacks. Commits arriving while a group is in flight form the next one, so the cost of
+ * a flush is shared by every command waiting on it; group_window lets a group wait a
+ * little longer for company. Direct I/O writes whole blocks: the block holding the end of
+ * the journal is padded with zeros (sequence 0 records, which readers ignore), rewritten by
+ * the next group and cut off when the storage is closed.
+ *
+ * Uses the raw io_uring system calls (Linux 5.6+). A failed write or sync is fatal: its
+ * group is never acknowledged and every later call throws.
+ */
+class UringJournalStorage : public JournalStorage {
+    private:
+        struct Ring;
+
+        int fd_;
+        UringJournalOptions options_;
+        bool direct_;
+        std::unique_ptr<Ring> ring_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;        // commit thread: a group is ready or stopping
+        std::condition_variable progress_;    // writers and sync(): a group finished
+        std::unique_ptr<char, void (*)(void*)> fill_;     // staging, starts at file offset fill_offset_
+        std::unique_ptr<char, void (*)(void*)> flight_;   // group being written
+        size_t buffer_bytes_;
+        size_t fill_size_ = 0;
+        uint64_t fill_offset_ = 0;
+        uint64_t written_ = 0;                // journal length including staged bytes
+        uint64_t durable_ = 0;                // journal length known durable
+        uint64_t opened_length_ = 0;          // journal length when opened
+        std::vector<std::function<void()>> acks_;   // syncAsync callbacks of the open group
+        bool group_open_ = false;
+        std::chrono::steady_clock::time_point group_opened_;
+        bool commit_now_ = false;
+        bool stopping_ = false;
+        std::string error_;
+        std::thread committer_;
+
+        std::atomic<uint64_t> groups_{0};
+        std::atomic<uint64_t> commits_{0};
+        std::atomic<uint64_t> enters_{0};
+        std::atomic<uint64_t> device_bytes_{0};
+        std::atomic<uint64_t> buffer_waits_{0};
+
+        void run();
+        bool groupReady() const;
+        void writeGroup(size_t size, uint64_t offset);
+        void throwIfFailed() const;
+
+    public:
+        /**
+         * @param path Journal file, created if missing and appended to otherwise
+         * @throws std::runtime_error if the file can't be opened or io_uring is unavailable
+         */
+        explicit UringJournalStorage(const std::string& path, const UringJournalOptions& options = UringJournalOptions{});
+
+        /**
+         * @brief Commits what is staged, stops the commit thread and trims the block padding
+         */
+        ~UringJournalStorage() override;
+
+        UringJournalStorage(const UringJournalStorage&) = delete;
+        UringJournalStorage& operator=(const UringJournalStorage&) = delete;
+
+        void write(const void* data, size_t size) override;
+
+        /**
+         * @brief Commit everything written so far now (not waiting for the group window) and wait for it
+         */
+        void sync() override;
+
+        /**
+         * @brief Join the open group; on_durable runs on the commit thread once the group is durable
+         */
+        void syncAsync(std::function<void()> on_durable) override;
+
+        bool isDirect() const { return direct_; }
+        UringJournalStatistics getStatistics() const;
+};
+
+/**
+ * @brief Appends command records to a journal through a JournalStorage backend
+ *
+ * Records are buffered and handed to the backend when the buffer fills, on flush() and on
+ * commit(); commit() additionally waits for durability. Not thread safe: the engine calls it
+ * under its exclusive lock.
+ */
+class JournalWriter {
+    private:
+        std::unique_ptr<JournalStorage> storage_;
+        std::vector<JournalRecord> buffer_;
+        size_t buffer_capacity_;
+        uint64_t next_sequence_;
+
+    public:
+        /**
+         * @param storage Backend to write to
+         * @param next_sequence Sequence given to the first appended record
+         * @param buffer_capacity Records buffered before they are written to the backend
+         */
+        JournalWriter(std::unique_ptr<JournalStorage> storage, uint64_t next_sequence = 1, size_t buffer_capacity = 256);
+        ~JournalWriter();
+
+        using StorageFactory = std::function<std::unique_ptr<JournalStorage>(const std::string& path)>;
+
+        /**
+         * @brief Open (or create) a journal file with the plain file backend
+         *
+         * A new file gets a header; an existing one is validated and appended to, continuing
+         * its sequence numbers.
+         * @param path Journal file path
+         * @param make_storage Backend to open the file with (FileJournalStorage if empty)
+         * @return Writer positioned at the end of the journal
+         * @throws std::runtime_error if the file exists but is not a journal
+         */
+        static std::shared_ptr<JournalWriter> open(const std::string& path, const StorageFactory& make_storage = nullptr);
+
+        /**
+         * @brief Append a record, assigning its sequence number
+         * @param record The command (sequence is overwritten)
+         * @return The assigned sequence number
+         */
+        uint64_t append(JournalRecord record);
+
+        /**
+         * @brief Hand buffered records to the backend without waiting for durability
+         */
+        void flush();
+
+        /**
+         * @brief Flush and wait until everything appended so far is durable
+         */
+        void commit();
+
+        /**
+         * @brief Flush and ask for durability without waiting
+         *
+         * on_durable receives the last sequence appended so far once it is durable: right
+         * away with the plain file backend, on the commit thread with UringJournalStorage.
+         */
+        void commitAsync(std::function<void(uint64_t)> on_durable);
+
+        /**
+         * @brief Sequence number of the last appended record (0 if none)
+         */
+        uint64_t getLastSequence() const { return next_sequence_ - 1; }
+};
+
+/**
+ * @brief Random-access reader over a journal file
+ */
+class JournalReader {
+    private:
+        int fd_;
+        uint64_t record_count_;
+
+    public:
+        /**
+         * @param path Journal file path
+         * @throws std::runtime_error if the file is missing or not a journal
+         */
+        explicit JournalReader(const std::string& path);
+        ~JournalReader();
+
+        JournalReader(const JournalReader&) = delete;
+        JournalReader& operator=(const JournalReader&) = delete;
+
+        /**
+         * @brief Number of complete records in the file (as of construction or refresh())
+         */
+        uint64_t getRecordCount() const { return record_count_; }
+
+        /**
+         * @brief Re-read the file size, picking up records appended since
+         */
+        void refresh();
+
+        /**
+         * @brief Read consecutive records starting at a sequence number
+         * @param first_sequence Sequence of the first record to read (1-based)
+         * @param out Destination buffer
+         * @param max_records Capacity of out
+         * @return Number of records read (0 past the end)
+         */
+        size_t read(uint64_t first_sequence, JournalRecord* out, size_t max_records) const;
+};
+
+/**
+ * @brief Size of the journal file header preceding the first record
+ */
+constexpr size_t JOURNAL_HEADER_SIZE = 16;
+
+} // namespace matching_engine
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace matching_engine {
+
+/**
+ * @brief Fixed-size log-linear histogram of nanosecond latencies, safe to record from any thread
+ *
+ * Values are bucketed by power of two, each power split into 16 linear sub-buckets, so any
+ * recorded value is reported within ~6% (values below 16 ns are exact). Recording is one
+ * relaxed atomic increment; no allocation, no locks.
+ */
+class LatencyHistogram {
+    private:
+        static constexpr unsigned SUB_BUCKET_BITS = 4;
+        static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+        static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+        std::atomic<uint64_t> total_{0};
+        std::atomic<uint64_t> max_{0};
+
+        static size_t bucketOf(uint64_t value) noexcept {
+            if (value < SUB_BUCKETS) {
+                return static_cast<size_t>(value);
+            }
+            unsigned magnitude = 63 - static_cast<unsigned>(__builtin_clzll(value)); // >= SUB_BUCKET_BITS
+            unsigned shift = magnitude - SUB_BUCKET_BITS;
+            size_t sub = static_cast<size_t>(value >> shift) - SUB_BUCKETS; // top bits below the leading one
+            return (shift + 1) * SUB_BUCKETS + sub;
+        }
+
+        // Largest value that lands in a bucket (what percentiles report)
+        static uint64_t bucketUpperBound(size_t bucket) noexcept {
+            if (bucket < SUB_BUCKETS) {
+                return bucket;
+            }
+            unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1;
+            uint64_t sub = bucket % SUB_BUCKETS + SUB_BUCKETS;
+            return ((sub + 1) << shift) - 1;
+        }
+
+    public:
+        /**
+         * @brief Record one latency
+         * @param nanos Latency in nanoseconds
+         */
+        void record(uint64_t nanos) noexcept {
+            counts_[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+            total_.fetch_add(1, std::memory_order_relaxed);
+            uint64_t seen = max_.load(std::memory_order_relaxed);
+            while (nanos > seen && !max_.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+            }
+        }
+
+        uint64_t count() const noexcept { return total_.load(std::memory_order_relaxed); }
+        uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Get a percentile of the recorded latencies
+         * @param p Percentile in [0, 100]
+         * @return Upper bound of the bucket holding that percentile, in nanoseconds (0 if empty)
+         */
+        uint64_t percentile(double p) const noexcept {
+            uint64_t total = count();
+            if (total == 0) return 0;
+            uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total - 1) + 0.5) + 1;
+            uint64_t seen = 0;
+            for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+                seen += counts_[bucket].load(std::memory_order_relaxed);
+                if (seen >= rank) {
+                    uint64_t bound = bucketUpperBound(bucket);
+                    return bound < max() ? bound : max();
+                }
+            }
+            return max();
+        }
+
+        /**
+         * @brief Clear all counts (not atomic with respect to concurrent record() calls)
+         */
+        void reset() noexcept {
+            for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+            total_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+};
+
+} // namespace matching_engine
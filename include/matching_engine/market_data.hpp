@@ -0,0 +1,147 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Dense numeric symbol handle used on the market-data wire (assigned by the publisher)
+ */
+using SymbolId = uint32_t;
+
+/**
+ * @brief One price level change: the level's total quantity after the change (0 = level gone)
+ */
+struct MarketDataUpdate {
+    uint64_t sequence = 0;   ///< Feed-wide update sequence, consecutive within and across packets
+    SymbolId symbol_id = 0;
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;
+    Quantity quantity = 0;
+
+    bool operator==(const MarketDataUpdate& other) const {
+        return sequence == other.sequence && symbol_id == other.symbol_id && side == other.side &&
+               price == other.price && quantity == other.quantity;
+    }
+};
+
+/**
+ * @brief Fixed-layout wire form of MarketDataUpdate: every field explicit, 32 bytes per update
+ *
+ * The baseline the compact encoding is measured against; trivially (de)serialized with memcpy.
+ */
+struct FixedMarketDataUpdate {
+    uint64_t sequence;
+    SymbolId symbol_id;
+    OrderSide side;
+    uint8_t reserved[3];
+    Price price;
+    Quantity quantity;
+};
+static_assert(sizeof(FixedMarketDataUpdate) == 32, "FixedMarketDataUpdate is a wire format");
+
+/**
+ * @brief Append updates to a packet in the fixed layout
+ * @param updates Updates to encode
+ * @param count Number of updates
+ * @param out Packet buffer; bytes are appended
+ */
+void encodeFixedUpdates(const MarketDataUpdate* updates, size_t count, std::string& out);
+
+/**
+ * @brief Decode a fixed-layout packet
+ * @param data Packet bytes
+ * @param size Packet size
+ * @param out Decoded updates are appended
+ * @return Number of updates decoded
+ * @throws std::runtime_error if size is not a whole number of updates
+ */
+size_t decodeFixedUpdates(const void* data, size_t size, std::vector<MarketDataUpdate>& out);
+
+/**
+ * @brief Stateful compact encoder for market-data packets
+ *
+ * Packet layout:
+ *
+ *   flags (1 byte, bit 0 = references reset), base sequence (varint), update count (varint)
+ *   per update:
+ *     control byte: bit 0 side, bit 1 symbol repeated from the previous update, bit 2 level
+ *                   removed (no quantity follows), bits 3-7 zigzag price delta 0..30 inline,
+ *                   31 = delta follows as a varint
+ *     [symbol id varint] [price delta varint] [quantity varint]
+ *
+ * Sequences are implicit (base + position in the packet). Prices are sent as whole ticks
+ * relative to a per-symbol reference: the last price sent for that symbol, so quotes that
+ * move a few ticks cost a single control byte plus the quantity. References live for the
+ * life of the stream; reset() makes the next packet start from zero references so a
+ * subscriber that joins (or recovers from a gap) can sync on it.
+ */
+class MarketDataEncoder {
+    private:
+        double ticks_per_unit_;
+        std::vector<int64_t> references_;   // last price in ticks, indexed by symbol id
+        std::vector<int64_t> ticks_;        // the packet's prices in ticks, from the validation pass
+        uint64_t next_sequence_ = 0;        // 0 until the first packet
+        bool reset_pending_ = true;
+
+    public:
+        /**
+         * @param tick_size Price increment all prices are multiples of
+         * @throws std::invalid_argument if tick_size is not positive
+         */
+        explicit MarketDataEncoder(Price tick_size = 0.01);
+
+        /**
+         * @brief Append one packet holding the given updates
+         * @param updates Updates with consecutive sequences, continuing the previous packet
+         * @param count Number of updates
+         * @param out Packet buffer; bytes are appended
+         * @return Bytes appended
+         * @throws std::invalid_argument if sequences are not consecutive or a price is off-tick
+         */
+        size_t encodePacket(const MarketDataUpdate* updates, size_t count, std::string& out);
+
+        /**
+         * @brief Drop all references; the next packet is self-contained
+         */
+        void reset();
+};
+
+/**
+ * @brief Decoder matching MarketDataEncoder, one per subscribed stream
+ *
+ * Packets before the first reset packet are skipped (nothing to take deltas from).
+ */
+class MarketDataDecoder {
+    private:
+        double ticks_per_unit_;
+        std::vector<int64_t> references_;
+        uint64_t next_sequence_ = 0;
+        bool synced_ = false;
+
+    public:
+        /**
+         * @param tick_size Must match the encoder's
+         */
+        explicit MarketDataDecoder(Price tick_size = 0.01);
+
+        /**
+         * @brief Decode one packet
+         * @param data Packet bytes
+         * @param size Packet size
+         * @param out Decoded updates are appended
+         * @return Number of updates decoded (0 for packets skipped before the first reset)
+         * @throws std::runtime_error on a malformed packet or a sequence gap; the decoder then
+         *         needs a reset packet before it decodes again
+         */
+        size_t decodePacket(const void* data, size_t size, std::vector<MarketDataUpdate>& out);
+
+        bool isSynced() const { return synced_; }
+        uint64_t getNextSequence() const { return next_sequence_; }
+};
+
+} // namespace matching_engine
@@ -4,6 +4,13 @@
 #include "order.hpp"
 #include "order_book.hpp"
 #include "matching_engine/trade.hpp"
+#include "matching_engine/memory_accounting.hpp"
+#include "matching_engine/journal.hpp"
+#include "matching_engine/duplicate_filter.hpp"
+#include "matching_engine/risk_budget.hpp"
+#include "matching_engine/engine_command.hpp"
+#include "matching_engine/snapshot.hpp"
+#include "matching_engine/reference_data.hpp"
 #include <unordered_map> //for the order books
 #include <memory> //for the order books
 #include <vector> //for the trades
@@ -11,8 +18,10 @@
 #include <atomic> //for the statistics
 #include <chrono> //for stats
 #include <shared_mutex> 
+#include <mutex> 
 #include <optional> 
 #include <string> 
+#include <cstring> //for strnlen
 
 namespace matching_engine {
 
@@ -35,11 +44,18 @@ struct EngineConfig { //values are fixed for testing purposes
     // Performance settings
     bool enable_threading = true; //engine will use threads to process the orders
     size_t max_symbols = 1000;
+    size_t analytics_depth = 5; //levels per side (K) behind the imbalance / depth-weighted mid signals
     
     // Validation settings
     bool strict_validation = true; //engine will not accept orders that do not meet the risk limits
     bool enable_logging = true; //enable logging means that the engine will log the orders and trades to the console
     
+    // Duplicate detection
+    size_t duplicate_order_window = 4096; //most recent client order ids remembered per session (0 disables the per-session check)
+    
+    // Journal settings
+    bool journal_sync_each_command = false; //wait for the command journal to be durable before returning from each command
+    
     // Timeout settings
     std::chrono::milliseconds order_timeout = std::chrono::milliseconds(5000);
 };
@@ -57,6 +73,16 @@ struct EngineStatistics { //values are fixed for testing purposes
     double trades_per_second = 0.0;
     std::chrono::milliseconds uptime = std::chrono::milliseconds(0);
     std::chrono::high_resolution_clock::time_point start_time;
+
+    // engine_mutex_ contention (only acquisitions that had to wait are counted)
+    uint64_t exclusive_lock_contentions = 0;
+    uint64_t shared_lock_contentions = 0;
+    uint64_t exclusive_lock_wait_nanoseconds = 0;
+    uint64_t shared_lock_wait_nanoseconds = 0;
+
+    uint64_t duplicate_orders_rejected = 0; // resubmitted order ids refused by submitOrder
+    uint64_t risk_rejections = 0;           // orders and amends refused by the account risk budget
+    uint64_t listed_symbols = 0;            // symbols loaded from reference data, with a book yet or not
 };
 
 /**
@@ -74,6 +100,70 @@ struct MarketDepth {
     std::chrono::high_resolution_clock::time_point timestamp;
 };
 
+/**
+ * @brief BBO and top-K summary of one symbol inside a MarketSnapshot
+ */
+struct SymbolSnapshot {
+    char symbol[8];                ///< Zero padded, not null-terminated when 8 characters
+    Price best_bid;                ///< 0 when bid_levels == 0
+    Price best_ask;                ///< 0 when ask_levels == 0
+    Quantity best_bid_quantity;
+    Quantity best_ask_quantity;
+    uint64_t total_orders;
+    uint32_t bid_levels;           ///< Levels filled in getBids(), at most the snapshot depth
+    uint32_t ask_levels;           ///< Levels filled in getAsks(), at most the snapshot depth
+    uint64_t found;                ///< 0 if the requested symbol has no book (everything else is zero)
+
+    std::string getSymbol() const { return std::string(symbol, strnlen(symbol, sizeof(symbol))); }
+};
+
+/**
+ * @brief Caller-owned buffer for MatchingEngine::getMarketSnapshot
+ *
+ * One contiguous allocation of fixed-stride records (SymbolSnapshot followed by depth bid
+ * levels and depth ask levels). Reusing a buffer across calls means no allocation once it
+ * has grown to the universe size.
+ */
+class MarketSnapshot {
+    private:
+        friend class MatchingEngine;
+
+        size_t depth_;
+        size_t stride_words_;                 // record size in uint64_t words
+        size_t count_ = 0;
+        std::vector<uint64_t> storage_;       // uint64_t keeps every record 8-byte aligned
+        std::vector<std::pair<const std::string*, const OrderBook*>> books_; // scratch for whole-universe fills
+
+        void resize(size_t count);
+        SymbolSnapshot* record(size_t index) { return reinterpret_cast<SymbolSnapshot*>(storage_.data() + index * stride_words_); }
+        DepthLevel* levels(size_t index) { return reinterpret_cast<DepthLevel*>(record(index) + 1); }
+
+    public:
+        /**
+         * @param depth Levels per side to capture for each symbol
+         */
+        explicit MarketSnapshot(size_t depth = 5);
+
+        size_t size() const { return count_; }
+        size_t getDepth() const { return depth_; }
+
+        const SymbolSnapshot& operator[](size_t index) const {
+            return *reinterpret_cast<const SymbolSnapshot*>(storage_.data() + index * stride_words_);
+        }
+
+        /**
+         * @brief Bid levels of record index, best first ((*this)[index].bid_levels of them)
+         */
+        const DepthLevel* getBids(size_t index) const {
+            return reinterpret_cast<const DepthLevel*>(&(*this)[index] + 1);
+        }
+
+        /**
+         * @brief Ask levels of record index, best first ((*this)[index].ask_levels of them)
+         */
+        const DepthLevel* getAsks(size_t index) const { return getBids(index) + depth_; }
+};
+
 
 
 /**
@@ -98,18 +188,38 @@ private:
     // Core Data Members
     // =============================================================================
     
+    // Heap used by the symbol directory itself (books report their own usage)
+    MemoryAccountant memory_;
+    
     // Multi-symbol order book management
-    std::unordered_map<std::string, std::unique_ptr<OrderBook>> order_books_; //hashmap with symbol as key and order book as value (through unique pointer)
+    using OrderBookMap = std::unordered_map<std::string, std::unique_ptr<OrderBook>, std::hash<std::string>, std::equal_to<std::string>,
+                                            CountingAllocator<std::pair<const std::string, std::unique_ptr<OrderBook>>>>;
+    OrderBookMap order_books_; //hashmap with symbol as key and order book as value (through unique pointer)
+    
+    // Symbols listed from reference data, sorted by symbol: one contiguous array of book headers.
+    // A listed symbol's OrderBook is only built, with the record's rules, when it is first used
+    std::vector<ReferenceRecord, CountingAllocator<ReferenceRecord>> listings_;
     
     // Event callbacks
     std::vector<std::function<void(const Trade&)>> trade_callbacks_; //vector of functions that take a const Trade& as an argument
     std::vector<std::function<void(const Order&)>> order_callbacks_; //vector of functions that take a const Order& as an argument
+    std::vector<std::function<void(const OrderEvent&)>> event_callbacks_; //order lifecycle stream; books only capture events while a stream callback exists
+    std::vector<std::pair<CallbackId, std::function<void(const OrderEvent*, size_t)>>> event_batch_callbacks_; //same stream, one call per command
+    CallbackId next_callback_id_ = 1;
+    std::vector<OrderEvent> dispatch_events_; //scratch: the stamped events of the command being dispatched
+    uint64_t event_sequence_ = 0; //last OrderEvent sequence handed out
     
     // Engine statistics and monitoring
     //atomic integer - thread safe integer
     std::atomic<uint64_t> total_orders_processed_; 
     std::atomic<uint64_t> total_trades_executed_;
     std::chrono::high_resolution_clock::time_point start_time_;
+
+    // Lock contention accounting, updated only when an acquisition has to wait
+    mutable std::atomic<uint64_t> exclusive_lock_contentions_{0};
+    mutable std::atomic<uint64_t> shared_lock_contentions_{0};
+    mutable std::atomic<uint64_t> exclusive_lock_wait_ns_{0};
+    mutable std::atomic<uint64_t> shared_lock_wait_ns_{0};
     
     // Configuration and thread safety
     EngineConfig config_; //config for the engine - stores all settings and limits
@@ -119,10 +229,67 @@ private:
     //atomic boolean - thread safe boolean
     std::atomic<bool> is_running_; //atomic boolean to store the state of the engine
     
+    // Command journal (optional): every command that reaches a book, in the order applied
+    std::shared_ptr<JournalWriter> journal_;
+    
+    // Recent client order ids per session, created on a session's first order
+    std::unordered_map<SessionId, std::unique_ptr<DuplicateOrderFilter>> session_filters_;
+    std::atomic<uint64_t> duplicate_orders_rejected_{0};
+    
+    // This engine's slice of the account notional budgets (optional, not owned)
+    ShardRiskBudget* risk_budget_ = nullptr;
+    std::vector<DepthLevel> risk_levels_; // scratch for pricing market orders
+    std::atomic<uint64_t> risk_rejections_{0};
+    
+    // Threads filling bulk snapshots, started on the first parallel snapshot and kept for the
+    // next ones; one parallel fill at a time (a concurrent one fills on its own thread)
+    class SnapshotWorkers;
+    mutable std::mutex snapshot_workers_mutex_;
+    mutable std::unique_ptr<SnapshotWorkers> snapshot_workers_;
+    
     // =============================================================================
     // Private Helper Methods
     // =============================================================================
     
+    /**
+     * @brief Acquire engine_mutex_ exclusively, recording the wait if it was contended
+     * @return Owning lock on engine_mutex_
+     */
+    std::unique_lock<std::shared_mutex> lockExclusive() const;
+    
+    /**
+     * @brief Acquire engine_mutex_ shared, recording the wait if it was contended
+     * @return Owning shared lock on engine_mutex_
+     */
+    std::shared_lock<std::shared_mutex> lockShared() const;
+    
+    /**
+     * @brief submitOrder, cancelOrder and modifyOrder without taking the lock (caller holds it exclusively)
+     */
+    std::vector<Trade> submitOrderLocked(Order order);
+    bool cancelOrderLocked(OrderId order_id, const std::string& symbol);
+    bool modifyOrderLocked(OrderId order_id, const std::string& symbol, Price new_price, Quantity new_quantity,
+                           std::vector<Trade>& trades);
+    
+    /**
+     * @brief Notional an order can commit: limit price x quantity, or for a market order
+     * what it would pay walking the opposite side as the book stands
+     */
+    Notional orderNotional(const OrderBook& book, const Order& order);
+
+    /**
+     * @brief Notional an order actually holds after matching: what it traded in trades plus
+     * its remainder resting at its limit price
+     */
+    Notional usedNotional(const OrderBook& book, OrderId order_id, const std::vector<Trade>& trades) const;
+
+    /**
+     * @brief Whether submitting the order would be rejected as a duplicate (its id is resting
+     * in its book or within its session's duplicate window); decides an annihilated pair
+     */
+    bool isKnownOrderId(const Order& order) const;
+    bool isResting(OrderId order_id, const std::string& symbol) const;
+    
     /**
      * @brief Validate order before processing
      * @param order The order to validate
@@ -151,6 +318,17 @@ private:
      */
     OrderBook* getOrderBook(const std::string& symbol); //get the order book for the symbol
     
+    /**
+     * @brief Build a symbol's book, applying its reference data rules if it is listed
+     * @return The new book, already in order_books_
+     */
+    OrderBook* createOrderBook(const std::string& symbol);
+    
+    /**
+     * @brief The book of a listed symbol that has none yet, built now (nullptr if not listed)
+     */
+    OrderBook* openListedBook(const std::string& symbol);
+    
     /**
      * @brief Remove empty order books to free memory
      */
@@ -167,6 +345,30 @@ private:
      * @param order The order to broadcast
      */
     void broadcastOrderUpdate(const Order& order); //broadcast the order update to all registered callbacks
+    
+    /**
+     * @brief Stamp and deliver the lifecycle events a book captured, then clear them
+     * @param book The book that just processed a command
+     */
+    void dispatchEvents(OrderBook& book);
+    
+    /**
+     * @brief Whether books need to capture events (any event stream callback registered)
+     */
+    bool capturesEvents() const { return !event_callbacks_.empty() || !event_batch_callbacks_.empty(); }
+    
+    /**
+     * @brief Append a command to the journal, if one is attached (caller holds the exclusive lock)
+     * @param record The command; sequence and timestamp are filled in here
+     */
+    void journalCommand(JournalRecord& record);
+    
+    /**
+     * @brief Fill records [0, count) of a snapshot on up to threads threads (the caller and
+     * snapshot_workers_)
+     * @param fill Fills one record by index
+     */
+    void fillInParallel(size_t count, size_t threads, const std::function<void(size_t)>& fill) const;
 
 
 
@@ -214,8 +416,12 @@ public:
     
     /**
      * @brief Submit an order to the matching engine
+     * 
+     * An order tagged with a session is refused if the session already used its id within the
+     * last duplicate_order_window orders; any order is refused if its id is still resting.
      * @param order The order to submit
      * @return Vector of trades executed (empty if no matches)
+     * @throws std::invalid_argument if the order fails validation or is a duplicate
      */
 
     std::vector<Trade> submitOrder(Order order);
@@ -240,6 +446,26 @@ public:
 
     bool modifyOrder(OrderId order_id, const std::string& symbol, Price new_price, Quantity new_quantity); //modify an existing order
     
+    /**
+     * @brief Apply a batch of queued commands under one exclusive lock (the matcher's batch path)
+     * 
+     * Each command behaves as the matching submitOrder / cancelOrder / modifyOrder call would,
+     * except that errors are reported in its result instead of thrown. NEW_ORDER commands'
+     * orders are moved out. Amends marked superseded are acknowledged without touching
+     * a book, and so are a new order and cancel marked annihilated, unless the id is resting
+     * already: the new order is then rejected as a duplicate and the cancel applied.
+     * @param commands Commands in the order to apply them
+     * @param results One result per command is appended, in the same order
+     * @return Number of commands processed
+     */
+    size_t processCommands(std::vector<EngineCommand>& commands, std::vector<CommandResult>& results);
+    
+    /**
+     * @brief Forget a session's recent order ids (call when its connection goes away)
+     * @param session The session to drop
+     */
+    void closeSession(SessionId session);
+    
     // =============================================================================
     // Getting Market Data
     // =============================================================================
@@ -274,7 +500,41 @@ public:
     MarketDepth getMarketDepth(const std::string& symbol, size_t levels = 5) const;
     
     /**
-     * @brief Get list of all active symbols
+     * @brief Get a lock-free handle to a symbol's top of book and top-K signals
+     * 
+     * Only the lookup takes the shared lock. The returned handle can be read from any
+     * thread with read() without touching engine_mutex_, and stays valid (frozen at its
+     * last state) even if the symbol is removed.
+     * @param symbol The symbol to query
+     * @return Snapshot handle, or nullptr if the symbol is unknown
+     */
+    std::shared_ptr<const TopOfBookSnapshot> getTopOfBookSnapshot(const std::string& symbol) const;
+    
+    /**
+     * @brief BBO and top-K depth for many symbols in one call
+     * 
+     * Takes the shared lock once, so every record comes from the same engine state, and writes
+     * into the caller's buffer without allocating (once the buffer is large enough). With
+     * threads > 1 the records are filled by that many threads in parallel, all under the
+     * same lock; worth it for thousands of symbols. The extra threads are started by the first
+     * such call and reused by later ones.
+     * @param symbols Symbols to capture, in output order (unknown symbols get found == 0)
+     * @param out Buffer to fill; its depth sets the levels per side
+     * @param threads Threads to fill with (1 = calling thread only)
+     * @return Number of records written (symbols.size())
+     */
+    size_t getMarketSnapshot(const std::vector<std::string>& symbols, MarketSnapshot& out, size_t threads = 1) const;
+    
+    /**
+     * @brief BBO and top-K depth for every active symbol (see the overload above)
+     * @param out Buffer to fill, one record per symbol in unspecified order
+     * @param threads Threads to fill with (1 = calling thread only)
+     * @return Number of records written
+     */
+    size_t getMarketSnapshot(MarketSnapshot& out, size_t threads = 1) const;
+    
+    /**
+     * @brief Get list of all active symbols (those with a book, then listed ones without one yet)
      * @return Vector of symbol names
      */
     std::vector<std::string> getActiveSymbols() const;
@@ -290,12 +550,92 @@ public:
     void addSymbol(const std::string& symbol);
     
     /**
-     * @brief Remove a trading symbol (only if no active orders)
+     * @brief List every symbol of a reference data file (see reference_data.hpp) in one step
+     * 
+     * The file is mapped, its records copied into one contiguous array under a single lock
+     * acquisition, and the mapping dropped. No book is built here: a listed symbol gets its
+     * OrderBook, with the record's tick size, lot size and price band, on its first order (or
+     * addSymbol / importSnapshot). Existing books of listed symbols get the record's rules.
+     * Replaces any listing loaded before.
+     * @param path Reference data file
+     * @return Number of symbols listed
+     * @throws std::runtime_error if the file is missing or malformed
+     * @throws std::invalid_argument if a record's rules are invalid (nothing is listed)
+     */
+    size_t loadReferenceData(const std::string& path);
+    
+    /**
+     * @brief Remove a trading symbol (only if no active orders), delisting it if it was listed
      * @param symbol The symbol to remove
      * @return true if symbol was removed successfully
      */
     bool removeSymbol(const std::string& symbol);
     
+    // =============================================================================
+    // Command Journal
+    // =============================================================================
+    
+    /**
+     * @brief Record every accepted command to a journal (nullptr detaches)
+     * 
+     * New orders are journaled once validated, cancels and modifies once they found their
+     * order, all under the exclusive lock so journal order is application order. Replaying
+     * the journal through OrderBook reproduces the books (see BookHistory).
+     * @param journal Journal to append to
+     */
+    void setCommandJournal(std::shared_ptr<JournalWriter> journal);
+    
+    /**
+     * @brief Flush the journal and wait until it is durable
+     */
+    void syncCommandJournal();
+    
+    // =============================================================================
+    // State Handoff
+    // =============================================================================
+    
+    /**
+     * @brief Encode every book in the snapshot format, e.g. to hand the engine to a new process
+     * 
+     * Waits for the command in flight; to hand the engine over, stop() it first so nothing
+     * lands after the image. An attached journal is made durable and its last sequence
+     * recorded in the image.
+     * @param event_sequence If given, receives the last OrderEvent sequence reflected in the image
+     * @return The snapshot image (see encodeSnapshot)
+     */
+    std::string exportSnapshot(uint64_t* event_sequence = nullptr);
+    
+    /**
+     * @brief Load the books of a snapshot image, replacing books of the same symbols
+     * @param snapshot Image produced by exportSnapshot()
+     * @param event_sequence Last OrderEvent sequence of the exporting engine, so the event
+     *        stream continues without a gap (0 leaves the sequence alone)
+     * @return Number of books restored
+     */
+    size_t importSnapshot(const SnapshotView& snapshot, uint64_t event_sequence = 0);
+    
+    /**
+     * @brief Last OrderEvent sequence handed out
+     */
+    uint64_t getEventSequence() const;
+    
+    // =============================================================================
+    // Account Risk
+    // =============================================================================
+    
+    /**
+     * @brief Check orders against account notional limits (nullptr turns checks off)
+     * 
+     * Orders with an account reserve their notional (limit price x quantity; for market
+     * orders, the cost of the levels they will take) from this engine's slice before they
+     * are accepted, and are refused with std::invalid_argument when the account's global
+     * limit would be exceeded. Executed notional stays used; cancelled and expired remainders
+     * are released, and an amend only needs budget for an increase in notional.
+     * @param budget This engine's shard of a RiskBudgetPool (must outlive the engine or be
+     *        detached first); calls are made under the engine's exclusive lock
+     */
+    void setRiskBudget(ShardRiskBudget* budget);
+    
     // =============================================================================
     // Event Handling & Callbacks
     // =============================================================================
@@ -312,6 +652,33 @@ public:
      */
     void registerOrderCallback(std::function<void(const Order&)> callback);
     
+    /**
+     * @brief Register a callback for the order lifecycle event stream
+     * 
+     * Every accept, fill (one event per side), amend, cancel and expiry, in the order they
+     * happened, with a gapless engine-wide sequence. Callbacks run under the engine's
+     * exclusive lock, so they should hand events off (e.g. to a queue) rather than block.
+     * @param callback Function to call for each event
+     */
+    void registerEventCallback(std::function<void(const OrderEvent&)> callback);
+    
+    /**
+     * @brief Register a callback for the event stream that receives each command's events at once
+     * 
+     * Same events and sequence as registerEventCallback, delivered as one array per command
+     * (a new order with its fills, an amend with its fills, a cancel), so a consumer never
+     * sees half a command. Runs under the engine's exclusive lock.
+     * @param callback Function called with the command's events and their count
+     * @return Id to pass to unregisterEventBatchCallback
+     */
+    CallbackId registerEventBatchCallback(std::function<void(const OrderEvent*, size_t)> callback);
+    
+    /**
+     * @brief Remove one batch callback; once it returns the callback is never called again
+     * @param id Id returned by registerEventBatchCallback (unknown ids are ignored)
+     */
+    void unregisterEventBatchCallback(CallbackId id);
+    
     /**
      * @brief Remove all registered callbacks
      */
@@ -327,6 +694,22 @@ public:
      */
     EngineStatistics getStatistics() const;
     
+    /**
+     * @brief Get live heap usage across all order books
+     * 
+     * Order storage, level index and order index are summed over every book; the symbol
+     * directory category covers the symbol map nodes plus the OrderBook objects themselves.
+     * @return Bytes and allocation counts per MemoryCategory
+     */
+    MemoryUsage getMemoryUsage() const;
+    
+    /**
+     * @brief Get live heap usage of one symbol's order book
+     * @param symbol The symbol to query
+     * @return Usage of that book, or an empty usage if the symbol is unknown
+     */
+    MemoryUsage getMemoryUsage(const std::string& symbol) const;
+    
     /**
      * @brief Get engine status as formatted string
      * @return Status report for monitoring
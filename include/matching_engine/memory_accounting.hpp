@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory> //for std::allocator
+
+namespace matching_engine {
+
+/**
+ * @brief What a piece of live heap memory is used for
+ *
+ * Order storage holds the resting Order objects themselves (including their inline symbol strings),
+ * the level index is the price -> level map, the order index is the id -> location hash map,
+ * event buffers are queues of events waiting for consumers and session filters are the per-session
+ * duplicate order id windows.
+ */
+enum class MemoryCategory : uint8_t {
+    ORDER_STORAGE = 0,    ///< Resting orders and the containers holding them within a level
+    LEVEL_INDEX = 1,      ///< Price level map nodes
+    ORDER_INDEX = 2,      ///< Order id lookup (nodes and buckets)
+    EVENT_BUFFERS = 3,    ///< Pending events for callbacks and consumers
+    SYMBOL_DIRECTORY = 4, ///< Symbol -> book map and the book objects themselves
+    SESSION_FILTERS = 5,  ///< Per-session duplicate order id filters
+    COUNT = 6
+};
+
+constexpr size_t MEMORY_CATEGORY_COUNT = static_cast<size_t>(MemoryCategory::COUNT);
+
+/**
+ * @brief Convert MemoryCategory enum to string
+ * @param category The category to convert
+ * @return String representation of the category
+ */
+constexpr const char* toString(MemoryCategory category) noexcept {
+    switch (category) {
+        case MemoryCategory::ORDER_STORAGE:    return "ORDER_STORAGE";
+        case MemoryCategory::LEVEL_INDEX:      return "LEVEL_INDEX";
+        case MemoryCategory::ORDER_INDEX:      return "ORDER_INDEX";
+        case MemoryCategory::EVENT_BUFFERS:    return "EVENT_BUFFERS";
+        case MemoryCategory::SYMBOL_DIRECTORY: return "SYMBOL_DIRECTORY";
+        case MemoryCategory::SESSION_FILTERS:  return "SESSION_FILTERS";
+        default:                               return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief Snapshot of live heap usage by category
+ *
+ * Bytes are what the containers requested from the allocator; malloc's own per-chunk
+ * overhead is not included, which is why the allocation count is reported alongside.
+ */
+struct MemoryUsage {
+    std::array<size_t, MEMORY_CATEGORY_COUNT> bytes{};
+    std::array<size_t, MEMORY_CATEGORY_COUNT> allocations{};
+
+    size_t getBytes(MemoryCategory category) const { return bytes[static_cast<size_t>(category)]; }
+    size_t getAllocations(MemoryCategory category) const { return allocations[static_cast<size_t>(category)]; }
+
+    size_t totalBytes() const {
+        size_t total = 0;
+        for (auto b : bytes) total += b;
+        return total;
+    }
+
+    size_t totalAllocations() const {
+        size_t total = 0;
+        for (auto a : allocations) total += a;
+        return total;
+    }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        for (size_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+            bytes[i] += other.bytes[i];
+            allocations[i] += other.allocations[i];
+        }
+        return *this;
+    }
+};
+
+/**
+ * @brief Live byte/allocation counters fed by CountingAllocator
+ *
+ * Not thread safe on its own: it is updated by whoever mutates the owning container, which in
+ * the engine is always done under the exclusive engine lock.
+ */
+class MemoryAccountant {
+    private:
+        MemoryUsage usage_;
+
+    public:
+        void onAllocate(MemoryCategory category, size_t bytes) noexcept {
+            auto i = static_cast<size_t>(category);
+            usage_.bytes[i] += bytes;
+            usage_.allocations[i]++;
+        }
+
+        void onDeallocate(MemoryCategory category, size_t bytes) noexcept {
+            auto i = static_cast<size_t>(category);
+            usage_.bytes[i] -= bytes;
+            usage_.allocations[i]--;
+        }
+
+        const MemoryUsage& getUsage() const noexcept { return usage_; }
+};
+
+/**
+ * @brief Standard-conforming allocator that reports every allocation to a MemoryAccountant
+ *
+ * The allocator is stateful (accountant + category), so containers using it must be given one
+ * at construction; rebinding keeps both, which means node-based containers charge their real
+ * node size (key, value and links) to the category rather than just sizeof(value).
+ */
+template <typename T>
+class CountingAllocator {
+    private:
+        MemoryAccountant* accountant_;
+        MemoryCategory category_;
+
+        template <typename U> friend class CountingAllocator;
+
+    public:
+        using value_type = T;
+
+        CountingAllocator(MemoryAccountant* accountant, MemoryCategory category) noexcept
+            : accountant_(accountant), category_(category) {}
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>& other) noexcept
+            : accountant_(other.accountant_), category_(other.category_) {}
+
+        T* allocate(size_t n) {
+            T* p = std::allocator<T>().allocate(n);
+            accountant_->onAllocate(category_, n * sizeof(T));
+            return p;
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            accountant_->onDeallocate(category_, n * sizeof(T));
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        MemoryAccountant* getAccountant() const noexcept { return accountant_; }
+        MemoryCategory getCategory() const noexcept { return category_; }
+
+        template <typename U>
+        bool operator==(const CountingAllocator<U>& other) const noexcept {
+            return accountant_ == other.accountant_ && category_ == other.category_;
+        }
+
+        template <typename U>
+        bool operator!=(const CountingAllocator<U>& other) const noexcept { return !(*this == other); }
+};
+
+} // namespace matching_engine
@@ -30,7 +30,10 @@ class Order {
         Quantity quantity_;
         Quantity remaining_quantity_;
         std::chrono::high_resolution_clock::time_point timestamp_;
-
+        AccountId account_ = 0;
+        SessionId session_ = 0;
+        OrderId parent_ = 0;
+        LinkId link_ = NO_LINK;
 
     public:
     /**
@@ -63,6 +66,30 @@ class Order {
     Price getPrice() const noexcept { return price_; }
     Quantity getQuantity() const noexcept { return quantity_; }
     Quantity getRemainingQuantity() const noexcept { return remaining_quantity_; }
+    AccountId getAccount() const noexcept { return account_; }
+    SessionId getSession() const noexcept { return session_; }
+    OrderId getParent() const noexcept { return parent_; }
+    LinkId getLink() const noexcept { return link_; }
+
+    /**
+     * @brief Tag the order with the account it trades for (carried into its lifecycle events)
+     */
+    void setAccount(AccountId account) noexcept { account_ = account; }
+
+    /**
+     * @brief Tag the order with the client session it arrived on (enables duplicate id detection)
+     */
+    void setSession(SessionId session) noexcept { session_ = session; }
+
+    /**
+     * @brief Mark the order as a child released by an engine-resident parent order (0 = none)
+     */
+    void setParent(OrderId parent) noexcept { parent_ = parent; }
+
+    /**
+     * @brief Tie the order to a linked group of its book (set by OrderBook::addLinkedOrders)
+     */
+    void setLink(LinkId link) noexcept { link_ = link; }
 
     /**
      * @brief Get the order timestamp for FIFO ordering
@@ -4,13 +4,34 @@
 #include <matching_engine/order.hpp>
 #include <map> //for buy and sell orders
 #include <queue> //for FIFO order processing
+#include <deque> //container behind each price level queue
 #include <vector> //for trade execution results
 #include <optional> //for optional values
 #include <unordered_map> //for fast order lookup
+#include <memory> //for the shared top-of-book snapshot
 #include "matching_engine/trade.hpp"
+#include "matching_engine/memory_accounting.hpp"
+#include "matching_engine/top_of_book.hpp"
+#include "matching_engine/order_event.hpp"
 
 namespace matching_engine {
 
+/**
+ * @brief One aggregated price level, as copied into caller-owned market data buffers
+ */
+struct DepthLevel {
+    Price price;
+    Quantity quantity; ///< Total remaining quantity at the price
+};
+
+/**
+ * @brief One member of a linked (one-cancels-other) group, see OrderBook::addLinkedOrders
+ */
+struct LinkedOrder {
+    Order order;
+    Price trigger_price = 0; ///< 0: a limit order entering the book now; otherwise held as a stop until a trade reaches it
+};
+
 /**
  * @brief Order book class maintaining buy and sell orders with price-time priority
  * 
@@ -22,21 +43,170 @@ namespace matching_engine {
  * Data Structure:
  * - Buy orders: std::map with descending price order (highest price first)
  * - Sell orders: std::map with ascending price order (lowest price first)
+ * - Each price level keeps its FIFO queue and a running total of its remaining quantity
+ * 
+ * Top of book and the top-K signals (imbalance, microprice, depth-weighted mid) are
+ * republished to a lock-free TopOfBookSnapshot after every command that touched one of
+ * the top K levels; changes deeper in the book don't trigger any work.
+ * 
+ * With event capture on, every command also appends the OrderEvents it caused (accept,
+ * fills on both sides, amend, cancel, expiry) to an internal buffer for the engine to drain.
+ * 
+ * Stop orders wait outside the levels until a trade prints at or through their trigger and
+ * then enter as if just submitted. Orders can be linked into one-cancels-other groups: the
+ * first fill (or trigger) of a member cancels the others within the same command. Members
+ * reach their group through the LinkId slot they carry, so the fill loop pays one branch
+ * for unlinked orders. Cancelling a sibling then goes straight to its stop entry or price
+ * level, both recorded in the group; a resting sibling is removed from its level by id.
  */
 
 
 class OrderBook {
+    public:
+        // Container types, all allocating through the book's MemoryAccountant
+        using OrderQueue = std::queue<Order, std::deque<Order, CountingAllocator<Order>>>;
+        
+        struct PriceLevel {
+            OrderQueue orders;            // FIFO queue at this price
+            Quantity total_quantity = 0;  // Sum of remaining quantity in the queue
+        };
+        
+        template <typename Compare>
+        using LevelMap = std::map<Price, PriceLevel, Compare, CountingAllocator<std::pair<const Price, PriceLevel>>>;
+        using OrderLocationMap = std::unordered_map<OrderId, std::pair<Price, OrderSide>, std::hash<OrderId>, std::equal_to<OrderId>,
+                                                    CountingAllocator<std::pair<const OrderId, std::pair<Price, OrderSide>>>>;
+        using EventBuffer = std::vector<OrderEvent, CountingAllocator<OrderEvent>>;
+        using StopMap = std::multimap<Price, Order, std::less<Price>, CountingAllocator<std::pair<const Price, Order>>>;
+        using StopLocationMap = std::unordered_map<OrderId, StopMap::iterator, std::hash<OrderId>, std::equal_to<OrderId>,
+                                                   CountingAllocator<std::pair<const OrderId, StopMap::iterator>>>;
+
     private:
+        // Live heap usage of the containers below (must be declared before them)
+        MemoryAccountant memory_;
+
         // Price level maps: Price -> Queue of orders at that price
-        std::map<Price, std::queue<Order>, std::greater<Price>> bids_;        // Descending: highest price first
-        std::map<Price, std::queue<Order>, std::less<Price>> asks_;     // Ascending: lowest price first
+        LevelMap<std::greater<Price>> bids_;        // Descending: highest price first
+        LevelMap<std::less<Price>> asks_;     // Ascending: lowest price first
         
         // Fast order lookup for cancellations
-        std::unordered_map<OrderId, std::pair<Price, OrderSide>> order_locations_; //hashmap with order id, (price, side) as key value pair
+        OrderLocationMap order_locations_; //hashmap with order id, (price, side) as key value pair
+        
+        // Stop orders by trigger price (FIFO among equal triggers), and where each one is
+        StopMap buy_stops_;     // trigger when a trade prints at or above
+        StopMap sell_stops_;    // trigger when a trade prints at or below
+        StopLocationMap stop_locations_;
+        
+        // One-cancels-other groups, indexed by LinkId (slot 0 is NO_LINK)
+        struct LinkMember {
+            OrderId id;
+            OrderSide side;
+            Price price;                 // resting price (limit members)
+            bool stop;                   // waiting in a stop map rather than a level
+            bool live;                   // still in the book and not yet cancelled
+            StopMap::iterator stop_entry;
+        };
+        struct LinkGroup {
+            std::vector<LinkMember> members;
+            bool fired = false;          // a member filled or triggered; the live ones are cancelled at the end of the step
+        };
+        std::vector<LinkGroup> link_groups_;
+        std::vector<LinkId> free_links_;
+        std::vector<LinkId> fired_links_;
         
         // Trade ID generator
         TradeId next_trade_id_;
         
+        // Top-K window per side as of the last recompute: a change at a price inside it
+        // (or anywhere while the side has fewer than K levels) marks the side dirty
+        struct DepthWindow {
+            Price boundary = 0;      // Price of the K-th level
+            size_t levels = 0;       // Levels currently inside the window (<= K)
+            Quantity quantity = 0;   // Total quantity inside the window
+            double notional = 0.0;   // Sum of price * quantity inside the window
+            bool dirty = false;
+        };
+        size_t analytics_depth_;
+        InstrumentRules rules_;   // tick / lot / band checks on orders entering the book
+        DepthWindow bid_window_;
+        DepthWindow ask_window_;
+        uint64_t top_of_book_sequence_;
+        std::shared_ptr<TopOfBookSnapshot> top_of_book_; // shared so reader handles outlive the book
+        
+        // Lifecycle events of the current command(s), drained by the owner
+        EventBuffer events_;
+        bool capture_events_;
+        
+        /**
+         * @brief Append an event for an order if capture is on
+         * @param type What happened
+         * @param order The order it happened to (its remaining quantity is recorded)
+         * @param price Order price, or execution price for fills
+         * @param quantity Order, fill or removed quantity depending on type
+         * @param trade_id Trade behind a fill
+         */
+        void recordEvent(OrderEventType type, const Order& order, Price price, Quantity quantity, TradeId trade_id = 0);
+        
+        /**
+         * @brief Record the fill events of one trade for both orders
+         */
+        void recordFills(const Order& aggressor, const Order& passive, const Trade& trade);
+        
+        /**
+         * @brief Note a quantity or level change at a price, dirtying the side if it is in the top K
+         * @param side The side that changed
+         * @param price The price level that changed
+         */
+        void markDepthChange(OrderSide side, Price price);
+        
+        /**
+         * @brief Recompute dirty top-K windows and publish a new TopOfBook if anything changed
+         */
+        void publishTopOfBook();
+        
+        /**
+         * @brief Match an order and rest its remainder (addOrder without the checks and follow-up)
+         * @return Trades it made
+         */
+        std::vector<Trade> enterOrder(Order& order);
+        
+        /**
+         * @brief End of a matching step: cancel siblings of fired groups, then run triggered stops
+         * @param trades Trades of the step; triggered stops append theirs
+         */
+        void settleStep(std::vector<Trade>& trades);
+        
+        /**
+         * @brief Cancel the live members of the groups fired so far and free their slots
+         */
+        void cancelFiredSiblings();
+        
+        /**
+         * @brief Fire the group of a member that just filled or triggered and unlink the member
+         */
+        void fireLink(Order& member);
+        
+        /**
+         * @brief Take the front order of a level off if its group fired earlier in this step
+         * @return true if it was removed (the caller moves on without trading with it)
+         */
+        bool dropFiredMember(PriceLevel& level, OrderSide side, Price price);
+        
+        /**
+         * @brief A member left its group (cancelled or fired); frees the slot once nobody is left
+         */
+        void retireMember(LinkId link, OrderId order_id);
+        
+        LinkId allocateLink();
+        void releaseLink(LinkId link);
+        
+        /**
+         * @brief Remove an untriggered stop order
+         * @return The stop order, or std::nullopt if order_id isn't a stop
+         */
+        std::optional<Order> removeStop(OrderId order_id);
+        
+        void checkTick(Price price) const;
+        
         /**
          * @brief Execute a market order against existing limit orders
          * @param market_order The market order to execute
@@ -63,9 +233,16 @@ class OrderBook {
          * @param price The price level to remove from
          * @param side The side (buy/sell) to remove from
          * @param order_id The order ID to remove
+         * @param removed If not null, receives a copy of the removed order
          * @return true if order was found and removed
          */
-        bool removeFromPriceLevel(Price price, OrderSide side, OrderId order_id);
+        bool removeFromPriceLevel(Price price, OrderSide side, OrderId order_id, std::optional<Order>* removed = nullptr);
+        
+        /**
+         * @brief Create an empty price level whose storage is charged to ORDER_STORAGE
+         * @return Empty order queue
+         */
+        PriceLevel makeLevel() { return PriceLevel{OrderQueue(std::deque<Order, CountingAllocator<Order>>(CountingAllocator<Order>(&memory_, MemoryCategory::ORDER_STORAGE))), 0}; }
         
         /**
          * @brief Generate a new trade ID
@@ -95,8 +272,30 @@ class OrderBook {
     public:
         /**
          * @brief Construct a new Order Book
+         * @param analytics_depth Number of levels per side (K) used for the depth-based signals
          */
-        OrderBook() : next_trade_id_(0) {}
+        explicit OrderBook(size_t analytics_depth = 5);
+        
+        /**
+         * @brief Set the tick size, lot size and price band orders must respect from now on
+         * 
+         * Checked by addOrder, addStopOrder, addLinkedOrders and replaceOrder; orders already
+         * resting and restore() are not checked.
+         * @throws std::invalid_argument if the rules fail isValidRules
+         */
+        void setRules(const InstrumentRules& rules);
+        const InstrumentRules& getRules() const { return rules_; }
+
+        /**
+         * @brief Throw std::invalid_argument if a price (MARKET_PRICE: none) or quantity breaks the instrument rules
+         *
+         * Lets a caller reject an order before it commits anything else to it (risk, journal).
+         */
+        void checkRules(Price price, Quantity quantity) const;
+        
+        // Containers hold a pointer to memory_, so a book stays where it was built
+        OrderBook(const OrderBook&) = delete;
+        OrderBook& operator=(const OrderBook&) = delete;
         
         /**
          * @brief Add an order to the order book and attempt matching
@@ -108,6 +307,8 @@ class OrderBook {
          * 
          * @param order The order to add
          * @return Vector of trades generated from matching
+         * @throws std::invalid_argument if an order with the same id is already resting or the
+         *         order breaks the instrument rules
          */
         std::vector<Trade> addOrder(Order order);
         
@@ -119,6 +320,56 @@ class OrderBook {
          */
         bool cancelOrder(OrderId order_id); 
         
+        /**
+         * @brief Cancel an existing order and return what was resting
+         * 
+         * @param order_id The ID of the order to cancel
+         * @return The removed order (with its remaining quantity), or std::nullopt if not found
+         */
+        std::optional<Order> removeOrder(OrderId order_id);
+        
+        /**
+         * @brief Replace a resting order's price and quantity (cancel/replace, losing time priority)
+         * 
+         * The replacement keeps the original's side and account and may trade immediately.
+         * Nothing changes if the new price or quantity is invalid.
+         * @param order_id The order to replace
+         * @param new_price New limit price
+         * @param new_quantity New quantity
+         * @param trades Receives any trades the replacement makes
+         * @return The replacement order as entered, or std::nullopt if order_id isn't resting
+         * @throws std::invalid_argument if new_price or new_quantity is out of range or breaks the instrument rules
+         */
+        std::optional<Order> replaceOrder(OrderId order_id, Price new_price, Quantity new_quantity, std::vector<Trade>& trades);
+        
+        /**
+         * @brief Hold an order until a trade prints at or through its trigger price
+         * 
+         * Buy stops trigger on a trade at or above trigger_price, sell stops at or below; the
+         * order (market: stop-market, limit: stop-limit) then enters as if just submitted, in
+         * the same command as the trade. An untriggered stop produces no events until it is
+         * triggered or cancelled (cancelOrder / removeOrder find it by id).
+         * @param order The order to enter when triggered
+         * @param trigger_price Trade price that triggers it
+         * @throws std::invalid_argument if the trigger is invalid or the id is resting or waiting already
+         */
+        void addStopOrder(Order order, Price trigger_price);
+        
+        /**
+         * @brief Enter a one-cancels-other group
+         * 
+         * Members with a trigger price wait as stops, the others (limit orders) are entered in
+         * the given order. As soon as one member fills or triggers, every other member still
+         * live is cancelled within the same command: resting ones met by the fill loop are taken
+         * off on the spot, the rest at the end of the matching step. Members not entered yet
+         * when the group fires are accepted and cancelled. A member cancelled on its own just
+         * leaves the group. Groups are not part of getRestingOrders()/restore().
+         * @param members At least two orders on this book's symbol with distinct, unused ids
+         * @return Trades the entered members made
+         * @throws std::invalid_argument on a malformed group (nothing is entered)
+         */
+        std::vector<Trade> addLinkedOrders(std::vector<LinkedOrder> members);
+        
         /**
          * @brief Get the best bid price (highest buy price)
          * @return Best bid price, or std::nullopt if no bids exist
@@ -161,6 +412,37 @@ class OrderBook {
          */
         size_t getOrderCount() const;
         
+        /**
+         * @brief Check whether an order is resting in the book
+         * @param order_id The order id to look up
+         * @return true if the order is resting
+         */
+        bool hasOrder(OrderId order_id) const { return order_locations_.count(order_id) != 0; }
+        
+        /**
+         * @brief Check whether a stop order is waiting for its trigger
+         */
+        bool hasStopOrder(OrderId order_id) const { return stop_locations_.count(order_id) != 0; }
+        
+        /**
+         * @brief Get the number of untriggered stop orders
+         */
+        size_t getStopOrderCount() const { return stop_locations_.size(); }
+        
+        /**
+         * @brief Get the number of linked groups with members still in the book
+         */
+        size_t getLinkedGroupCount() const { return link_groups_.size() - 1 - free_links_.size(); }
+        
+        /**
+         * @brief Look at a resting order without changing the book
+         * 
+         * Scans the order's price level, so O(orders at that price).
+         * @param order_id The order id to look up
+         * @return The resting order (valid until the book next changes), or nullptr
+         */
+        const Order* findOrder(OrderId order_id) const;
+        
 
         /**
          * @brief Get number of price levels on bid side
@@ -195,6 +477,89 @@ class OrderBook {
          */
         std::vector<std::pair<Price, Quantity>> getAskLevels(size_t max_levels = 10) const;
         
+        /**
+         * @brief Copy the best bid levels into a caller-provided array (no allocation)
+         * @param out Destination, room for max_levels entries
+         * @param max_levels Maximum number of levels to copy
+         * @return Number of levels copied, best price first
+         */
+        size_t copyBidLevels(DepthLevel* out, size_t max_levels) const;
+        
+        /**
+         * @brief Copy the best ask levels into a caller-provided array (no allocation)
+         * @param out Destination, room for max_levels entries
+         * @param max_levels Maximum number of levels to copy
+         * @return Number of levels copied, best price first
+         */
+        size_t copyAskLevels(DepthLevel* out, size_t max_levels) const;
+        
+        /**
+         * @brief Read the latest top of book and top-K signals without locking
+         * @return Most recently published TopOfBook
+         */
+        TopOfBook getTopOfBook() const { return top_of_book_->read(); }
+        
+        /**
+         * @brief Get a handle to the book's top-of-book snapshot
+         * 
+         * Readers can keep the handle and call read() on it from any thread without going
+         * through the book (or the engine's lock) again.
+         * @return Shared handle to the snapshot
+         */
+        std::shared_ptr<const TopOfBookSnapshot> getTopOfBookSnapshot() const { return top_of_book_; }
+        
+        /**
+         * @brief Get the number of levels used for the depth-based signals
+         */
+        size_t getAnalyticsDepth() const { return analytics_depth_; }
+        
+        /**
+         * @brief Get live heap usage of the book by category
+         * 
+         * Counted at the allocator level, so it includes map/hash node overhead and the
+         * deque blocks behind each price level's queue.
+         * @return Bytes and allocation counts per MemoryCategory
+         */
+        MemoryUsage getMemoryUsage() const { return memory_.getUsage(); }
+        
+        /**
+         * @brief Copy out every resting order in priority order
+         * 
+         * Bids best price first, then asks best price first, FIFO within each level. Together
+         * with getLastTradeId() this is all restore() needs to rebuild an identical book.
+         * @return Resting orders with their remaining quantities
+         */
+        std::vector<Order> getRestingOrders() const;
+        
+        /**
+         * @brief Get the id of the last trade this book generated (0 if none)
+         */
+        TradeId getLastTradeId() const { return next_trade_id_; }
+        
+        /**
+         * @brief Replace the book's contents with previously exported resting orders
+         * 
+         * Orders are placed without matching, in the given order, so queue priority is kept.
+         * @param orders Resting orders in priority order (as returned by getRestingOrders)
+         * @param last_trade_id Trade id to continue numbering from
+         */
+        void restore(const std::vector<Order>& orders, TradeId last_trade_id);
+        
+        /**
+         * @brief Turn lifecycle event capture on or off (off by default)
+         */
+        void setEventCapture(bool enabled) { capture_events_ = enabled; }
+        bool isCapturingEvents() const { return capture_events_; }
+        
+        /**
+         * @brief Events captured since the last clearEvents(), in the order they happened
+         * 
+         * sequence and timestamp_ns are left for the consumer to assign. The buffer's
+         * capacity is kept across clears and shows up as EVENT_BUFFERS memory.
+         */
+        const EventBuffer& getEvents() const { return events_; }
+        void clearEvents() { events_.clear(); }
+        
         /**
          * @brief Clear all orders from the book
          */
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <cstdint>
+#include <cstring> //for the fixed-width symbol
+#include <string>
+#include <type_traits>
+
+namespace matching_engine {
+
+/**
+ * @brief What happened to an order
+ */
+enum class OrderEventType : uint8_t {
+    ACCEPTED = 0,          ///< Order reached its book (before any matching)
+    PARTIALLY_FILLED = 1,  ///< Traded, quantity still remaining
+    FILLED = 2,            ///< Traded, nothing remaining
+    AMENDED = 3,           ///< Price/quantity replaced (loses time priority)
+    CANCELLED = 4,         ///< Removed from the book on request
+    EXPIRED = 5            ///< Unfilled market order remainder dropped
+};
+
+/**
+ * @brief One step of an order's lifecycle, as published on the engine's event stream
+ *
+ * Trivially copyable and fixed-size so it can be queued, written to disk or shared between
+ * processes as-is.
+ *
+ * Field meaning by type:
+ * - ACCEPTED / AMENDED: price and quantity of the (new) order
+ * - PARTIALLY_FILLED / FILLED: execution price, fill quantity and trade_id
+ * - CANCELLED / EXPIRED: order price and the quantity that was taken off
+ * remaining_quantity is what is still live after the event.
+ */
+struct OrderEvent {
+    uint64_t sequence = 0;        ///< Engine-wide event sequence, assigned on dispatch
+    int64_t timestamp_ns = 0;     ///< Wall-clock nanoseconds since the Unix epoch, assigned on dispatch
+    OrderId order_id = 0;
+    AccountId account = 0;
+    TradeId trade_id = 0;         ///< Fills only
+    Price price = 0;
+    Quantity quantity = 0;
+    Quantity remaining_quantity = 0;
+    char symbol[8] = {};          ///< Not null-terminated when the symbol is 8 characters
+    OrderEventType type = OrderEventType::ACCEPTED;
+    OrderSide side = OrderSide::BUY;
+    OrderType order_type = OrderType::LIMIT;
+    uint8_t reserved[5] = {};
+
+    std::string getSymbol() const { return std::string(symbol, strnlen(symbol, sizeof(symbol))); }
+
+    void setSymbol(const std::string& value) {
+        std::memset(symbol, 0, sizeof(symbol));
+        std::memcpy(symbol, value.data(), value.size() < sizeof(symbol) ? value.size() : sizeof(symbol));
+    }
+};
+static_assert(sizeof(OrderEvent) == 80, "OrderEvent is an on-disk format");
+static_assert(std::is_trivially_copyable<OrderEvent>::value, "OrderEvent must be trivially copyable");
+
+inline const char* toString(OrderEventType type) {
+    switch (type) {
+        case OrderEventType::ACCEPTED: return "ACCEPTED";
+        case OrderEventType::PARTIALLY_FILLED: return "PARTIALLY_FILLED";
+        case OrderEventType::FILLED: return "FILLED";
+        case OrderEventType::AMENDED: return "AMENDED";
+        case OrderEventType::CANCELLED: return "CANCELLED";
+        case OrderEventType::EXPIRED: return "EXPIRED";
+    }
+    return "UNKNOWN";
+}
+
+} // namespace matching_engine
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "matching_engine/engine_shard.hpp"
+#include "matching_engine/latency_histogram.hpp"
+#include "matching_engine/order_event.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Tuning for OutputSequencer
+ */
+struct SequencerOptions {
+    size_t ring_capacity = 1 << 16;                ///< Events buffered per input (rounded up to a power of two)
+    size_t max_batch = 1024;                       ///< Most events handed to the callback at once
+    std::chrono::microseconds idle_wait{50};       ///< Sleep when no input has anything that may go out
+};
+
+/**
+ * @brief An event in the sequencer's single, gap-free output stream
+ */
+struct SequencedEvent {
+    uint64_t sequence = 0;    ///< Global sequence, 1, 2, 3, ... across all inputs
+    uint32_t input = 0;       ///< Input (shard) the event came from, in attach order
+    OrderEvent event;         ///< As the shard's engine published it (event.sequence is the shard's own)
+};
+
+/**
+ * @brief Counters of an OutputSequencer
+ */
+struct SequencerStatistics {
+    uint64_t events = 0;              ///< Events sequenced
+    uint64_t batches = 0;             ///< Callback invocations
+    uint64_t producer_stalls = 0;     ///< Times an input's ring was full and its shard had to wait
+    uint64_t clamped = 0;             ///< Events whose timestamp went backwards within their input (ordered at the input's previous time)
+    uint64_t input_gaps = 0;          ///< Events whose shard sequence didn't follow the previous one
+    size_t inputs = 0;
+};
+
+/**
+ * @brief Merges the event streams of several shards into one totally ordered, gap-free stream
+ *
+ * Each input (one per shard, usually attached with attach()) owns a single-producer ring
+ * written on its shard's thread; nothing is shared between shards, so the sequencer adds
+ * no lock or atomic counter to the matching path. The sequencer thread merges the rings by
+ * (timestamp, input, shard sequence), which makes the order a function of the streams alone:
+ * every replay of the same shard streams gives the same global sequence, and a command's
+ * events (which share one timestamp) stay together.
+ *
+ * An event may only go out once no input can still produce an earlier one. Every input
+ * publishes a watermark: the time its next event can't precede. A shard moves it forward
+ * whenever it publishes and after every batch and idle wait, so the delay the sequencer
+ * adds is bounded by the slowest shard's idle wait (ShardOptions::idle_wait) plus its own.
+ * A stopped or closed input stops holding the others back.
+ *
+ * The callback runs on the sequencer thread with up to max_batch events at a time.
+ */
+class OutputSequencer {
+    public:
+        using EventCallback = std::function<void(const SequencedEvent*, size_t)>;
+
+        /**
+         * @brief One shard's ring into the sequencer (single producer)
+         *
+         * publish() and heartbeat() must be called from one thread at a time, and the
+         * timestamps they carry must not run ahead of what that producer stamps later:
+         * attach() satisfies this by only feeding the ring from the shard's matcher thread.
+         */
+        class Input {
+            private:
+                friend class OutputSequencer;
+
+                struct Slot {
+                    int64_t key;          // event time, never below the input's previous key
+                    OrderEvent event;
+                };
+
+                std::vector<Slot> slots_;
+                size_t mask_;
+                alignas(64) std::atomic<uint64_t> head_{0};          // next slot the producer writes
+                std::atomic<int64_t> watermark_{INT64_MIN};          // no later event is keyed below this
+                std::atomic<bool> closed_{false};
+                uint64_t cached_tail_ = 0;                           // producer's view of tail_
+                int64_t floor_ = INT64_MIN;                          // producer: largest key / heartbeat so far
+                uint64_t last_sequence_ = 0;                         // producer: previous shard sequence
+                std::atomic<uint64_t> stalls_{0};
+                std::atomic<uint64_t> clamped_{0};
+                std::atomic<uint64_t> gaps_{0};
+                alignas(64) std::atomic<uint64_t> tail_{0};          // next slot the sequencer reads
+
+            public:
+                explicit Input(size_t capacity);
+
+                /**
+                 * @brief Append a command's events, waiting while the ring is full
+                 *
+                 * Dropped once the input is closed.
+                 */
+                void publish(const OrderEvent* events, size_t count);
+
+                /**
+                 * @brief Promise that no event published from now on is stamped before now_ns
+                 */
+                void heartbeat(int64_t now_ns);
+
+                /**
+                 * @brief No more events: the sequencer stops waiting for this input
+                 */
+                void close();
+        };
+
+    private:
+        SequencerOptions options_;
+        EventCallback on_events_;
+        std::vector<std::shared_ptr<Input>> inputs_;   // shared: engine and shard callbacks can outlive the sequencer
+        std::thread thread_;
+        std::atomic<bool> stopping_{false};
+        std::atomic<uint64_t> events_{0};
+        std::atomic<uint64_t> batches_{0};
+        std::unique_ptr<LatencyHistogram> delay_;      // event timestamp -> handed to the callback
+
+        // Sequencer thread's view of each input
+        struct Cursor {
+            Input* input;
+            uint64_t tail = 0;
+            uint64_t head = 0;    // last head_ seen
+        };
+        std::vector<Cursor> cursors_;
+
+        void run();
+        void merge(std::vector<SequencedEvent>& out, uint64_t& next_sequence);
+        void deliver(const std::vector<SequencedEvent>& out);
+
+    public:
+        explicit OutputSequencer(const SequencerOptions& options = SequencerOptions{});
+
+        /**
+         * @brief Stops the sequencer, delivering what is still buffered
+         */
+        ~OutputSequencer();
+
+        OutputSequencer(const OutputSequencer&) = delete;
+        OutputSequencer& operator=(const OutputSequencer&) = delete;
+
+        /**
+         * @brief Set the callback receiving the ordered stream (call before start())
+         */
+        void setEventCallback(EventCallback callback) { on_events_ = std::move(callback); }
+
+        /**
+         * @brief Add an input fed by hand (call before start())
+         * @return The input; its index in the output is the number of inputs added before it
+         */
+        Input& addInput();
+
+        /**
+         * @brief Feed a shard's event stream into a new input (call before start() and shard.start())
+         *
+         * Registers an event batch callback on the shard's engine and sets the shard's tick
+         * callback (replacing any other); the engine must only be driven through this shard. The input closes when
+         * the shard's matcher thread exits.
+         * @return The input's index
+         */
+        size_t attach(EngineShard& shard);
+
+        /**
+         * @brief Start the sequencer thread
+         */
+        void start();
+
+        /**
+         * @brief Close every input, deliver what they hold and join the sequencer thread
+         *
+         * Stop the producers first: events published afterwards are dropped.
+         */
+        void stop();
+
+        size_t getInputCount() const { return inputs_.size(); }
+        SequencerStatistics getStatistics() const;
+
+        /**
+         * @brief Distribution of event timestamp -> delivery (includes waiting for the slowest input)
+         */
+        const LatencyHistogram& getDelay() const { return *delay_; }
+};
+
+} // namespace matching_engine
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "matching_engine/engine_command.hpp"
+#include "matching_engine/types.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief How a parent order releases its children
+ */
+enum class ParentAlgo : uint8_t {
+    TWAP = 0,    ///< Equal slices spread evenly over a duration
+    POV = 1      ///< A fixed share of the symbol's traded volume
+};
+
+enum class ParentStatus : uint8_t {
+    WORKING = 0,
+    COMPLETED = 1,    ///< Filled in full
+    CANCELLED = 2,    ///< Cancelled on request; working children were cancelled with it
+    REJECTED = 3      ///< A child was refused by the engine; the rest were cancelled
+};
+
+/**
+ * @brief A parent order as submitted to an EngineShard
+ *
+ * Children are limit orders at limit_price for the parent's account and session.
+ */
+struct ParentOrderSpec {
+    OrderId id = 0;                  ///< Parent id (its own id space, shared with no order)
+    std::string symbol;
+    OrderSide side = OrderSide::BUY;
+    Price limit_price = 0;
+    Quantity quantity = 0;
+    ParentAlgo algo = ParentAlgo::TWAP;
+    AccountId account = 0;
+    SessionId session = 0;
+
+    // TWAP: slices released at start, start + duration / slices, ...
+    std::chrono::nanoseconds duration{std::chrono::seconds(60)};
+    size_t slices = 10;
+
+    // POV: children keep released quantity at participation x volume traded by others since start
+    double participation = 0.1;      ///< In (0, 1]
+    Quantity min_child_quantity = 1; ///< Smallest child released (the last one may be smaller)
+};
+
+/**
+ * @brief Progress of a parent order, reported on every change
+ */
+struct ParentOrderState {
+    OrderId id = 0;
+    std::string symbol;
+    OrderSide side = OrderSide::BUY;
+    ParentAlgo algo = ParentAlgo::TWAP;
+    ParentStatus status = ParentStatus::WORKING;
+    Quantity quantity = 0;
+    Quantity released = 0;       ///< Sent to the book as children (less children cancelled by others)
+    Quantity filled = 0;
+    Quantity working = 0;        ///< Live in children: released - filled
+    size_t children = 0;         ///< Children released so far
+    OrderId last_child = 0;      ///< Id of the most recent child
+};
+
+inline const char* toString(ParentStatus status) {
+    switch (status) {
+        case ParentStatus::WORKING: return "WORKING";
+        case ParentStatus::COMPLETED: return "COMPLETED";
+        case ParentStatus::CANCELLED: return "CANCELLED";
+        case ParentStatus::REJECTED: return "REJECTED";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief Engine-resident TWAP / POV parent orders (state of one shard, used by its matcher thread only)
+ *
+ * The shard feeds it the clock (onTimer, between batches) and every command result
+ * (onResult); both append the child commands to apply next. TWAP parents wait in a heap
+ * keyed by the time of their next slice and POV parents in a per-symbol heap keyed by the
+ * traded volume at which their next child is due, so a tick or a trade only touches the
+ * parents that actually release something: O(1) per event plus O(log n) per child.
+ *
+ * Children get ids counting up from first_child_id, tagged with Order::setParent so order
+ * callbacks show which parent they belong to. A child cancelled by someone else returns its
+ * quantity to the parent, which releases it again. Finished parents are reported once more
+ * with their final status and then forgotten.
+ */
+class ParentOrderScheduler {
+    public:
+        using StateCallback = std::function<void(const ParentOrderState&)>;
+
+    private:
+        struct Parent {
+            ParentOrderSpec spec;
+            ParentOrderState state;
+            int64_t interval_ns = 0;          // TWAP: time between slices
+            int64_t next_slice_ns = 0;        // TWAP: when the next slice is due (key of its heap entry)
+            size_t slices_released = 0;
+            Quantity volume_at_start = 0;     // POV: symbol volume when the parent arrived
+            Quantity next_volume = 0;         // POV: volume at which the next child is due (key of its heap entry)
+            std::unordered_set<OrderId> live_children;
+        };
+
+        struct Child {
+            OrderId parent;
+            Quantity remaining;
+        };
+
+        template <typename Key>
+        using MinHeap = std::priority_queue<std::pair<Key, OrderId>, std::vector<std::pair<Key, OrderId>>,
+                                            std::greater<std::pair<Key, OrderId>>>;
+
+        // Volume traded on a symbol (children excluded) while it has POV parents
+        struct Flow {
+            Quantity volume = 0;
+            MinHeap<Quantity> due;
+            size_t parents = 0;
+        };
+
+        std::unordered_map<OrderId, Parent> parents_;
+        std::unordered_map<OrderId, Child> children_;
+        std::unordered_map<std::string, Flow> flows_;
+        MinHeap<int64_t> slices_due_;                 // TWAP; stale entries are skipped
+        OrderId next_child_id_;
+        int64_t now_ns_ = 0;                          // last clock reading seen
+        uint64_t children_released_ = 0;
+        StateCallback on_state_;
+
+        void release(Parent& parent, Quantity quantity, std::vector<EngineCommand>& out);
+        void releaseSlice(Parent& parent, std::vector<EngineCommand>& out);
+        void releaseParticipation(Parent& parent, Quantity volume, std::vector<EngineCommand>& out);
+        void scheduleParticipation(Parent& parent, Flow& flow);
+        void recordFill(OrderId child_id, Quantity quantity, std::vector<EngineCommand>& out);
+        void recordVolume(const std::string& symbol, Quantity quantity, std::vector<EngineCommand>& out);
+        void finish(OrderId parent_id, ParentStatus status, std::vector<EngineCommand>& out);
+        void report(const Parent& parent);
+
+    public:
+        static constexpr OrderId DEFAULT_FIRST_CHILD_ID = OrderId{1} << 60;
+
+        /**
+         * @param first_child_id First id given to a child (keep client order ids below it)
+         */
+        explicit ParentOrderScheduler(OrderId first_child_id = DEFAULT_FIRST_CHILD_ID) : next_child_id_(first_child_id) {}
+
+        /**
+         * @brief Check a parent order without adding it
+         * @throws std::invalid_argument describing the first problem found
+         */
+        static void validate(const ParentOrderSpec& spec);
+
+        /**
+         * @brief Set the callback receiving parent state changes (on the matcher thread)
+         */
+        void setStateCallback(StateCallback callback) { on_state_ = std::move(callback); }
+
+        /**
+         * @brief Start working a parent order (TWAP releases its first slice right away)
+         * @throws std::invalid_argument if the spec is invalid or its id is working already
+         */
+        void add(const ParentOrderSpec& spec, int64_t now_ns, std::vector<EngineCommand>& out);
+
+        /**
+         * @brief Cancel a parent and its working children
+         * @return false if no such parent is working
+         */
+        bool cancel(OrderId parent_id, std::vector<EngineCommand>& out);
+
+        /**
+         * @brief Release the TWAP slices due by now_ns
+         */
+        void onTimer(int64_t now_ns, std::vector<EngineCommand>& out);
+
+        /**
+         * @brief Account for a command's outcome: child fills, refusals and cancels, and traded volume
+         */
+        void onResult(const CommandResult& result, std::vector<EngineCommand>& out);
+
+        std::optional<ParentOrderState> getState(OrderId parent_id) const;
+        size_t getWorkingCount() const { return parents_.size(); }
+        uint64_t getChildrenReleased() const { return children_released_; }
+        bool empty() const { return parents_.empty(); }
+};
+
+} // namespace matching_engine
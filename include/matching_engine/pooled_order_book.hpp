@@ -0,0 +1,147 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <matching_engine/order.hpp>
+#include <map> //price levels
+#include <vector> //node pool and trade results
+#include <optional>
+#include <unordered_map> //order id -> node
+#include "matching_engine/trade.hpp"
+#include "matching_engine/memory_accounting.hpp"
+
+namespace matching_engine {
+
+/**
+ * @brief Alternative order book with pooled order nodes and O(1) cancellation
+ *
+ * Same public interface and matching semantics as OrderBook (price-time priority, passive
+ * price execution, identical trade id sequence), but:
+ * - Orders live in a pool of nodes linked into a doubly-linked FIFO list per price level,
+ *   so cancelling from the middle of a level is O(1) instead of copying the level's queue
+ * - Each level caches its total quantity and order count, so top-of-book quantity and
+ *   depth queries don't walk the orders
+ * - Freed nodes are recycled through a free list
+ *
+ * OrderBook stays the reference implementation; this one has to produce the same trades,
+ * BBO and depth for any command sequence (see fuzz/differential_fuzz.cpp).
+ */
+class PooledOrderBook {
+    public:
+        using NodeIndex = uint32_t;
+        static constexpr NodeIndex NIL = UINT32_MAX;
+
+        struct Node {
+            Order order;
+            NodeIndex prev;
+            NodeIndex next;
+        };
+
+        struct Level {
+            NodeIndex head = NIL;
+            NodeIndex tail = NIL;
+            Quantity total_quantity = 0;
+            size_t order_count = 0;
+        };
+
+        template <typename Compare>
+        using LevelMap = std::map<Price, Level, Compare, CountingAllocator<std::pair<const Price, Level>>>;
+        using NodePool = std::vector<Node, CountingAllocator<Node>>;
+        using NodeIndexMap = std::unordered_map<OrderId, NodeIndex, std::hash<OrderId>, std::equal_to<OrderId>,
+                                                CountingAllocator<std::pair<const OrderId, NodeIndex>>>;
+
+    private:
+        MemoryAccountant memory_; // must be declared before the containers using it
+
+        LevelMap<std::greater<Price>> bids_; // Descending: highest price first
+        LevelMap<std::less<Price>> asks_;    // Ascending: lowest price first
+
+        NodePool nodes_;
+        NodeIndex free_head_; // recycled nodes, linked through Node::next
+        NodeIndexMap order_nodes_;
+
+        TradeId next_trade_id_;
+        size_t order_count_;
+
+        /**
+         * @brief Match an incoming order against one side of the book
+         * @param levels The opposite side's levels, best price first
+         * @param incoming The aggressive order (filled in place)
+         * @param trades Receives the executions
+         */
+        template <typename Levels>
+        void match(Levels& levels, Order& incoming, std::vector<Trade>& trades);
+
+        /**
+         * @brief Append an order at the tail of its price level
+         */
+        void addToBook(const Order& order);
+
+        /**
+         * @brief Unlink a node from its level, erasing the level if it became empty
+         */
+        template <typename Levels>
+        void unlink(Levels& levels, typename Levels::iterator level_it, NodeIndex index);
+
+        NodeIndex allocateNode(const Order& order);
+        void releaseNode(NodeIndex index);
+
+        template <typename Levels>
+        static std::vector<std::pair<Price, Quantity>> collectLevels(const Levels& levels, size_t max_levels);
+
+        TradeId generateTradeId() { return ++next_trade_id_; }
+
+    public:
+        PooledOrderBook();
+
+        // Containers hold a pointer to memory_, so a book stays where it was built
+        PooledOrderBook(const PooledOrderBook&) = delete;
+        PooledOrderBook& operator=(const PooledOrderBook&) = delete;
+
+        /**
+         * @brief Add an order to the book and attempt matching (see OrderBook::addOrder)
+         * @param order The order to add
+         * @return Vector of trades generated from matching
+         * @throws std::invalid_argument if an order with the same id is already resting
+         */
+        std::vector<Trade> addOrder(Order order);
+
+        /**
+         * @brief Cancel an existing order in O(1)
+         * @param order_id The ID of the order to cancel
+         * @return true if order was found and cancelled
+         */
+        bool cancelOrder(OrderId order_id) { return removeOrder(order_id).has_value(); }
+
+        /**
+         * @brief Cancel an existing order and return what was resting
+         * @param order_id The ID of the order to cancel
+         * @return The removed order, or std::nullopt if not found
+         */
+        std::optional<Order> removeOrder(OrderId order_id);
+
+        std::optional<Price> getBestBid() const;
+        std::optional<Price> getBestAsk() const;
+        std::optional<Price> getSpread() const;
+        Quantity getBestBidQuantity() const { return bids_.empty() ? 0 : bids_.begin()->second.total_quantity; }
+        Quantity getBestAskQuantity() const { return asks_.empty() ? 0 : asks_.begin()->second.total_quantity; }
+
+        bool isEmpty() const { return bids_.empty() && asks_.empty(); }
+        size_t getOrderCount() const { return order_count_; }
+        bool hasOrder(OrderId order_id) const { return order_nodes_.count(order_id) != 0; }
+        size_t getBidLevelCount() const { return bids_.size(); }
+        size_t getAskLevelCount() const { return asks_.size(); }
+
+        std::vector<std::pair<Price, Quantity>> getBidLevels(size_t max_levels = 10) const;
+        std::vector<std::pair<Price, Quantity>> getAskLevels(size_t max_levels = 10) const;
+
+        std::string toString(size_t max_levels = 5) const;
+
+        /**
+         * @brief Get live heap usage of the book by category (see OrderBook::getMemoryUsage)
+         */
+        MemoryUsage getMemoryUsage() const { return memory_.getUsage(); }
+
+        void clear();
+};
+
+} // namespace matching_engine
@@ -1,5 +1,8 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "matching_engine/engine_command.hpp"
 
 namespace matching_engine {
 
@@ -13,6 +16,8 @@ enum class MessageType { // define a enum class to hold the message type
 struct Message { // define a struct to hold the message type and payload
     MessageType type;
     std::string payload;
+    int64_t receive_timestamp_ns = 0; // when the message's last byte reached the host (CLOCK_REALTIME ns), 0 if unknown
+    bool kernel_timestamp = false; // receive_timestamp_ns is the kernel's software receive timestamp, not the read time
 };
 
 // Convert MessageType to string
@@ -27,4 +32,14 @@ std::string serializeMessage(const Message& msg);
 // Deserialize a string to a message
 Message deserializeMessage(const std::string& data);
 
+// Encode a basket of new orders as one ORDER payload, a single line on the wire:
+// "SUBMIT_ORDERS|count|id,symbol,side,type,price,quantity;id,symbol,..."
+std::string encodeSubmitOrders(const Order* orders, size_t count);
+
+// Decode a SUBMIT_ORDER or SUBMIT_ORDERS payload into NEW_ORDER commands for
+// MatchingEngine::processCommands, each tagged with the given session. Returns false (leaving
+// commands untouched) if the payload is neither; throws std::invalid_argument if it is malformed
+// or holds an invalid order, in which case none of its orders are appended
+bool decodeSubmitOrders(const std::string& payload, SessionId session, std::vector<EngineCommand>& commands);
+
 } // namespace matching_engine 
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Binary reference data file: the symbols an engine lists and their trading rules
+ *
+ * Layout (all fields little-endian, fixed-size records, so the file is mapped and read in
+ * place):
+ *
+ *   ReferenceDataHeader
+ *   ReferenceRecord[symbol_count]   sorted by symbol (bytewise), no duplicates
+ */
+struct ReferenceDataHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t symbol_count;
+    uint64_t reserved;
+};
+
+struct ReferenceRecord {
+    char symbol[8] = {};      ///< Zero-padded, not null-terminated when the symbol is 8 characters
+    Price tick_size = 0;
+    Quantity lot_size = 0;
+    Price band_low = 0;
+    Price band_high = 0;
+    MatchingPolicy policy = MatchingPolicy::PRICE_TIME;
+    uint8_t reserved[7] = {};
+
+    std::string getSymbol() const;
+
+    /**
+     * @throws std::invalid_argument if the symbol is empty or longer than 8 characters
+     */
+    void setSymbol(const std::string& value);
+
+    InstrumentRules getRules() const;
+};
+
+static_assert(sizeof(ReferenceDataHeader) == 32, "ReferenceDataHeader is an on-disk format");
+static_assert(sizeof(ReferenceRecord) == 48, "ReferenceRecord is an on-disk format");
+
+/**
+ * @brief Write a reference data file, sorting the records by symbol
+ * @param path File to create or replace
+ * @param records One record per symbol
+ * @throws std::invalid_argument if a symbol appears twice
+ * @throws std::runtime_error if the file can't be written
+ */
+void writeReferenceData(const std::string& path, std::vector<ReferenceRecord> records);
+
+/**
+ * @brief Read-only mapping of a reference data file
+ *
+ * The constructor maps the file and checks the header, the size and the sort order; the
+ * records are then used in place.
+ */
+class ReferenceDataFile {
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        const ReferenceRecord* records_ = nullptr;
+        size_t count_ = 0;
+
+    public:
+        /**
+         * @param path Reference data file
+         * @throws std::runtime_error if the file is missing, truncated, unsorted or not reference data
+         */
+        explicit ReferenceDataFile(const std::string& path);
+        ~ReferenceDataFile();
+
+        ReferenceDataFile(const ReferenceDataFile&) = delete;
+        ReferenceDataFile& operator=(const ReferenceDataFile&) = delete;
+
+        size_t size() const { return count_; }
+        const ReferenceRecord* begin() const { return records_; }
+        const ReferenceRecord* end() const { return records_ + count_; }
+        const ReferenceRecord& operator[](size_t index) const { return records_[index]; }
+
+        /**
+         * @brief Binary search for a symbol's record (nullptr if not listed)
+         */
+        const ReferenceRecord* find(const std::string& symbol) const;
+};
+
+/**
+ * @brief Binary search a symbol-sorted record range (nullptr if the symbol isn't there)
+ */
+const ReferenceRecord* findReferenceRecord(const ReferenceRecord* begin, const ReferenceRecord* end, const std::string& symbol);
+
+} // namespace matching_engine
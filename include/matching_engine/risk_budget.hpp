@@ -0,0 +1,202 @@
+#pragma once
+
+#include "matching_engine/types.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Notional in hundredths of a price unit times quantity
+ *
+ * Integer so that reserving an order and later releasing its remainder in pieces always adds
+ * up exactly.
+ */
+using Notional = int64_t;
+
+constexpr Notional NOTIONAL_SCALE = 100;
+
+/**
+ * @brief Notional of quantity at price (the price is rounded to the nearest hundredth first)
+ */
+inline Notional toNotional(Price price, Quantity quantity) {
+    return static_cast<Notional>(std::llround(price * NOTIONAL_SCALE)) * static_cast<Notional>(quantity);
+}
+
+class RiskBudgetPool;
+
+/**
+ * @brief One shard's slices of the account budgets in a RiskBudgetPool
+ *
+ * Owned by the shard's matching thread: tryReserve() and release() must only be called from
+ * that thread. The common case touches nothing but this shard's own cache lines; the pool's
+ * lock is taken only the first time an account is seen and when a slice runs dry.
+ */
+class ShardRiskBudget {
+    private:
+        friend class RiskBudgetPool;
+        struct Slice;
+
+        RiskBudgetPool& pool_;
+        size_t index_;
+        uint64_t generation_ = 0;                        // pool account generation cache_ was built for
+        std::unordered_map<AccountId, Slice*> cache_;    // nullptr = account has no limit
+        uint64_t refills_ = 0;
+        uint64_t rejections_ = 0;
+
+        ShardRiskBudget(RiskBudgetPool& pool, size_t index) : pool_(pool), index_(index) {}
+        Slice* slice(AccountId account);
+
+    public:
+        ShardRiskBudget(const ShardRiskBudget&) = delete;
+        ShardRiskBudget& operator=(const ShardRiskBudget&) = delete;
+
+        /**
+         * @brief Take notional from the account's budget
+         *
+         * Served from this shard's slice; when it is short, the shard refills from the pool
+         * (taking unused budget back from other shards if the pool is empty) before giving up.
+         * @param account The account (accounts without a limit always succeed)
+         * @param notional Amount to reserve (>= 0)
+         * @return false if the account's global limit would be exceeded
+         */
+        bool tryReserve(AccountId account, Notional notional);
+
+        /**
+         * @brief Give notional back to the account's budget (e.g. a cancelled remainder)
+         * @param account The account
+         * @param notional Amount previously reserved on any shard
+         */
+        void release(AccountId account, Notional notional);
+
+        /**
+         * @brief Budget currently held in this shard's slice (0 for accounts without a limit)
+         */
+        Notional getLocalAvailable(AccountId account);
+
+        size_t getIndex() const noexcept { return index_; }
+        uint64_t getRefillCount() const noexcept { return refills_; }
+        uint64_t getRejectionCount() const noexcept { return rejections_; }
+};
+
+/**
+ * @brief Per-account notional limits split into shard-local slices
+ *
+ * Each account's limit is held partly in the pool (unallocated) and partly in one slice per
+ * shard. A shard reserves from its own slice and only comes back to the pool when the slice
+ * can't cover an order; the pool then makes the reservation itself (pulling idle budget from
+ * other shards if it has to) and tops the slice up with refill_chunk. The optional background
+ * rebalancer returns surplus (anything above two chunks) from slices to the pool, so busy
+ * shards are refilled from the pool rather than by taking from other shards.
+ *
+ * For every account, at all times:
+ *   limit == unallocated + sum of slices + everything reserved and not yet released
+ * so the limit holds globally no matter how orders are spread over shards.
+ */
+class RiskBudgetPool {
+    private:
+        friend class ShardRiskBudget;
+
+        struct Account {
+            Notional limit = 0;
+            Notional unallocated = 0;
+            std::unique_ptr<ShardRiskBudget::Slice[]> slices; // one per shard
+        };
+
+        Notional refill_chunk_;
+        std::vector<std::unique_ptr<ShardRiskBudget>> shards_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<AccountId, Account> accounts_;  // never erased: shards cache slice pointers
+        std::atomic<uint64_t> generation_{0};              // bumped when an account is added
+
+        std::thread rebalancer_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+        uint64_t rebalanced_ = 0;                          // notional moved by rebalance()
+
+        ShardRiskBudget::Slice* findSlice(AccountId account, size_t shard);
+        bool reserveFromPool(size_t shard, AccountId account, Notional notional); // slow path of tryReserve
+        static Notional takeFromSlice(ShardRiskBudget::Slice& slice, Notional keep);
+        Notional reclaim(Account& account, Notional wanted, size_t skip_shard); // wanted -1 = everything
+
+    public:
+        /**
+         * @param shards Number of shard budgets (one per matching thread)
+         * @param refill_chunk Extra budget a shard takes on each refill, so it comes back rarely
+         */
+        RiskBudgetPool(size_t shards, Notional refill_chunk);
+
+        /**
+         * @brief Stops the rebalancer; the shard budgets die with the pool
+         */
+        ~RiskBudgetPool();
+
+        RiskBudgetPool(const RiskBudgetPool&) = delete;
+        RiskBudgetPool& operator=(const RiskBudgetPool&) = delete;
+
+        /**
+         * @brief Set (or change) an account's global notional limit
+         *
+         * Lowering a limit pulls all unused budget back from the shards, so it takes effect
+         * for the next reservation on every shard. If more is already reserved than the new
+         * limit, reservations fail until enough has been released.
+         * @throws std::invalid_argument if limit is negative
+         */
+        void setAccountLimit(AccountId account, Notional limit);
+
+        ShardRiskBudget& getShard(size_t index) { return *shards_.at(index); }
+        size_t getShardCount() const noexcept { return shards_.size(); }
+
+        /**
+         * @brief Budget not reserved anywhere: the pool's plus every shard's slice
+         * @return The account's unused budget, or -1 if it has no limit
+         */
+        Notional getAvailable(AccountId account) const;
+
+        /**
+         * @brief Budget held by the pool itself (not in any shard's slice)
+         */
+        Notional getUnallocated(AccountId account) const;
+
+        /**
+         * @brief One rebalancing pass: return slice surplus above two refill chunks to the pool
+         * @return Notional moved back to the pool
+         */
+        Notional rebalance();
+
+        /**
+         * @brief Run rebalance() on a background thread every interval
+         */
+        void startRebalancer(std::chrono::milliseconds interval);
+
+        /**
+         * @brief Stop the background rebalancer (no-op if not running)
+         */
+        void stopRebalancer();
+
+        /**
+         * @brief Total notional rebalance() has moved back to the pool
+         */
+        uint64_t getRebalancedNotional() const;
+};
+
+/**
+ * @brief A shard's slice of one account's budget, alone on its cache line
+ *
+ * Atomic only so that refills and the rebalancer can take budget back; the owning shard's
+ * reserve and release are uncontended and stay in its core's cache.
+ */
+struct alignas(64) ShardRiskBudget::Slice {
+    std::atomic<Notional> available{0};
+};
+
+} // namespace matching_engine
@@ -3,26 +3,93 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "matching_engine/protocol.hpp"
+#include "matching_engine/latency_histogram.hpp"
 
 namespace matching_engine {
 
+/**
+ * @brief Where time goes between a command reaching the host and the server finishing with it
+ *
+ * Both histograms start at Message::receive_timestamp_ns, i.e. the kernel receive timestamp
+ * when SO_TIMESTAMPING is available, so time spent in the socket buffer waiting for the
+ * io_context shows up in socket_queue instead of disappearing.
+ */
+struct ServerLatency {
+    LatencyHistogram socket_queue; // receive timestamp -> message handler starts
+    LatencyHistogram handler;      // receive timestamp -> message handler returns
+};
+
+/**
+ * @brief A client connection as handed to another process: the socket and any partial line read from it
+ */
+struct SessionHandle {
+    int fd;
+    std::string pending; // bytes received after the last newline
+};
+
 class Server { // define a class to hold the server
 public:
     using MessageHandler = std::function<void(const Message&, std::shared_ptr<boost::asio::ip::tcp::socket>)>; // define a function to handle the message
 
     Server(boost::asio::io_context& io_context, unsigned short port, MessageHandler handler); // constructor
+
+    /**
+     * @brief Serve on a socket that is already listening, e.g. one inherited in a handoff
+     * @param acceptor Acceptor over the listening socket, e.g. tcp::acceptor(io_context, tcp::v4(), fd)
+     */
+    Server(boost::asio::io_context& io_context, boost::asio::ip::tcp::acceptor acceptor, MessageHandler handler);
     void start(); // start the server
     void stop(); // stop the server
 
+    /**
+     * @brief Latency from each message's receive timestamp to its handling (thread safe to read)
+     */
+    const ServerLatency& getLatency() const { return *latency_; }
+
+    /**
+     * @brief Port the server is listening on (useful when constructed with port 0)
+     */
+    unsigned short getPort() const;
+
+    /**
+     * @brief Listening socket and open connections, for handing them to another process
+     *
+     * Call with the io_context stopped, so nothing is read from the sockets meanwhile. The
+     * descriptors stay owned by this server.
+     */
+    int getListenerHandle();
+    std::vector<SessionHandle> getSessionHandles() const;
+
+    /**
+     * @brief Take over a connection accepted elsewhere (e.g. inherited in a handoff)
+     * @param fd Connected TCP socket; the server takes ownership
+     * @param pending Partial line already read from it
+     */
+    void adoptSession(int fd, std::string pending = std::string());
+
+    /**
+     * @brief Current wall-clock time on the same clock as Message::receive_timestamp_ns
+     */
+    static int64_t nowNanos();
+
 private:
+    struct Connection; // socket plus the bytes of a partially received line
+
     void doAccept(); // accept a new connection
-    void doRead(std::shared_ptr<boost::asio::ip::tcp::socket> socket); // read a message from the socket
+    void startConnection(std::shared_ptr<Connection> connection); // enable receive timestamps and start reading
+    void doRead(std::shared_ptr<Connection> connection); // wait until the socket is readable
+    bool readAvailable(Connection& connection); // drain the socket and dispatch complete lines, false once closed
+    void dispatch(Connection& connection, std::string line, int64_t receive_ns, bool kernel_timestamp);
 
     boost::asio::io_context& io_context_; // io context -> this does the work of accepting new connections and reading data from them
     boost::asio::ip::tcp::acceptor acceptor_; // acceptor -> this is the object that accepts new connections
     MessageHandler message_handler_; // message handler -> this is the function that handles the message
     bool running_; // running -> this is the flag that indicates if the server is running
+    std::unique_ptr<ServerLatency> latency_; // histograms are large and must not move
+    std::unordered_map<Connection*, std::weak_ptr<Connection>> connections_; // open connections, for handoff
 };
 
-} // namespace matching_engine 
\ No newline at end of file
+} // namespace matching_engine
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief One class of background work and its budgets
+ */
+struct TaskClass {
+    std::string name;
+    std::chrono::microseconds quantum{50};              ///< Longest slice a task of this class should run before yielding
+    std::chrono::microseconds latency_budget{10000};    ///< Longest a runnable task waits for a slice while commands keep arriving
+};
+
+/**
+ * @brief Counters of one task class (finished tasks included)
+ */
+struct TaskClassStatistics {
+    std::string name;
+    uint64_t tasks = 0;              ///< Tasks added to the class
+    uint64_t slices = 0;
+    uint64_t cpu_nanos = 0;          ///< Thread CPU time spent in the class's slices
+    uint64_t wall_nanos = 0;         ///< Wall time of those slices
+    uint64_t max_slice_nanos = 0;
+    uint64_t max_wait_nanos = 0;     ///< Longest a runnable task waited for a slice
+    uint64_t overruns = 0;           ///< Slices longer than twice the quantum (the task's steps are too big, or it didn't check shouldYield)
+    uint64_t budget_misses = 0;      ///< Slices that started after waiting longer than the latency budget
+};
+
+/**
+ * @brief Counters of one live task
+ */
+struct TaskStatistics {
+    uint32_t id = 0;
+    std::string name;
+    size_t task_class = 0;
+    uint64_t slices = 0;
+    uint64_t cpu_nanos = 0;
+    uint64_t wall_nanos = 0;
+    uint64_t max_slice_nanos = 0;
+    uint64_t max_wait_nanos = 0;
+    uint64_t completions = 0;        ///< Times the task returned false (once per period for periodic tasks)
+};
+
+/**
+ * @brief What a background task sees while it runs: when to hand the thread back
+ */
+class TaskSlice {
+    private:
+        int64_t deadline_ns_;
+        const std::function<bool()>* commands_waiting_;   // nullptr: only the quantum counts
+
+    public:
+        TaskSlice(int64_t deadline_ns, const std::function<bool()>* commands_waiting)
+            : deadline_ns_(deadline_ns), commands_waiting_(commands_waiting) {}
+
+        /**
+         * @brief True once the quantum is used up or commands are waiting; check between small steps
+         */
+        bool shouldYield() const;
+};
+
+/**
+ * @brief Cooperative scheduler for a shard's background work, run on the matcher thread
+ *
+ * Tasks (timers, snapshots, compaction, stats aggregation...) do their work in steps,
+ * checking TaskSlice::shouldYield() between them, and return true while they have more to do.
+ * The matcher calls runSlices() between command batches. Each call is one round: with no
+ * commands waiting every runnable task gets a slice, longest-waiting first, until commands
+ * arrive; with commands waiting only a task that has waited past its class's latency budget
+ * gets one, so background work never starves but never delays a batch by more than a quantum
+ * either. Periodic tasks become runnable every period and rest after returning false;
+ * one-shot tasks are dropped once they return false. CPU time is measured per slice with
+ * CLOCK_THREAD_CPUTIME_ID.
+ *
+ * addClass() and addTask() are thread safe; tasks only ever run on the thread calling runSlices().
+ */
+class ShardScheduler {
+    public:
+        using Task = std::function<bool(TaskSlice&)>;
+        using TaskId = uint32_t;
+
+    private:
+        struct Entry {
+            TaskId id;
+            std::string name;
+            size_t task_class;
+            Task task;
+            int64_t quantum_ns;          // copied from the class so the matcher never reads classes_
+            int64_t budget_ns;
+            int64_t period_ns;           // 0: one-shot
+            int64_t next_due_ns;         // periodic: when it next becomes runnable
+            int64_t runnable_since_ns;   // -1: not runnable
+            bool finished = false;       // one-shot that returned false, removed after the round
+            TaskStatistics stats;
+        };
+
+        std::function<bool()> commands_waiting_;
+
+        // Guards the classes, the statistics and changes to entries_ / added_. The matcher
+        // thread is the only one changing entries_, so it reads the list without the lock.
+        mutable std::mutex mutex_;
+        std::vector<TaskClass> classes_;
+        std::vector<TaskClassStatistics> class_stats_;
+        std::vector<std::unique_ptr<Entry>> entries_;
+        std::vector<std::unique_ptr<Entry>> added_;   // waiting to join entries_ on the matcher thread
+        std::atomic<bool> added_pending_{false};
+        TaskId next_id_ = 1;
+        std::vector<Entry*> ready_;                   // runSlices scratch, matcher thread only
+
+        void adoptAdded();
+        void runSlice(Entry& entry, int64_t now, bool yield_to_commands);
+
+    public:
+        /**
+         * @param commands_waiting Cheap check (any thread-safe predicate) that the matcher has work
+         */
+        explicit ShardScheduler(std::function<bool()> commands_waiting = nullptr);
+
+        /**
+         * @brief Register a task class
+         * @return Index to pass to addTask
+         * @throws std::invalid_argument if the quantum or the latency budget is not positive
+         */
+        size_t addClass(const TaskClass& task_class);
+
+        /**
+         * @brief Add a task; it becomes runnable at once (one-shot) or after its first period
+         * @param task_class Index returned by addClass
+         * @param name Shown in the statistics
+         * @param task Returns true while it has more work in hand
+         * @param period How often a periodic task becomes runnable (0: one-shot)
+         * @throws std::invalid_argument if the class is unknown or the task empty
+         */
+        TaskId addTask(size_t task_class, std::string name, Task task, std::chrono::microseconds period = std::chrono::microseconds(0));
+
+        /**
+         * @brief Give background work slices (matcher thread, between batches)
+         * @return Number of slices run
+         */
+        size_t runSlices();
+
+        /**
+         * @brief How long the matcher may sleep before a task needs a slice (zero if one is runnable)
+         * @param longest Returned when no task is due sooner
+         */
+        std::chrono::microseconds timeUntilDue(std::chrono::microseconds longest) const;
+
+        std::vector<TaskClassStatistics> getClassStatistics() const;
+        std::vector<TaskStatistics> getTaskStatistics() const;
+};
+
+} // namespace matching_engine
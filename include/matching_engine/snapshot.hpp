@@ -0,0 +1,104 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <matching_engine/order_book.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Binary image of a set of order books as of one journal sequence
+ *
+ * Layout (all fields little-endian, no pointers, so it can be written to a file or a shared
+ * memory region and read back in place):
+ *
+ *   SnapshotHeader
+ *   SnapshotBookEntry[book_count]   sorted by symbol
+ *   SnapshotOrder[...]              each book's resting orders in priority order
+ *
+ * Restoring one book only touches its directory entry and its own orders.
+ */
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t book_count;
+    uint64_t sequence;       ///< Last journal sequence reflected in the books
+    int64_t timestamp_ns;    ///< Journal timestamp of that command
+    uint64_t total_size;     ///< Size of the whole image in bytes
+};
+
+struct SnapshotBookEntry {
+    char symbol[8];
+    uint64_t first_order;    ///< Index of the book's first SnapshotOrder
+    uint64_t order_count;
+    TradeId last_trade_id;
+};
+
+struct SnapshotOrder {
+    OrderId order_id;
+    Price price;
+    Quantity quantity;
+    Quantity remaining_quantity;
+    AccountId account;
+    OrderSide side;
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(SnapshotHeader) == 40, "SnapshotHeader is an on-disk format");
+static_assert(sizeof(SnapshotBookEntry) == 32, "SnapshotBookEntry is an on-disk format");
+static_assert(sizeof(SnapshotOrder) == 48, "SnapshotOrder is an on-disk format");
+
+/**
+ * @brief Serialize order books into a snapshot image
+ * @param sequence Last journal sequence reflected in the books
+ * @param timestamp_ns Journal timestamp of that command
+ * @param books (symbol, book) pairs; symbols must be unique and at most 8 characters
+ * @return The encoded image
+ */
+std::string encodeSnapshot(uint64_t sequence, int64_t timestamp_ns,
+                           const std::vector<std::pair<std::string, const OrderBook*>>& books);
+
+/**
+ * @brief Read-only view over an encoded snapshot image (in memory or mmap'd)
+ *
+ * The view does not own the bytes; they must outlive it.
+ */
+class SnapshotView {
+    private:
+        const char* data_;
+        size_t size_;
+        SnapshotHeader header_;
+
+        SnapshotBookEntry entryAt(size_t index) const;
+
+    public:
+        /**
+         * @param data Start of the image
+         * @param size Bytes available at data
+         * @throws std::runtime_error if the image is malformed or truncated
+         */
+        SnapshotView(const void* data, size_t size);
+
+        uint64_t getSequence() const { return header_.sequence; }
+        int64_t getTimestamp() const { return header_.timestamp_ns; }
+        size_t getBookCount() const { return header_.book_count; }
+        size_t getSize() const { return header_.total_size; }
+
+        /**
+         * @brief Symbols present in the snapshot, sorted
+         */
+        std::vector<std::string> getSymbols() const;
+
+        /**
+         * @brief Rebuild one symbol's book from the snapshot
+         * @param symbol The symbol to restore
+         * @param book Destination; cleared if the symbol isn't in the snapshot
+         * @return true if the symbol was present
+         */
+        bool restoreBook(const std::string& symbol, OrderBook& book) const;
+};
+
+} // namespace matching_engine
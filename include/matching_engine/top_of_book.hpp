@@ -0,0 +1,97 @@
+#pragma once
+
+#include <matching_engine/types.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstring> //for memcpy into/out of the seqlock words
+#include <type_traits>
+
+namespace matching_engine {
+
+/**
+ * @brief Top-of-book state plus signals derived from the top K levels
+ *
+ * Prices and quantities are 0 for an empty side; the derived signals are 0 when the
+ * inputs they need are missing (e.g. microprice needs both sides).
+ */
+struct TopOfBook {
+    Price best_bid = 0;
+    Price best_ask = 0;
+    Quantity best_bid_quantity = 0;
+    Quantity best_ask_quantity = 0;
+
+    Quantity bid_depth_quantity = 0; ///< Total quantity over the top K bid levels
+    Quantity ask_depth_quantity = 0; ///< Total quantity over the top K ask levels
+
+    /// (bid depth - ask depth) / (bid depth + ask depth) over the top K levels, in [-1, 1]
+    double imbalance = 0.0;
+
+    /// Best bid/ask weighted by the opposite side's best quantity
+    double microprice = 0.0;
+
+    /// Midpoint of the volume-weighted average bid and ask over the top K levels
+    double depth_weighted_mid = 0.0;
+
+    uint64_t depth_levels = 0; ///< K used for the depth-based signals
+    uint64_t sequence = 0;     ///< Increments every time the book publishes a change
+
+    bool hasBid() const noexcept { return best_bid_quantity > 0; }
+    bool hasAsk() const noexcept { return best_ask_quantity > 0; }
+};
+
+/**
+ * @brief Single-writer, many-reader seqlock holding the latest TopOfBook
+ *
+ * The book (under the engine's exclusive lock) publishes; readers copy the snapshot without
+ * taking any lock and retry only if they raced a publish. The payload is stored as relaxed
+ * atomic words so concurrent copies are well-defined.
+ */
+class TopOfBookSnapshot {
+    private:
+        static_assert(std::is_trivially_copyable<TopOfBook>::value, "TopOfBook must be trivially copyable");
+        static_assert(sizeof(TopOfBook) % sizeof(uint64_t) == 0, "TopOfBook must be a whole number of words");
+        static constexpr size_t WORDS = sizeof(TopOfBook) / sizeof(uint64_t);
+
+        alignas(64) std::atomic<uint64_t> version_{0}; // odd while a publish is in progress
+        std::atomic<uint64_t> words_[WORDS] = {};
+
+    public:
+        /**
+         * @brief Publish a new snapshot (single writer only)
+         * @param top The state to publish
+         */
+        void publish(const TopOfBook& top) noexcept {
+            uint64_t raw[WORDS];
+            std::memcpy(raw, &top, sizeof(TopOfBook));
+
+            uint64_t version = version_.load(std::memory_order_relaxed);
+            version_.store(version + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; ++i) {
+                words_[i].store(raw[i], std::memory_order_relaxed);
+            }
+            version_.store(version + 2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Read a consistent copy of the latest snapshot without locking
+         * @return The most recently published TopOfBook
+         */
+        TopOfBook read() const noexcept {
+            uint64_t raw[WORDS];
+            while (true) {
+                uint64_t before = version_.load(std::memory_order_acquire);
+                if (before & 1) continue; // publish in progress
+                for (size_t i = 0; i < WORDS; ++i) {
+                    raw[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (version_.load(std::memory_order_relaxed) == before) break;
+            }
+            TopOfBook top;
+            std::memcpy(&top, raw, sizeof(TopOfBook));
+            return top;
+        }
+};
+
+} // namespace matching_engine
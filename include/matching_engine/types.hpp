@@ -34,6 +34,30 @@ using Quantity = uint64_t;
  */
 using TradeId = uint64_t;
 
+/**
+ * @brief Trading account an order belongs to (0 = unspecified)
+ */
+using AccountId = uint64_t;
+
+/**
+ * @brief Client session (connection) an order arrived on (0 = none)
+ * 
+ * Client order ids only have to be unique within a session; duplicates are detected per session.
+ */
+using SessionId = uint64_t;
+
+/**
+ * @brief Handle of a linked (one-cancels-other) order group inside its book (0 = not linked)
+ * 
+ * A slot index, so a member reaches its group and siblings without an id lookup.
+ */
+using LinkId = uint32_t;
+
+/**
+ * @brief Handle of a registered engine callback, for unregistering it (0 = none)
+ */
+using CallbackId = uint64_t;
+
 /**
  * @brief Symbol type for trading instruments
  */
@@ -89,6 +113,27 @@ enum class TradeSide : uint8_t {
     SELL = 1   ///< Trade initiated by a sell order
 };
 
+/**
+ * @brief How a book allocates fills among resting orders at a price
+ * 
+ * Only price-time (FIFO) priority is implemented; the field exists so reference data can
+ * say so explicitly and other policies can be rejected rather than silently ignored.
+ */
+enum class MatchingPolicy : uint8_t {
+    PRICE_TIME = 0   ///< Best price first, then arrival order within a level
+};
+
+/**
+ * @brief Trading rules of one instrument, enforced by its book (zero fields are not checked)
+ */
+struct InstrumentRules {
+    Price tick_size = 0;      ///< Limit and trigger prices must be whole multiples of this
+    Quantity lot_size = 0;    ///< Quantities must be whole multiples of this
+    Price band_low = 0;       ///< Lowest limit price accepted
+    Price band_high = 0;      ///< Highest limit price accepted
+    MatchingPolicy policy = MatchingPolicy::PRICE_TIME;
+};
+
 
 // Constants
 /**
@@ -121,6 +166,11 @@ constexpr Quantity MIN_QUANTITY = 1;
  */
 constexpr Quantity MAX_QUANTITY = 1e9;
 
+/**
+ * @brief LinkId of an order that belongs to no group
+ */
+constexpr LinkId NO_LINK = 0;
+
 /**
  * @brief Price used for market orders (convention: 0 means "any price")
  */
@@ -212,4 +262,14 @@ constexpr bool isValidQuantity(Quantity quantity) noexcept {
     return quantity >= MIN_QUANTITY && quantity <= MAX_QUANTITY;
 }
 
+/**
+ * @brief Check that instrument rules can be enforced
+ * @param rules The rules to validate
+ * @return true if no field is negative (or NaN), the band isn't empty and the policy is supported
+ */
+constexpr bool isValidRules(const InstrumentRules& rules) noexcept {
+    return rules.tick_size >= 0 && rules.band_low >= 0 && rules.band_high >= 0 &&
+           (rules.band_high == 0 || rules.band_low <= rules.band_high) && rules.policy == MatchingPolicy::PRICE_TIME;
+}
+
 }
\ No newline at end of file
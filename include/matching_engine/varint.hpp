@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace matching_engine {
+
+// LEB128 varints and zigzag signed encoding shared by the compact wire formats
+// (market data, drop copy). Multi-byte values are little-endian like the rest of the formats.
+
+constexpr size_t MAX_VARINT_BYTES = 10;
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline uint8_t* writeVarint(uint8_t* p, uint64_t value) {
+    if (value < 0x80) { // most quantities and ids: one byte
+        *p = static_cast<uint8_t>(value);
+        return p + 1;
+    }
+    do {
+        *p++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    } while (value >= 0x80);
+    *p++ = static_cast<uint8_t>(value);
+    return p;
+}
+
+/**
+ * @brief Read a LEB128 varint, advancing p
+ *
+ * With 8 readable bytes, values up to 8 bytes long are decoded without per-byte branches:
+ * the terminating byte is found from the continuation bits and the 7-bit groups are packed
+ * together with three mask-and-shift steps.
+ * @return false if the varint runs past end or is longer than 10 bytes
+ */
+inline bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    if (p < end && *p < 0x80) {
+        value = *p++;
+        return true;
+    }
+    if (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word)); // little-endian, like the rest of the wire formats
+        uint64_t stops = ~word & 0x8080808080808080ULL;
+        if (stops != 0) {
+            unsigned length = static_cast<unsigned>(__builtin_ctzll(stops)) / 8 + 1;
+            uint64_t bytes = length == 8 ? word : word & ((uint64_t{1} << (length * 8)) - 1);
+            uint64_t x = bytes & 0x7F7F7F7F7F7F7F7FULL;
+            x = (x & 0x007F007F007F007FULL) | ((x & 0x7F007F007F007F00ULL) >> 1);
+            x = (x & 0x00003FFF00003FFFULL) | ((x & 0x3FFF00003FFF0000ULL) >> 2);
+            x = (x & 0x000000000FFFFFFFULL) | ((x & 0x0FFFFFFF00000000ULL) >> 4);
+            value = x;
+            p += length;
+            return true;
+        }
+    }
+    // Near the end of the packet, or 9-10 byte values
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace matching_engine
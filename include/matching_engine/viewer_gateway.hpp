@@ -0,0 +1,221 @@
+#pragma once
+
+#include "matching_engine/book_replica.hpp"
+#include "matching_engine/order_event.hpp"
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace matching_engine {
+
+/**
+ * @brief Encoding of the frames a viewer receives, chosen per connection (?format=json|binary)
+ */
+enum class ViewerFormat : uint8_t {
+    JSON = 0,     ///< Text frames, see ViewerGateway
+    BINARY = 1    ///< Binary frames, see decodeViewerFrame
+};
+
+/**
+ * @brief One frame as sent to viewers
+ */
+struct ViewerFrame {
+    enum Kind : uint8_t { BOOK = 1, TRADES = 2 };
+
+    Kind kind = BOOK;
+    std::string symbol;
+    uint64_t sequence = 0;                          ///< Engine event sequence the frame reflects
+    std::vector<std::pair<Price, Quantity>> bids;   ///< BOOK: highest first
+    std::vector<std::pair<Price, Quantity>> asks;   ///< BOOK: lowest first
+    uint32_t trades = 0;                            ///< TRADES: trades since the symbol's previous trade frame
+    Quantity volume = 0;
+    Price last = 0;
+    Price high = 0;
+    Price low = 0;
+};
+
+/**
+ * @brief Decode one binary viewer frame
+ *
+ * Layout (integers are LEB128 varints unless noted, prices 8-byte IEEE doubles):
+ *   kind (1 byte), symbol length (1 byte) + symbol bytes, sequence
+ *   BOOK:   bid count, ask count, then per level: price, quantity
+ *   TRADES: trades, volume, last, high, low
+ * @throws std::runtime_error if the frame is truncated or malformed
+ */
+void decodeViewerFrame(const char* data, size_t size, ViewerFrame& frame);
+
+/**
+ * @brief Tuning for ViewerGateway
+ */
+struct ViewerGatewayOptions {
+    std::string address = "0.0.0.0";
+    unsigned short port = 0;                        ///< 0 picks a free port (see getPort)
+    std::chrono::milliseconds interval{100};        ///< Conflation interval: at most one book and one trade frame per symbol per interval
+    size_t depth = 10;                              ///< Price levels per side in book frames
+    size_t max_viewers = 1024;                      ///< WebSocket connections beyond this are refused with 503
+    int send_buffer = 64 * 1024;                    ///< SO_SNDBUF of viewer connections, i.e. how far a slow viewer may fall behind before its frames conflate (0: system default)
+};
+
+/**
+ * @brief Counters of a ViewerGateway
+ */
+struct ViewerGatewayStatistics {
+    size_t viewers = 0;                 ///< Open WebSocket connections
+    uint64_t http_requests = 0;         ///< Plain HTTP requests answered
+    uint64_t events = 0;                ///< Engine events taken from the stream
+    uint64_t ticks = 0;                 ///< Conflation intervals processed
+    uint64_t frames_built = 0;          ///< Frames encoded (once per symbol, kind and format per tick)
+    uint64_t frames_sent = 0;           ///< Frames written to viewers
+    uint64_t frames_conflated = 0;      ///< Frames replaced by a newer one before a slow viewer took them
+    uint64_t bytes_sent = 0;            ///< WebSocket payload bytes written
+};
+
+/**
+ * @brief WebSocket / HTTP gateway serving live books and trades to internal UIs
+ *
+ * Browser-speed viewers never touch the order-entry Server or the engine: the engine only
+ * copies each command's events into the gateway's inbox (registerEventBatchCallback), and
+ * books are read from a BookReplica. The gateway runs its own thread and io_context. Every
+ * interval it takes the inbox, notes which symbols changed and sums their trades, then
+ * sends each changed symbol's subscribers one book frame (top depth levels per side, from
+ * the replica) and one trade frame (count, volume, last, high, low since the previous one).
+ * However fast the book moves, a viewer gets at most two frames per symbol per interval.
+ *
+ * A viewer that reads slower than that never backs up the gateway: each connection keeps at
+ * most one unsent frame per symbol and kind, and a newer frame replaces an unsent one, so a
+ * viewer's backlog is bounded by its subscriptions plus the socket's send buffer, and it
+ * always catches up to the latest state.
+ *
+ * Endpoints:
+ *   GET /ws?symbols=AAPL,MSFT&format=json    WebSocket upgrade; symbols=* follows every symbol.
+ *                                            Text messages "subscribe SYM" / "unsubscribe SYM"
+ *                                            change the subscription. A new subscription gets the
+ *                                            book on the next interval even if it didn't change.
+ *   GET /symbols                             JSON array of the replica's symbols
+ *   GET /book?symbol=AAPL                    JSON book frame
+ *   GET /stats                               JSON ViewerGatewayStatistics
+ *
+ * Query parameters are URL-decoded. A symbol a viewer names (subscription or /book) must be
+ * 1-16 letters, digits, '.', '_' or '-'; anything else is ignored (404 for /book).
+ *
+ * JSON frames:
+ *   {"type":"book","symbol":"AAPL","seq":812,"bids":[[100.01,500],...],"asks":[[100.02,300],...]}
+ *   {"type":"trades","symbol":"AAPL","seq":812,"count":3,"volume":700,"last":100.02,"high":100.02,"low":100.01}
+ *
+ * The gateway may be destroyed before the engine (it unregisters from the stream), not after it.
+ */
+class ViewerGateway {
+    private:
+        struct Viewer;
+        struct Request;
+        using Frame = std::shared_ptr<const std::string>;
+
+        // Filled on the engine's dispatch under its lock
+        struct Inbox {
+            std::mutex mutex;
+            std::vector<OrderEvent> events;
+            bool closed = false;
+        };
+
+        // Gateway thread only
+        struct SymbolState {
+            uint64_t changed_sequence = 0;   // last event not yet reflected in a book frame (0: none)
+            TradeId last_trade = 0;          // both sides of a trade carry its id: count it once
+            uint64_t trade_sequence = 0;
+            uint32_t trades = 0;
+            Quantity volume = 0;
+            Price last = 0;
+            Price high = 0;
+            Price low = 0;
+        };
+
+        MatchingEngine& engine_;
+        const BookReplica& replica_;
+        ViewerGatewayOptions options_;
+        std::shared_ptr<Inbox> inbox_;
+        CallbackId callback_id_ = 0;   // our registerEventBatchCallback, dropped by the destructor
+
+        boost::asio::io_context io_context_;
+        boost::asio::ip::tcp::acceptor acceptor_;
+        boost::asio::steady_timer timer_;
+        std::thread thread_;
+        bool started_ = false;
+
+        // Gateway thread only
+        std::vector<OrderEvent> events_;
+        std::unordered_map<std::string, SymbolState> symbols_;
+        std::unordered_set<std::shared_ptr<Viewer>> viewers_;
+        std::unordered_map<std::string, std::unordered_set<Viewer*>> subscribers_;
+        std::unordered_set<Viewer*> everything_;     // symbols=*
+        std::vector<std::pair<std::weak_ptr<Viewer>, std::string>> snapshot_requests_;
+
+        std::atomic<size_t> viewer_count_{0};
+        std::atomic<uint64_t> http_requests_{0};
+        std::atomic<uint64_t> events_seen_{0};
+        std::atomic<uint64_t> ticks_{0};
+        std::atomic<uint64_t> frames_built_{0};
+        std::atomic<uint64_t> frames_sent_{0};
+        std::atomic<uint64_t> frames_conflated_{0};
+        std::atomic<uint64_t> bytes_sent_{0};
+
+        void doAccept();
+        void readRequest(std::shared_ptr<Request> request);
+        void answer(std::shared_ptr<Request> request);
+        void openViewer(std::shared_ptr<Request> request);
+        void readViewer(std::shared_ptr<Viewer> viewer);
+        void closeViewer(const std::shared_ptr<Viewer>& viewer);
+        void subscribe(const std::shared_ptr<Viewer>& viewer, const std::string& symbol);
+        void unsubscribe(Viewer& viewer, const std::string& symbol);
+        void offer(const std::shared_ptr<Viewer>& viewer, uint8_t kind, const std::string& symbol, const Frame& frame);
+        void writeNext(std::shared_ptr<Viewer> viewer);
+        void scheduleTick();
+        void tick();
+        std::string encodeBook(const std::string& symbol, ViewerFormat format) const;
+
+    public:
+        /**
+         * @brief Bind the listening socket and start taking the engine's events
+         * @param engine Engine whose event stream the gateway follows (must outlive the gateway)
+         * @param replica Replica of the same engine the books are read from (must outlive the gateway)
+         * @param options Address, conflation interval and depth
+         * @throws std::invalid_argument if the interval or depth is zero
+         * @throws boost::system::system_error if the address can't be bound
+         */
+        ViewerGateway(MatchingEngine& engine, const BookReplica& replica, const ViewerGatewayOptions& options = ViewerGatewayOptions{});
+
+        /**
+         * @brief Close every connection, stop the gateway thread and unregister from the engine
+         */
+        ~ViewerGateway();
+
+        ViewerGateway(const ViewerGateway&) = delete;
+        ViewerGateway& operator=(const ViewerGateway&) = delete;
+
+        /**
+         * @brief Start accepting viewers and sending frames on the gateway thread
+         */
+        void start();
+
+        /**
+         * @brief Close every connection and join the gateway thread (events are dropped from then on)
+         */
+        void stop();
+
+        /**
+         * @brief Port the gateway is listening on (useful with port 0)
+         */
+        unsigned short getPort() const;
+
+        ViewerGatewayStatistics getStatistics() const;
+};
+
+} // namespace matching_engine
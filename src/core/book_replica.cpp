@@ -0,0 +1,322 @@
+#include "matching_engine/book_replica.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <pthread.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace matching_engine {
+
+BookReplica::BookReplica(MatchingEngine& engine, const ReplicaOptions& options)
+    : engine_(engine), options_(options), inbox_(std::make_shared<Inbox>()) {
+    // Subscribe before seeding: events between the two are in the inbox and skipped by sequence
+    std::shared_ptr<Inbox> inbox = inbox_;
+    callback_id_ = engine_.registerEventBatchCallback([inbox](const OrderEvent* events, size_t count) {
+        if (count == 0) return;
+        bool was_empty;
+        {
+            std::lock_guard<std::mutex> lock(inbox->mutex);
+            if (inbox->closed) return;
+            was_empty = inbox->events.empty();
+            inbox->events.insert(inbox->events.end(), events, events + count);
+            inbox->command_ends.push_back(inbox->events.size());
+        }
+        inbox->published.store(events[count - 1].sequence, std::memory_order_release);
+        if (was_empty) {
+            inbox->ready.notify_one();
+        }
+    });
+
+    std::string image = engine_.exportSnapshot(&seed_sequence_);
+    SnapshotView snapshot(image.data(), image.size());
+    OrderBook scratch;
+    for (const auto& symbol : snapshot.getSymbols()) {
+        snapshot.restoreBook(symbol, scratch);
+        Book& book = bookFor(symbol);
+        for (const auto& order : scratch.getRestingOrders()) {
+            book.orders[order.getId()] = ReplicaOrder{order.getSide(), order.getPrice(), order.getRemainingQuantity(), true};
+            addToLevel(book, order.getSide(), order.getPrice(), order.getRemainingQuantity());
+            book.resting_orders++;
+        }
+    }
+    applied_sequence_.store(seed_sequence_, std::memory_order_release);
+
+    thread_ = std::thread(&BookReplica::run, this);
+    if (options_.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options_.cpu, &cpus);
+        if (pthread_setaffinity_np(thread_.native_handle(), sizeof(cpus), &cpus) != 0) {
+            {
+                std::lock_guard<std::mutex> lock(inbox_->mutex);
+                inbox_->closed = true;
+            }
+            inbox_->ready.notify_all();
+            thread_.join();
+            engine_.unregisterEventBatchCallback(callback_id_);
+            throw std::runtime_error("BookReplica: cannot pin the replica thread to cpu " + std::to_string(options_.cpu));
+        }
+    }
+}
+
+BookReplica::~BookReplica() {
+    engine_.unregisterEventBatchCallback(callback_id_);
+    {
+        std::lock_guard<std::mutex> lock(inbox_->mutex);
+        inbox_->closed = true;
+        inbox_->events.clear();
+        inbox_->command_ends.clear();
+    }
+    inbox_->ready.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+// =============================================================================
+// Applying the Stream
+// =============================================================================
+
+void BookReplica::run() {
+    std::vector<OrderEvent> events;
+    std::vector<size_t> command_ends;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(inbox_->mutex);
+            inbox_->ready.wait(lock, [this] { return !inbox_->events.empty() || inbox_->closed; });
+            if (inbox_->closed) {
+                return;
+            }
+            events.swap(inbox_->events);
+            command_ends.swap(inbox_->command_ends);
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(state_mutex_);
+            size_t begin = 0;
+            for (size_t end : command_ends) {
+                applyCommand(events.data() + begin, end - begin);
+                begin = end;
+            }
+            if (events.back().sequence > applied_sequence_.load(std::memory_order_relaxed)) {
+                applied_sequence_.store(events.back().sequence, std::memory_order_release);
+            }
+        }
+        events_applied_.fetch_add(events.size(), std::memory_order_relaxed);
+        commands_applied_.fetch_add(command_ends.size(), std::memory_order_relaxed);
+        apply_passes_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex_); //a waiter can't miss the notify between its check and its wait
+        }
+        progress_.notify_all();
+        events.clear();
+        command_ends.clear();
+    }
+}
+
+BookReplica::Book& BookReplica::bookFor(const std::string& symbol) {
+    auto it = books_.find(symbol);
+    if (it == books_.end()) {
+        it = books_.emplace(symbol, Book{}).first;
+        it->second.top = engine_.getTopOfBookSnapshot(symbol);
+    }
+    return it->second;
+}
+
+void BookReplica::applyCommand(const OrderEvent* events, size_t count) {
+    // A command's events share one dispatch, so they are all in the seed or none is
+    if (count == 0 || events[0].sequence <= seed_sequence_) {
+        return;
+    }
+    Book& book = bookFor(events[0].getSymbol()); //a command touches one book
+
+    // The order a command enters only rests once its matching is over (its fills are in this command)
+    OrderId incoming = 0;
+    bool has_incoming = false;
+    for (size_t i = 0; i < count; ++i) {
+        const OrderEvent& event = events[i];
+        switch (event.type) {
+            case OrderEventType::AMENDED:
+                removeResting(book, event.order_id);
+                [[fallthrough]];
+            case OrderEventType::ACCEPTED:
+                if (event.order_type == OrderType::LIMIT) {
+                    book.orders[event.order_id] = ReplicaOrder{event.side, event.price, event.quantity, false};
+                    incoming = event.order_id;
+                    has_incoming = true;
+                }
+                break;
+            case OrderEventType::PARTIALLY_FILLED:
+            case OrderEventType::FILLED: {
+                auto it = book.orders.find(event.order_id);
+                if (it == book.orders.end()) {
+                    break; //market orders are never tracked
+                }
+                bool done = event.type == OrderEventType::FILLED;
+                if (it->second.resting) {
+                    takeFromLevel(book, it->second.side, it->second.price, event.quantity, done);
+                    if (done) book.resting_orders--;
+                }
+                it->second.remaining = event.remaining_quantity;
+                if (done) {
+                    book.orders.erase(it);
+                }
+                break;
+            }
+            case OrderEventType::CANCELLED:
+            case OrderEventType::EXPIRED:
+                removeResting(book, event.order_id);
+                break;
+        }
+    }
+
+    if (has_incoming) {
+        auto it = book.orders.find(incoming);
+        if (it != book.orders.end() && !it->second.resting && it->second.remaining > 0) {
+            it->second.resting = true;
+            addToLevel(book, it->second.side, it->second.price, it->second.remaining);
+            book.resting_orders++;
+        }
+    }
+}
+
+void BookReplica::addToLevel(Book& book, OrderSide side, Price price, Quantity quantity) {
+    Level& level = side == OrderSide::BUY ? book.bids[price] : book.asks[price];
+    level.quantity += quantity;
+    level.orders++;
+}
+
+void BookReplica::takeFromLevel(Book& book, OrderSide side, Price price, Quantity quantity, bool last) {
+    auto update = [&](auto& levels) {
+        auto it = levels.find(price);
+        if (it == levels.end()) return;
+        it->second.quantity -= std::min(quantity, it->second.quantity);
+        if (last && --it->second.orders == 0) {
+            levels.erase(it);
+        }
+    };
+    if (side == OrderSide::BUY) {
+        update(book.bids);
+    } else {
+        update(book.asks);
+    }
+}
+
+void BookReplica::removeResting(Book& book, OrderId order_id) {
+    auto it = book.orders.find(order_id);
+    if (it == book.orders.end()) {
+        return;
+    }
+    if (it->second.resting) {
+        takeFromLevel(book, it->second.side, it->second.price, it->second.remaining, true);
+        book.resting_orders--;
+    }
+    book.orders.erase(it);
+}
+
+// =============================================================================
+// Queries
+// =============================================================================
+
+MarketDepth BookReplica::getMarketDepth(const std::string& symbol, size_t levels, uint64_t* sequence) const {
+    MarketDepth depth;
+    depth.symbol = symbol;
+    std::shared_ptr<const TopOfBookSnapshot> top;
+    {
+        std::shared_lock<std::shared_mutex> lock(state_mutex_);
+        if (sequence) {
+            *sequence = applied_sequence_.load(std::memory_order_relaxed);
+        }
+        auto it = books_.find(symbol);
+        if (it == books_.end()) {
+            return depth;
+        }
+        const Book& book = it->second;
+        for (const auto& [price, level] : book.bids) {
+            if (depth.bids.size() >= levels) break;
+            depth.bids.push_back({price, level.quantity});
+        }
+        for (const auto& [price, level] : book.asks) {
+            if (depth.asks.size() >= levels) break;
+            depth.asks.push_back({price, level.quantity});
+        }
+        depth.total_orders = book.resting_orders;
+        top = book.top;
+    }
+    if (top) {
+        TopOfBook bbo = top->read();
+        if (bbo.hasBid()) depth.best_bid = bbo.best_bid;
+        if (bbo.hasAsk()) depth.best_ask = bbo.best_ask;
+        if (depth.best_bid && depth.best_ask) depth.spread = *depth.best_ask - *depth.best_bid;
+    }
+    depth.timestamp = std::chrono::high_resolution_clock::now();
+    return depth;
+}
+
+std::string BookReplica::getOrderBookState(const std::string& symbol, size_t max_levels, uint64_t* sequence) const {
+    std::ostringstream oss;
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    if (sequence) {
+        *sequence = applied_sequence_.load(std::memory_order_relaxed);
+    }
+    auto it = books_.find(symbol);
+    if (it == books_.end()) return "Symbol not found";
+    const Book& book = it->second;
+
+    oss << "=== ORDER BOOK ===" << std::endl;
+    oss << "ASKS (lowest first):" << std::endl;
+    size_t ask_count = 0;
+    for (const auto& [price, level] : book.asks) {
+        if (ask_count++ >= max_levels) break;
+        oss << "  ASK " << std::fixed << std::setprecision(3) << price
+            << " [" << level.quantity << " qty, " << level.orders << " orders]" << std::endl;
+    }
+    TopOfBook bbo = book.top ? book.top->read() : TopOfBook{};
+    if (bbo.hasBid() && bbo.hasAsk()) {
+        oss << "SPREAD: " << std::fixed << std::setprecision(3) << bbo.best_ask - bbo.best_bid << std::endl;
+    } else {
+        oss << "SPREAD: N/A" << std::endl;
+    }
+    oss << "BIDS (highest first):" << std::endl;
+    size_t bid_count = 0;
+    for (const auto& [price, level] : book.bids) {
+        if (bid_count++ >= max_levels) break;
+        oss << "  BID " << std::fixed << std::setprecision(3) << price
+            << " [" << level.quantity << " qty, " << level.orders << " orders]" << std::endl;
+    }
+    oss << "=================" << std::endl;
+    oss << "Total Orders: " << book.resting_orders << std::endl;
+    return oss.str();
+}
+
+std::vector<std::string> BookReplica::getSymbols() const {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    std::vector<std::string> symbols;
+    symbols.reserve(books_.size());
+    for (const auto& [symbol, book] : books_) {
+        symbols.push_back(symbol);
+    }
+    return symbols;
+}
+
+uint64_t BookReplica::getLag() const {
+    uint64_t published = inbox_->published.load(std::memory_order_acquire);
+    uint64_t applied = applied_sequence_.load(std::memory_order_acquire);
+    return published > applied ? published - applied : 0;
+}
+
+bool BookReplica::waitForSequence(uint64_t sequence, std::chrono::microseconds timeout) const {
+    std::unique_lock<std::mutex> lock(progress_mutex_);
+    return progress_.wait_for(lock, timeout, [this, sequence] { return getSequence() >= sequence; });
+}
+
+ReplicaStatistics BookReplica::getStatistics() const {
+    ReplicaStatistics stats;
+    stats.applied_sequence = applied_sequence_.load(std::memory_order_acquire);
+    stats.published_sequence = std::max(inbox_->published.load(std::memory_order_acquire), stats.applied_sequence);
+    stats.events_applied = events_applied_.load(std::memory_order_relaxed);
+    stats.commands_applied = commands_applied_.load(std::memory_order_relaxed);
+    stats.apply_passes = apply_passes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace matching_engine
@@ -0,0 +1,130 @@
+#include "matching_engine/duplicate_filter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace {
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+} // namespace
+
+DuplicateOrderFilter::DuplicateOrderFilter(size_t window) {
+    if (window == 0) {
+        throw std::invalid_argument("Duplicate filter window must be positive");
+    }
+    window_ = roundUpPowerOfTwo(window);
+    size_t bloom_words = std::max<size_t>(1, window_ * BLOOM_BITS_PER_ID / 64);
+    bloom_mask_ = bloom_words * 64 - 1;
+    table_mask_ = window_ * 2 - 1;
+    for (auto& generation : generations_) {
+        generation.bloom.assign(bloom_words, 0);
+        generation.table.assign(window_ * 2, INVALID_ORDER_ID);
+    }
+}
+
+bool DuplicateOrderFilter::checkAndInsert(OrderId id) {
+    if (id == INVALID_ORDER_ID) {
+        return false;
+    }
+    uint64_t hash = mix(id);
+    if (generationContains(generations_[current_], id, hash) ||
+        generationContains(generations_[current_ ^ 1], id, hash)) {
+        return true;
+    }
+
+    if (current_size_ == window_) {
+        // The current generation holds a full window: it becomes the older one, and the old
+        // older one (entirely outside the window now) is wiped for reuse
+        current_ ^= 1;
+        std::fill(generations_[current_].bloom.begin(), generations_[current_].bloom.end(), 0);
+        std::fill(generations_[current_].table.begin(), generations_[current_].table.end(), INVALID_ORDER_ID);
+        current_size_ = 0;
+    }
+    Generation& generation = generations_[current_];
+
+    uint64_t step = (hash >> 32) | 1;
+    for (size_t i = 0; i < BLOOM_HASHES; ++i) {
+        size_t bit = static_cast<size_t>((hash + i * step) & bloom_mask_);
+        generation.bloom[bit >> 6] |= uint64_t{1} << (bit & 63);
+    }
+    size_t slot = static_cast<size_t>(hash >> 20) & table_mask_;
+    while (generation.table[slot] != INVALID_ORDER_ID) {
+        slot = (slot + 1) & table_mask_;
+    }
+    generation.table[slot] = id;
+    current_size_++;
+    return false;
+}
+
+bool DuplicateOrderFilter::contains(OrderId id) const noexcept {
+    if (id == INVALID_ORDER_ID) {
+        return false;
+    }
+    uint64_t hash = mix(id);
+    return generationContains(generations_[current_], id, hash) ||
+           generationContains(generations_[current_ ^ 1], id, hash);
+}
+
+void DuplicateOrderFilter::clear() noexcept {
+    for (auto& generation : generations_) {
+        std::fill(generation.bloom.begin(), generation.bloom.end(), 0);
+        std::fill(generation.table.begin(), generation.table.end(), INVALID_ORDER_ID);
+    }
+    current_ = 0;
+    current_size_ = 0;
+}
+
+size_t DuplicateOrderFilter::getMemoryBytes() const noexcept {
+    size_t bytes = 0;
+    for (const auto& generation : generations_) {
+        bytes += generation.bloom.size() * sizeof(uint64_t) + generation.table.size() * sizeof(OrderId);
+    }
+    return bytes;
+}
+
+size_t DuplicateOrderFilter::getAllocationCount() const noexcept {
+    size_t blocks = 0;
+    for (const auto& generation : generations_) {
+        blocks += (generation.bloom.capacity() > 0) + (generation.table.capacity() > 0);
+    }
+    return blocks;
+}
+
+// =============================================================================
+// Private Helper Methods
+// =============================================================================
+
+uint64_t DuplicateOrderFilter::mix(OrderId id) noexcept {
+    // splitmix64 finalizer: client ids are often sequential, so spread them over all bits
+    uint64_t x = id;
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+bool DuplicateOrderFilter::generationContains(const Generation& generation, OrderId id, uint64_t hash) const noexcept {
+    uint64_t step = (hash >> 32) | 1;
+    for (size_t i = 0; i < BLOOM_HASHES; ++i) {
+        size_t bit = static_cast<size_t>((hash + i * step) & bloom_mask_);
+        if ((generation.bloom[bit >> 6] & (uint64_t{1} << (bit & 63))) == 0) {
+            return false; // definitely not in this generation
+        }
+    }
+    // Bloom filter says maybe: confirm against the exact ids
+    for (size_t slot = static_cast<size_t>(hash >> 20) & table_mask_; generation.table[slot] != INVALID_ORDER_ID;
+         slot = (slot + 1) & table_mask_) {
+        if (generation.table[slot] == id) return true;
+    }
+    return false;
+}
+
+} // namespace matching_engine
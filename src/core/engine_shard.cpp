@@ -0,0 +1,263 @@
+#include "matching_engine/engine_shard.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace {
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t elapsedSince(int64_t then, int64_t now) {
+    return now > then ? static_cast<uint64_t>(now - then) : 0;
+}
+
+} // namespace
+
+EngineShard::EngineShard(MatchingEngine& engine, const ShardOptions& options)
+    : engine_(engine), options_(options), queue_(options.coalesce), batch_limit_(options.batch_size),
+      latency_(std::make_unique<ShardLatency>()), scheduler_([this] { return queue_.hasPending(); }) {
+    if (options_.batch_size == 0) {
+        throw std::invalid_argument("Shard batch size must be positive");
+    }
+    if (options_.adaptive_batching) {
+        if (options_.min_batch_size == 0 || options_.min_batch_size > options_.max_batch_size) {
+            throw std::invalid_argument("Shard batch size bounds must satisfy 0 < min <= max");
+        }
+        if (options_.latency_budget.count() <= 0) {
+            throw std::invalid_argument("Shard latency budget must be positive");
+        }
+        batch_limit_ = std::clamp(options_.batch_size, options_.min_batch_size, options_.max_batch_size);
+    }
+    parents_.setStateCallback([this](const ParentOrderState& state) {
+        if (!on_parent_) {
+            return;
+        }
+        try {
+            on_parent_(state);
+        } catch (const std::exception& e) {
+            std::cerr << "EngineShard: parent callback failed: " << e.what() << std::endl;
+        }
+    });
+}
+
+EngineShard::~EngineShard() {
+    stop();
+}
+
+void EngineShard::start() {
+    if (!thread_.joinable() && !queue_.isClosed()) {
+        thread_ = std::thread(&EngineShard::run, this);
+    }
+}
+
+void EngineShard::stop() {
+    queue_.close();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+ShardStatistics EngineShard::getStatistics() const {
+    ShardStatistics stats;
+    stats.ingress = queue_.getStatistics();
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.commands_applied = commands_applied_.load(std::memory_order_relaxed);
+    stats.batch_limit = batch_limit_.load(std::memory_order_relaxed);
+    stats.batch_limit_raises = batch_limit_raises_.load(std::memory_order_relaxed);
+    stats.batch_limit_cuts = batch_limit_cuts_.load(std::memory_order_relaxed);
+    stats.parent_orders = parent_orders_.load(std::memory_order_relaxed);
+    stats.child_orders = child_orders_.load(std::memory_order_relaxed);
+    for (const auto& group : scheduler_.getClassStatistics()) {
+        stats.background_slices += group.slices;
+        stats.background_cpu_nanos += group.cpu_nanos;
+    }
+    return stats;
+}
+
+void EngineShard::adaptBatchLimit(size_t taken, uint64_t apply_nanos) {
+    if (taken > 0) {
+        double per_command = static_cast<double>(apply_nanos) / static_cast<double>(taken);
+        nanos_per_command_ = nanos_per_command_ == 0.0 ? per_command : nanos_per_command_ * 0.875 + per_command * 0.125;
+    }
+    // Largest batch that should apply within the budget at the current cost per command
+    double budget = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(options_.latency_budget).count());
+    double fitting = nanos_per_command_ > 0.0 ? budget / nanos_per_command_ : static_cast<double>(options_.max_batch_size);
+    size_t fits = static_cast<size_t>(std::clamp(fitting, static_cast<double>(options_.min_batch_size),
+                                                 static_cast<double>(options_.max_batch_size)));
+
+    size_t limit = batch_limit_.load(std::memory_order_relaxed);
+    size_t next = limit;
+    size_t backlog = queue_.depth();
+    if (taken >= limit && backlog >= limit) {
+        next = std::min(limit * 2, fits); //burst: a full batch and at least as much waiting
+    } else if (backlog == 0 && taken * 2 < limit) {
+        next = std::max(limit / 2, options_.min_batch_size); //quiet: keep the next burst's first batches short
+    }
+    next = std::min(next, fits);
+
+    if (next > limit) {
+        batch_limit_raises_.fetch_add(1, std::memory_order_relaxed);
+    } else if (next < limit) {
+        batch_limit_cuts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    batch_limit_.store(next, std::memory_order_relaxed);
+}
+
+void EngineShard::run() {
+    std::vector<EngineCommand> batch;
+    std::vector<CommandResult> results;
+    size_t capacity = options_.adaptive_batching ? options_.max_batch_size : options_.batch_size;
+    batch.reserve(capacity);
+    results.reserve(capacity);
+    while (true) {
+        size_t taken = queue_.drain(batch, batch_limit_.load(std::memory_order_relaxed), scheduler_.timeUntilDue(options_.idle_wait));
+        if (taken == 0) {
+            if (queue_.isClosed() && queue_.depth() == 0) {
+                tick(true);
+                return; //stopped and everything queued has been applied
+            }
+            if (options_.adaptive_batching) {
+                adaptBatchLimit(0, 0);
+            }
+            workParentOrders(results);
+            tick(false);
+            scheduler_.runSlices();
+            continue;
+        }
+
+        int64_t drained_ns = steadyNanos();
+        for (const auto& command : batch) {
+            latency_->queue_wait.record(elapsedSince(command.enqueue_ns, drained_ns));
+        }
+        engine_.processCommands(batch, results);
+        uint64_t apply_nanos = elapsedSince(drained_ns, steadyNanos());
+        latency_->batch_size.record(taken);
+        latency_->batch_apply.record(apply_nanos);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        commands_applied_.fetch_add(taken, std::memory_order_relaxed);
+
+        reportResults(results);
+        workParentOrders(results);
+        tick(false);
+        scheduler_.runSlices();
+        if (options_.adaptive_batching) {
+            adaptBatchLimit(taken, apply_nanos);
+        }
+        batch.clear();
+        results.clear();
+    }
+}
+
+void EngineShard::reportResults(const std::vector<CommandResult>& results) {
+    for (const auto& result : results) {
+        latency_->result.record(elapsedSince(result.enqueue_ns, steadyNanos()));
+        if (!on_result_) {
+            continue;
+        }
+        try {
+            on_result_(result);
+        } catch (const std::exception& e) {
+            std::cerr << "EngineShard: result callback failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+void EngineShard::tick(bool stopping) {
+    if (!on_tick_) {
+        return;
+    }
+    try {
+        on_tick_(stopping);
+    } catch (const std::exception& e) {
+        std::cerr << "EngineShard: tick callback failed: " << e.what() << std::endl;
+    }
+}
+
+// =============================================================================
+// Parent Orders
+// =============================================================================
+
+bool EngineShard::submit(EngineCommand command) {
+    if (command.type == CommandType::NEW_ORDER && command.order_id >= ParentOrderScheduler::DEFAULT_FIRST_CHILD_ID) {
+        // It would collide with a child the shard generates, now or later
+        throw std::invalid_argument("Order id " + std::to_string(command.order_id) + " is in the range kept for parent order children");
+    }
+    return queue_.push(std::move(command));
+}
+
+bool EngineShard::submitParentOrder(const ParentOrderSpec& spec) {
+    ParentOrderScheduler::validate(spec); //report bad specs to the caller, not the matcher
+    std::lock_guard<std::mutex> lock(parent_mutex_);
+    if (queue_.isClosed()) {
+        return false;
+    }
+    parent_requests_.push_back(ParentRequest{spec, false});
+    parent_requests_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool EngineShard::cancelParentOrder(OrderId parent_id) {
+    std::lock_guard<std::mutex> lock(parent_mutex_);
+    if (queue_.isClosed()) {
+        return false;
+    }
+    ParentRequest request;
+    request.spec.id = parent_id;
+    request.cancel = true;
+    parent_requests_.push_back(std::move(request));
+    parent_requests_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+void EngineShard::workParentOrders(const std::vector<CommandResult>& results) {
+    bool pending = parent_requests_pending_.load(std::memory_order_acquire);
+    if (!pending && parents_.empty()) {
+        return;
+    }
+    // Trade hook, then new requests, then the timer; children are applied as one batch
+    std::vector<EngineCommand> children;
+    for (const auto& result : results) {
+        parents_.onResult(result, children);
+    }
+    int64_t now = steadyNanos();
+    if (pending) {
+        std::vector<ParentRequest> requests;
+        {
+            std::lock_guard<std::mutex> lock(parent_mutex_);
+            requests.swap(parent_requests_);
+            parent_requests_pending_.store(false, std::memory_order_relaxed);
+        }
+        for (const auto& request : requests) {
+            try {
+                if (request.cancel) {
+                    parents_.cancel(request.spec.id, children);
+                } else {
+                    parents_.add(request.spec, now, children);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "EngineShard: parent order " << request.spec.id << " refused: " << e.what() << std::endl;
+            }
+        }
+    }
+    parents_.onTimer(now, children);
+
+    // Children can trade and, if refused, cancel their siblings: apply until nothing follows
+    std::vector<CommandResult> child_results;
+    while (!children.empty()) {
+        engine_.processCommands(children, child_results);
+        children.clear();
+        reportResults(child_results);
+        for (const auto& result : child_results) {
+            parents_.onResult(result, children);
+        }
+        child_results.clear();
+    }
+    parent_orders_.store(parents_.getWorkingCount(), std::memory_order_relaxed);
+    child_orders_.store(parents_.getChildrenReleased(), std::memory_order_relaxed);
+}
+
+} // namespace matching_engine
@@ -0,0 +1,128 @@
+#include "matching_engine/ingress_queue.hpp"
+
+namespace matching_engine {
+
+namespace {
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void IngressQueue::forget(const EngineCommand& command, uint64_t position) {
+    // The command leaves the queue: it can no longer be folded into
+    if (command.type == CommandType::CANCEL) {
+        return;
+    }
+    auto it = pending_.find(OrderKey{command.session, command.order_id, command.symbol});
+    if (it == pending_.end()) {
+        return;
+    }
+    if (it->second.new_order == position) it->second.new_order = NONE;
+    if (it->second.amend == position) it->second.amend = NONE;
+    if (it->second.new_order == NONE && it->second.amend == NONE) {
+        pending_.erase(it);
+    }
+}
+
+bool IngressQueue::push(EngineCommand command) {
+    command.enqueue_ns = steadyNanos();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        stats_.commands_pushed++;
+        uint64_t position = head_position_ + entries_.size();
+
+        if (coalesce_) {
+            OrderKey key{command.session, command.order_id, command.symbol};
+            switch (command.type) {
+                case CommandType::NEW_ORDER: {
+                    Pending& pending = pending_[key];
+                    pending.repeated = pending.new_order != NONE; //a repeated id is left for the engine to reject
+                    pending.new_order = position;
+                    break;
+                }
+                case CommandType::AMEND: {
+                    Pending& pending = pending_[key];
+                    if (pending.amend != NONE) {
+                        at(pending.amend).superseded = true; //only the latest amend matters
+                        stats_.amends_coalesced++;
+                    }
+                    pending.amend = position;
+                    break;
+                }
+                case CommandType::CANCEL: {
+                    auto it = pending_.find(key);
+                    if (it != pending_.end()) {
+                        if (it->second.amend != NONE) {
+                            at(it->second.amend).superseded = true;
+                            stats_.amends_coalesced++;
+                        }
+                        if (it->second.new_order != NONE && !it->second.repeated) {
+                            at(it->second.new_order).annihilated = true;
+                            stats_.orders_annihilated++;
+                            command.annihilated = true;
+                        }
+                        pending_.erase(it);
+                    }
+                    break;
+                }
+            }
+        }
+
+        entries_.push_back(std::move(command));
+        size_hint_.store(entries_.size(), std::memory_order_relaxed);
+    }
+    ready_.notify_one();
+    return true;
+}
+
+size_t IngressQueue::drain(std::vector<EngineCommand>& out, size_t max_commands, std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (entries_.empty() && !closed_) {
+        ready_.wait_for(lock, timeout, [this] { return !entries_.empty() || closed_; });
+    }
+    size_t taken = 0;
+    while (!entries_.empty() && taken < max_commands) {
+        if (coalesce_) {
+            forget(entries_.front(), head_position_);
+        }
+        out.push_back(std::move(entries_.front()));
+        entries_.pop_front();
+        head_position_++;
+        taken++;
+    }
+    stats_.commands_drained += taken;
+    size_hint_.store(entries_.size(), std::memory_order_relaxed);
+    return taken;
+}
+
+void IngressQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    ready_.notify_all();
+}
+
+bool IngressQueue::isClosed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+size_t IngressQueue::depth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+IngressStatistics IngressQueue::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    IngressStatistics stats = stats_;
+    stats.depth = entries_.size();
+    return stats;
+}
+
+} // namespace matching_engine
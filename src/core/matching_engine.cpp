@@ -2,12 +2,19 @@
 #include "matching_engine/trade.hpp"
 #include <iostream>
 #include <stdexcept>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <condition_variable>
 
 namespace matching_engine {
 
 MatchingEngine::MatchingEngine(const EngineConfig& config)
-    : config_(config), total_orders_processed_(0), total_trades_executed_(0), is_running_(false) { //initialize the engine with the config
+    : order_books_(OrderBookMap::allocator_type(&memory_, MemoryCategory::SYMBOL_DIRECTORY))
+    , listings_(CountingAllocator<ReferenceRecord>(&memory_, MemoryCategory::SYMBOL_DIRECTORY))
+    , config_(config), total_orders_processed_(0), total_trades_executed_(0), is_running_(false) { //initialize the engine with the config
     start_time_ = std::chrono::high_resolution_clock::now();
 }
 
@@ -16,18 +23,25 @@ MatchingEngine::~MatchingEngine() { //destructor
 }
 
 void MatchingEngine::start() { //start the engine
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     is_running_ = true;
     start_time_ = std::chrono::high_resolution_clock::now();
 }
 
 void MatchingEngine::stop() { //stop the engine
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     is_running_ = false;
+    if (journal_) {
+        journal_->commit(); //everything accepted so far is on disk once stopped
+    }
 }
 
 std::vector<Trade> MatchingEngine::submitOrder(Order order) {
-    std::unique_lock lock(engine_mutex_); //lock the engine mutex- only one thread can access the engine at a time
+    auto lock = lockExclusive(); //lock the engine mutex- only one thread can access the engine at a time
+    return submitOrderLocked(std::move(order));
+}
+
+std::vector<Trade> MatchingEngine::submitOrderLocked(Order order) {
     if (!is_running_) {
         throw std::runtime_error("Engine is not running"); 
     }
@@ -35,10 +49,71 @@ std::vector<Trade> MatchingEngine::submitOrder(Order order) {
         throw std::invalid_argument("Order validation failed");
     }
     auto* book = getOrderBook(order.getSymbol());
+    if (!book) {
+        book = openListedBook(order.getSymbol()); //first order of a listed symbol
+    }
     if (!book) {
         throw std::runtime_error("Symbol not found: " + order.getSymbol());
     }
-    auto trades = book->addOrder(order); //add the order to the order book
+    if (book->hasOrder(order.getId())) {
+        duplicate_orders_rejected_++;
+        throw std::invalid_argument("Duplicate order id " + std::to_string(order.getId()) + ": order is still resting");
+    }
+    book->checkRules(order.getPrice(), order.getQuantity()); //before anything is reserved, filtered or journaled
+    const bool risk_checked = risk_budget_ && order.getAccount() != 0;
+    Notional reserved = 0;
+    if (risk_checked) {
+        reserved = orderNotional(*book, order);
+        if (!risk_budget_->tryReserve(order.getAccount(), reserved)) {
+            risk_rejections_++;
+            throw std::invalid_argument("Order " + std::to_string(order.getId()) + " exceeds the risk budget of account " +
+                                        std::to_string(order.getAccount()));
+        }
+    }
+    if (order.getSession() != 0 && config_.duplicate_order_window > 0) {
+        auto& filter = session_filters_[order.getSession()];
+        if (!filter) {
+            filter = std::make_unique<DuplicateOrderFilter>(config_.duplicate_order_window);
+        }
+        if (filter->checkAndInsert(order.getId())) {
+            if (risk_checked) {
+                risk_budget_->release(order.getAccount(), reserved);
+            }
+            duplicate_orders_rejected_++;
+            throw std::invalid_argument("Duplicate order id " + std::to_string(order.getId()) +
+                                        " in session " + std::to_string(order.getSession()));
+        }
+    }
+    if (journal_) {
+        JournalRecord record;
+        record.command = JournalCommand::NEW_ORDER;
+        record.order_id = order.getId();
+        record.setSymbol(order.getSymbol());
+        record.side = order.getSide();
+        record.order_type = order.getType();
+        record.price = order.getPrice();
+        record.quantity = order.getQuantity();
+        record.account = order.getAccount();
+        journalCommand(record);
+    }
+    std::vector<Trade> trades;
+    try {
+        trades = book->addOrder(order); //add the order to the order book
+    } catch (...) {
+        if (risk_checked) {
+            risk_budget_->release(order.getAccount(), reserved);
+        }
+        throw;
+    }
+    dispatchEvents(*book);
+    if (risk_checked) {
+        // Only what traded and what rests stays used; fills at better prices and the rest of a
+        // market order's walk estimate go back
+        Notional used = usedNotional(*book, order.getId(), trades);
+        if (reserved > used) {
+            risk_budget_->release(order.getAccount(), reserved - used);
+        }
+    }
     total_orders_processed_++; //increment the total number of orders processed
     total_trades_executed_ += trades.size(); //increment the total number of trades executed
     for (const auto& trade : trades) { //broadcast the trades to all registered callbacks
@@ -49,63 +124,176 @@ std::vector<Trade> MatchingEngine::submitOrder(Order order) {
 }
 
 bool MatchingEngine::cancelOrder(OrderId order_id, const std::string& symbol) { 
-    std::unique_lock lock(engine_mutex_); //lock the engine mutex- only one thread can access the engine at a time
+    auto lock = lockExclusive(); //lock the engine mutex- only one thread can access the engine at a time
+    return cancelOrderLocked(order_id, symbol);
+}
+
+bool MatchingEngine::cancelOrderLocked(OrderId order_id, const std::string& symbol) {
     auto it = order_books_.find(symbol); //find the order book for the symbol
     if (it == order_books_.end()) {
         return false; // Symbol not found
     }
-    bool result = it->second->cancelOrder(order_id); //cancel the order, second parameter is the order id
-    if (result) {
-        broadcastOrderUpdate(Order(order_id, symbol, OrderSide::BUY, OrderType::LIMIT, 0, 0)); // Dummy order for callback *****REVIEW*****
+    auto cancelled = it->second->removeOrder(order_id); //cancel the order and keep what was resting for the callback
+    dispatchEvents(*it->second);
+    if (cancelled) {
+        if (journal_) {
+            JournalRecord record;
+            record.command = JournalCommand::CANCEL_ORDER;
+            record.order_id = order_id;
+            record.setSymbol(symbol);
+            record.side = cancelled->getSide();
+            journalCommand(record);
+        }
+        if (risk_budget_ && cancelled->getAccount() != 0) {
+            risk_budget_->release(cancelled->getAccount(), toNotional(cancelled->getPrice(), cancelled->getRemainingQuantity()));
+        }
+        broadcastOrderUpdate(*cancelled);
     }
-    return result;
+    return cancelled.has_value();
 }
 
 bool MatchingEngine::modifyOrder(OrderId order_id, const std::string& symbol, Price new_price, Quantity new_quantity) { 
-    std::unique_lock lock(engine_mutex_); //lock the engine mutex- only one thread can access the engine at a time
+    auto lock = lockExclusive(); //lock the engine mutex- only one thread can access the engine at a time
+    std::vector<Trade> trades;
+    return modifyOrderLocked(order_id, symbol, new_price, new_quantity, trades);
+}
+
+bool MatchingEngine::modifyOrderLocked(OrderId order_id, const std::string& symbol, Price new_price, Quantity new_quantity,
+                                       std::vector<Trade>& trades) {
     auto it = order_books_.find(symbol); //find the order book for the symbol
     if (it == order_books_.end()) {
         return false;
     }
-    // Cancel and re-submit as new order (simple approach)
-    bool cancelled = it->second->cancelOrder(order_id); //cancel the order, second parameter is the order id
-    if (!cancelled) {
+    it->second->checkRules(new_price, new_quantity); //before reserving anything for the amend
+    // The old remainder's reservation carries over, so only an increase needs budget
+    AccountId account = 0;
+    Notional change = 0;
+    Notional held = 0;
+    if (risk_budget_) {
+        const Order* resting = it->second->findOrder(order_id);
+        if (!resting) {
+            return false;
+        }
+        account = resting->getAccount();
+        held = toNotional(resting->getPrice(), resting->getRemainingQuantity());
+        change = toNotional(new_price, new_quantity) - held;
+        if (account != 0 && change > 0 && !risk_budget_->tryReserve(account, change)) {
+            risk_rejections_++;
+            return false;
+        }
+        held += std::max<Notional>(change, 0);
+    }
+    // Cancel/replace inside the book: same side and account, new price and quantity
+    std::optional<Order> replaced;
+    try {
+        replaced = it->second->replaceOrder(order_id, new_price, new_quantity, trades);
+    } catch (...) {
+        if (account != 0 && change > 0) {
+            risk_budget_->release(account, change);
+        }
+        throw;
+    }
+    if (!replaced) {
+        if (account != 0 && change > 0) {
+            risk_budget_->release(account, change);
+        }
         return false;
     }
-    //create a new order with the new price and quantity
-    Order new_order(order_id, symbol, OrderSide::BUY, OrderType::LIMIT, new_price, new_quantity); // Assumes BUY, real impl should track side/type *****REVIEW*****
-    auto trades = it->second->addOrder(new_order); //add the order to the order book
+    dispatchEvents(*it->second);
+    if (account != 0) {
+        Notional used = usedNotional(*it->second, order_id, trades);
+        if (held > used) {
+            risk_budget_->release(account, held - used);
+        }
+    }
+    if (journal_) {
+        JournalRecord record;
+        record.command = JournalCommand::MODIFY_ORDER;
+        record.order_id = order_id;
+        record.setSymbol(symbol);
+        record.side = replaced->getSide();
+        record.price = new_price;
+        record.quantity = new_quantity;
+        record.account = replaced->getAccount();
+        journalCommand(record);
+    }
     //broadcast the trades to all registered callbacks
     for (const auto& trade : trades) { 
         broadcastTrade(trade);
     }
-    broadcastOrderUpdate(new_order);
+    broadcastOrderUpdate(*replaced);
     return true;
 }
 
+void MatchingEngine::closeSession(SessionId session) {
+    auto lock = lockExclusive();
+    session_filters_.erase(session);
+}
+
+size_t MatchingEngine::processCommands(std::vector<EngineCommand>& commands, std::vector<CommandResult>& results) {
+    auto lock = lockExclusive(); //one acquisition for the whole batch
+    for (auto& command : commands) {
+        CommandResult result;
+        result.type = command.type;
+        result.session = command.session;
+        result.order_id = command.order_id;
+        result.enqueue_ns = command.enqueue_ns;
+        try {
+            switch (command.type) {
+                case CommandType::NEW_ORDER:
+                    if (command.annihilated && !isKnownOrderId(*command.order)) {
+                        result.status = CommandStatus::ANNIHILATED; //its cancel met it in the queue
+                    } else {
+                        result.trades = submitOrderLocked(std::move(*command.order)); //a duplicate after all: rejected as usual
+                    }
+                    break;
+                case CommandType::CANCEL:
+                    if (command.annihilated && !isResting(command.order_id, command.symbol)) {
+                        result.status = CommandStatus::ANNIHILATED; //its order never reached the book
+                    } else if (!cancelOrderLocked(command.order_id, command.symbol)) {
+                        result.status = CommandStatus::NOT_FOUND;
+                    }
+                    break;
+                case CommandType::AMEND:
+                    if (command.superseded) {
+                        result.status = CommandStatus::SUPERSEDED; //a later amend or cancel of the order took its place
+                    } else if (!modifyOrderLocked(command.order_id, command.symbol, command.price, command.quantity, result.trades)) {
+                        result.status = CommandStatus::NOT_FOUND;
+                    }
+                    break;
+            }
+        } catch (const std::exception& e) {
+            result.status = CommandStatus::REJECTED;
+            result.error = e.what();
+        }
+        results.push_back(std::move(result));
+    }
+    return commands.size();
+}
+
 std::optional<Price> MatchingEngine::getBestBid(const std::string& symbol) const { 
-    std::shared_lock lock(engine_mutex_); //unique vs shared lock - unique lock is used to lock the engine mutex- only one thread can access the engine at a time, shared lock is used to lock the engine mutex- multiple threads can access the engine at a time
+    auto lock = lockShared(); //unique vs shared lock - unique lock is used to lock the engine mutex- only one thread can access the engine at a time, shared lock is used to lock the engine mutex- multiple threads can access the engine at a time
     auto it = order_books_.find(symbol);
     if (it == order_books_.end()) return std::nullopt; //if the order book is not found, return nullopt
     return it->second->getBestBid(); //return the best bid for the symbol
 }
 
 std::optional<Price> MatchingEngine::getBestAsk(const std::string& symbol) const {
-    std::shared_lock lock(engine_mutex_); 
+    auto lock = lockShared(); 
     auto it = order_books_.find(symbol); 
     if (it == order_books_.end()) return std::nullopt; //if the order book is not found, return nullopt
     return it->second->getBestAsk(); //return the best ask for the symbol
 }
 
 std::optional<Price> MatchingEngine::getSpread(const std::string& symbol) const {
-    std::shared_lock lock(engine_mutex_);
+    auto lock = lockShared();
     auto it = order_books_.find(symbol); 
     if (it == order_books_.end()) return std::nullopt; //if the order book is not found, return nullopt
     return it->second->getSpread(); //return the spread for the symbol
 }
 
 MarketDepth MatchingEngine::getMarketDepth(const std::string& symbol, size_t levels) const {
-    std::shared_lock lock(engine_mutex_);
+    auto lock = lockShared();
     MarketDepth depth; //create a new market depth object
     depth.symbol = symbol; //set the symbol for the market depth
     auto it = order_books_.find(symbol); //find the order book for the symbol
@@ -122,51 +310,367 @@ MarketDepth MatchingEngine::getMarketDepth(const std::string& symbol, size_t lev
     return depth; //return the market depth object
 }
 
+std::shared_ptr<const TopOfBookSnapshot> MatchingEngine::getTopOfBookSnapshot(const std::string& symbol) const {
+    auto lock = lockShared();
+    auto it = order_books_.find(symbol);
+    if (it == order_books_.end()) return nullptr;
+    return it->second->getTopOfBookSnapshot();
+}
+
+MarketSnapshot::MarketSnapshot(size_t depth)
+    : depth_(depth), stride_words_((sizeof(SymbolSnapshot) + 2 * depth * sizeof(DepthLevel)) / sizeof(uint64_t)) {
+    static_assert(sizeof(SymbolSnapshot) % sizeof(uint64_t) == 0 && sizeof(DepthLevel) % sizeof(uint64_t) == 0,
+                  "snapshot records must stay 8-byte aligned");
+}
+
+void MarketSnapshot::resize(size_t count) {
+    if (storage_.size() < count * stride_words_) {
+        storage_.resize(count * stride_words_); //grows only; a reused buffer never reallocates
+    }
+    count_ = count;
+}
+
+namespace {
+
+void fillSymbolSnapshot(const std::string& symbol, const OrderBook* book, SymbolSnapshot& record, DepthLevel* levels,
+                        size_t depth) {
+    std::memset(&record, 0, sizeof(record));
+    std::memcpy(record.symbol, symbol.data(), std::min(symbol.size(), sizeof(record.symbol)));
+    if (!book) return;
+    record.found = 1;
+    record.bid_levels = static_cast<uint32_t>(book->copyBidLevels(levels, depth));
+    record.ask_levels = static_cast<uint32_t>(book->copyAskLevels(levels + depth, depth));
+    record.best_bid = book->getBestBid().value_or(0);
+    record.best_ask = book->getBestAsk().value_or(0);
+    record.best_bid_quantity = book->getBestBidQuantity();
+    record.best_ask_quantity = book->getBestAskQuantity();
+    record.total_orders = book->getOrderCount();
+}
+
+} // namespace
+
+/**
+ * @brief Persistent helpers for bulk snapshots: worker i fills chunk i + 1, the caller chunk 0
+ */
+class MatchingEngine::SnapshotWorkers {
+    private:
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        std::vector<std::thread> threads_;
+        uint64_t generation_ = 0;     // bumped once per fill
+        bool stopping_ = false;
+        const std::function<void(size_t)>* fill_ = nullptr;
+        size_t count_ = 0;
+        size_t chunk_ = 0;
+        size_t helpers_ = 0;          // workers taking part in the current fill
+        size_t remaining_ = 0;        // of those, not finished yet
+
+        void fillChunk(size_t chunk_index) {
+            size_t end = std::min(count_, (chunk_index + 1) * chunk_);
+            for (size_t i = chunk_index * chunk_; i < end; ++i) (*fill_)(i);
+        }
+
+        void work(size_t index) {
+            uint64_t seen = 0;
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+                if (index >= helpers_) continue;
+                lock.unlock();
+                fillChunk(index + 1);
+                lock.lock();
+                if (--remaining_ == 0) done_.notify_one();
+            }
+        }
+
+    public:
+        ~SnapshotWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto& thread : threads_) thread.join();
+        }
+
+        void run(size_t count, size_t threads, const std::function<void(size_t)>& fill) {
+            while (threads_.size() < threads - 1) {
+                threads_.emplace_back(&SnapshotWorkers::work, this, threads_.size());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                fill_ = &fill;
+                count_ = count;
+                chunk_ = (count + threads - 1) / threads;
+                helpers_ = threads - 1;
+                remaining_ = helpers_;
+                generation_++;
+            }
+            wake_.notify_all();
+            fillChunk(0);
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return remaining_ == 0; });
+        }
+};
+
+void MatchingEngine::fillInParallel(size_t count, size_t threads, const std::function<void(size_t)>& fill) const {
+    threads = std::max<size_t>(1, std::min(threads, count));
+    std::unique_lock<std::mutex> workers(snapshot_workers_mutex_, std::defer_lock);
+    if (threads == 1 || !workers.try_lock()) {
+        for (size_t i = 0; i < count; ++i) fill(i); //another reader has the workers: don't wait for them
+        return;
+    }
+    if (!snapshot_workers_) {
+        snapshot_workers_ = std::make_unique<SnapshotWorkers>();
+    }
+    snapshot_workers_->run(count, threads, fill);
+}
+
+size_t MatchingEngine::getMarketSnapshot(const std::vector<std::string>& symbols, MarketSnapshot& out, size_t threads) const {
+    auto lock = lockShared(); //one lock for the whole set: every record is from the same engine state
+    out.resize(symbols.size());
+    fillInParallel(symbols.size(), threads, [this, &symbols, &out](size_t i) {
+        auto it = order_books_.find(symbols[i]);
+        const OrderBook* book = it == order_books_.end() ? nullptr : it->second.get();
+        fillSymbolSnapshot(symbols[i], book, *out.record(i), out.levels(i), out.depth_);
+    });
+    return symbols.size();
+}
+
+size_t MatchingEngine::getMarketSnapshot(MarketSnapshot& out, size_t threads) const {
+    auto lock = lockShared();
+    out.books_.clear(); //keeps its capacity
+    for (const auto& [symbol, book] : order_books_) {
+        out.books_.emplace_back(&symbol, book.get());
+    }
+    out.resize(out.books_.size());
+    fillInParallel(out.books_.size(), threads, [&out](size_t i) {
+        fillSymbolSnapshot(*out.books_[i].first, out.books_[i].second, *out.record(i), out.levels(i), out.depth_);
+    });
+    return out.size();
+}
+
 std::vector<std::string> MatchingEngine::getActiveSymbols() const {
-    std::shared_lock lock(engine_mutex_);
+    auto lock = lockShared();
     std::vector<std::string> symbols; //create a new vector of strings
     for (const auto& [symbol, _] : order_books_) { //iterate through the order books
         symbols.push_back(symbol); //add the symbol to the vector
     }
+    for (const auto& listing : listings_) { //listed symbols nobody has traded yet
+        std::string symbol = listing.getSymbol();
+        if (order_books_.count(symbol) == 0) {
+            symbols.push_back(std::move(symbol));
+        }
+    }
     return symbols; //return the vector of active symbols
 }
 
 void MatchingEngine::addSymbol(const std::string& symbol) {
-    std::unique_lock lock(engine_mutex_); //lock the engine mutex- only one thread can access the engine at a time
+    auto lock = lockExclusive(); //lock the engine mutex- only one thread can access the engine at a time
     if (order_books_.count(symbol) == 0) { //if the symbol is not found, create a new order book for the symbol
-        order_books_[symbol] = std::make_unique<OrderBook>();//creates order book object and wraps it in a unique pointer, which is a smart pointer that automatically manages the memory of the object
+        createOrderBook(symbol);
     }
 }
 
+size_t MatchingEngine::loadReferenceData(const std::string& path) {
+    ReferenceDataFile file(path); //mapped and checked before taking the lock
+    for (const auto& record : file) {
+        if (!isValidRules(record.getRules())) {
+            throw std::invalid_argument("Invalid rules for " + record.getSymbol() + " in " + path);
+        }
+    }
+    auto lock = lockExclusive();
+    listings_.assign(file.begin(), file.end());
+    for (auto& [symbol, book] : order_books_) {
+        if (const ReferenceRecord* listing = findReferenceRecord(listings_.data(), listings_.data() + listings_.size(), symbol)) {
+            book->setRules(listing->getRules());
+        }
+    }
+    return listings_.size();
+}
+
 bool MatchingEngine::removeSymbol(const std::string& symbol) {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     auto it = order_books_.find(symbol);
-    if (it == order_books_.end()) return false;
-    if (it->second->getOrderCount() > 0){
+    if (it != order_books_.end() && it->second->getOrderCount() > 0){
         return false; // Can't remove if orders exist
     } 
+    const ReferenceRecord* listing = findReferenceRecord(listings_.data(), listings_.data() + listings_.size(), symbol);
+    if (listing) {
+        listings_.erase(listings_.begin() + (listing - listings_.data())); //delisted: its first order must not bring it back
+    }
+    if (it == order_books_.end()) return listing != nullptr;
     order_books_.erase(it); //remove the order book for the symbol
     return true; //return true if the order book is removed
 }
 
+void MatchingEngine::setCommandJournal(std::shared_ptr<JournalWriter> journal) {
+    auto lock = lockExclusive();
+    if (journal_) {
+        journal_->commit(); //don't leave the old journal with buffered records
+    }
+    journal_ = std::move(journal);
+}
+
+void MatchingEngine::setRiskBudget(ShardRiskBudget* budget) {
+    auto lock = lockExclusive();
+    risk_budget_ = budget;
+}
+
+Notional MatchingEngine::orderNotional(const OrderBook& book, const Order& order) {
+    if (!order.isMarketOrder()) {
+        return toNotional(order.getPrice(), order.getQuantity());
+    }
+    // Walk the opposite side; look deeper only if the order outlasts the levels fetched
+    for (size_t levels = 16;; levels *= 4) {
+        if (risk_levels_.size() < levels) {
+            risk_levels_.resize(levels);
+        }
+        size_t count = order.isBuyOrder() ? book.copyAskLevels(risk_levels_.data(), levels)
+                                          : book.copyBidLevels(risk_levels_.data(), levels);
+        Quantity left = order.getQuantity();
+        Notional notional = 0;
+        for (size_t i = 0; i < count && left > 0; ++i) {
+            Quantity take = std::min(left, risk_levels_[i].quantity);
+            notional += toNotional(risk_levels_[i].price, take);
+            left -= take;
+        }
+        if (left == 0 || count < levels) {
+            return notional;
+        }
+    }
+}
+
+bool MatchingEngine::isKnownOrderId(const Order& order) const {
+    if (isResting(order.getId(), order.getSymbol())) {
+        return true;
+    }
+    auto filter = session_filters_.find(order.getSession());
+    return order.getSession() != 0 && filter != session_filters_.end() && filter->second->contains(order.getId());
+}
+
+bool MatchingEngine::isResting(OrderId order_id, const std::string& symbol) const {
+    auto it = order_books_.find(symbol);
+    return it != order_books_.end() && it->second->hasOrder(order_id);
+}
+
+Notional MatchingEngine::usedNotional(const OrderBook& book, OrderId order_id, const std::vector<Trade>& trades) const {
+    Notional used = 0;
+    for (const auto& trade : trades) {
+        if (trade.buy_order_id == order_id || trade.sell_order_id == order_id) { //not stops the trades triggered
+            used += toNotional(trade.price, trade.quantity);
+        }
+    }
+    if (const Order* resting = book.findOrder(order_id)) {
+        used += toNotional(resting->getPrice(), resting->getRemainingQuantity());
+    }
+    return used;
+}
+
+void MatchingEngine::syncCommandJournal() {
+    auto lock = lockExclusive();
+    if (journal_) {
+        journal_->commit();
+    }
+}
+
+std::string MatchingEngine::exportSnapshot(uint64_t* event_sequence) {
+    auto lock = lockExclusive();
+    if (event_sequence) {
+        *event_sequence = event_sequence_;
+    }
+    uint64_t sequence = 0;
+    if (journal_) {
+        journal_->commit();
+        sequence = journal_->getLastSequence();
+    }
+    std::vector<std::pair<std::string, const OrderBook*>> books;
+    books.reserve(order_books_.size());
+    for (const auto& [symbol, book] : order_books_) {
+        books.emplace_back(symbol, book.get());
+    }
+    return encodeSnapshot(sequence, wallClockNanos(), books);
+}
+
+size_t MatchingEngine::importSnapshot(const SnapshotView& snapshot, uint64_t event_sequence) {
+    auto lock = lockExclusive();
+    size_t restored = 0;
+    for (const auto& symbol : snapshot.getSymbols()) {
+        OrderBook* book = getOrderBook(symbol);
+        if (!book) {
+            book = createOrderBook(symbol);
+        }
+        snapshot.restoreBook(symbol, *book);
+        book->clearEvents(); //restored orders are not new activity
+        restored++;
+    }
+    if (event_sequence != 0) {
+        event_sequence_ = event_sequence;
+    }
+    return restored;
+}
+
+uint64_t MatchingEngine::getEventSequence() const {
+    auto lock = lockShared();
+    return event_sequence_;
+}
+
 void MatchingEngine::registerTradeCallback(std::function<void(const Trade&)> callback) {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     trade_callbacks_.push_back(std::move(callback)); //add the callback to the vector of trade callbacks
 }
 
 void MatchingEngine::registerOrderCallback(std::function<void(const Order&)> callback) {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     order_callbacks_.push_back(std::move(callback)); //add the callback to the vector of order callbacks
 }
 
+void MatchingEngine::registerEventCallback(std::function<void(const OrderEvent&)> callback) {
+    auto lock = lockExclusive();
+    event_callbacks_.push_back(std::move(callback));
+    for (auto& [symbol, book] : order_books_) {
+        book->setEventCapture(true);
+    }
+}
+
+CallbackId MatchingEngine::registerEventBatchCallback(std::function<void(const OrderEvent*, size_t)> callback) {
+    auto lock = lockExclusive();
+    CallbackId id = next_callback_id_++;
+    event_batch_callbacks_.emplace_back(id, std::move(callback));
+    for (auto& [symbol, book] : order_books_) {
+        book->setEventCapture(true);
+    }
+    return id;
+}
+
+void MatchingEngine::unregisterEventBatchCallback(CallbackId id) {
+    auto lock = lockExclusive();
+    event_batch_callbacks_.erase(std::remove_if(event_batch_callbacks_.begin(), event_batch_callbacks_.end(),
+                                                [id](const auto& entry) { return entry.first == id; }),
+                                 event_batch_callbacks_.end());
+    if (!capturesEvents()) {
+        for (auto& [symbol, book] : order_books_) {
+            book->setEventCapture(false);
+        }
+    }
+}
+
 void MatchingEngine::unregisterAllCallbacks() {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     trade_callbacks_.clear(); //clear the vector of trade callbacks
     order_callbacks_.clear(); //clear the vector of order callbacks
+    event_callbacks_.clear();
+    event_batch_callbacks_.clear();
+    for (auto& [symbol, book] : order_books_) {
+        book->setEventCapture(false);
+    }
 }
 
 EngineStatistics MatchingEngine::getStatistics() const { 
-    std::shared_lock lock(engine_mutex_);
+    auto lock = lockShared();
     EngineStatistics stats; //create a new engine statistics object
     stats.total_orders_processed = total_orders_processed_; //set the total number of orders processed
     stats.total_trades_executed = total_trades_executed_; //set the total number of trades executed
@@ -174,11 +678,46 @@ EngineStatistics MatchingEngine::getStatistics() const {
     stats.uptime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time_); //set the uptime
     // Latency, orders/sec, trades/sec can be calculated here if needed
     stats.average_latency_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time_).count(); // calculate the average latency in microseconds
-    stats.orders_per_second = total_orders_processed_ / stats.uptime.count(); //set the orders per second
-    stats.trades_per_second = total_trades_executed_ / stats.uptime.count(); //set the trades per second
+    if (stats.uptime.count() > 0) { //avoid dividing by zero right after start
+        stats.orders_per_second = total_orders_processed_ / stats.uptime.count(); //set the orders per second
+        stats.trades_per_second = total_trades_executed_ / stats.uptime.count(); //set the trades per second
+    }
+    stats.exclusive_lock_contentions = exclusive_lock_contentions_.load(std::memory_order_relaxed);
+    stats.shared_lock_contentions = shared_lock_contentions_.load(std::memory_order_relaxed);
+    stats.exclusive_lock_wait_nanoseconds = exclusive_lock_wait_ns_.load(std::memory_order_relaxed);
+    stats.shared_lock_wait_nanoseconds = shared_lock_wait_ns_.load(std::memory_order_relaxed);
+    stats.duplicate_orders_rejected = duplicate_orders_rejected_.load(std::memory_order_relaxed);
+    stats.risk_rejections = risk_rejections_.load(std::memory_order_relaxed);
+    stats.listed_symbols = listings_.size();
     return stats; //return the engine statistics object
 }
 
+MemoryUsage MatchingEngine::getMemoryUsage() const {
+    auto lock = lockShared();
+    MemoryUsage usage = memory_.getUsage(); //symbol map nodes and buckets
+    for (const auto& [symbol, book] : order_books_) {
+        usage += book->getMemoryUsage();
+    }
+    // The books themselves are one make_unique each
+    auto directory = static_cast<size_t>(MemoryCategory::SYMBOL_DIRECTORY);
+    usage.bytes[directory] += order_books_.size() * sizeof(OrderBook);
+    usage.allocations[directory] += order_books_.size();
+    // Session filters are fixed-size: the filter and its arrays, allocated when the session starts
+    auto sessions = static_cast<size_t>(MemoryCategory::SESSION_FILTERS);
+    for (const auto& [session, filter] : session_filters_) {
+        usage.bytes[sessions] += sizeof(DuplicateOrderFilter) + filter->getMemoryBytes();
+        usage.allocations[sessions] += 1 + filter->getAllocationCount();
+    }
+    return usage;
+}
+
+MemoryUsage MatchingEngine::getMemoryUsage(const std::string& symbol) const {
+    auto lock = lockShared();
+    auto it = order_books_.find(symbol);
+    if (it == order_books_.end()) return MemoryUsage{};
+    return it->second->getMemoryUsage();
+}
+
 std::string MatchingEngine::getEngineStatus() const {
     auto stats = getStatistics(); //get the engine statistics
     std::ostringstream oss; //create a new string stream
@@ -189,36 +728,66 @@ std::string MatchingEngine::getEngineStatus() const {
 }
 
 void MatchingEngine::resetStatistics() {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     total_orders_processed_ = 0;
     total_trades_executed_ = 0;
+    exclusive_lock_contentions_ = 0;
+    shared_lock_contentions_ = 0;
+    exclusive_lock_wait_ns_ = 0;
+    shared_lock_wait_ns_ = 0;
+    duplicate_orders_rejected_ = 0;
+    risk_rejections_ = 0;
 
     start_time_ = std::chrono::high_resolution_clock::now();
 }
 
 void MatchingEngine::updateConfig(const EngineConfig& config) {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     config_ = config; //update the config object
 }
 
 EngineConfig MatchingEngine::getConfig() const {
-    std::shared_lock lock(engine_mutex_);
+    auto lock = lockShared();
     return config_; //return the config object
 }
 
 std::string MatchingEngine::getOrderBookState(const std::string& symbol, size_t max_levels) const {
-    std::shared_lock lock(engine_mutex_);
+    auto lock = lockShared();
     auto it = order_books_.find(symbol); //find the order book for the symbol
     if (it == order_books_.end()) return "Symbol not found";
     return it->second->toString(max_levels); //return the order book state for the symbol
 }
 
 void MatchingEngine::clearAllOrderBooks() {
-    std::unique_lock lock(engine_mutex_);
+    auto lock = lockExclusive();
     order_books_.clear();
 }
 
 // --- Private helpers ---
+std::unique_lock<std::shared_mutex> MatchingEngine::lockExclusive() const {
+    std::unique_lock<std::shared_mutex> lock(engine_mutex_, std::try_to_lock); //uncontended path costs the same as lock()
+    if (!lock.owns_lock()) {
+        auto wait_start = std::chrono::steady_clock::now();
+        lock.lock();
+        auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wait_start);
+        exclusive_lock_contentions_.fetch_add(1, std::memory_order_relaxed);
+        exclusive_lock_wait_ns_.fetch_add(waited.count(), std::memory_order_relaxed);
+    }
+    return lock;
+}
+
+std::shared_lock<std::shared_mutex> MatchingEngine::lockShared() const {
+    std::shared_lock<std::shared_mutex> lock(engine_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        auto wait_start = std::chrono::steady_clock::now();
+        lock.lock();
+        auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wait_start);
+        shared_lock_contentions_.fetch_add(1, std::memory_order_relaxed);
+        shared_lock_wait_ns_.fetch_add(waited.count(), std::memory_order_relaxed);
+    }
+    return lock;
+}
+
 bool MatchingEngine::validateOrder(const Order& order) const {
     if (!validateSymbol(order.getSymbol())){
         return false;
@@ -276,6 +845,21 @@ OrderBook* MatchingEngine::getOrderBook(const std::string& symbol) {
     return it->second.get();
 }
 
+OrderBook* MatchingEngine::createOrderBook(const std::string& symbol) {
+    auto& book = order_books_[symbol];
+    book = std::make_unique<OrderBook>(config_.analytics_depth); //creates order book object and wraps it in a unique pointer, which is a smart pointer that automatically manages the memory of the object
+    book->setEventCapture(capturesEvents());
+    if (const ReferenceRecord* listing = findReferenceRecord(listings_.data(), listings_.data() + listings_.size(), symbol)) {
+        book->setRules(listing->getRules());
+    }
+    return book.get();
+}
+
+OrderBook* MatchingEngine::openListedBook(const std::string& symbol) {
+    if (!findReferenceRecord(listings_.data(), listings_.data() + listings_.size(), symbol)) return nullptr;
+    return createOrderBook(symbol);
+}
+
 void MatchingEngine::cleanupEmptyOrderBooks() {
     for (auto it = order_books_.begin(); it != order_books_.end(); ) {
         if (it->second->getOrderCount() == 0) {
@@ -287,6 +871,33 @@ void MatchingEngine::cleanupEmptyOrderBooks() {
 }
 
 
+void MatchingEngine::dispatchEvents(OrderBook& book) {
+    if (book.getEvents().empty()) {
+        return;
+    }
+    int64_t now = wallClockNanos(); //one timestamp per command
+    dispatch_events_.assign(book.getEvents().begin(), book.getEvents().end());
+    book.clearEvents();
+    for (OrderEvent& event : dispatch_events_) {
+        event.sequence = ++event_sequence_;
+        event.timestamp_ns = now;
+        for (const auto& cb : event_callbacks_) {
+            cb(event);
+        }
+    }
+    for (const auto& [id, cb] : event_batch_callbacks_) {
+        cb(dispatch_events_.data(), dispatch_events_.size());
+    }
+}
+
+void MatchingEngine::journalCommand(JournalRecord& record) {
+    record.timestamp_ns = wallClockNanos();
+    journal_->append(record);
+    if (config_.journal_sync_each_command) {
+        journal_->commit();
+    }
+}
+
 void MatchingEngine::broadcastTrade(const Trade& trade) {
     for (const auto& cb : trade_callbacks_) {
         cb(trade);
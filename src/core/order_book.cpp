@@ -1,5 +1,6 @@
 #include "../../include/matching_engine/order_book.hpp"
 #include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <iomanip>
 
@@ -9,42 +10,251 @@ namespace matching_engine {
 // Public Methods
 // =============================================================================
 
+OrderBook::OrderBook(size_t analytics_depth)
+    : bids_(std::greater<Price>(), CountingAllocator<Order>(&memory_, MemoryCategory::LEVEL_INDEX))
+    , asks_(std::less<Price>(), CountingAllocator<Order>(&memory_, MemoryCategory::LEVEL_INDEX))
+    , order_locations_(CountingAllocator<Order>(&memory_, MemoryCategory::ORDER_INDEX))
+    , buy_stops_(std::less<Price>(), CountingAllocator<Order>(&memory_, MemoryCategory::ORDER_STORAGE))
+    , sell_stops_(std::less<Price>(), CountingAllocator<Order>(&memory_, MemoryCategory::ORDER_STORAGE))
+    , stop_locations_(CountingAllocator<Order>(&memory_, MemoryCategory::ORDER_INDEX))
+    , link_groups_(1) //slot 0 stands for NO_LINK
+    , next_trade_id_(0)
+    , analytics_depth_(std::max<size_t>(1, analytics_depth))
+    , top_of_book_sequence_(0)
+    , top_of_book_(std::make_shared<TopOfBookSnapshot>())
+    , events_(CountingAllocator<OrderEvent>(&memory_, MemoryCategory::EVENT_BUFFERS))
+    , capture_events_(false) {
+    // Publish the empty book so readers see depth_levels from the start
+    bid_window_.dirty = true;
+    publishTopOfBook();
+}
+
+void OrderBook::setRules(const InstrumentRules& rules) {
+    if (!isValidRules(rules)) {
+        throw std::invalid_argument("Invalid instrument rules (negative field, empty band or unsupported matching policy)");
+    }
+    rules_ = rules;
+}
+
+void OrderBook::checkRules(Price price, Quantity quantity) const {
+    if (rules_.lot_size > 1 && quantity % rules_.lot_size != 0) {
+        throw std::invalid_argument("Quantity " + std::to_string(quantity) + " is not a multiple of the lot size " +
+                                    std::to_string(rules_.lot_size));
+    }
+    if (price == MARKET_PRICE) return;
+    checkTick(price);
+    if ((rules_.band_low > 0 && price < rules_.band_low) || (rules_.band_high > 0 && price > rules_.band_high)) {
+        throw std::invalid_argument("Price " + std::to_string(price) + " is outside the price band");
+    }
+}
+
+void OrderBook::checkTick(Price price) const {
+    if (rules_.tick_size <= 0) return;
+    double ticks = price / rules_.tick_size;
+    if (std::fabs(ticks - std::round(ticks)) > 1e-6) { //prices are doubles: allow for representation error
+        throw std::invalid_argument("Price " + std::to_string(price) + " is not a multiple of the tick size " +
+                                    std::to_string(rules_.tick_size));
+    }
+}
+
 std::vector<Trade> OrderBook::addOrder(Order order) {
-    std::vector<Trade> trades;
-    
-    if (order.isMarketOrder()) { //if the order is a market order
-        trades = executeMarketOrder(order);
-        // Market orders are never added to book - they execute immediately
-    } else if (order.isLimitOrder()) { //if the order is a limit order
-        trades = matchLimitOrder(order);
-        
-        // If the limit order is not fully filled, add remaining to the book
-        if (!order.isFullyFilled()) {
-            addToBook(order);
-        }
+    if (order_locations_.count(order.getId()) != 0 || (!stop_locations_.empty() && stop_locations_.count(order.getId()) != 0)) {
+        // Resting it would overwrite the live order's location and orphan it in its level
+        throw std::invalid_argument("Order id already resting: " + std::to_string(order.getId()));
     }
+    checkRules(order.getPrice(), order.getQuantity());
+    order.setLink(NO_LINK); //only addLinkedOrders hands out groups
+    std::vector<Trade> trades = enterOrder(order);
+    settleStep(trades);
+
+    publishTopOfBook(); //no-op unless the top K levels changed
 
     // If trades were executed, return the trades
     return trades;
 }
 
+void OrderBook::addStopOrder(Order order, Price trigger_price) {
+    if (!isValidPrice(trigger_price)) {
+        throw std::invalid_argument("Invalid stop trigger price");
+    }
+    if (order_locations_.count(order.getId()) != 0 || stop_locations_.count(order.getId()) != 0) {
+        throw std::invalid_argument("Order id already resting: " + std::to_string(order.getId()));
+    }
+    checkTick(trigger_price);
+    checkRules(order.getPrice(), order.getQuantity());
+    order.setLink(NO_LINK);
+    StopMap& stops = order.isBuyOrder() ? buy_stops_ : sell_stops_;
+    OrderId id = order.getId();
+    stop_locations_[id] = stops.emplace(trigger_price, std::move(order));
+}
+
+std::vector<Trade> OrderBook::addLinkedOrders(std::vector<LinkedOrder> members) {
+    // Check the whole group before anything enters the book
+    if (members.size() < 2) {
+        throw std::invalid_argument("A linked group needs at least two orders");
+    }
+    for (size_t i = 0; i < members.size(); ++i) {
+        const Order& order = members[i].order;
+        if (order.getSymbol() != members[0].order.getSymbol()) {
+            throw std::invalid_argument("Linked orders must share a symbol");
+        }
+        if (members[i].trigger_price == 0 ? !order.isLimitOrder() : !isValidPrice(members[i].trigger_price)) {
+            throw std::invalid_argument("Linked orders are limit orders or stops with a valid trigger");
+        }
+        if (order_locations_.count(order.getId()) != 0 || stop_locations_.count(order.getId()) != 0) {
+            throw std::invalid_argument("Order id already resting: " + std::to_string(order.getId()));
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (members[j].order.getId() == order.getId()) {
+                throw std::invalid_argument("Linked orders need distinct ids");
+            }
+        }
+        if (members[i].trigger_price != 0) {
+            checkTick(members[i].trigger_price);
+        }
+        checkRules(order.getPrice(), order.getQuantity());
+    }
+
+    LinkId link = allocateLink();
+    LinkGroup& group = link_groups_[link];
+    group.members.reserve(members.size());
+    for (auto& member : members) {
+        Order& order = member.order;
+        order.setLink(link);
+        group.members.push_back(LinkMember{order.getId(), order.getSide(), order.getPrice(), member.trigger_price != 0, true, {}});
+        if (member.trigger_price != 0) {
+            StopMap& stops = order.isBuyOrder() ? buy_stops_ : sell_stops_;
+            group.members.back().stop_entry = stops.emplace(member.trigger_price, order);
+            stop_locations_[order.getId()] = group.members.back().stop_entry;
+        }
+    }
+
+    std::vector<Trade> trades;
+    for (auto& member : members) {
+        if (member.trigger_price != 0) {
+            continue;
+        }
+        Order& order = member.order;
+        if (link_groups_[link].fired) {
+            // An earlier member already filled: this one is accepted and cancelled at once
+            recordEvent(OrderEventType::ACCEPTED, order, order.getPrice(), order.getQuantity());
+            recordEvent(OrderEventType::CANCELLED, order, order.getPrice(), order.getRemainingQuantity());
+            retireMember(link, order.getId());
+            continue;
+        }
+        std::vector<Trade> made = enterOrder(order);
+        trades.insert(trades.end(), made.begin(), made.end());
+    }
+    settleStep(trades);
+    publishTopOfBook();
+    return trades;
+}
+
 bool OrderBook::cancelOrder(OrderId order_id) {
-    // Look up order in order_locations_
-    auto it = order_locations_.find(order_id); //iterator to the order
-    if (it == order_locations_.end()) { //if the order is not found
-        return false; // Order not found
+    return removeOrder(order_id).has_value(); //same removal, the caller just doesn't need the order
+}
+
+std::optional<Order> OrderBook::removeOrder(OrderId order_id) {
+    auto it = order_locations_.find(order_id);
+    if (it == order_locations_.end()) {
+        return stop_locations_.empty() ? std::nullopt : removeStop(order_id); // Order not found (or waiting as a stop)
     }
     
-    // Get price and side
-    auto [price, side] = it->second; //get the price and side from the order
+    auto [price, side] = it->second;
+    std::optional<Order> removed;
+    removeFromPriceLevel(price, side, order_id, &removed); //removed receives the resting order
+    order_locations_.erase(it);
+    if (removed) {
+        recordEvent(OrderEventType::CANCELLED, *removed, removed->getPrice(), removed->getRemainingQuantity());
+        if (removed->getLink() != NO_LINK) {
+            retireMember(removed->getLink(), order_id); //the rest of its group stays linked
+        }
+    }
+    publishTopOfBook();
     
-    // Remove from price level
-    removeFromPriceLevel(price, side, order_id); //remove the order from the price level
+    return removed;
+}
+
+std::optional<Order> OrderBook::removeStop(OrderId order_id) {
+    auto it = stop_locations_.find(order_id);
+    if (it == stop_locations_.end()) {
+        return std::nullopt;
+    }
+    Order removed = it->second->second;
+    (removed.isBuyOrder() ? buy_stops_ : sell_stops_).erase(it->second);
+    stop_locations_.erase(it);
+    recordEvent(OrderEventType::CANCELLED, removed, removed.getPrice(), removed.getRemainingQuantity());
+    if (removed.getLink() != NO_LINK) {
+        retireMember(removed.getLink(), order_id);
+    }
+    return removed;
+}
+
+std::optional<Order> OrderBook::replaceOrder(OrderId order_id, Price new_price, Quantity new_quantity, std::vector<Trade>& trades) {
+    // Validate before touching the book so a bad amend leaves the original resting
+    if (!isValidPrice(new_price) || !isValidQuantity(new_quantity)) {
+        throw std::invalid_argument("Invalid replacement price or quantity");
+    }
+    checkRules(new_price, new_quantity);
+    auto it = order_locations_.find(order_id);
+    if (it == order_locations_.end()) {
+        return std::nullopt; // Order not found
+    }
     
-    // Remove from order_locations_
-    order_locations_.erase(it); //remove the order from the order_locations_
+    auto [price, side] = it->second;
+    std::optional<Order> removed;
+    removeFromPriceLevel(price, side, order_id, &removed);
+    order_locations_.erase(it);
+    
+    Order replacement(order_id, removed->getSymbol(), side, OrderType::LIMIT, new_price, new_quantity);
+    replacement.setAccount(removed->getAccount());
+    if (removed->getLink() != NO_LINK) {
+        // Still the same group member, now resting somewhere else
+        replacement.setLink(removed->getLink());
+        for (auto& member : link_groups_[removed->getLink()].members) {
+            if (member.id == order_id) member.price = new_price;
+        }
+    }
+    Order entered = replacement; //returned as entered, before any fills
+    recordEvent(OrderEventType::AMENDED, replacement, new_price, new_quantity);
     
-    return true; //return true if the order is cancelled
+    trades = matchLimitOrder(replacement);
+    if (!replacement.isFullyFilled()) {
+        addToBook(replacement);
+    }
+    settleStep(trades);
+    publishTopOfBook();
+    
+    return entered;
+}
+
+const Order* OrderBook::findOrder(OrderId order_id) const {
+    auto it = order_locations_.find(order_id);
+    if (it == order_locations_.end()) {
+        return nullptr;
+    }
+    // std::queue keeps its container protected; a derived type can hand out a const view of it
+    struct QueueView : OrderQueue {
+        static const OrderQueue::container_type& of(const OrderQueue& queue) { return queue.*(&QueueView::c); }
+    };
+    auto [price, side] = it->second;
+    const PriceLevel* level = nullptr;
+    if (side == OrderSide::BUY) {
+        auto found = bids_.find(price);
+        level = found == bids_.end() ? nullptr : &found->second;
+    } else {
+        auto found = asks_.find(price);
+        level = found == asks_.end() ? nullptr : &found->second;
+    }
+    if (!level) {
+        return nullptr;
+    }
+    for (const Order& order : QueueView::of(level->orders)) {
+        if (order.getId() == order_id) {
+            return &order;
+        }
+    }
+    return nullptr;
 }
 
 std::optional<Price> OrderBook::getBestBid() const {
@@ -79,23 +289,13 @@ Quantity OrderBook::getBestBidQuantity() const {
         return 0; //if there are no bids, return 0
     }
     
-    // Find the price level and sum all quantities in the queue
+    // Find the price level, which carries the total of its queue
     auto price_level_it = bids_.find(*best_bid);
     if (price_level_it == bids_.end()) {
         return 0; //if the price level is not found, return 0
     }
     
-    const auto& orders_queue = price_level_it->second;
-    Quantity total_quantity = 0;
-    
-    // Create a copy of the queue to iterate through it (since std::queue doesn't have iterators)
-    auto temp_queue = orders_queue;
-    while (!temp_queue.empty()) {
-        total_quantity += temp_queue.front().getRemainingQuantity();
-        temp_queue.pop();
-    }
-    
-    return total_quantity;
+    return price_level_it->second.total_quantity; //kept up to date as orders are added, filled and removed
 }
 
 
@@ -110,30 +310,11 @@ Quantity OrderBook::getBestAskQuantity() const {
         return 0; //if the price level is not found, return 0
     }
     
-    const auto& orders_queue = price_level_it->second; //get the queue at the price level
-    Quantity total_quantity = 0;
-
-    auto temp_queue = orders_queue;
-    while (!temp_queue.empty()) {
-        total_quantity += temp_queue.front().getRemainingQuantity();
-        temp_queue.pop();
-    }
-    
-    return total_quantity;
+    return price_level_it->second.total_quantity;
 }
 
 size_t OrderBook::getOrderCount() const {
-    size_t count = 0;
-    
-    // Iterate through both bids_ and asks_ maps
-    for (const auto& [price, queue] : bids_) { //for each price level in bids_
-        count += queue.size(); //add the number of orders in the queue to the count
-    }
-    for (const auto& [price, queue] : asks_) { //for each price level in asks_
-        count += queue.size(); //add the number of orders in the queue to the count
-    }
-    
-    return count; //return the total number of orders
+    return order_locations_.size(); //every resting order has exactly one location entry
 }
 
 std::string OrderBook::toString(size_t max_levels) const {
@@ -144,16 +325,10 @@ std::string OrderBook::toString(size_t max_levels) const {
     oss << "ASKS (lowest first):" << std::endl;
     
     size_t ask_count = 0;
-    for (const auto& [price, queue] : asks_) {
+    for (const auto& [price, level] : asks_) {
         if (ask_count >= max_levels) break;
-        Quantity total_qty = 0;
-        auto temp_queue = queue;
-        while (!temp_queue.empty()) {
-            total_qty += temp_queue.front().getRemainingQuantity();
-            temp_queue.pop();
-        }
         oss << "  ASK " << std::fixed << std::setprecision(3) << price 
-            << " [" << total_qty << " qty, " << queue.size() << " orders]" << std::endl;
+            << " [" << level.total_quantity << " qty, " << level.orders.size() << " orders]" << std::endl;
         ask_count++;
     }
     
@@ -168,16 +343,10 @@ std::string OrderBook::toString(size_t max_levels) const {
     // Display bids (highest prices first, limited by max_levels)
     oss << "BIDS (highest first):" << std::endl;
     size_t bid_count = 0;
-    for (const auto& [price, queue] : bids_) {
+    for (const auto& [price, level] : bids_) {
         if (bid_count >= max_levels) break;
-        Quantity total_qty = 0;
-        auto temp_queue = queue;
-        while (!temp_queue.empty()) {
-            total_qty += temp_queue.front().getRemainingQuantity();
-            temp_queue.pop();
-        }
         oss << "  BID " << std::fixed << std::setprecision(3) << price 
-            << " [" << total_qty << " qty, " << queue.size() << " orders]" << std::endl;
+            << " [" << level.total_quantity << " qty, " << level.orders.size() << " orders]" << std::endl;
         bid_count++;
     }
     
@@ -191,14 +360,8 @@ std::vector<std::pair<Price, Quantity>> OrderBook::getBidLevels(size_t max_level
     std::vector<std::pair<Price, Quantity>> levels;
 
     // Iterate through bids_ map, sum quantities at each price level
-    for (const auto& [price, queue] : bids_) { //for each price level in bids_
-        Quantity total_qty = 0;
-        auto temp_queue = queue;
-        while (!temp_queue.empty()) {
-            total_qty += temp_queue.front().getRemainingQuantity();
-            temp_queue.pop();
-        }
-        levels.push_back({price, total_qty}); //add the price and total quantity to the levels vector
+    for (const auto& [price, level] : bids_) { //for each price level in bids_
+        levels.push_back({price, level.total_quantity}); //add the price and total quantity to the levels vector
         if (levels.size() >= max_levels) break; //if the number of levels is greater than or equal to max_levels, break
     }
     
@@ -209,14 +372,8 @@ std::vector<std::pair<Price, Quantity>> OrderBook::getBidLevels(size_t max_level
 std::vector<std::pair<Price, Quantity>> OrderBook::getAskLevels(size_t max_levels) const {
     std::vector<std::pair<Price, Quantity>> levels;
     // Iterate through asks_ map, sum quantities at each price level
-    for (const auto& [price, queue] : asks_) { //for each price level in asks_
-        Quantity total_qty = 0;
-        auto temp_queue = queue;
-        while (!temp_queue.empty()) {
-            total_qty += temp_queue.front().getRemainingQuantity();
-            temp_queue.pop();
-        }
-        levels.push_back({price, total_qty}); //add the price and total quantity to the levels vector
+    for (const auto& [price, level] : asks_) { //for each price level in asks_
+        levels.push_back({price, level.total_quantity}); //add the price and total quantity to the levels vector
         if (levels.size() >= max_levels) break; //if the number of levels is greater than or equal to max_levels, break
     }
 
@@ -224,12 +381,68 @@ std::vector<std::pair<Price, Quantity>> OrderBook::getAskLevels(size_t max_level
     return levels;
 }
 
+size_t OrderBook::copyBidLevels(DepthLevel* out, size_t max_levels) const {
+    size_t count = 0;
+    for (auto it = bids_.begin(); it != bids_.end() && count < max_levels; ++it, ++count) {
+        out[count] = DepthLevel{it->first, it->second.total_quantity};
+    }
+    return count;
+}
+
+size_t OrderBook::copyAskLevels(DepthLevel* out, size_t max_levels) const {
+    size_t count = 0;
+    for (auto it = asks_.begin(); it != asks_.end() && count < max_levels; ++it, ++count) {
+        out[count] = DepthLevel{it->first, it->second.total_quantity};
+    }
+    return count;
+}
+
 void OrderBook::clear() {
     // Clear bids_
     bids_.clear();
     asks_.clear();
     order_locations_.clear();
+    buy_stops_.clear();
+    sell_stops_.clear();
+    stop_locations_.clear();
+    link_groups_.assign(1, LinkGroup{});
+    free_links_.clear();
+    fired_links_.clear();
     next_trade_id_ = 0;
+    
+    bid_window_ = DepthWindow{};
+    ask_window_ = DepthWindow{};
+    bid_window_.dirty = true;
+    publishTopOfBook();
+}
+
+std::vector<Order> OrderBook::getRestingOrders() const {
+    std::vector<Order> orders;
+    orders.reserve(order_locations_.size());
+    
+    // std::queue can't be iterated, so walk a copy of each level
+    auto collect = [&orders](const auto& levels) {
+        for (const auto& [price, level] : levels) {
+            OrderQueue queue = level.orders;
+            while (!queue.empty()) {
+                orders.push_back(queue.front());
+                queue.pop();
+            }
+        }
+    };
+    collect(bids_);
+    collect(asks_);
+    return orders;
+}
+
+void OrderBook::restore(const std::vector<Order>& orders, TradeId last_trade_id) {
+    clear();
+    for (Order order : orders) {
+        order.setLink(NO_LINK); //groups aren't exported
+        addToBook(order); //no matching: the exported book was already uncrossed
+    }
+    next_trade_id_ = last_trade_id;
+    publishTopOfBook();
 }
 
 // =============================================================================
@@ -244,13 +457,17 @@ std::vector<Trade> OrderBook::executeMarketOrder(Order& market_order) {
     if (market_order.isBuyOrder()) {
         // Match against asks - lowest prices first
         while (market_order.getRemainingQuantity() > 0 && !asks_.empty()) { //while the market order has remaining quantity and there are asks
-            auto& best_price_level = asks_.begin()->second;
+            auto& best_level = asks_.begin()->second;
+            auto& best_price_level = best_level.orders;
             if (best_price_level.empty()) { //if the best price level is empty
                 asks_.erase(asks_.begin()); //remove the best price level
                 continue;
             }
             
             Order& best_order = best_price_level.front();
+            if (best_order.getLink() != NO_LINK && dropFiredMember(best_level, OrderSide::SELL, asks_.begin()->first)) {
+                continue; //its group fired earlier in this step
+            }
             Price execution_price = determineExecutionPrice(market_order, best_order);
             
             // Calculate trade quantity (minimum of remaining quantities)
@@ -264,6 +481,13 @@ std::vector<Trade> OrderBook::executeMarketOrder(Order& market_order) {
             // Fill both orders
             market_order.fill(trade_qty);
             best_order.fill(trade_qty);
+            best_level.total_quantity -= trade_qty;
+            recordFills(market_order, best_order, trade);
+            if ((market_order.getLink() | best_order.getLink()) != NO_LINK) { //one branch for unlinked orders
+                if (market_order.getLink() != NO_LINK) fireLink(market_order);
+                if (best_order.getLink() != NO_LINK) fireLink(best_order);
+            }
+            markDepthChange(OrderSide::SELL, asks_.begin()->first);
             
             // Remove fully filled order from book
             if (best_order.isFullyFilled()) {
@@ -279,13 +503,17 @@ std::vector<Trade> OrderBook::executeMarketOrder(Order& market_order) {
     } else {
         // Market sell order - match against bids (highest prices first)
         while (market_order.getRemainingQuantity() > 0 && !bids_.empty()) {
-            auto& best_price_level = bids_.begin()->second;
+            auto& best_level = bids_.begin()->second;
+            auto& best_price_level = best_level.orders;
             if (best_price_level.empty()) { //if the best price level is empty
                 bids_.erase(bids_.begin()); //remove the best price level
                 continue;
             }
             
             Order& best_order = best_price_level.front();
+            if (best_order.getLink() != NO_LINK && dropFiredMember(best_level, OrderSide::BUY, bids_.begin()->first)) {
+                continue; //its group fired earlier in this step
+            }
             Price execution_price = determineExecutionPrice(market_order, best_order);
             
             // Calculate trade quantity (minimum of remaining quantities)
@@ -299,6 +527,13 @@ std::vector<Trade> OrderBook::executeMarketOrder(Order& market_order) {
             // Fill both orders
             market_order.fill(trade_qty);
             best_order.fill(trade_qty);
+            best_level.total_quantity -= trade_qty;
+            recordFills(market_order, best_order, trade);
+            if ((market_order.getLink() | best_order.getLink()) != NO_LINK) { //one branch for unlinked orders
+                if (market_order.getLink() != NO_LINK) fireLink(market_order);
+                if (best_order.getLink() != NO_LINK) fireLink(best_order);
+            }
+            markDepthChange(OrderSide::BUY, bids_.begin()->first);
             
             // Remove fully filled order from book
             if (best_order.isFullyFilled()) {
@@ -325,13 +560,17 @@ std::vector<Trade> OrderBook::matchLimitOrder(Order& limit_order) {
     if (limit_order.isBuyOrder()) {
         // Match against asks - check if ask price <= limit price
         while (limit_order.getRemainingQuantity() > 0 && !asks_.empty()) { //while the limit order has remaining quantity and there are asks
-            auto& best_price_level = asks_.begin()->second;
+            auto& best_level = asks_.begin()->second;
+            auto& best_price_level = best_level.orders;
             if (best_price_level.empty()) { //if the best price level is empty
                 asks_.erase(asks_.begin()); //remove the best price level
                 continue;
             }
             
             Order& best_ask = best_price_level.front();
+            if (best_ask.getLink() != NO_LINK && dropFiredMember(best_level, OrderSide::SELL, asks_.begin()->first)) {
+                continue; //its group fired earlier in this step
+            }
             
             // Check if limit order can match with this ask
             if (!limit_order.canMatchWith(best_ask)) {
@@ -351,6 +590,13 @@ std::vector<Trade> OrderBook::matchLimitOrder(Order& limit_order) {
             // Fill both orders
             limit_order.fill(trade_qty);
             best_ask.fill(trade_qty);
+            best_level.total_quantity -= trade_qty;
+            recordFills(limit_order, best_ask, trade);
+            if ((limit_order.getLink() | best_ask.getLink()) != NO_LINK) { //one branch for unlinked orders
+                if (limit_order.getLink() != NO_LINK) fireLink(limit_order);
+                if (best_ask.getLink() != NO_LINK) fireLink(best_ask);
+            }
+            markDepthChange(OrderSide::SELL, asks_.begin()->first);
             
             // Remove fully filled order from book
             if (best_ask.isFullyFilled()) {
@@ -366,13 +612,17 @@ std::vector<Trade> OrderBook::matchLimitOrder(Order& limit_order) {
     } else {
         // Limit sell order - match against bids if bid price >= limit price
         while (limit_order.getRemainingQuantity() > 0 && !bids_.empty()) {
-            auto& best_price_level = bids_.begin()->second;
+            auto& best_level = bids_.begin()->second;
+            auto& best_price_level = best_level.orders;
             if (best_price_level.empty()) { //if the best price level is empty
                 bids_.erase(bids_.begin()); //remove the best price level
                 continue;
             }
             
             Order& best_bid = best_price_level.front();
+            if (best_bid.getLink() != NO_LINK && dropFiredMember(best_level, OrderSide::BUY, bids_.begin()->first)) {
+                continue; //its group fired earlier in this step
+            }
             
             // Check if limit order can match with this bid
             if (!limit_order.canMatchWith(best_bid)) {
@@ -392,6 +642,13 @@ std::vector<Trade> OrderBook::matchLimitOrder(Order& limit_order) {
             // Fill both orders
             limit_order.fill(trade_qty);
             best_bid.fill(trade_qty);
+            best_level.total_quantity -= trade_qty;
+            recordFills(limit_order, best_bid, trade);
+            if ((limit_order.getLink() | best_bid.getLink()) != NO_LINK) { //one branch for unlinked orders
+                if (limit_order.getLink() != NO_LINK) fireLink(limit_order);
+                if (best_bid.getLink() != NO_LINK) fireLink(best_bid);
+            }
+            markDepthChange(OrderSide::BUY, bids_.begin()->first);
             
             // Remove fully filled order from book
             if (best_bid.isFullyFilled()) {
@@ -411,18 +668,30 @@ std::vector<Trade> OrderBook::matchLimitOrder(Order& limit_order) {
 
 void OrderBook::addToBook(const Order& order) {
     // Add order to appropriate price level based on side
+    // Levels are built explicitly because their queues need the book's allocator
     if (order.isBuyOrder()) {
-        bids_[order.getPrice()].push(order);
+        auto level_it = bids_.find(order.getPrice());
+        if (level_it == bids_.end()) {
+            level_it = bids_.emplace(order.getPrice(), makeLevel()).first;
+        }
+        level_it->second.orders.push(order);
+        level_it->second.total_quantity += order.getRemainingQuantity();
     } else {
-        asks_[order.getPrice()].push(order);
+        auto level_it = asks_.find(order.getPrice());
+        if (level_it == asks_.end()) {
+            level_it = asks_.emplace(order.getPrice(), makeLevel()).first;
+        }
+        level_it->second.orders.push(order);
+        level_it->second.total_quantity += order.getRemainingQuantity();
     }
+    markDepthChange(order.getSide(), order.getPrice());
     
     // Add to order_locations_ for fast lookup during cancellation
     order_locations_[order.getId()] = {order.getPrice(), order.getSide()};
 }
 
-bool OrderBook::removeFromPriceLevel(Price price, OrderSide side, OrderId order_id) {
-    std::queue<Order>* orders_queue_ptr = nullptr; //pointer to the orders queue
+bool OrderBook::removeFromPriceLevel(Price price, OrderSide side, OrderId order_id, std::optional<Order>* removed) {
+    PriceLevel* level_ptr = nullptr; //pointer to the price level
     
     // Get the appropriate queue based on order side
     if (side == OrderSide::BUY) {
@@ -430,21 +699,21 @@ bool OrderBook::removeFromPriceLevel(Price price, OrderSide side, OrderId order_
         if (price_level_it == bids_.end()) {
             return false; // Price level not found
         }
-        orders_queue_ptr = &(price_level_it->second);
+        level_ptr = &(price_level_it->second);
     } else {
         auto price_level_it = asks_.find(price); //find the price level iterator
         if (price_level_it == asks_.end()) {
             return false; // Price level not found
         }
-        orders_queue_ptr = &(price_level_it->second);
+        level_ptr = &(price_level_it->second);
     }
     
-    auto& orders_queue = *orders_queue_ptr; //get the orders queue
+    auto& orders_queue = level_ptr->orders; //get the orders queue
     
     // Since std::queue doesn't support removal from middle, we need to pop all orders, skip the target, and push the rest back
 
     
-    std::queue<Order> temp_queue; //temporary queue
+    OrderQueue temp_queue = makeLevel().orders; //temporary queue
     bool found = false; //flag to check if the order is found
     
     while (!orders_queue.empty()) {
@@ -453,12 +722,19 @@ bool OrderBook::removeFromPriceLevel(Price price, OrderSide side, OrderId order_
         
         if (current_order.getId() == order_id) {
             found = true; // Skip this order (don't add to temp_queue)
+            level_ptr->total_quantity -= current_order.getRemainingQuantity();
+            if (removed) {
+                *removed = current_order;
+            }
         } else {
             temp_queue.push(current_order); // Keep this order
         }
     }
     
     orders_queue = std::move(temp_queue); //put the remaining orders back into the orders queue
+    if (found) {
+        markDepthChange(side, price);
+    }
     
     // If the price level is now empty, remove it from the map
     if (orders_queue.empty()) {
@@ -472,12 +748,253 @@ bool OrderBook::removeFromPriceLevel(Price price, OrderSide side, OrderId order_
     return found;
 }
 
+// =============================================================================
+// Stops and Linked Groups
+// =============================================================================
+
+std::vector<Trade> OrderBook::enterOrder(Order& order) {
+    std::vector<Trade> trades;
+    recordEvent(OrderEventType::ACCEPTED, order, order.getPrice(), order.getQuantity());
+    
+    if (order.isMarketOrder()) { //if the order is a market order
+        trades = executeMarketOrder(order);
+        // Market orders are never added to book - they execute immediately
+        if (!order.isFullyFilled()) {
+            recordEvent(OrderEventType::EXPIRED, order, order.getPrice(), order.getRemainingQuantity());
+        }
+    } else if (order.isLimitOrder()) { //if the order is a limit order
+        trades = matchLimitOrder(order);
+        
+        // If the limit order is not fully filled, add remaining to the book
+        if (!order.isFullyFilled()) {
+            addToBook(order);
+        }
+    }
+    return trades;
+}
+
+void OrderBook::settleStep(std::vector<Trade>& trades) {
+    cancelFiredSiblings();
+
+    // The step's last trade may have reached stop triggers; each triggered stop enters as a new order
+    while (!trades.empty() && !stop_locations_.empty()) {
+        Price last = trades.back().price;
+        StopMap* stops = nullptr;
+        StopMap::iterator triggered;
+        if (!buy_stops_.empty() && buy_stops_.begin()->first <= last) {
+            stops = &buy_stops_;
+            triggered = buy_stops_.begin();
+        } else if (!sell_stops_.empty() && std::prev(sell_stops_.end())->first >= last) {
+            stops = &sell_stops_;
+            triggered = sell_stops_.lower_bound(std::prev(sell_stops_.end())->first); //earliest of the highest trigger
+        } else {
+            break;
+        }
+        Order order = triggered->second;
+        stop_locations_.erase(order.getId());
+        stops->erase(triggered);
+        if (order.getLink() != NO_LINK) {
+            fireLink(order); //triggering counts: its siblings go before it enters
+            cancelFiredSiblings();
+        }
+        std::vector<Trade> made = enterOrder(order);
+        trades.insert(trades.end(), made.begin(), made.end());
+        cancelFiredSiblings();
+    }
+}
+
+void OrderBook::cancelFiredSiblings() {
+    for (LinkId link : fired_links_) {
+        for (auto& member : link_groups_[link].members) {
+            if (!member.live) continue;
+            member.live = false;
+            if (member.stop) {
+                Order order = member.stop_entry->second;
+                (order.isBuyOrder() ? buy_stops_ : sell_stops_).erase(member.stop_entry);
+                stop_locations_.erase(member.id);
+                recordEvent(OrderEventType::CANCELLED, order, order.getPrice(), order.getRemainingQuantity());
+            } else {
+                // Resting sibling the fill loop didn't meet: the member knows its level, but the level's
+                // queue holds orders by value, so it is removed there by id like any cancel
+                std::optional<Order> removed;
+                if (removeFromPriceLevel(member.price, member.side, member.id, &removed)) {
+                    order_locations_.erase(member.id);
+                    recordEvent(OrderEventType::CANCELLED, *removed, removed->getPrice(), removed->getRemainingQuantity());
+                }
+            }
+        }
+        releaseLink(link);
+    }
+    fired_links_.clear();
+}
+
+void OrderBook::fireLink(Order& member) {
+    LinkId link = member.getLink();
+    member.setLink(NO_LINK); //the member that filled or triggered carries on unlinked
+    LinkGroup& group = link_groups_[link];
+    for (auto& sibling : group.members) {
+        if (sibling.id == member.getId()) {
+            sibling.live = false;
+        }
+    }
+    if (!group.fired) {
+        group.fired = true;
+        fired_links_.push_back(link);
+    }
+}
+
+bool OrderBook::dropFiredMember(PriceLevel& level, OrderSide side, Price price) {
+    Order& order = level.orders.front();
+    LinkGroup& group = link_groups_[order.getLink()];
+    if (!group.fired) {
+        return false;
+    }
+    for (auto& member : group.members) {
+        if (member.id == order.getId()) {
+            member.live = false;
+        }
+    }
+    order_locations_.erase(order.getId());
+    level.total_quantity -= order.getRemainingQuantity();
+    recordEvent(OrderEventType::CANCELLED, order, order.getPrice(), order.getRemainingQuantity());
+    markDepthChange(side, price);
+    level.orders.pop(); //an emptied level is erased by the caller's loop
+    return true;
+}
+
+void OrderBook::retireMember(LinkId link, OrderId order_id) {
+    LinkGroup& group = link_groups_[link];
+    bool anyone_left = false;
+    for (auto& member : group.members) {
+        if (member.id == order_id) {
+            member.live = false;
+        }
+        anyone_left = anyone_left || member.live;
+    }
+    if (!anyone_left && !group.fired) {
+        releaseLink(link); //a fired group is released by cancelFiredSiblings
+    }
+}
+
+LinkId OrderBook::allocateLink() {
+    if (!free_links_.empty()) {
+        LinkId link = free_links_.back();
+        free_links_.pop_back();
+        return link;
+    }
+    link_groups_.emplace_back();
+    return static_cast<LinkId>(link_groups_.size() - 1);
+}
+
+void OrderBook::releaseLink(LinkId link) {
+    link_groups_[link] = LinkGroup{};
+    free_links_.push_back(link);
+}
+
+// =============================================================================
+// Top of Book Analytics
+// =============================================================================
+
+void OrderBook::markDepthChange(OrderSide side, Price price) {
+    DepthWindow& window = (side == OrderSide::BUY) ? bid_window_ : ask_window_;
+    if (window.dirty) {
+        return; //already being recomputed at the end of this command
+    }
+    // Anything at or better than the K-th level, or any change while the side is shallower than K, can move the top K
+    bool inside = window.levels < analytics_depth_ ||
+                  (side == OrderSide::BUY ? price >= window.boundary : price <= window.boundary);
+    if (inside) {
+        window.dirty = true;
+    }
+}
+
+void OrderBook::publishTopOfBook() {
+    if (!bid_window_.dirty && !ask_window_.dirty) {
+        return; //nothing in the top K moved
+    }
+    
+    // Walk at most K levels per dirty side using the cached level totals
+    auto recompute = [this](const auto& levels, DepthWindow& window) {
+        window = DepthWindow{};
+        for (const auto& [price, level] : levels) {
+            if (window.levels >= analytics_depth_) break;
+            window.boundary = price;
+            window.levels++;
+            window.quantity += level.total_quantity;
+            window.notional += price * static_cast<double>(level.total_quantity);
+        }
+    };
+    if (bid_window_.dirty) recompute(bids_, bid_window_);
+    if (ask_window_.dirty) recompute(asks_, ask_window_);
+    
+    TopOfBook top;
+    if (!bids_.empty()) {
+        top.best_bid = bids_.begin()->first;
+        top.best_bid_quantity = bids_.begin()->second.total_quantity;
+    }
+    if (!asks_.empty()) {
+        top.best_ask = asks_.begin()->first;
+        top.best_ask_quantity = asks_.begin()->second.total_quantity;
+    }
+    top.bid_depth_quantity = bid_window_.quantity;
+    top.ask_depth_quantity = ask_window_.quantity;
+    
+    double bid_depth = static_cast<double>(bid_window_.quantity);
+    double ask_depth = static_cast<double>(ask_window_.quantity);
+    if (bid_depth + ask_depth > 0) {
+        top.imbalance = (bid_depth - ask_depth) / (bid_depth + ask_depth);
+    }
+    if (top.hasBid() && top.hasAsk()) {
+        double bid_qty = static_cast<double>(top.best_bid_quantity);
+        double ask_qty = static_cast<double>(top.best_ask_quantity);
+        top.microprice = (top.best_bid * ask_qty + top.best_ask * bid_qty) / (bid_qty + ask_qty);
+        top.depth_weighted_mid = (bid_window_.notional / bid_depth + ask_window_.notional / ask_depth) / 2.0;
+    }
+    top.depth_levels = analytics_depth_;
+    top.sequence = ++top_of_book_sequence_;
+    
+    top_of_book_->publish(top);
+}
+
+// =============================================================================
+// Lifecycle Events
+// =============================================================================
+
+void OrderBook::recordEvent(OrderEventType type, const Order& order, Price price, Quantity quantity, TradeId trade_id) {
+    if (!capture_events_) {
+        return;
+    }
+    OrderEvent event;
+    event.order_id = order.getId();
+    event.account = order.getAccount();
+    event.trade_id = trade_id;
+    event.price = price;
+    event.quantity = quantity;
+    bool removed = type == OrderEventType::CANCELLED || type == OrderEventType::EXPIRED;
+    event.remaining_quantity = removed ? 0 : order.getRemainingQuantity();
+    event.setSymbol(order.getSymbol());
+    event.type = type;
+    event.side = order.getSide();
+    event.order_type = order.getType();
+    events_.push_back(event);
+}
+
+void OrderBook::recordFills(const Order& aggressor, const Order& passive, const Trade& trade) {
+    if (!capture_events_) {
+        return;
+    }
+    for (const Order* order : {&aggressor, &passive}) {
+        auto type = order->isFullyFilled() ? OrderEventType::FILLED : OrderEventType::PARTIALLY_FILLED;
+        recordEvent(type, *order, trade.price, trade.quantity, trade.trade_id);
+    }
+}
+
 // =============================================================================
 // Helper Functions for Trade Creation
 // =============================================================================
 
 Trade OrderBook::createTrade(const Order& buy_order, const Order& sell_order, const std::string& symbol, Price execution_price, Quantity quantity) {
-    return Trade(generateTradeId(), symbol, buy_order.getId(), sell_order.getId(), execution_price, quantity);
+    return Trade(generateTradeId(), symbol, execution_price, quantity, buy_order.getId(), sell_order.getId());
 }
 
 Price OrderBook::determineExecutionPrice(const Order& aggressive_order, const Order& passive_order) {
@@ -0,0 +1,235 @@
+#include "matching_engine/output_sequencer.hpp"
+#include "matching_engine/journal.hpp"
+#include <iostream>
+#include <stdexcept>
+
+namespace matching_engine {
+
+// =============================================================================
+// Inputs
+// =============================================================================
+
+OutputSequencer::Input::Input(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+void OutputSequencer::Input::publish(const OrderEvent* events, size_t count) {
+    if (count == 0 || closed_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (head - cached_tail_ == slots_.size()) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ == slots_.size()) {
+                // Full: the shard waits for the sequencer (the ring bounds the backlog)
+                stalls_.fetch_add(1, std::memory_order_relaxed);
+                head_.store(head, std::memory_order_release);
+                while (head - cached_tail_ == slots_.size()) {
+                    if (closed_.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                    cached_tail_ = tail_.load(std::memory_order_acquire);
+                }
+            }
+        }
+        const OrderEvent& event = events[i];
+        int64_t key = event.timestamp_ns;
+        if (key < floor_) {
+            key = floor_; //the wall clock stepped back: keep the input's own order
+            clamped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        floor_ = key;
+        if (last_sequence_ != 0 && event.sequence != last_sequence_ + 1) {
+            gaps_.fetch_add(1, std::memory_order_relaxed);
+        }
+        last_sequence_ = event.sequence;
+        Slot& slot = slots_[head & mask_];
+        slot.key = key;
+        slot.event = event;
+        ++head;
+    }
+    head_.store(head, std::memory_order_release);
+    watermark_.store(floor_, std::memory_order_release);
+}
+
+void OutputSequencer::Input::heartbeat(int64_t now_ns) {
+    if (now_ns > floor_) {
+        floor_ = now_ns;
+        watermark_.store(floor_, std::memory_order_release);
+    }
+}
+
+void OutputSequencer::Input::close() {
+    closed_.store(true, std::memory_order_relaxed);
+    watermark_.store(INT64_MAX, std::memory_order_release);
+}
+
+// =============================================================================
+// Lifecycle
+// =============================================================================
+
+OutputSequencer::OutputSequencer(const SequencerOptions& options)
+    : options_(options), delay_(std::make_unique<LatencyHistogram>()) {
+    if (options_.ring_capacity == 0 || options_.max_batch == 0) {
+        throw std::invalid_argument("Sequencer ring capacity and batch size must be positive");
+    }
+}
+
+OutputSequencer::~OutputSequencer() {
+    stop();
+}
+
+OutputSequencer::Input& OutputSequencer::addInput() {
+    if (thread_.joinable()) {
+        throw std::runtime_error("Sequencer inputs must be added before start()");
+    }
+    inputs_.push_back(std::make_shared<Input>(options_.ring_capacity));
+    return *inputs_.back();
+}
+
+size_t OutputSequencer::attach(EngineShard& shard) {
+    addInput();
+    std::shared_ptr<Input> input = inputs_.back();
+    shard.getEngine().registerEventBatchCallback([input](const OrderEvent* events, size_t count) {
+        input->publish(events, count);
+    });
+    // Read after the batch's events were stamped: whatever the shard applies next is stamped later
+    shard.setTickCallback([input](bool stopping) {
+        if (stopping) {
+            input->close();
+        } else {
+            input->heartbeat(wallClockNanos());
+        }
+    });
+    return inputs_.size() - 1;
+}
+
+void OutputSequencer::start() {
+    if (thread_.joinable() || stopping_.load()) {
+        return;
+    }
+    cursors_.clear();
+    for (const auto& input : inputs_) {
+        cursors_.push_back(Cursor{input.get()});
+    }
+    thread_ = std::thread(&OutputSequencer::run, this);
+}
+
+void OutputSequencer::stop() {
+    stopping_.store(true, std::memory_order_release);
+    for (const auto& input : inputs_) {
+        input->close();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+SequencerStatistics OutputSequencer::getStatistics() const {
+    SequencerStatistics stats;
+    stats.events = events_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    for (const auto& input : inputs_) {
+        stats.producer_stalls += input->stalls_.load(std::memory_order_relaxed);
+        stats.clamped += input->clamped_.load(std::memory_order_relaxed);
+        stats.input_gaps += input->gaps_.load(std::memory_order_relaxed);
+    }
+    stats.inputs = inputs_.size();
+    return stats;
+}
+
+// =============================================================================
+// Merging
+// =============================================================================
+
+void OutputSequencer::run() {
+    std::vector<SequencedEvent> out;
+    out.reserve(options_.max_batch);
+    uint64_t next_sequence = 1;
+    while (true) {
+        bool stopping = stopping_.load(std::memory_order_acquire); //before merging: inputs are closed by then
+        merge(out, next_sequence);
+        if (!out.empty()) {
+            deliver(out);
+            continue;
+        }
+        if (stopping) {
+            return; //every input closed and empty
+        }
+        std::this_thread::sleep_for(options_.idle_wait);
+    }
+}
+
+void OutputSequencer::merge(std::vector<SequencedEvent>& out, uint64_t& next_sequence) {
+    out.clear();
+    while (out.size() < options_.max_batch) {
+        // Earliest buffered event, and the earliest (time, input) an empty input could still send
+        size_t best = cursors_.size();
+        int64_t best_key = 0;
+        size_t bound = cursors_.size();
+        int64_t bound_key = INT64_MAX;
+        for (size_t i = 0; i < cursors_.size(); ++i) {
+            Cursor& cursor = cursors_[i];
+            if (cursor.tail == cursor.head) {
+                // Watermark first: events published before it are then visible in head_
+                int64_t watermark = cursor.input->watermark_.load(std::memory_order_acquire);
+                cursor.head = cursor.input->head_.load(std::memory_order_acquire);
+                if (cursor.tail == cursor.head) {
+                    if (watermark < bound_key) {
+                        bound = i;
+                        bound_key = watermark;
+                    }
+                    continue;
+                }
+            }
+            int64_t key = cursor.input->slots_[cursor.tail & cursor.input->mask_].key;
+            if (best == cursors_.size() || key < best_key) {
+                best = i;
+                best_key = key;
+            }
+        }
+        if (best == cursors_.size()) {
+            break;
+        }
+        // Ties go to the lower input: an empty input at the same time only holds back higher ones
+        if (bound != cursors_.size() && (bound_key < best_key || (bound_key == best_key && bound < best))) {
+            break;
+        }
+        Cursor& cursor = cursors_[best];
+        out.push_back(SequencedEvent{next_sequence++, static_cast<uint32_t>(best),
+                                     cursor.input->slots_[cursor.tail & cursor.input->mask_].event});
+        cursor.tail++;
+    }
+    // Hand the slots back once per batch
+    for (Cursor& cursor : cursors_) {
+        if (cursor.input->tail_.load(std::memory_order_relaxed) != cursor.tail) {
+            cursor.input->tail_.store(cursor.tail, std::memory_order_release);
+        }
+    }
+}
+
+void OutputSequencer::deliver(const std::vector<SequencedEvent>& out) {
+    int64_t now = wallClockNanos();
+    for (const auto& sequenced : out) {
+        delay_->record(now > sequenced.event.timestamp_ns ? static_cast<uint64_t>(now - sequenced.event.timestamp_ns) : 0);
+    }
+    events_.fetch_add(out.size(), std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    if (!on_events_) {
+        return;
+    }
+    try {
+        on_events_(out.data(), out.size());
+    } catch (const std::exception& e) {
+        std::cerr << "OutputSequencer: event callback failed: " << e.what() << std::endl;
+    }
+}
+
+} // namespace matching_engine
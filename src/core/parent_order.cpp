@@ -0,0 +1,278 @@
+#include "matching_engine/parent_order.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace matching_engine {
+
+void ParentOrderScheduler::validate(const ParentOrderSpec& spec) {
+    if (spec.id == INVALID_ORDER_ID) {
+        throw std::invalid_argument("Parent order ID cannot be zero");
+    }
+    if (spec.symbol.empty()) {
+        throw std::invalid_argument("Parent order symbol cannot be empty");
+    }
+    if (!isValidQuantity(spec.quantity)) {
+        throw std::invalid_argument("Parent order quantity must be between " + std::to_string(MIN_QUANTITY) + " and " +
+                                    std::to_string(MAX_QUANTITY));
+    }
+    if (!isValidPrice(spec.limit_price)) {
+        throw std::invalid_argument("Parent order needs a valid limit price for its children");
+    }
+    if (spec.algo == ParentAlgo::TWAP) {
+        if (spec.slices == 0 || spec.duration.count() < 0) {
+            throw std::invalid_argument("TWAP parent needs at least one slice and a non-negative duration");
+        }
+    } else {
+        if (!(spec.participation > 0.0 && spec.participation <= 1.0)) {
+            throw std::invalid_argument("POV participation must be in (0, 1]");
+        }
+        if (spec.min_child_quantity == 0) {
+            throw std::invalid_argument("POV minimum child quantity must be positive");
+        }
+    }
+}
+
+// =============================================================================
+// Parent Lifecycle
+// =============================================================================
+
+void ParentOrderScheduler::add(const ParentOrderSpec& spec, int64_t now_ns, std::vector<EngineCommand>& out) {
+    validate(spec);
+    if (parents_.count(spec.id)) {
+        throw std::invalid_argument("Parent order " + std::to_string(spec.id) + " is already working");
+    }
+    now_ns_ = std::max(now_ns_, now_ns);
+    Parent& parent = parents_[spec.id];
+    parent.spec = spec;
+    parent.state.id = spec.id;
+    parent.state.symbol = spec.symbol;
+    parent.state.side = spec.side;
+    parent.state.algo = spec.algo;
+    parent.state.quantity = spec.quantity;
+
+    if (spec.algo == ParentAlgo::TWAP) {
+        parent.interval_ns = spec.duration.count() / static_cast<int64_t>(spec.slices);
+        parent.next_slice_ns = now_ns_;
+        releaseSlice(parent, out);
+    } else {
+        Flow& flow = flows_[spec.symbol];
+        flow.parents++;
+        parent.volume_at_start = flow.volume;
+        scheduleParticipation(parent, flow);
+    }
+    report(parent);
+}
+
+bool ParentOrderScheduler::cancel(OrderId parent_id, std::vector<EngineCommand>& out) {
+    if (!parents_.count(parent_id)) {
+        return false;
+    }
+    finish(parent_id, ParentStatus::CANCELLED, out);
+    return true;
+}
+
+void ParentOrderScheduler::finish(OrderId parent_id, ParentStatus status, std::vector<EngineCommand>& out) {
+    auto it = parents_.find(parent_id);
+    Parent& parent = it->second;
+    for (OrderId child : parent.live_children) {
+        out.push_back(EngineCommand::cancel(parent.spec.session, child, parent.spec.symbol));
+        out.back().enqueue_ns = now_ns_;
+        children_.erase(child); //its cancel result then belongs to nobody
+    }
+    parent.state.status = status;
+    parent.state.working = 0;
+    report(parent);
+
+    if (parent.spec.algo == ParentAlgo::POV) {
+        auto flow = flows_.find(parent.spec.symbol);
+        if (flow != flows_.end() && --flow->second.parents == 0) {
+            flows_.erase(flow); //stale heap entries go with it
+        }
+    }
+    parents_.erase(it);
+}
+
+void ParentOrderScheduler::report(const Parent& parent) {
+    if (on_state_) {
+        on_state_(parent.state);
+    }
+}
+
+std::optional<ParentOrderState> ParentOrderScheduler::getState(OrderId parent_id) const {
+    auto it = parents_.find(parent_id);
+    if (it == parents_.end()) {
+        return std::nullopt;
+    }
+    return it->second.state;
+}
+
+// =============================================================================
+// Releasing Children
+// =============================================================================
+
+void ParentOrderScheduler::release(Parent& parent, Quantity quantity, std::vector<EngineCommand>& out) {
+    if (quantity == 0) {
+        return;
+    }
+    OrderId child_id = next_child_id_++;
+    Order child(child_id, parent.spec.symbol, parent.spec.side, OrderType::LIMIT, parent.spec.limit_price, quantity);
+    child.setAccount(parent.spec.account);
+    child.setSession(parent.spec.session);
+    child.setParent(parent.spec.id);
+    out.push_back(EngineCommand::newOrder(child));
+    out.back().enqueue_ns = now_ns_;
+
+    children_[child_id] = Child{parent.spec.id, quantity};
+    parent.live_children.insert(child_id);
+    parent.state.released += quantity;
+    parent.state.working += quantity;
+    parent.state.children++;
+    parent.state.last_child = child_id;
+    children_released_++;
+}
+
+void ParentOrderScheduler::releaseSlice(Parent& parent, std::vector<EngineCommand>& out) {
+    Quantity unreleased = parent.state.quantity - parent.state.released;
+    size_t slices_left = parent.spec.slices - parent.slices_released;
+    if (slices_left == 0) {
+        release(parent, unreleased, out); //quantity handed back by a cancelled child after the last slice
+        return;
+    }
+    release(parent, (unreleased + slices_left - 1) / slices_left, out);
+    parent.slices_released++;
+    if (parent.slices_released < parent.spec.slices) {
+        parent.next_slice_ns += parent.interval_ns;
+        slices_due_.push({parent.next_slice_ns, parent.spec.id});
+    }
+}
+
+void ParentOrderScheduler::scheduleParticipation(Parent& parent, Flow& flow) {
+    Quantity unreleased = parent.state.quantity - parent.state.released;
+    if (unreleased == 0) {
+        return;
+    }
+    // Smallest volume at which participation x traded covers released + the next child
+    Quantity step = std::min(parent.spec.min_child_quantity, unreleased);
+    double needed = std::ceil(static_cast<double>(parent.state.released + step) / parent.spec.participation);
+    parent.next_volume = std::max(parent.volume_at_start + static_cast<Quantity>(needed), flow.volume + 1);
+    flow.due.push({parent.next_volume, parent.spec.id});
+}
+
+void ParentOrderScheduler::releaseParticipation(Parent& parent, Quantity volume, std::vector<EngineCommand>& out) {
+    double share = parent.spec.participation * static_cast<double>(volume - parent.volume_at_start);
+    Quantity target = std::min(parent.state.quantity, static_cast<Quantity>(share));
+    if (target > parent.state.released) {
+        release(parent, target - parent.state.released, out);
+    }
+}
+
+// =============================================================================
+// Events
+// =============================================================================
+
+void ParentOrderScheduler::onTimer(int64_t now_ns, std::vector<EngineCommand>& out) {
+    now_ns_ = std::max(now_ns_, now_ns);
+    while (!slices_due_.empty() && slices_due_.top().first <= now_ns_) {
+        auto [due, parent_id] = slices_due_.top();
+        slices_due_.pop();
+        auto it = parents_.find(parent_id);
+        if (it == parents_.end() || it->second.next_slice_ns != due) {
+            continue; //finished, or rescheduled since
+        }
+        releaseSlice(it->second, out);
+        report(it->second);
+    }
+}
+
+void ParentOrderScheduler::onResult(const CommandResult& result, std::vector<EngineCommand>& out) {
+    if (children_.empty() && flows_.empty()) {
+        return; //nothing working: the common case costs one branch per result
+    }
+
+    auto child = children_.find(result.order_id);
+    if (child != children_.end()) {
+        bool refused = result.type == CommandType::NEW_ORDER && result.status == CommandStatus::REJECTED;
+        bool cancelled = result.type == CommandType::CANCEL && result.status == CommandStatus::ACCEPTED;
+        if (refused || cancelled) {
+            Parent& parent = parents_.at(child->second.parent);
+            Quantity returned = child->second.remaining;
+            parent.live_children.erase(child->first);
+            parent.state.released -= returned;
+            parent.state.working -= returned;
+            children_.erase(child);
+            if (refused) {
+                finish(parent.spec.id, ParentStatus::REJECTED, out);
+                return;
+            }
+            // Someone else cancelled a child: its quantity goes back into the schedule
+            if (parent.spec.algo == ParentAlgo::TWAP) {
+                if (parent.slices_released == parent.spec.slices) {
+                    parent.next_slice_ns = now_ns_;
+                    slices_due_.push({now_ns_, parent.spec.id});
+                }
+            } else {
+                scheduleParticipation(parent, flows_.at(parent.spec.symbol));
+            }
+            report(parent);
+        }
+    }
+
+    for (const auto& trade : result.trades) {
+        bool own = false;
+        if (children_.count(trade.buy_order_id)) {
+            own = true;
+            recordFill(trade.buy_order_id, trade.quantity, out);
+        }
+        if (children_.count(trade.sell_order_id)) {
+            own = true;
+            recordFill(trade.sell_order_id, trade.quantity, out);
+        }
+        if (!own) {
+            recordVolume(trade.symbol, trade.quantity, out);
+        }
+    }
+}
+
+void ParentOrderScheduler::recordFill(OrderId child_id, Quantity quantity, std::vector<EngineCommand>& out) {
+    auto child = children_.find(child_id);
+    Parent& parent = parents_.at(child->second.parent);
+    Quantity filled = std::min(quantity, child->second.remaining);
+    child->second.remaining -= filled;
+    parent.state.filled += filled;
+    parent.state.working -= filled;
+    if (child->second.remaining == 0) {
+        parent.live_children.erase(child_id);
+        children_.erase(child);
+    }
+    if (parent.state.filled >= parent.state.quantity) {
+        finish(parent.spec.id, ParentStatus::COMPLETED, out);
+    } else {
+        report(parent);
+    }
+}
+
+void ParentOrderScheduler::recordVolume(const std::string& symbol, Quantity quantity, std::vector<EngineCommand>& out) {
+    if (flows_.empty()) {
+        return;
+    }
+    auto it = flows_.find(symbol);
+    if (it == flows_.end()) {
+        return;
+    }
+    Flow& flow = it->second;
+    flow.volume += quantity;
+    while (!flow.due.empty() && flow.due.top().first <= flow.volume) {
+        auto [due, parent_id] = flow.due.top();
+        flow.due.pop();
+        auto parent = parents_.find(parent_id);
+        if (parent == parents_.end() || parent->second.next_volume != due) {
+            continue; //finished, or rescheduled since
+        }
+        releaseParticipation(parent->second, flow.volume, out);
+        scheduleParticipation(parent->second, flow);
+        report(parent->second);
+    }
+}
+
+} // namespace matching_engine
@@ -0,0 +1,249 @@
+#include "matching_engine/pooled_order_book.hpp"
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace matching_engine {
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+template <typename Levels>
+std::vector<std::pair<Price, Quantity>> PooledOrderBook::collectLevels(const Levels& levels, size_t max_levels) {
+    std::vector<std::pair<Price, Quantity>> result;
+    for (const auto& [price, level] : levels) {
+        if (result.size() >= max_levels) break;
+        result.push_back({price, level.total_quantity});
+    }
+    return result;
+}
+
+PooledOrderBook::PooledOrderBook()
+    : bids_(std::greater<Price>(), CountingAllocator<Level>(&memory_, MemoryCategory::LEVEL_INDEX))
+    , asks_(std::less<Price>(), CountingAllocator<Level>(&memory_, MemoryCategory::LEVEL_INDEX))
+    , nodes_(CountingAllocator<Node>(&memory_, MemoryCategory::ORDER_STORAGE))
+    , free_head_(NIL)
+    , order_nodes_(CountingAllocator<NodeIndex>(&memory_, MemoryCategory::ORDER_INDEX))
+    , next_trade_id_(0)
+    , order_count_(0) {}
+
+std::vector<Trade> PooledOrderBook::addOrder(Order order) {
+    if (order_nodes_.count(order.getId()) != 0) {
+        throw std::invalid_argument("Order id already resting: " + std::to_string(order.getId()));
+    }
+    std::vector<Trade> trades;
+
+    if (order.isBuyOrder()) {
+        match(asks_, order, trades);
+    } else {
+        match(bids_, order, trades);
+    }
+
+    // Market orders never rest; limit orders rest whatever is left
+    if (order.isLimitOrder() && !order.isFullyFilled()) {
+        addToBook(order);
+    }
+    return trades;
+}
+
+std::optional<Order> PooledOrderBook::removeOrder(OrderId order_id) {
+    auto it = order_nodes_.find(order_id);
+    if (it == order_nodes_.end()) {
+        return std::nullopt; // Order not found
+    }
+
+    NodeIndex index = it->second;
+    Order removed = nodes_[index].order;
+    order_nodes_.erase(it);
+
+    if (removed.isBuyOrder()) {
+        unlink(bids_, bids_.find(removed.getPrice()), index);
+    } else {
+        unlink(asks_, asks_.find(removed.getPrice()), index);
+    }
+    return removed;
+}
+
+std::optional<Price> PooledOrderBook::getBestBid() const {
+    if (bids_.empty()) return std::nullopt;
+    return bids_.begin()->first;
+}
+
+std::optional<Price> PooledOrderBook::getBestAsk() const {
+    if (asks_.empty()) return std::nullopt;
+    return asks_.begin()->first;
+}
+
+std::optional<Price> PooledOrderBook::getSpread() const {
+    auto best_bid = getBestBid();
+    auto best_ask = getBestAsk();
+    if (best_bid && best_ask) {
+        return *best_ask - *best_bid;
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<Price, Quantity>> PooledOrderBook::getBidLevels(size_t max_levels) const {
+    return collectLevels(bids_, max_levels);
+}
+
+std::vector<std::pair<Price, Quantity>> PooledOrderBook::getAskLevels(size_t max_levels) const {
+    return collectLevels(asks_, max_levels);
+}
+
+std::string PooledOrderBook::toString(size_t max_levels) const {
+    std::ostringstream oss;
+
+    oss << "=== ORDER BOOK ===" << std::endl;
+    oss << "ASKS (lowest first):" << std::endl;
+    size_t ask_count = 0;
+    for (const auto& [price, level] : asks_) {
+        if (ask_count++ >= max_levels) break;
+        oss << "  ASK " << std::fixed << std::setprecision(3) << price
+            << " [" << level.total_quantity << " qty, " << level.order_count << " orders]" << std::endl;
+    }
+
+    auto spread = getSpread();
+    if (spread) {
+        oss << "SPREAD: " << std::fixed << std::setprecision(3) << *spread << std::endl;
+    } else {
+        oss << "SPREAD: N/A" << std::endl;
+    }
+
+    oss << "BIDS (highest first):" << std::endl;
+    size_t bid_count = 0;
+    for (const auto& [price, level] : bids_) {
+        if (bid_count++ >= max_levels) break;
+        oss << "  BID " << std::fixed << std::setprecision(3) << price
+            << " [" << level.total_quantity << " qty, " << level.order_count << " orders]" << std::endl;
+    }
+
+    oss << "=================" << std::endl;
+    oss << "Total Orders: " << getOrderCount() << std::endl;
+    return oss.str();
+}
+
+void PooledOrderBook::clear() {
+    bids_.clear();
+    asks_.clear();
+    nodes_.clear();
+    order_nodes_.clear();
+    free_head_ = NIL;
+    next_trade_id_ = 0;
+    order_count_ = 0;
+}
+
+// =============================================================================
+// Private Helper Methods
+// =============================================================================
+
+template <typename Levels>
+void PooledOrderBook::match(Levels& levels, Order& incoming, std::vector<Trade>& trades) {
+    while (incoming.getRemainingQuantity() > 0 && !levels.empty()) {
+        auto level_it = levels.begin();
+        Price level_price = level_it->first;
+
+        // Limit orders stop at their price; market orders take whatever is there
+        if (incoming.isLimitOrder()) {
+            bool crosses = incoming.isBuyOrder() ? level_price <= incoming.getPrice()
+                                                 : level_price >= incoming.getPrice();
+            if (!crosses) break;
+        }
+
+        Level& level = level_it->second;
+        NodeIndex index = level.head;
+        Order& resting = nodes_[index].order;
+
+        Quantity trade_qty = std::min(incoming.getRemainingQuantity(), resting.getRemainingQuantity());
+        OrderId buy_id = incoming.isBuyOrder() ? incoming.getId() : resting.getId();
+        OrderId sell_id = incoming.isBuyOrder() ? resting.getId() : incoming.getId();
+        trades.emplace_back(generateTradeId(), incoming.getSymbol(), level_price, trade_qty, buy_id, sell_id);
+
+        incoming.fill(trade_qty);
+        resting.fill(trade_qty);
+        level.total_quantity -= trade_qty;
+
+        if (resting.isFullyFilled()) {
+            order_nodes_.erase(resting.getId());
+            unlink(levels, level_it, index);
+        }
+    }
+}
+
+void PooledOrderBook::addToBook(const Order& order) {
+    NodeIndex index = allocateNode(order);
+
+    auto append = [&](auto& levels) {
+        auto level_it = levels.find(order.getPrice());
+        if (level_it == levels.end()) {
+            level_it = levels.emplace(order.getPrice(), Level{}).first;
+        }
+        Level& level = level_it->second;
+        nodes_[index].prev = level.tail;
+        nodes_[index].next = NIL;
+        if (level.tail != NIL) {
+            nodes_[level.tail].next = index;
+        } else {
+            level.head = index;
+        }
+        level.tail = index;
+        level.total_quantity += order.getRemainingQuantity();
+        level.order_count++;
+    };
+
+    if (order.isBuyOrder()) {
+        append(bids_);
+    } else {
+        append(asks_);
+    }
+
+    order_nodes_[order.getId()] = index;
+    order_count_++;
+}
+
+template <typename Levels>
+void PooledOrderBook::unlink(Levels& levels, typename Levels::iterator level_it, NodeIndex index) {
+    Level& level = level_it->second;
+    Node& node = nodes_[index];
+
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        level.head = node.next;
+    }
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    } else {
+        level.tail = node.prev;
+    }
+
+    level.total_quantity -= node.order.getRemainingQuantity();
+    level.order_count--;
+    order_count_--;
+    releaseNode(index);
+
+    if (level.order_count == 0) {
+        levels.erase(level_it);
+    }
+}
+
+PooledOrderBook::NodeIndex PooledOrderBook::allocateNode(const Order& order) {
+    if (free_head_ != NIL) {
+        NodeIndex index = free_head_;
+        free_head_ = nodes_[index].next;
+        nodes_[index].order = order;
+        return index;
+    }
+    nodes_.push_back(Node{order, NIL, NIL});
+    return static_cast<NodeIndex>(nodes_.size() - 1);
+}
+
+void PooledOrderBook::releaseNode(NodeIndex index) {
+    nodes_[index].prev = NIL;
+    nodes_[index].next = free_head_;
+    free_head_ = index;
+}
+
+} // namespace matching_engine
@@ -0,0 +1,220 @@
+#include "matching_engine/risk_budget.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace matching_engine {
+
+// ============================================================================
+// ShardRiskBudget
+// ============================================================================
+
+ShardRiskBudget::Slice* ShardRiskBudget::slice(AccountId account) {
+    uint64_t generation = pool_.generation_.load(std::memory_order_acquire);
+    if (generation != generation_) {
+        cache_.clear(); //accounts were added: "no limit" entries may be stale
+        generation_ = generation;
+    }
+    auto it = cache_.find(account);
+    if (it != cache_.end()) {
+        return it->second;
+    }
+    Slice* found = pool_.findSlice(account, index_);
+    cache_.emplace(account, found);
+    return found;
+}
+
+bool ShardRiskBudget::tryReserve(AccountId account, Notional notional) {
+    Slice* local = slice(account);
+    if (!local) {
+        return true; //no limit for this account
+    }
+    Notional available = local->available.load(std::memory_order_relaxed);
+    while (available >= notional) {
+        if (local->available.compare_exchange_weak(available, available - notional, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    // Slice is short: reserve through the pool, which also refills the slice
+    refills_++;
+    if (pool_.reserveFromPool(index_, account, notional)) {
+        return true;
+    }
+    rejections_++;
+    return false;
+}
+
+void ShardRiskBudget::release(AccountId account, Notional notional) {
+    if (Slice* local = slice(account)) {
+        local->available.fetch_add(notional, std::memory_order_relaxed);
+    }
+}
+
+Notional ShardRiskBudget::getLocalAvailable(AccountId account) {
+    Slice* local = slice(account);
+    return local ? local->available.load(std::memory_order_relaxed) : 0;
+}
+
+// ============================================================================
+// RiskBudgetPool
+// ============================================================================
+
+RiskBudgetPool::RiskBudgetPool(size_t shards, Notional refill_chunk) : refill_chunk_(refill_chunk) {
+    if (shards == 0) {
+        throw std::invalid_argument("RiskBudgetPool needs at least one shard");
+    }
+    if (refill_chunk < 0) {
+        throw std::invalid_argument("Refill chunk must not be negative");
+    }
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.emplace_back(new ShardRiskBudget(*this, i)); //constructor is private to the pool
+    }
+}
+
+RiskBudgetPool::~RiskBudgetPool() {
+    stopRebalancer();
+}
+
+void RiskBudgetPool::setAccountLimit(AccountId account, Notional limit) {
+    if (limit < 0) {
+        throw std::invalid_argument("Account limit must not be negative");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = accounts_.try_emplace(account);
+    Account& entry = it->second;
+    if (inserted) {
+        entry.slices.reset(new ShardRiskBudget::Slice[shards_.size()]);
+    }
+    Notional previous = entry.limit;
+    entry.limit = limit;
+    entry.unallocated += limit - previous;
+    if (limit < previous) {
+        reclaim(entry, -1, shards_.size()); //a lower limit applies on every shard right away
+    }
+    if (inserted) {
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+ShardRiskBudget::Slice* RiskBudgetPool::findSlice(AccountId account, size_t shard) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = accounts_.find(account);
+    return it == accounts_.end() ? nullptr : &it->second.slices[shard];
+}
+
+Notional RiskBudgetPool::takeFromSlice(ShardRiskBudget::Slice& slice, Notional keep) {
+    Notional current = slice.available.load(std::memory_order_relaxed);
+    while (current > keep && !slice.available.compare_exchange_weak(current, keep, std::memory_order_relaxed)) {
+    }
+    return current > keep ? current - keep : 0;
+}
+
+Notional RiskBudgetPool::reclaim(Account& account, Notional wanted, size_t skip_shard) {
+    Notional taken = 0;
+    for (size_t i = 0; i < shards_.size() && (wanted < 0 || taken < wanted); ++i) {
+        if (i != skip_shard) {
+            taken += takeFromSlice(account.slices[i], 0);
+        }
+    }
+    account.unallocated += taken;
+    return taken;
+}
+
+bool RiskBudgetPool::reserveFromPool(size_t shard, AccountId account, Notional notional) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = accounts_.find(account);
+    if (it == accounts_.end()) {
+        return true;
+    }
+    // Under the lock nobody else touches this slice (its owner is the caller), so pool the
+    // slice's remainder with the unallocated budget and reserve from the sum
+    Account& entry = it->second;
+    entry.unallocated += takeFromSlice(entry.slices[shard], 0);
+    if (entry.unallocated < notional) {
+        reclaim(entry, notional - entry.unallocated, shard); //pool is short: take idle budget from other shards
+    }
+    if (entry.unallocated < notional) {
+        return false;
+    }
+    entry.unallocated -= notional;
+    Notional grant = std::min(entry.unallocated, refill_chunk_);
+    entry.unallocated -= grant;
+    entry.slices[shard].available.fetch_add(grant, std::memory_order_relaxed);
+    return true;
+}
+
+Notional RiskBudgetPool::getAvailable(AccountId account) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = accounts_.find(account);
+    if (it == accounts_.end()) {
+        return -1;
+    }
+    Notional total = it->second.unallocated;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        total += it->second.slices[i].available.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+Notional RiskBudgetPool::getUnallocated(AccountId account) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = accounts_.find(account);
+    return it == accounts_.end() ? 0 : it->second.unallocated;
+}
+
+Notional RiskBudgetPool::rebalance() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Notional moved = 0;
+    for (auto& [_, entry] : accounts_) {
+        // Slices holding more than two chunks give back all but one, so a busy shard isn't
+        // sent straight back for a refill
+        Notional taken = 0;
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            if (entry.slices[i].available.load(std::memory_order_relaxed) > 2 * refill_chunk_) {
+                taken += takeFromSlice(entry.slices[i], refill_chunk_);
+            }
+        }
+        entry.unallocated += taken;
+        moved += taken;
+        if (entry.unallocated < 0) {
+            moved += reclaim(entry, -entry.unallocated, shards_.size()); //limit was lowered below what's out
+        }
+    }
+    rebalanced_ += static_cast<uint64_t>(moved);
+    return moved;
+}
+
+void RiskBudgetPool::startRebalancer(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rebalancer_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    rebalancer_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_for(lock, interval, [this] { return stopping_; })) {
+            lock.unlock();
+            rebalance();
+            lock.lock();
+        }
+    });
+}
+
+void RiskBudgetPool::stopRebalancer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (rebalancer_.joinable()) {
+        rebalancer_.join();
+    }
+}
+
+uint64_t RiskBudgetPool::getRebalancedNotional() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rebalanced_;
+}
+
+} // namespace matching_engine
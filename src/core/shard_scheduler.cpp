@@ -0,0 +1,207 @@
+#include "matching_engine/shard_scheduler.hpp"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace {
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t threadCpuNanos() {
+    timespec now;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+int64_t toNanos(std::chrono::microseconds duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+} // namespace
+
+bool TaskSlice::shouldYield() const {
+    if (commands_waiting_ && (*commands_waiting_)()) {
+        return true;
+    }
+    return steadyNanos() >= deadline_ns_;
+}
+
+ShardScheduler::ShardScheduler(std::function<bool()> commands_waiting) : commands_waiting_(std::move(commands_waiting)) {}
+
+size_t ShardScheduler::addClass(const TaskClass& task_class) {
+    if (task_class.quantum.count() <= 0 || task_class.latency_budget.count() <= 0) {
+        throw std::invalid_argument("Task class quantum and latency budget must be positive");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    classes_.push_back(task_class);
+    TaskClassStatistics stats;
+    stats.name = task_class.name;
+    class_stats_.push_back(std::move(stats));
+    return classes_.size() - 1;
+}
+
+ShardScheduler::TaskId ShardScheduler::addTask(size_t task_class, std::string name, Task task, std::chrono::microseconds period) {
+    if (!task) {
+        throw std::invalid_argument("Background task is empty");
+    }
+    if (period.count() < 0) {
+        throw std::invalid_argument("Background task period can't be negative");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (task_class >= classes_.size()) {
+        throw std::invalid_argument("Unknown task class " + std::to_string(task_class));
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->id = next_id_++;
+    entry->name = std::move(name);
+    entry->task_class = task_class;
+    entry->task = std::move(task);
+    entry->quantum_ns = toNanos(classes_[task_class].quantum);
+    entry->budget_ns = toNanos(classes_[task_class].latency_budget);
+    entry->period_ns = toNanos(period);
+    int64_t now = steadyNanos();
+    entry->next_due_ns = now + entry->period_ns;
+    entry->runnable_since_ns = entry->period_ns > 0 ? -1 : now;
+    entry->stats.id = entry->id;
+    entry->stats.name = entry->name;
+    entry->stats.task_class = task_class;
+    class_stats_[task_class].tasks++;
+    TaskId id = entry->id;
+    added_.push_back(std::move(entry));
+    added_pending_.store(true, std::memory_order_release);
+    return id;
+}
+
+void ShardScheduler::adoptAdded() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : added_) {
+        entries_.push_back(std::move(entry));
+    }
+    added_.clear();
+    added_pending_.store(false, std::memory_order_relaxed);
+}
+
+size_t ShardScheduler::runSlices() {
+    if (added_pending_.load(std::memory_order_acquire)) {
+        adoptAdded();
+    }
+    if (entries_.empty()) {
+        return 0;
+    }
+    // One round: every runnable task at most once, longest waiting first
+    int64_t now = steadyNanos();
+    ready_.clear();
+    for (auto& entry : entries_) {
+        if (entry->runnable_since_ns < 0 && entry->period_ns > 0 && now >= entry->next_due_ns) {
+            entry->runnable_since_ns = entry->next_due_ns;
+        }
+        if (entry->runnable_since_ns >= 0) {
+            ready_.push_back(entry.get());
+        }
+    }
+    std::sort(ready_.begin(), ready_.end(), [](const Entry* a, const Entry* b) { return a->runnable_since_ns < b->runnable_since_ns; });
+
+    size_t slices = 0;
+    bool finished = false;
+    for (Entry* entry : ready_) {
+        bool busy = commands_waiting_ && commands_waiting_();
+        int64_t start = steadyNanos();
+        if (busy && (slices > 0 || start - entry->runnable_since_ns < entry->budget_ns)) {
+            continue; //commands first: only one overdue slice gets in ahead of them
+        }
+        runSlice(*entry, start, !busy);
+        finished |= entry->finished;
+        slices++;
+    }
+    if (finished) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const std::unique_ptr<Entry>& e) { return e->finished; }),
+                       entries_.end());
+    }
+    return slices;
+}
+
+void ShardScheduler::runSlice(Entry& entry, int64_t start, bool yield_to_commands) {
+    TaskSlice slice(start + entry.quantum_ns, yield_to_commands && commands_waiting_ ? &commands_waiting_ : nullptr);
+    uint64_t cpu_start = threadCpuNanos();
+    bool more = false;
+    try {
+        more = entry.task(slice);
+    } catch (const std::exception& e) {
+        std::cerr << "ShardScheduler: task " << entry.name << " failed: " << e.what() << std::endl;
+    }
+    uint64_t cpu = threadCpuNanos() - cpu_start;
+    int64_t end = steadyNanos();
+    uint64_t wall = static_cast<uint64_t>(end - start);
+    uint64_t wait = static_cast<uint64_t>(std::max<int64_t>(0, start - entry.runnable_since_ns));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        TaskClassStatistics& group = class_stats_[entry.task_class];
+        entry.stats.slices++;
+        group.slices++;
+        entry.stats.cpu_nanos += cpu;
+        group.cpu_nanos += cpu;
+        entry.stats.wall_nanos += wall;
+        group.wall_nanos += wall;
+        entry.stats.max_slice_nanos = std::max(entry.stats.max_slice_nanos, wall);
+        group.max_slice_nanos = std::max(group.max_slice_nanos, wall);
+        entry.stats.max_wait_nanos = std::max(entry.stats.max_wait_nanos, wait);
+        group.max_wait_nanos = std::max(group.max_wait_nanos, wait);
+        group.overruns += wall > 2 * static_cast<uint64_t>(entry.quantum_ns); //the step in hand always finishes past the deadline
+        group.budget_misses += wait > static_cast<uint64_t>(entry.budget_ns);
+        entry.stats.completions += more ? 0 : 1;
+    }
+
+    if (more) {
+        entry.runnable_since_ns = end; //to the back of the line
+    } else if (entry.period_ns > 0) {
+        entry.runnable_since_ns = -1;
+        entry.next_due_ns += entry.period_ns;
+        if (entry.next_due_ns <= end) {
+            entry.next_due_ns = end + entry.period_ns; //fell behind: skip the missed periods
+        }
+    } else {
+        entry.finished = true;
+    }
+}
+
+std::chrono::microseconds ShardScheduler::timeUntilDue(std::chrono::microseconds longest) const {
+    if (added_pending_.load(std::memory_order_acquire)) {
+        return std::chrono::microseconds(0);
+    }
+    int64_t now = steadyNanos();
+    int64_t soonest = toNanos(longest);
+    for (const auto& entry : entries_) {
+        if (entry->runnable_since_ns >= 0) {
+            return std::chrono::microseconds(0);
+        }
+        if (entry->period_ns > 0) {
+            soonest = std::min(soonest, std::max<int64_t>(0, entry->next_due_ns - now));
+        }
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(soonest));
+}
+
+std::vector<TaskClassStatistics> ShardScheduler::getClassStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return class_stats_;
+}
+
+std::vector<TaskStatistics> ShardScheduler::getTaskStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TaskStatistics> stats;
+    for (const auto* list : {&entries_, &added_}) {
+        for (const auto& entry : *list) {
+            stats.push_back(entry->stats);
+        }
+    }
+    return stats;
+}
+
+} // namespace matching_engine
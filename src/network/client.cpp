@@ -55,6 +55,19 @@ std::vector<Trade> Client::submitOrder(const Order& order) {
     return {};
 }
 
+size_t Client::submitOrders(const Order* orders, size_t count) {
+    if (!isConnected()) {
+        throw std::runtime_error("Not connected to server");
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    Message msg{MessageType::ORDER, encodeSubmitOrders(orders, count)};
+    sendMessage(msg);
+    return count;
+}
+
 bool Client::cancelOrder(OrderId order_id, const std::string& symbol) {
     if (!isConnected()) {
         return false;
@@ -0,0 +1,332 @@
+#include "matching_engine/drop_copy.hpp"
+#include "matching_engine/varint.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr uint8_t PACKET_MAGIC = 0xDC;
+constexpr uint8_t PACKET_VERSION = 1;
+
+constexpr uint8_t FLAG_SELL = 0x01;
+constexpr uint8_t FLAG_FILLED = 0x02;
+constexpr uint8_t FLAG_SAME_SYMBOL = 0x04;
+
+constexpr size_t SYMBOL_BYTES = sizeof(OrderEvent::symbol);
+constexpr size_t MAX_HEADER_BYTES = 2 + 5 * MAX_VARINT_BYTES;
+constexpr size_t MAX_EXECUTION_BYTES = 1 + 7 * MAX_VARINT_BYTES + sizeof(Price) + 1 + SYMBOL_BYTES;
+
+inline bool isExecution(const OrderEvent& event) {
+    return event.type == OrderEventType::PARTIALLY_FILLED || event.type == OrderEventType::FILLED;
+}
+
+[[noreturn]] void fail(const char* what) {
+    throw std::runtime_error(std::string("Malformed drop-copy packet: ") + what);
+}
+
+} // namespace
+
+// =============================================================================
+// Packet Decoding
+// =============================================================================
+
+void decodeDropCopyPacket(const char* data, size_t size, DropCopyPacketHeader& header, std::vector<DropCopyExecution>& out) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    if (size < 2 || p[0] != PACKET_MAGIC) fail("bad magic");
+    if (p[1] != PACKET_VERSION) fail("unsupported version");
+    p += 2;
+
+    uint64_t firm, first_sequence, count, engine_sequence, timestamp;
+    if (!readVarint(p, end, firm) || !readVarint(p, end, first_sequence) || !readVarint(p, end, count) ||
+        !readVarint(p, end, engine_sequence) || !readVarint(p, end, timestamp)) {
+        fail("truncated header");
+    }
+    if (firm > UINT32_MAX) fail("bad firm");
+    if (count > size) fail("bad count"); //every execution takes several bytes
+    header.firm = static_cast<FirmId>(firm);
+    header.first_sequence = first_sequence;
+    header.count = count;
+
+    std::string symbol;
+    int64_t time = static_cast<int64_t>(timestamp);
+    for (uint64_t i = 0; i < count; ++i) {
+        if (p >= end) fail("truncated execution");
+        uint8_t flags = *p++;
+        uint64_t sequence_delta, time_delta, order_id, trade_id, account, quantity, remaining = 0;
+        if (!readVarint(p, end, sequence_delta) || !readVarint(p, end, time_delta) || !readVarint(p, end, order_id) ||
+            !readVarint(p, end, trade_id) || !readVarint(p, end, account)) {
+            fail("truncated execution");
+        }
+        if (end - p < static_cast<ptrdiff_t>(sizeof(Price))) fail("truncated price");
+        Price price;
+        std::memcpy(&price, p, sizeof(price));
+        p += sizeof(price);
+        if (!readVarint(p, end, quantity)) fail("truncated quantity");
+        if (!(flags & FLAG_FILLED) && !readVarint(p, end, remaining)) fail("truncated remaining quantity");
+        if (!(flags & FLAG_SAME_SYMBOL)) {
+            if (p >= end || *p > SYMBOL_BYTES || end - p - 1 < *p) fail("truncated symbol");
+            symbol.assign(reinterpret_cast<const char*>(p + 1), *p);
+            p += 1 + *p;
+        } else if (i == 0) {
+            fail("first execution refers to a previous symbol");
+        }
+
+        engine_sequence = i == 0 ? engine_sequence : engine_sequence + sequence_delta;
+        time = i == 0 ? time : time + unzigzag(time_delta);
+
+        DropCopyExecution execution;
+        execution.sequence = first_sequence + i;
+        execution.engine_sequence = engine_sequence;
+        execution.timestamp_ns = time;
+        execution.order_id = order_id;
+        execution.trade_id = trade_id;
+        execution.account = account;
+        execution.price = price;
+        execution.quantity = quantity;
+        execution.remaining_quantity = remaining;
+        execution.symbol = symbol;
+        execution.side = (flags & FLAG_SELL) ? OrderSide::SELL : OrderSide::BUY;
+        out.push_back(std::move(execution));
+    }
+    if (p != end) fail("trailing bytes");
+}
+
+// =============================================================================
+// DropCopyService
+// =============================================================================
+
+DropCopyService::DropCopyService(const DropCopyOptions& options) : options_(options) {
+    if (options_.max_batch == 0) {
+        throw std::invalid_argument("Drop-copy batch size must be positive");
+    }
+    thread_ = std::thread(&DropCopyService::run, this);
+}
+
+DropCopyService::~DropCopyService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void DropCopyService::setFirm(AccountId account, FirmId firm) {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    account_firms_[account] = firm;
+}
+
+uint64_t DropCopyService::subscribe(FirmId firm, PacketSink sink) {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    Firm& entry = firms_[firm];
+    auto sinks = entry.sinks ? std::make_shared<std::vector<PacketSink>>(*entry.sinks)
+                             : std::make_shared<std::vector<PacketSink>>();
+    sinks->push_back(std::move(sink));
+    entry.sinks = std::move(sinks); //packets already made keep the old list
+    return entry.next_sequence;
+}
+
+void DropCopyService::enqueue(const OrderEvent& event) {
+    if (!isExecution(event)) {
+        return;
+    }
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake = queue_.empty(); //the thread drains the whole queue each time it wakes
+        queue_.push_back(event);
+        enqueued_++;
+    }
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void DropCopyService::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = enqueued_;
+    flush_requested_ = true;
+    wake_.notify_one();
+    flushed_.wait(lock, [&] { return published_ >= target; });
+}
+
+bool DropCopyService::recover(FirmId firm, uint64_t from_sequence, std::vector<std::string>& packets) const {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    auto it = firms_.find(firm);
+    if (it == firms_.end()) {
+        return from_sequence <= 1; //nothing published yet, nothing missed
+    }
+    const auto& retained = it->second.retained;
+    if (from_sequence >= it->second.next_sequence) {
+        return true; //up to date
+    }
+    if (retained.empty() || retained.front().first > from_sequence) {
+        return false; //already dropped
+    }
+    // Last packet starting at or before from_sequence, then everything after it
+    auto first = std::upper_bound(retained.begin(), retained.end(), from_sequence,
+                                  [](uint64_t sequence, const auto& entry) { return sequence < entry.first; });
+    for (auto packet = std::prev(first); packet != retained.end(); ++packet) {
+        packets.push_back(*packet->second);
+    }
+    return true;
+}
+
+uint64_t DropCopyService::getNextSequence(FirmId firm) const {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    auto it = firms_.find(firm);
+    return it == firms_.end() ? 1 : it->second.next_sequence;
+}
+
+uint64_t DropCopyService::getPacketCount() const {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    return packets_;
+}
+
+uint64_t DropCopyService::getByteCount() const {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    return bytes_;
+}
+
+void DropCopyService::run() {
+    std::vector<OrderEvent> batch;
+    while (true) {
+        bool flush_now = false;
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [&] { return stopping_ || flush_requested_ || !queue_.empty(); };
+            std::chrono::steady_clock::time_point deadline;
+            if (nextDeadline(deadline)) {
+                wake_.wait_until(lock, deadline, ready); //a partial batch is waiting to go out
+            } else {
+                wake_.wait(lock, ready);
+            }
+            batch.swap(queue_);
+            flush_now = flush_requested_ || stopping_;
+            flush_requested_ = false;
+            stop = stopping_;
+        }
+
+        uint64_t published = route(batch, flush_now);
+        batch.clear();
+        for (const auto& delivery : outbox_) {
+            for (const auto& sink : *delivery.sinks) {
+                try {
+                    sink(delivery.firm, *delivery.packet);
+                } catch (const std::exception& e) {
+                    std::cerr << "DropCopyService: sink for firm " << delivery.firm << " failed: " << e.what() << std::endl;
+                }
+            }
+        }
+        outbox_.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            published_ += published;
+        }
+        flushed_.notify_all();
+        if (stop) {
+            return;
+        }
+    }
+}
+
+bool DropCopyService::nextDeadline(std::chrono::steady_clock::time_point& deadline) const {
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    bool any = false;
+    for (const auto& [_, firm] : firms_) {
+        if (!firm.pending.empty() && (!any || firm.oldest < deadline)) {
+            deadline = firm.oldest;
+            any = true;
+        }
+    }
+    deadline += options_.max_delay;
+    return any;
+}
+
+uint64_t DropCopyService::route(const std::vector<OrderEvent>& events, bool everything) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t published = 0;
+    std::lock_guard<std::mutex> lock(firms_mutex_);
+    for (const auto& event : events) {
+        auto mapped = account_firms_.find(event.account);
+        FirmId firm_id = mapped == account_firms_.end() ? 0 : mapped->second;
+        Firm& firm = firms_[firm_id];
+        if (firm.pending.empty()) {
+            firm.oldest = now;
+        }
+        firm.pending.push_back(event);
+        if (firm.pending.size() >= options_.max_batch) {
+            published += publish(firm_id, firm);
+        }
+    }
+    for (auto& [firm_id, firm] : firms_) {
+        if (!firm.pending.empty() && (everything || now - firm.oldest >= options_.max_delay)) {
+            published += publish(firm_id, firm);
+        }
+    }
+    return published;
+}
+
+uint64_t DropCopyService::publish(FirmId firm_id, Firm& firm) {
+    const auto& pending = firm.pending;
+    packet_.resize(MAX_HEADER_BYTES + pending.size() * MAX_EXECUTION_BYTES);
+    uint8_t* p = packet_.data();
+    *p++ = PACKET_MAGIC;
+    *p++ = PACKET_VERSION;
+    p = writeVarint(p, firm_id);
+    p = writeVarint(p, firm.next_sequence);
+    p = writeVarint(p, pending.size());
+    p = writeVarint(p, pending.front().sequence);
+    p = writeVarint(p, static_cast<uint64_t>(pending.front().timestamp_ns));
+
+    const OrderEvent* previous = nullptr;
+    for (const auto& event : pending) {
+        bool same_symbol = previous && std::memcmp(previous->symbol, event.symbol, SYMBOL_BYTES) == 0;
+        uint8_t flags = (event.side == OrderSide::SELL ? FLAG_SELL : 0) | (event.remaining_quantity == 0 ? FLAG_FILLED : 0) |
+                        (same_symbol ? FLAG_SAME_SYMBOL : 0);
+        *p++ = flags;
+        p = writeVarint(p, previous ? event.sequence - previous->sequence : 0);
+        p = writeVarint(p, previous ? zigzag(event.timestamp_ns - previous->timestamp_ns) : 0);
+        p = writeVarint(p, event.order_id);
+        p = writeVarint(p, event.trade_id);
+        p = writeVarint(p, event.account);
+        std::memcpy(p, &event.price, sizeof(event.price));
+        p += sizeof(event.price);
+        p = writeVarint(p, event.quantity);
+        if (event.remaining_quantity != 0) {
+            p = writeVarint(p, event.remaining_quantity);
+        }
+        if (!same_symbol) {
+            uint8_t length = static_cast<uint8_t>(strnlen(event.symbol, SYMBOL_BYTES));
+            *p++ = length;
+            std::memcpy(p, event.symbol, length);
+            p += length;
+        }
+        previous = &event;
+    }
+
+    auto packet = std::make_shared<const std::string>(reinterpret_cast<const char*>(packet_.data()),
+                                                      static_cast<size_t>(p - packet_.data()));
+    firm.retained.emplace_back(firm.next_sequence, packet);
+    if (firm.retained.size() > options_.retained_packets) {
+        firm.retained.pop_front();
+    }
+    if (firm.sinks && !firm.sinks->empty()) {
+        outbox_.push_back(Delivery{firm_id, packet, firm.sinks});
+    }
+
+    uint64_t count = pending.size();
+    firm.next_sequence += count;
+    firm.pending.clear();
+    packets_++;
+    bytes_ += packet->size();
+    return count;
+}
+
+} // namespace matching_engine
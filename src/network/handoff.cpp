@@ -0,0 +1,304 @@
+#include "matching_engine/handoff.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr char HANDOFF_MAGIC[8] = {'M', 'E', 'H', 'A', 'N', 'D', '0', '1'};
+constexpr uint32_t HANDOFF_VERSION = 1;
+constexpr size_t FDS_PER_MESSAGE = 250; // the kernel accepts at most SCM_MAX_FD (253) per message
+constexpr char CONTINUATION = 'F';      // payload of the messages carrying further descriptors
+constexpr char ACKNOWLEDGED = 'A';
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error("Handoff: " + what + ": " + std::strerror(errno));
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Handoff socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+// One SCM_RIGHTS message: payload bytes plus up to FDS_PER_MESSAGE descriptors
+void sendWithDescriptors(int channel, const void* payload, size_t size, const int* fds, size_t count) {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * FDS_PER_MESSAGE)];
+    iovec iov{const_cast<void*>(payload), size};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    if (count > 0) {
+        message.msg_control = control;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+    }
+    while (::sendmsg(channel, &message, MSG_NOSIGNAL) < 0) {
+        if (errno != EINTR) fail("sendmsg");
+    }
+}
+
+// Receive one message; descriptors it carried are appended to fds
+size_t receiveWithDescriptors(int channel, void* payload, size_t size, std::vector<int>& fds) {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * FDS_PER_MESSAGE)];
+    iovec iov{payload, size};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t received;
+    while ((received = ::recvmsg(channel, &message, MSG_CMSG_CLOEXEC)) < 0) {
+        if (errno != EINTR) fail("recvmsg");
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            size_t first = fds.size();
+            fds.resize(first + count);
+            std::memcpy(fds.data() + first, CMSG_DATA(cmsg), sizeof(int) * count);
+        }
+    }
+    if (message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+        for (int fd : fds) ::close(fd);
+        throw std::runtime_error("Handoff: message truncated");
+    }
+    return static_cast<size_t>(received);
+}
+
+// State region: snapshot image, then (uint32_t length, bytes) per session
+int writeStateRegion(const std::string& image, const std::vector<SessionHandle>& sessions, size_t& region_size) {
+    region_size = image.size();
+    for (const auto& session : sessions) {
+        region_size += sizeof(uint32_t) + session.pending.size();
+    }
+    int fd = ::memfd_create("matching_engine_handoff", MFD_CLOEXEC);
+    if (fd < 0) fail("memfd_create");
+    if (::ftruncate(fd, static_cast<off_t>(region_size)) != 0) {
+        ::close(fd);
+        fail("ftruncate");
+    }
+    void* mapped = ::mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        ::close(fd);
+        fail("mmap");
+    }
+    char* cursor = static_cast<char*>(mapped);
+    std::memcpy(cursor, image.data(), image.size());
+    cursor += image.size();
+    for (const auto& session : sessions) {
+        uint32_t length = static_cast<uint32_t>(session.pending.size());
+        std::memcpy(cursor, &length, sizeof(length));
+        std::memcpy(cursor + sizeof(length), session.pending.data(), length);
+        cursor += sizeof(length) + length;
+    }
+    ::munmap(mapped, region_size);
+    return fd;
+}
+
+} // namespace
+
+// =============================================================================
+// Channel Setup
+// =============================================================================
+
+int listenForSuccessor(const std::string& path) {
+    sockaddr_un address = unixAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0); //message boundaries keep each fd batch whole
+    if (fd < 0) fail("socket");
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 1) != 0) {
+        ::close(fd);
+        fail("bind " + path);
+    }
+    return fd;
+}
+
+int acceptSuccessor(int listener) {
+    int fd;
+    while ((fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)) < 0) {
+        if (errno != EINTR) fail("accept");
+    }
+    return fd;
+}
+
+int connectToPredecessor(const std::string& path) {
+    sockaddr_un address = unixAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) fail("socket");
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        fail("connect " + path);
+    }
+    return fd;
+}
+
+// =============================================================================
+// Outgoing Side
+// =============================================================================
+
+HandoffReport handOver(int channel, MatchingEngine& engine, int listener, const std::vector<SessionHandle>& sessions) {
+    HandoffReport report;
+    HandoffHeader header{};
+    header.frozen_at_ns = Server::nowNanos();
+    auto frozen = std::chrono::steady_clock::now();
+    engine.stop();
+
+    try {
+        std::string image = engine.exportSnapshot();
+        size_t region_size = 0;
+        int region = writeStateRegion(image, sessions, region_size);
+        report.books = SnapshotView(image.data(), image.size()).getBookCount();
+        report.sessions = sessions.size();
+        report.region_bytes = region_size;
+        report.export_nanos = nanosSince(frozen);
+
+        std::memcpy(header.magic, HANDOFF_MAGIC, sizeof(HANDOFF_MAGIC));
+        header.version = HANDOFF_VERSION;
+        header.listener_count = listener >= 0 ? 1 : 0;
+        header.session_count = static_cast<uint32_t>(sessions.size());
+        header.snapshot_size = image.size();
+        header.region_size = region_size;
+        header.event_sequence = engine.getEventSequence();
+
+        std::vector<int> fds{region};
+        if (listener >= 0) fds.push_back(listener);
+        for (const auto& session : sessions) fds.push_back(session.fd);
+        try {
+            for (size_t sent = 0; sent < fds.size(); sent += FDS_PER_MESSAGE) {
+                size_t count = std::min(FDS_PER_MESSAGE, fds.size() - sent);
+                if (sent == 0) {
+                    sendWithDescriptors(channel, &header, sizeof(header), fds.data(), count);
+                } else {
+                    sendWithDescriptors(channel, &CONTINUATION, 1, fds.data() + sent, count);
+                }
+            }
+        } catch (...) {
+            ::close(region);
+            throw;
+        }
+        ::close(region); //the successor holds its own reference now
+        report.send_nanos = nanosSince(frozen);
+    } catch (...) {
+        engine.start();
+        throw;
+    }
+
+    // Until the successor confirms, this process still owns the market
+    char reply = 0;
+    ssize_t received;
+    while ((received = ::recv(channel, &reply, 1, 0)) < 0 && errno == EINTR) {
+    }
+    report.accepted = received == 1 && reply == ACKNOWLEDGED;
+    if (!report.accepted) {
+        engine.start();
+    }
+    return report;
+}
+
+// =============================================================================
+// Incoming Side
+// =============================================================================
+
+HandoffState::HandoffState(int channel) : header_{} {
+    std::vector<int> fds;
+    size_t received = receiveWithDescriptors(channel, &header_, sizeof(header_), fds);
+    auto closeAll = [&fds] {
+        for (int fd : fds) ::close(fd);
+    };
+    if (received != sizeof(header_) || std::memcmp(header_.magic, HANDOFF_MAGIC, sizeof(HANDOFF_MAGIC)) != 0 ||
+        header_.version != HANDOFF_VERSION) {
+        closeAll();
+        throw std::runtime_error("Handoff: not a handoff message");
+    }
+    size_t expected = 1 + size_t{header_.listener_count} + header_.session_count;
+    while (fds.size() < expected) {
+        char marker = 0;
+        size_t before = fds.size();
+        if (receiveWithDescriptors(channel, &marker, 1, fds) != 1 || marker != CONTINUATION || fds.size() == before) {
+            closeAll();
+            throw std::runtime_error("Handoff: descriptors missing");
+        }
+    }
+
+    // Map the state region; the mapping keeps it alive after the descriptor is closed
+    struct stat info;
+    if (::fstat(fds[0], &info) != 0 || static_cast<uint64_t>(info.st_size) < header_.region_size ||
+        header_.snapshot_size > header_.region_size) {
+        closeAll();
+        throw std::runtime_error("Handoff: state region smaller than announced");
+    }
+    void* mapped = ::mmap(nullptr, header_.region_size, PROT_READ, MAP_SHARED, fds[0], 0);
+    if (mapped == MAP_FAILED) {
+        closeAll();
+        fail("mmap");
+    }
+    const char* region = static_cast<const char*>(mapped);
+
+    // Partial lines of the sessions follow the snapshot image
+    const char* cursor = region + header_.snapshot_size;
+    const char* end = region + header_.region_size;
+    for (size_t i = 0; i < header_.session_count; ++i) {
+        uint32_t length = 0;
+        bool fits = static_cast<size_t>(end - cursor) >= sizeof(length);
+        if (fits) {
+            std::memcpy(&length, cursor, sizeof(length));
+            cursor += sizeof(length);
+            fits = static_cast<size_t>(end - cursor) >= length;
+        }
+        if (!fits) {
+            ::munmap(mapped, header_.region_size);
+            closeAll();
+            throw std::runtime_error("Handoff: session data truncated");
+        }
+        sessions_.push_back(SessionHandle{fds[1 + header_.listener_count + i], std::string(cursor, length)});
+        cursor += length;
+    }
+
+    ::close(fds[0]);
+    region_ = region;
+    region_size_ = header_.region_size;
+    listeners_.assign(fds.begin() + 1, fds.begin() + 1 + header_.listener_count);
+}
+
+HandoffState::~HandoffState() {
+    if (region_) {
+        ::munmap(const_cast<char*>(region_), region_size_);
+    }
+}
+
+size_t HandoffState::resume(MatchingEngine& engine) const {
+    size_t books = engine.importSnapshot(getSnapshot(), header_.event_sequence);
+    engine.start();
+    return books;
+}
+
+void acknowledgeHandoff(int channel) {
+    while (::send(channel, &ACKNOWLEDGED, 1, MSG_NOSIGNAL) != 1) {
+        if (errno != EINTR) fail("send");
+    }
+}
+
+} // namespace matching_engine
@@ -0,0 +1,217 @@
+#include "matching_engine/market_data.hpp"
+#include "matching_engine/varint.hpp"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr uint8_t FLAG_RESET = 0x01;
+
+constexpr uint8_t CONTROL_SELL = 0x01;
+constexpr uint8_t CONTROL_SAME_SYMBOL = 0x02;
+constexpr uint8_t CONTROL_REMOVED = 0x04;
+constexpr unsigned CONTROL_DELTA_SHIFT = 3;
+constexpr uint64_t INLINE_DELTA_ESCAPE = 31; // bits 3-7 all set: delta follows as a varint
+
+constexpr size_t MAX_PACKET_HEADER_BYTES = 1 + 2 * MAX_VARINT_BYTES;
+constexpr size_t MAX_UPDATE_BYTES = 1 + 5 + 2 * MAX_VARINT_BYTES;
+constexpr SymbolId MAX_SYMBOL_ID = (1u << 20) - 1; // bounds the reference tables
+
+double ticksPerUnit(Price tick_size) {
+    if (!(tick_size > 0)) {
+        throw std::invalid_argument("Market data tick size must be positive");
+    }
+    // 1 / 0.01 is not exactly 100 in binary; snap to the integer so prices divide back exactly
+    double ticks = 1.0 / tick_size;
+    double rounded = std::round(ticks);
+    return std::fabs(ticks - rounded) < 1e-9 * ticks ? rounded : ticks;
+}
+
+} // namespace
+
+// =============================================================================
+// Fixed Layout
+// =============================================================================
+
+void encodeFixedUpdates(const MarketDataUpdate* updates, size_t count, std::string& out) {
+    size_t start = out.size();
+    out.resize(start + count * sizeof(FixedMarketDataUpdate));
+    char* cursor = &out[start];
+    for (size_t i = 0; i < count; ++i, cursor += sizeof(FixedMarketDataUpdate)) {
+        FixedMarketDataUpdate fixed{};
+        fixed.sequence = updates[i].sequence;
+        fixed.symbol_id = updates[i].symbol_id;
+        fixed.side = updates[i].side;
+        fixed.price = updates[i].price;
+        fixed.quantity = updates[i].quantity;
+        std::memcpy(cursor, &fixed, sizeof(fixed));
+    }
+}
+
+size_t decodeFixedUpdates(const void* data, size_t size, std::vector<MarketDataUpdate>& out) {
+    if (size % sizeof(FixedMarketDataUpdate) != 0) {
+        throw std::runtime_error("Fixed market data packet is not a whole number of updates");
+    }
+    size_t count = size / sizeof(FixedMarketDataUpdate);
+    const char* cursor = static_cast<const char*>(data);
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; ++i, cursor += sizeof(FixedMarketDataUpdate)) {
+        FixedMarketDataUpdate fixed;
+        std::memcpy(&fixed, cursor, sizeof(fixed));
+        out.push_back(MarketDataUpdate{fixed.sequence, fixed.symbol_id, fixed.side, fixed.price, fixed.quantity});
+    }
+    return count;
+}
+
+// =============================================================================
+// MarketDataEncoder
+// =============================================================================
+
+MarketDataEncoder::MarketDataEncoder(Price tick_size)
+    : ticks_per_unit_(ticksPerUnit(tick_size)) {}
+
+void MarketDataEncoder::reset() {
+    reset_pending_ = true;
+}
+
+size_t MarketDataEncoder::encodePacket(const MarketDataUpdate* updates, size_t count, std::string& out) {
+    uint64_t base = count > 0 ? updates[0].sequence : next_sequence_;
+
+    // Validate everything first so a rejected packet leaves the stream state untouched
+    if (next_sequence_ != 0 && base != next_sequence_) {
+        throw std::invalid_argument("Market data sequence " + std::to_string(base) + " does not continue " +
+                                    std::to_string(next_sequence_));
+    }
+    ticks_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const MarketDataUpdate& update = updates[i];
+        if (update.sequence != base + i) {
+            throw std::invalid_argument("Market data sequences must be consecutive within a packet");
+        }
+        if (update.symbol_id > MAX_SYMBOL_ID) {
+            throw std::invalid_argument("Market data symbol id out of range: " + std::to_string(update.symbol_id));
+        }
+        double scaled = update.price * ticks_per_unit_;
+        int64_t ticks = static_cast<int64_t>(scaled + (scaled < 0 ? -0.5 : 0.5));
+        if (std::fabs(scaled - static_cast<double>(ticks)) > 1e-6) {
+            throw std::invalid_argument("Market data price is not a multiple of the tick size");
+        }
+        ticks_[i] = ticks;
+    }
+
+    if (reset_pending_) {
+        references_.assign(references_.size(), 0);
+    }
+
+    size_t start = out.size();
+    out.resize(start + MAX_PACKET_HEADER_BYTES + count * MAX_UPDATE_BYTES);
+    uint8_t* begin = reinterpret_cast<uint8_t*>(&out[start]);
+    uint8_t* p = begin;
+    *p++ = reset_pending_ ? FLAG_RESET : 0;
+    p = writeVarint(p, base);
+    p = writeVarint(p, count);
+
+    SymbolId previous_symbol = MAX_SYMBOL_ID + 1; // no previous update in this packet
+    for (size_t i = 0; i < count; ++i) {
+        const MarketDataUpdate& update = updates[i];
+        if (update.symbol_id >= references_.size()) {
+            references_.resize(update.symbol_id + 1, 0);
+        }
+        uint64_t delta = zigzag(ticks_[i] - references_[update.symbol_id]);
+        references_[update.symbol_id] = ticks_[i];
+
+        bool same_symbol = update.symbol_id == previous_symbol;
+        bool removed = update.quantity == 0;
+        uint64_t inline_delta = delta < INLINE_DELTA_ESCAPE ? delta : INLINE_DELTA_ESCAPE;
+        *p++ = static_cast<uint8_t>((update.side == OrderSide::SELL ? CONTROL_SELL : 0) |
+                                    (same_symbol ? CONTROL_SAME_SYMBOL : 0) |
+                                    (removed ? CONTROL_REMOVED : 0) |
+                                    (inline_delta << CONTROL_DELTA_SHIFT));
+        if (!same_symbol) {
+            p = writeVarint(p, update.symbol_id);
+        }
+        if (inline_delta == INLINE_DELTA_ESCAPE) {
+            p = writeVarint(p, delta);
+        }
+        if (!removed) {
+            p = writeVarint(p, update.quantity);
+        }
+        previous_symbol = update.symbol_id;
+    }
+
+    size_t written = static_cast<size_t>(p - begin);
+    out.resize(start + written);
+    next_sequence_ = base + count;
+    reset_pending_ = false;
+    return written;
+}
+
+// =============================================================================
+// MarketDataDecoder
+// =============================================================================
+
+MarketDataDecoder::MarketDataDecoder(Price tick_size)
+    : ticks_per_unit_(ticksPerUnit(tick_size)) {}
+
+size_t MarketDataDecoder::decodePacket(const void* data, size_t size, std::vector<MarketDataUpdate>& out) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    size_t original_size = out.size();
+    auto fail = [&](const char* what) {
+        out.resize(original_size);
+        synced_ = false; // references may be half updated; wait for the next reset
+        throw std::runtime_error(std::string("Market data packet rejected: ") + what);
+    };
+
+    uint64_t base = 0, count = 0;
+    if (p == end) fail("empty");
+    uint8_t flags = *p++;
+    if (!readVarint(p, end, base) || !readVarint(p, end, count)) fail("truncated header");
+
+    if (flags & FLAG_RESET) {
+        references_.assign(references_.size(), 0);
+        synced_ = true;
+    } else if (!synced_) {
+        return 0; // joined mid-stream: nothing to apply deltas to until a reset
+    } else if (base != next_sequence_) {
+        fail("sequence gap");
+    }
+    if (count > static_cast<uint64_t>(end - p)) fail("update count exceeds packet"); // every update is >= 1 byte
+
+    out.reserve(out.size() + count);
+    SymbolId symbol = 0;
+    bool have_symbol = false;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (p == end) fail("truncated update");
+        uint8_t control = *p++;
+        if (!(control & CONTROL_SAME_SYMBOL)) {
+            uint64_t id;
+            if (!readVarint(p, end, id) || id > MAX_SYMBOL_ID) fail("bad symbol id");
+            symbol = static_cast<SymbolId>(id);
+            have_symbol = true;
+            if (symbol >= references_.size()) {
+                references_.resize(symbol + 1, 0);
+            }
+        } else if (!have_symbol) {
+            fail("repeated symbol without a previous update");
+        }
+        uint64_t delta = control >> CONTROL_DELTA_SHIFT;
+        if (delta == INLINE_DELTA_ESCAPE && !readVarint(p, end, delta)) fail("truncated price");
+        uint64_t quantity = 0;
+        if (!(control & CONTROL_REMOVED) && !readVarint(p, end, quantity)) fail("truncated quantity");
+
+        int64_t ticks = references_[symbol] + unzigzag(delta);
+        references_[symbol] = ticks;
+        out.push_back(MarketDataUpdate{base + i, symbol,
+                                       (control & CONTROL_SELL) ? OrderSide::SELL : OrderSide::BUY,
+                                       static_cast<double>(ticks) / ticks_per_unit_, quantity});
+    }
+    if (p != end) fail("trailing bytes");
+    next_sequence_ = base + count;
+    return static_cast<size_t>(count);
+}
+
+} // namespace matching_engine
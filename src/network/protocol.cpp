@@ -1,10 +1,90 @@
 #include "matching_engine/protocol.hpp"
 #include <boost/asio.hpp>
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace matching_engine {
 
+namespace {
+
+const std::string SUBMIT_ORDER_PREFIX = "SUBMIT_ORDER|";
+const std::string SUBMIT_ORDERS_PREFIX = "SUBMIT_ORDERS|";
+
+template <typename T>
+void appendNumber(std::string& out, T value) {
+    char digits[32];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr; //shortest form that reads back exactly
+    out.append(digits, end);
+}
+
+// "id,symbol,side,type,price,quantity", the fields Client::submitOrder sends
+void appendOrder(std::string& out, const Order& order) {
+    appendNumber(out, order.getId());
+    out += ',';
+    out += order.getSymbol();
+    out += ',';
+    appendNumber(out, static_cast<int>(order.getSide()));
+    out += ',';
+    appendNumber(out, static_cast<int>(order.getType()));
+    out += ',';
+    appendNumber(out, order.getPrice());
+    out += ',';
+    appendNumber(out, order.getQuantity());
+}
+
+// Walks the delimited fields of a payload in place, throwing on anything malformed
+class FieldReader {
+    private:
+        const char* cursor_;
+        const char* end_;
+
+    public:
+        FieldReader(const char* begin, const char* end) : cursor_(begin), end_(end) {}
+
+        bool atEnd() const { return cursor_ == end_; }
+
+        // The next field, ending at the delimiter (consumed) or the end of the payload
+        std::string_view field(char delimiter) {
+            const char* stop = static_cast<const char*>(std::memchr(cursor_, delimiter, end_ - cursor_));
+            std::string_view value(cursor_, (stop ? stop : end_) - cursor_);
+            cursor_ = stop ? stop + 1 : end_;
+            return value;
+        }
+
+        template <typename T>
+        T number(char delimiter) {
+            std::string_view text = field(delimiter);
+            T value{};
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (text.empty() || error != std::errc() || end != text.data() + text.size()) {
+                throw std::invalid_argument("Malformed number in order message: '" + std::string(text) + "'");
+            }
+            return value;
+        }
+};
+
+Order readOrder(FieldReader& in) {
+    OrderId id = in.number<OrderId>(',');
+    std::string symbol(in.field(','));
+    int side = in.number<int>(',');
+    int type = in.number<int>(',');
+    Price price = in.number<Price>(',');
+    Quantity quantity = in.number<Quantity>(';');
+    if (side != static_cast<int>(OrderSide::BUY) && side != static_cast<int>(OrderSide::SELL)) {
+        throw std::invalid_argument("Invalid order side " + std::to_string(side));
+    }
+    if (type != static_cast<int>(OrderType::MARKET) && type != static_cast<int>(OrderType::LIMIT)) {
+        throw std::invalid_argument("Invalid order type " + std::to_string(type));
+    }
+    return Order(id, symbol, static_cast<OrderSide>(side), static_cast<OrderType>(type), price, quantity);
+}
+
+} // namespace
+
 MessageType stringToMessageType(const std::string& type_str) { // convert string to MessageType
     if (type_str == "ORDER") return MessageType::ORDER;
     if (type_str == "CANCEL") return MessageType::CANCEL;
@@ -34,4 +114,45 @@ Message deserializeMessage(const std::string& data) { // deserialize a string to
     return {stringToMessageType(type_str), payload};
 }
 
-} // namespace matching_engine 
\ No newline at end of file
+std::string encodeSubmitOrders(const Order* orders, size_t count) {
+    std::string payload;
+    payload.reserve(SUBMIT_ORDERS_PREFIX.size() + 24 + count * 48);
+    payload += SUBMIT_ORDERS_PREFIX;
+    appendNumber(payload, count);
+    payload += '|';
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) payload += ';';
+        appendOrder(payload, orders[i]);
+    }
+    return payload;
+}
+
+bool decodeSubmitOrders(const std::string& payload, SessionId session, std::vector<EngineCommand>& commands) {
+    bool batch = payload.compare(0, SUBMIT_ORDERS_PREFIX.size(), SUBMIT_ORDERS_PREFIX) == 0;
+    if (!batch && payload.compare(0, SUBMIT_ORDER_PREFIX.size(), SUBMIT_ORDER_PREFIX) != 0) return false;
+
+    const std::string& prefix = batch ? SUBMIT_ORDERS_PREFIX : SUBMIT_ORDER_PREFIX;
+    FieldReader in(payload.data() + prefix.size(), payload.data() + payload.size());
+    size_t count = batch ? in.number<size_t>('|') : 1;
+    if (count > payload.size()) { //every order takes well over a byte: don't reserve for a bogus count
+        throw std::invalid_argument("SUBMIT_ORDERS count " + std::to_string(count) + " exceeds the message size");
+    }
+    size_t first = commands.size();
+    commands.reserve(first + count);
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            Order order = readOrder(in);
+            order.setSession(session);
+            commands.push_back(EngineCommand::newOrder(order));
+        }
+        if (!in.atEnd()) {
+            throw std::invalid_argument("More orders than the SUBMIT_ORDERS count of " + std::to_string(count));
+        }
+    } catch (...) {
+        commands.erase(commands.begin() + static_cast<std::ptrdiff_t>(first), commands.end());
+        throw;
+    }
+    return true;
+}
+
+} // namespace matching_engine
@@ -1,13 +1,39 @@
 #include "matching_engine/server.hpp"
+#include <cerrno>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <linux/errqueue.h> //for struct scm_timestamping
+#include <linux/net_tstamp.h> //for the SOF_TIMESTAMPING_* flags
+#include <sys/socket.h>
 
 namespace matching_engine {
 
+namespace {
+
+constexpr size_t READ_CHUNK = 4096;
+
+} // namespace
+
+struct Server::Connection {
+    std::shared_ptr<boost::asio::ip::tcp::socket> socket;
+    std::string pending; // bytes received after the last newline
+    bool kernel_timestamps = false; // SO_TIMESTAMPING was accepted for this socket
+};
+
 Server::Server(boost::asio::io_context& io_context, unsigned short port, MessageHandler handler) // constructor
     : io_context_(io_context),
       acceptor_(io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)),
       message_handler_(std::move(handler)),
-      running_(false) {}
+      running_(false),
+      latency_(std::make_unique<ServerLatency>()) {}
+
+Server::Server(boost::asio::io_context& io_context, boost::asio::ip::tcp::acceptor acceptor, MessageHandler handler)
+    : io_context_(io_context),
+      acceptor_(std::move(acceptor)),
+      message_handler_(std::move(handler)),
+      running_(false),
+      latency_(std::make_unique<ServerLatency>()) {}
 
 void Server::start() { // start the server
     running_ = true;
@@ -20,34 +46,145 @@ void Server::stop() { // stop the server
     acceptor_.close(ec);
 }
 
+unsigned short Server::getPort() const {
+    boost::system::error_code ec;
+    return acceptor_.local_endpoint(ec).port();
+}
+
+int Server::getListenerHandle() {
+    return acceptor_.native_handle();
+}
+
+std::vector<SessionHandle> Server::getSessionHandles() const {
+    std::vector<SessionHandle> sessions;
+    for (const auto& [key, weak] : connections_) {
+        auto connection = weak.lock();
+        if (connection && connection->socket->is_open()) {
+            sessions.push_back(SessionHandle{connection->socket->native_handle(), connection->pending});
+        }
+    }
+    return sessions;
+}
+
+void Server::adoptSession(int fd, std::string pending) {
+    auto connection = std::make_shared<Connection>();
+    connection->socket = std::make_shared<boost::asio::ip::tcp::socket>(io_context_, boost::asio::ip::tcp::v4(), fd);
+    connection->pending = std::move(pending);
+    startConnection(connection);
+}
+
+int64_t Server::nowNanos() {
+    timespec now;
+    ::clock_gettime(CLOCK_REALTIME, &now); // the clock SO_TIMESTAMPING software stamps use
+    return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
 void Server::doAccept() { // accept a new connection
     if (!running_) return;
     auto socket = std::make_shared<boost::asio::ip::tcp::socket>(io_context_);
     acceptor_.async_accept(*socket, [this, socket](boost::system::error_code ec) {
         if (!ec) {
-            doRead(socket);
+            auto connection = std::make_shared<Connection>();
+            connection->socket = socket;
+            startConnection(connection);
         }
         doAccept();
     });
 }
 
-void Server::doRead(std::shared_ptr<boost::asio::ip::tcp::socket> socket) { // read a message from the socket
-    auto buffer = std::make_shared<boost::asio::streambuf>();
-    boost::asio::async_read_until(*socket, *buffer, '\n',
-        [this, socket, buffer](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
-            if (!ec) {
-                std::istream is(buffer.get());
-                std::string line;
-                std::getline(is, line);
-                if (!line.empty()) {
-                    Message msg = deserializeMessage(line);
-                    message_handler_(msg, socket);
-                }
-                doRead(socket); // Continue reading
+void Server::startConnection(std::shared_ptr<Connection> connection) {
+    // Ask the kernel to stamp each segment on arrival; works on loopback, no NIC support needed
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    connection->kernel_timestamps =
+        ::setsockopt(connection->socket->native_handle(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+    connections_[connection.get()] = connection;
+    doRead(connection);
+}
+
+void Server::doRead(std::shared_ptr<Connection> connection) { // read messages from the socket
+    // Wait for readability and read with recvmsg ourselves: async_read_until can't return the
+    // control messages that carry the receive timestamps
+    connection->socket->async_wait(boost::asio::ip::tcp::socket::wait_read,
+        [this, connection](boost::system::error_code ec) {
+            if (!ec && readAvailable(*connection)) {
+                doRead(connection); // Continue reading
             } else {
-                socket->close();
+                boost::system::error_code ignored;
+                connection->socket->close(ignored);
+                connections_.erase(connection.get());
             }
         });
 }
 
-} // namespace matching_engine 
\ No newline at end of file
+bool Server::readAvailable(Connection& connection) {
+    char data[READ_CHUNK];
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(scm_timestamping))];
+    int fd = connection.socket->native_handle();
+
+    while (connection.socket->is_open()) {
+        iovec iov{data, sizeof(data)};
+        msghdr header{};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+
+        ssize_t received = ::recvmsg(fd, &header, MSG_DONTWAIT);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK; // drained, or a real error
+        }
+        if (received == 0) {
+            return false; // peer closed
+        }
+
+        // For TCP the stamp is that of the newest segment this read consumed
+        int64_t receive_ns = 0;
+        bool kernel_timestamp = false;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                scm_timestamping stamps;
+                std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                if (stamps.ts[0].tv_sec != 0 || stamps.ts[0].tv_nsec != 0) {
+                    receive_ns = static_cast<int64_t>(stamps.ts[0].tv_sec) * 1000000000LL + stamps.ts[0].tv_nsec;
+                    kernel_timestamp = true;
+                }
+            }
+        }
+        if (!kernel_timestamp) {
+            receive_ns = nowNanos(); // no stamp: fall back to when we read it
+        }
+
+        // Split into lines; a line's timestamp is that of the read that completed it
+        const char* cursor = data;
+        const char* end = data + received;
+        while (const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor))) {
+            connection.pending.append(cursor, newline);
+            std::string line;
+            line.swap(connection.pending);
+            dispatch(connection, std::move(line), receive_ns, kernel_timestamp);
+            cursor = newline + 1;
+        }
+        connection.pending.append(cursor, end);
+
+        if (static_cast<size_t>(received) < sizeof(data)) {
+            return true; // short read: the buffer is empty, go back to waiting
+        }
+    }
+    return false;
+}
+
+void Server::dispatch(Connection& connection, std::string line, int64_t receive_ns, bool kernel_timestamp) {
+    if (line.empty()) return;
+    Message msg = deserializeMessage(line);
+    msg.receive_timestamp_ns = receive_ns;
+    msg.kernel_timestamp = kernel_timestamp;
+
+    int64_t start = nowNanos();
+    latency_->socket_queue.record(start > receive_ns ? static_cast<uint64_t>(start - receive_ns) : 0);
+    message_handler_(msg, connection.socket);
+    int64_t done = nowNanos();
+    latency_->handler.record(done > receive_ns ? static_cast<uint64_t>(done - receive_ns) : 0);
+}
+
+} // namespace matching_engine
@@ -0,0 +1,717 @@
+#include "matching_engine/viewer_gateway.hpp"
+#include "matching_engine/varint.hpp"
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+constexpr size_t MAX_SYMBOL_BYTES = 16;
+constexpr size_t MAX_VIEWER_MESSAGE = 4096;
+
+[[noreturn]] void fail(const char* what) {
+    throw std::runtime_error(std::string("Malformed viewer frame: ") + what);
+}
+
+// =============================================================================
+// Frame Encoding
+// =============================================================================
+
+void appendNumber(std::string& out, double value) {
+    char digits[32];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr; //shortest form that reads back exactly
+    out.append(digits, end);
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+void appendVarint(std::string& out, uint64_t value) {
+    uint8_t bytes[MAX_VARINT_BYTES];
+    out.append(reinterpret_cast<const char*>(bytes), writeVarint(bytes, value) - bytes);
+}
+
+void appendDouble(std::string& out, double value) {
+    char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    out.append(bytes, sizeof(bytes));
+}
+
+void appendHeader(std::string& out, ViewerFrame::Kind kind, const std::string& symbol, uint64_t sequence) {
+    out.push_back(static_cast<char>(kind));
+    out.push_back(static_cast<char>(symbol.size()));
+    out.append(symbol);
+    appendVarint(out, sequence);
+}
+
+// Quoted JSON string; symbols come from the engine, so escape rather than trust them
+void appendJsonString(std::string& out, const std::string& value) {
+    out.push_back('"');
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            const char* hex = "0123456789abcdef";
+            out.append("\\u00");
+            out.push_back(hex[(c >> 4) & 0xf]);
+            out.push_back(hex[c & 0xf]);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+void appendJsonHeader(std::string& out, const char* type, const std::string& symbol, uint64_t sequence) {
+    out.append("{\"type\":\"").append(type).append("\",\"symbol\":");
+    appendJsonString(out, symbol);
+    out.append(",\"seq\":");
+    appendNumber(out, sequence);
+}
+
+void appendJsonLevels(std::string& out, const char* name, const std::vector<std::pair<Price, Quantity>>& levels) {
+    out.append(",\"").append(name).append("\":[");
+    for (size_t i = 0; i < levels.size(); ++i) {
+        out.append(i == 0 ? "[" : ",[");
+        appendNumber(out, levels[i].first);
+        out.push_back(',');
+        appendNumber(out, levels[i].second);
+        out.push_back(']');
+    }
+    out.push_back(']');
+}
+
+std::string encodeBookFrame(const MarketDepth& depth, uint64_t sequence, ViewerFormat format) {
+    std::string out;
+    if (format == ViewerFormat::BINARY) {
+        appendHeader(out, ViewerFrame::BOOK, depth.symbol, sequence);
+        appendVarint(out, depth.bids.size());
+        appendVarint(out, depth.asks.size());
+        for (const auto* side : {&depth.bids, &depth.asks}) {
+            for (const auto& [price, quantity] : *side) {
+                appendDouble(out, price);
+                appendVarint(out, quantity);
+            }
+        }
+        return out;
+    }
+    appendJsonHeader(out, "book", depth.symbol, sequence);
+    appendJsonLevels(out, "bids", depth.bids);
+    appendJsonLevels(out, "asks", depth.asks);
+    out.push_back('}');
+    return out;
+}
+
+std::string encodeTradeFrame(const ViewerFrame& trades, ViewerFormat format) {
+    std::string out;
+    if (format == ViewerFormat::BINARY) {
+        appendHeader(out, ViewerFrame::TRADES, trades.symbol, trades.sequence);
+        appendVarint(out, trades.trades);
+        appendVarint(out, trades.volume);
+        for (double price : {trades.last, trades.high, trades.low}) {
+            appendDouble(out, price);
+        }
+        return out;
+    }
+    appendJsonHeader(out, "trades", trades.symbol, trades.sequence);
+    out.append(",\"count\":");
+    appendNumber(out, uint64_t{trades.trades});
+    out.append(",\"volume\":");
+    appendNumber(out, trades.volume);
+    out.append(",\"last\":");
+    appendNumber(out, trades.last);
+    out.append(",\"high\":");
+    appendNumber(out, trades.high);
+    out.append(",\"low\":");
+    appendNumber(out, trades.low);
+    out.push_back('}');
+    return out;
+}
+
+// "%2C" -> ",", "+" -> " " (malformed escapes are kept as they are)
+std::string percentDecode(beast::string_view text) {
+    auto hexValue = [](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2])));
+            i += 2;
+        } else {
+            decoded.push_back(text[i] == '+' ? ' ' : text[i]);
+        }
+    }
+    return decoded;
+}
+
+// "/ws?symbols=A,B&format=json" -> path and (decoded) parameters
+std::string splitTarget(beast::string_view target, std::map<std::string, std::string>& parameters) {
+    size_t question = target.find('?');
+    std::string path(target.substr(0, question));
+    if (question == beast::string_view::npos) {
+        return path;
+    }
+    beast::string_view query = target.substr(question + 1);
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        beast::string_view pair = query.substr(0, amp);
+        size_t equals = pair.find('=');
+        if (equals != beast::string_view::npos) {
+            parameters[percentDecode(pair.substr(0, equals))] = percentDecode(pair.substr(equals + 1));
+        }
+        query = amp == beast::string_view::npos ? beast::string_view() : query.substr(amp + 1);
+    }
+    return path;
+}
+
+// What a viewer may name: letters, digits and . _ - only, so it can be echoed back as is
+bool isViewerSymbol(const std::string& symbol) {
+    if (symbol.empty() || symbol.size() > MAX_SYMBOL_BYTES) {
+        return false;
+    }
+    return std::all_of(symbol.begin(), symbol.end(), [](char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '-';
+    });
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = std::min(list.find(',', start), list.size());
+        if (comma > start) {
+            items.push_back(list.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return items;
+}
+
+} // namespace
+
+// =============================================================================
+// Frame Decoding
+// =============================================================================
+
+void decodeViewerFrame(const char* data, size_t size, ViewerFrame& frame) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    if (size < 2 || (p[0] != ViewerFrame::BOOK && p[0] != ViewerFrame::TRADES)) fail("bad kind");
+    frame.kind = static_cast<ViewerFrame::Kind>(p[0]);
+    if (p[1] > MAX_SYMBOL_BYTES || end - p - 2 < p[1]) fail("truncated symbol");
+    frame.symbol.assign(reinterpret_cast<const char*>(p + 2), p[1]);
+    p += 2 + p[1];
+    if (!readVarint(p, end, frame.sequence)) fail("truncated sequence");
+
+    auto readPrice = [&]() {
+        if (end - p < static_cast<ptrdiff_t>(sizeof(Price))) fail("truncated price");
+        Price price;
+        std::memcpy(&price, p, sizeof(price));
+        p += sizeof(price);
+        return price;
+    };
+
+    frame.bids.clear();
+    frame.asks.clear();
+    if (frame.kind == ViewerFrame::BOOK) {
+        uint64_t bids, asks;
+        if (!readVarint(p, end, bids) || !readVarint(p, end, asks)) fail("truncated level counts");
+        if (bids > size || asks > size - bids) fail("bad level counts"); //every level takes several bytes
+        for (uint64_t i = 0; i < bids + asks; ++i) {
+            Price price = readPrice();
+            uint64_t quantity;
+            if (!readVarint(p, end, quantity)) fail("truncated quantity");
+            (i < bids ? frame.bids : frame.asks).push_back({price, quantity});
+        }
+    } else {
+        uint64_t trades;
+        if (!readVarint(p, end, trades) || !readVarint(p, end, frame.volume)) fail("truncated trade counts");
+        if (trades > UINT32_MAX) fail("bad trade count");
+        frame.trades = static_cast<uint32_t>(trades);
+        frame.last = readPrice();
+        frame.high = readPrice();
+        frame.low = readPrice();
+    }
+    if (p != end) fail("trailing bytes");
+}
+
+// =============================================================================
+// Connections
+// =============================================================================
+
+struct ViewerGateway::Request {
+    tcp::socket socket;
+    beast::flat_buffer buffer;
+    http::request<http::string_body> message;
+    http::response<http::string_body> response;
+
+    explicit Request(tcp::socket connection) : socket(std::move(connection)) {}
+};
+
+struct ViewerGateway::Viewer : std::enable_shared_from_this<ViewerGateway::Viewer> {
+    using Key = std::pair<uint8_t, std::string>;   // frame kind, symbol
+
+    websocket::stream<tcp::socket> ws;
+    beast::flat_buffer buffer;
+    ViewerFormat format;
+    bool open = true;
+    bool everything = false;
+    std::unordered_set<std::string> symbols;
+    std::deque<Key> queued;          // unsent frames, oldest first
+    std::map<Key, Frame> unsent;     // at most one per key: newer frames replace older ones
+    Frame writing;                   // kept alive until its write completes
+
+    Viewer(tcp::socket socket, ViewerFormat viewer_format) : ws(std::move(socket)), format(viewer_format) {}
+};
+
+ViewerGateway::ViewerGateway(MatchingEngine& engine, const BookReplica& replica, const ViewerGatewayOptions& options)
+    : engine_(engine), replica_(replica), options_(options), inbox_(std::make_shared<Inbox>()), acceptor_(io_context_), timer_(io_context_) {
+    if (options_.interval.count() <= 0) {
+        throw std::invalid_argument("Viewer gateway interval must be positive");
+    }
+    if (options_.depth == 0) {
+        throw std::invalid_argument("Viewer gateway depth must be positive");
+    }
+    tcp::endpoint endpoint(asio::ip::make_address(options_.address), options_.port);
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(asio::socket_base::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+
+    inbox_->closed = true; //until start()
+    std::shared_ptr<Inbox> inbox = inbox_;
+    callback_id_ = engine_.registerEventBatchCallback([inbox](const OrderEvent* events, size_t count) {
+        std::lock_guard<std::mutex> lock(inbox->mutex);
+        if (inbox->closed) return;
+        inbox->events.insert(inbox->events.end(), events, events + count);
+    });
+}
+
+ViewerGateway::~ViewerGateway() {
+    engine_.unregisterEventBatchCallback(callback_id_);
+    stop();
+}
+
+void ViewerGateway::start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+    {
+        std::lock_guard<std::mutex> lock(inbox_->mutex);
+        inbox_->closed = false;
+    }
+    doAccept();
+    scheduleTick();
+    thread_ = std::thread([this] { io_context_.run(); });
+}
+
+void ViewerGateway::stop() {
+    {
+        std::lock_guard<std::mutex> lock(inbox_->mutex);
+        inbox_->closed = true;
+        inbox_->events.clear();
+    }
+    if (!thread_.joinable()) {
+        return;
+    }
+    asio::post(io_context_, [this] {
+        boost::system::error_code ignored;
+        acceptor_.close(ignored);
+        timer_.cancel();
+        auto viewers = viewers_;
+        for (const auto& viewer : viewers) {
+            closeViewer(viewer);
+        }
+        io_context_.stop(); //half-read HTTP requests would otherwise keep the loop alive
+    });
+    thread_.join();
+}
+
+unsigned short ViewerGateway::getPort() const {
+    return acceptor_.local_endpoint().port();
+}
+
+ViewerGatewayStatistics ViewerGateway::getStatistics() const {
+    ViewerGatewayStatistics stats;
+    stats.viewers = viewer_count_.load(std::memory_order_relaxed);
+    stats.http_requests = http_requests_.load(std::memory_order_relaxed);
+    stats.events = events_seen_.load(std::memory_order_relaxed);
+    stats.ticks = ticks_.load(std::memory_order_relaxed);
+    stats.frames_built = frames_built_.load(std::memory_order_relaxed);
+    stats.frames_sent = frames_sent_.load(std::memory_order_relaxed);
+    stats.frames_conflated = frames_conflated_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ViewerGateway::doAccept() {
+    acceptor_.async_accept([this](const boost::system::error_code& error, tcp::socket socket) {
+        if (!acceptor_.is_open()) {
+            return;
+        }
+        if (!error) {
+            boost::system::error_code ignored;
+            socket.set_option(tcp::no_delay(true), ignored);
+            readRequest(std::make_shared<Request>(std::move(socket)));
+        }
+        doAccept();
+    });
+}
+
+void ViewerGateway::readRequest(std::shared_ptr<Request> request) {
+    http::async_read(request->socket, request->buffer, request->message,
+                     [this, request](const boost::system::error_code& error, size_t) {
+                         if (error) {
+                             return;
+                         }
+                         if (websocket::is_upgrade(request->message) && request->message.target().starts_with("/ws") &&
+                             viewer_count_.load(std::memory_order_relaxed) < options_.max_viewers) {
+                             openViewer(request);
+                         } else {
+                             answer(request);
+                         }
+                     });
+}
+
+void ViewerGateway::answer(std::shared_ptr<Request> request) {
+    http_requests_.fetch_add(1, std::memory_order_relaxed);
+    std::map<std::string, std::string> parameters;
+    std::string path = splitTarget(request->message.target(), parameters);
+    http::response<http::string_body>& response = request->response;
+    response.version(request->message.version());
+    response.keep_alive(false);
+    response.set(http::field::content_type, "application/json");
+    response.result(http::status::ok);
+
+    if (websocket::is_upgrade(request->message)) {
+        bool full = path == "/ws";
+        response.result(full ? http::status::service_unavailable : http::status::not_found);
+        response.body() = full ? "{\"error\":\"too many viewers\"}" : "{\"error\":\"not found\"}";
+    } else if (request->message.method() != http::verb::get) {
+        response.result(http::status::method_not_allowed);
+        response.body() = "{\"error\":\"GET only\"}";
+    } else if (path == "/symbols") {
+        std::string& body = response.body();
+        body = "[";
+        for (const auto& symbol : replica_.getSymbols()) {
+            if (body.size() > 1) body.push_back(',');
+            appendJsonString(body, symbol);
+        }
+        body.append("]");
+    } else if (path == "/book" && isViewerSymbol(parameters["symbol"])) {
+        response.body() = encodeBook(parameters["symbol"], ViewerFormat::JSON);
+    } else if (path == "/stats") {
+        ViewerGatewayStatistics stats = getStatistics();
+        std::string& body = response.body();
+        body = "{\"viewers\":";
+        appendNumber(body, uint64_t{stats.viewers});
+        const std::pair<const char*, uint64_t> counters[] = {
+            {"http_requests", stats.http_requests}, {"events", stats.events}, {"ticks", stats.ticks},
+            {"frames_built", stats.frames_built}, {"frames_sent", stats.frames_sent},
+            {"frames_conflated", stats.frames_conflated}, {"bytes_sent", stats.bytes_sent}};
+        for (const auto& [name, value] : counters) {
+            body.append(",\"").append(name).append("\":");
+            appendNumber(body, value);
+        }
+        body.append("}");
+    } else {
+        response.result(http::status::not_found);
+        response.body() = "{\"error\":\"not found\"}";
+    }
+    response.prepare_payload();
+    http::async_write(request->socket, response, [request](const boost::system::error_code&, size_t) {
+        boost::system::error_code ignored;
+        request->socket.shutdown(tcp::socket::shutdown_send, ignored);
+    });
+}
+
+void ViewerGateway::openViewer(std::shared_ptr<Request> request) {
+    std::map<std::string, std::string> parameters;
+    splitTarget(request->message.target(), parameters);
+    ViewerFormat format = parameters["format"] == "binary" ? ViewerFormat::BINARY : ViewerFormat::JSON;
+    auto viewer = std::make_shared<Viewer>(std::move(request->socket), format);
+    viewer->ws.binary(format == ViewerFormat::BINARY);
+    viewer->ws.read_message_max(MAX_VIEWER_MESSAGE);
+    if (options_.send_buffer > 0) {
+        boost::system::error_code ignored;
+        viewer->ws.next_layer().set_option(asio::socket_base::send_buffer_size(options_.send_buffer), ignored);
+    }
+    std::vector<std::string> symbols = splitList(parameters["symbols"]);
+    viewer->ws.async_accept(request->message, [this, viewer, symbols](const boost::system::error_code& error) {
+        if (error || !acceptor_.is_open()) {
+            return;
+        }
+        viewers_.insert(viewer);
+        viewer_count_.fetch_add(1, std::memory_order_relaxed);
+        for (const auto& symbol : symbols) {
+            subscribe(viewer, symbol);
+        }
+        readViewer(viewer);
+    });
+}
+
+void ViewerGateway::readViewer(std::shared_ptr<Viewer> viewer) {
+    viewer->ws.async_read(viewer->buffer, [this, viewer](const boost::system::error_code& error, size_t) {
+        if (error) {
+            closeViewer(viewer);
+            return;
+        }
+        std::string text = beast::buffers_to_string(viewer->buffer.data());
+        viewer->buffer.consume(viewer->buffer.size());
+        size_t space = text.find(' ');
+        std::string command = text.substr(0, space);
+        std::string symbol = space == std::string::npos ? std::string() : text.substr(space + 1);
+        if (command == "subscribe") {
+            subscribe(viewer, symbol);
+        } else if (command == "unsubscribe") {
+            unsubscribe(*viewer, symbol);
+        }
+        readViewer(viewer);
+    });
+}
+
+void ViewerGateway::closeViewer(const std::shared_ptr<Viewer>& viewer) {
+    if (!viewer->open) {
+        return;
+    }
+    viewer->open = false;
+    for (const auto& symbol : viewer->symbols) {
+        auto it = subscribers_.find(symbol);
+        if (it != subscribers_.end()) {
+            it->second.erase(viewer.get());
+            if (it->second.empty()) subscribers_.erase(it);
+        }
+    }
+    everything_.erase(viewer.get());
+    viewers_.erase(viewer);
+    viewer_count_.fetch_sub(1, std::memory_order_relaxed);
+    boost::system::error_code ignored;
+    viewer->ws.next_layer().close(ignored); //pending reads and writes complete with an error
+}
+
+void ViewerGateway::subscribe(const std::shared_ptr<Viewer>& viewer, const std::string& symbol) {
+    if (!viewer->open) {
+        return;
+    }
+    if (symbol == "*") {
+        if (!viewer->everything) {
+            viewer->everything = true;
+            everything_.insert(viewer.get());
+            for (const auto& listed : replica_.getSymbols()) {
+                snapshot_requests_.push_back({viewer, listed});
+            }
+        }
+        return;
+    }
+    if (!isViewerSymbol(symbol)) {
+        return;
+    }
+    if (viewer->symbols.insert(symbol).second) {
+        subscribers_[symbol].insert(viewer.get());
+        snapshot_requests_.push_back({viewer, symbol});
+    }
+}
+
+void ViewerGateway::unsubscribe(Viewer& viewer, const std::string& symbol) {
+    if (symbol == "*") {
+        viewer.everything = false;
+        everything_.erase(&viewer);
+        return;
+    }
+    if (viewer.symbols.erase(symbol) > 0) {
+        auto it = subscribers_.find(symbol);
+        it->second.erase(&viewer);
+        if (it->second.empty()) subscribers_.erase(it);
+    }
+}
+
+void ViewerGateway::offer(const std::shared_ptr<Viewer>& viewer, uint8_t kind, const std::string& symbol, const Frame& frame) {
+    Viewer::Key key{kind, symbol};
+    auto it = viewer->unsent.find(key);
+    if (it != viewer->unsent.end()) {
+        it->second = frame; //the viewer hasn't taken the previous one: only the latest matters
+        frames_conflated_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        viewer->unsent.emplace(key, frame);
+        viewer->queued.push_back(std::move(key));
+    }
+    if (!viewer->writing) {
+        writeNext(viewer);
+    }
+}
+
+void ViewerGateway::writeNext(std::shared_ptr<Viewer> viewer) {
+    if (viewer->queued.empty() || !viewer->open) {
+        return;
+    }
+    auto it = viewer->unsent.find(viewer->queued.front());
+    viewer->queued.pop_front();
+    viewer->writing = std::move(it->second);
+    viewer->unsent.erase(it);
+    viewer->ws.async_write(asio::buffer(*viewer->writing), [this, viewer](const boost::system::error_code& error, size_t bytes) {
+        viewer->writing.reset();
+        if (error) {
+            closeViewer(viewer);
+            return;
+        }
+        frames_sent_.fetch_add(1, std::memory_order_relaxed);
+        bytes_sent_.fetch_add(bytes, std::memory_order_relaxed);
+        writeNext(viewer);
+    });
+}
+
+// =============================================================================
+// Conflation
+// =============================================================================
+
+void ViewerGateway::scheduleTick() {
+    timer_.expires_after(options_.interval);
+    timer_.async_wait([this](const boost::system::error_code& error) {
+        if (error) {
+            return;
+        }
+        try {
+            tick();
+        } catch (const std::exception& e) {
+            std::cerr << "ViewerGateway: tick failed: " << e.what() << std::endl;
+        }
+        scheduleTick();
+    });
+}
+
+std::string ViewerGateway::encodeBook(const std::string& symbol, ViewerFormat format) const {
+    uint64_t sequence = 0;
+    MarketDepth depth = replica_.getMarketDepth(symbol, options_.depth, &sequence);
+    return encodeBookFrame(depth, sequence, format);
+}
+
+void ViewerGateway::tick() {
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(inbox_->mutex);
+        events_.swap(inbox_->events);
+    }
+    events_seen_.fetch_add(events_.size(), std::memory_order_relaxed);
+    for (const auto& event : events_) {
+        SymbolState& state = symbols_[event.getSymbol()];
+        state.changed_sequence = event.sequence;
+        bool fill = event.type == OrderEventType::PARTIALLY_FILLED || event.type == OrderEventType::FILLED;
+        if (fill && event.trade_id != state.last_trade) {
+            state.last_trade = event.trade_id;
+            state.trade_sequence = event.sequence;
+            state.high = state.trades == 0 ? event.price : std::max(state.high, event.price);
+            state.low = state.trades == 0 ? event.price : std::min(state.low, event.price);
+            state.last = event.price;
+            state.volume += event.quantity;
+            state.trades++;
+        }
+    }
+    events_.clear();
+
+    // Each book is read from the replica at most once per tick and encoded at most once per format
+    struct BookFrames {
+        bool loaded = false;
+        uint64_t sequence = 0;
+        MarketDepth depth;
+        std::array<Frame, 2> frames;
+    };
+    std::unordered_map<std::string, BookFrames> books;
+    auto bookFrame = [&](const std::string& symbol, ViewerFormat format) -> BookFrames& {
+        BookFrames& book = books[symbol];
+        if (!book.loaded) {
+            book.depth = replica_.getMarketDepth(symbol, options_.depth, &book.sequence);
+            book.loaded = true;
+        }
+        Frame& frame = book.frames[static_cast<size_t>(format)];
+        if (!frame) {
+            frame = std::make_shared<const std::string>(encodeBookFrame(book.depth, book.sequence, format));
+            frames_built_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return book;
+    };
+
+    std::vector<std::shared_ptr<Viewer>> watching;
+    for (auto& [symbol, state] : symbols_) {
+        if (state.changed_sequence == 0 && state.trades == 0) {
+            continue;
+        }
+        watching.clear();
+        auto it = subscribers_.find(symbol);
+        if (it != subscribers_.end()) {
+            for (Viewer* viewer : it->second) watching.push_back(viewer->shared_from_this());
+        }
+        for (Viewer* viewer : everything_) {
+            if (!viewer->symbols.count(symbol)) watching.push_back(viewer->shared_from_this());
+        }
+
+        if (state.changed_sequence != 0) {
+            uint64_t reflected = UINT64_MAX;
+            for (const auto& viewer : watching) {
+                BookFrames& book = bookFrame(symbol, viewer->format);
+                offer(viewer, ViewerFrame::BOOK, symbol, book.frames[static_cast<size_t>(viewer->format)]);
+                reflected = book.sequence;
+            }
+            if (reflected >= state.changed_sequence) {
+                state.changed_sequence = 0; //otherwise the replica is behind: send it again next tick
+            }
+        }
+        if (state.trades > 0) {
+            ViewerFrame trades;
+            trades.kind = ViewerFrame::TRADES;
+            trades.symbol = symbol;
+            trades.sequence = state.trade_sequence;
+            trades.trades = state.trades;
+            trades.volume = state.volume;
+            trades.last = state.last;
+            trades.high = state.high;
+            trades.low = state.low;
+            std::array<Frame, 2> frames;
+            for (const auto& viewer : watching) {
+                Frame& frame = frames[static_cast<size_t>(viewer->format)];
+                if (!frame) {
+                    frame = std::make_shared<const std::string>(encodeTradeFrame(trades, viewer->format));
+                    frames_built_.fetch_add(1, std::memory_order_relaxed);
+                }
+                offer(viewer, ViewerFrame::TRADES, symbol, frame);
+            }
+            state.trades = 0;
+            state.volume = 0;
+        }
+    }
+
+    // New subscriptions get the current book whether or not it changed
+    std::vector<std::pair<std::weak_ptr<Viewer>, std::string>> requests;
+    requests.swap(snapshot_requests_);
+    for (const auto& [weak, symbol] : requests) {
+        std::shared_ptr<Viewer> viewer = weak.lock();
+        if (viewer && viewer->open && (viewer->everything || viewer->symbols.count(symbol))) {
+            offer(viewer, ViewerFrame::BOOK, symbol, bookFrame(symbol, viewer->format).frames[static_cast<size_t>(viewer->format)]);
+        }
+    }
+}
+
+} // namespace matching_engine
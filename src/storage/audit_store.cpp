@@ -0,0 +1,478 @@
+#include "matching_engine/audit_store.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr size_t MERGE_BUFFER = 65536; // index entries buffered per write while merging
+
+std::string eventsPath(const std::string& dir) { return dir + "/events.log"; }
+std::string manifestPath(const std::string& dir) { return dir + "/MANIFEST"; }
+
+std::string segmentPath(const std::string& dir, const std::string& kind, uint64_t id) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%06llu.idx", static_cast<unsigned long long>(id));
+    return dir + "/" + kind + name;
+}
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("audit store write failed");
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+int createFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw systemError("cannot create " + path);
+    }
+    return fd;
+}
+
+void syncAndClose(int fd, const std::string& path) {
+    if (::fdatasync(fd) != 0) {
+        ::close(fd);
+        throw systemError("cannot sync " + path);
+    }
+    ::close(fd);
+}
+
+/**
+ * Manifest contents: "indexed <N>", "next <segment id>", then "<kind> <segment id> <entries>" lines
+ */
+struct Manifest {
+    uint64_t indexed_events = 0;
+    uint64_t next_segment_id = 1;
+    std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> segments;
+};
+
+bool readManifest(const std::string& dir, Manifest& manifest) {
+    std::ifstream in(manifestPath(dir));
+    if (!in) {
+        return false;
+    }
+    std::string key;
+    while (in >> key) {
+        if (key == "indexed") {
+            in >> manifest.indexed_events;
+        } else if (key == "next") {
+            in >> manifest.next_segment_id;
+        } else {
+            uint64_t id = 0, entries = 0;
+            in >> id >> entries;
+            manifest.segments.push_back({key, {id, entries}});
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// =============================================================================
+// AuditStoreWriter
+// =============================================================================
+
+AuditStoreWriter::AuditStoreWriter(const std::string& dir, const AuditStoreOptions& options)
+    : dir_(dir)
+    , options_(options)
+    , events_fd_(-1) {
+    std::filesystem::create_directories(dir_);
+    events_fd_ = ::open(eventsPath(dir_).c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (events_fd_ < 0) {
+        throw systemError("cannot open " + eventsPath(dir_));
+    }
+    try {
+        recover();
+    } catch (...) {
+        ::close(events_fd_);
+        throw;
+    }
+    thread_ = std::thread(&AuditStoreWriter::run, this);
+}
+
+AuditStoreWriter::~AuditStoreWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+    ::close(events_fd_);
+}
+
+void AuditStoreWriter::enqueue(const OrderEvent& event) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(event);
+        enqueued_++;
+        wake = queue_.size() >= options_.segment_events; // don't let the queue outgrow a segment
+    }
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void AuditStoreWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = enqueued_;
+    flush_requested_ = true;
+    wake_.notify_one();
+    flushed_.wait(lock, [&] { return indexed_ >= target || !error_.empty(); });
+    if (!error_.empty()) {
+        throw std::runtime_error("audit store writer failed: " + error_);
+    }
+}
+
+void AuditStoreWriter::recover() {
+    Manifest manifest;
+    readManifest(dir_, manifest);
+    next_segment_id_ = manifest.next_segment_id;
+    for (const auto& [kind, segment] : manifest.segments) {
+        auto& segments = (kind == "order") ? order_segments_ : account_segments_;
+        segments.push_back(Segment{segment.first, segment.second});
+    }
+
+    // Drop a torn trailing event, then index anything the manifest doesn't cover yet
+    struct stat st;
+    if (::fstat(events_fd_, &st) != 0) {
+        throw systemError("cannot stat " + eventsPath(dir_));
+    }
+    written_ = static_cast<uint64_t>(st.st_size) / sizeof(OrderEvent);
+    if (::ftruncate(events_fd_, static_cast<off_t>(written_ * sizeof(OrderEvent))) != 0) {
+        throw systemError("cannot truncate " + eventsPath(dir_));
+    }
+
+    OrderEvent event;
+    for (uint64_t i = manifest.indexed_events; i < written_; ++i) {
+        if (::pread(events_fd_, &event, sizeof(event), static_cast<off_t>(i * sizeof(OrderEvent))) != static_cast<ssize_t>(sizeof(event))) {
+            throw systemError("cannot read " + eventsPath(dir_));
+        }
+        pending_orders_.push_back({event.order_id, i});
+        if (event.account != 0) {
+            pending_accounts_.push_back({event.account, i});
+        }
+    }
+    writeSegments(); //enqueued_/indexed_ only count events queued from now on
+}
+
+void AuditStoreWriter::run() {
+    std::vector<OrderEvent> batch;
+    while (true) {
+        bool flush_now = false;
+        bool stop = false;
+        uint64_t target = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, options_.flush_interval, [&] {
+                return stopping_ || flush_requested_ || queue_.size() >= options_.segment_events;
+            });
+            batch.swap(queue_);
+            flush_now = flush_requested_ || stopping_;
+            flush_requested_ = false;
+            stop = stopping_;
+            target = enqueued_;
+        }
+
+        try {
+            if (!batch.empty()) {
+                appendEvents(batch);
+                batch.clear();
+            }
+            if (flush_now || pending_orders_.size() >= options_.segment_events) {
+                writeSegments();
+                std::lock_guard<std::mutex> lock(mutex_);
+                indexed_ = target; //everything dequeued so far is now indexed
+                flushed_.notify_all();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "AuditStoreWriter: " << e.what() << std::endl;
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = e.what();
+            flushed_.notify_all();
+            return;
+        }
+
+        if (stop) {
+            return;
+        }
+    }
+}
+
+void AuditStoreWriter::appendEvents(const std::vector<OrderEvent>& events) {
+    writeAll(events_fd_, events.data(), events.size() * sizeof(OrderEvent));
+    for (const auto& event : events) {
+        pending_orders_.push_back({event.order_id, written_});
+        if (event.account != 0) {
+            pending_accounts_.push_back({event.account, written_});
+        }
+        written_++;
+    }
+}
+
+void AuditStoreWriter::writeSegments() {
+    if (pending_orders_.empty() && pending_accounts_.empty()) {
+        return;
+    }
+    // Index entries must never point past what is durable in events.log
+    if (::fdatasync(events_fd_) != 0) {
+        throw systemError("cannot sync " + eventsPath(dir_));
+    }
+
+    std::vector<std::string> obsolete;
+    if (!pending_orders_.empty()) {
+        order_segments_.push_back(writeSegment("order", pending_orders_));
+        mergeSegments("order", order_segments_, obsolete);
+    }
+    if (!pending_accounts_.empty()) {
+        account_segments_.push_back(writeSegment("account", pending_accounts_));
+        mergeSegments("account", account_segments_, obsolete);
+    }
+    writeManifest(written_);
+
+    // Readers that already mapped the old segments keep them alive until they refresh
+    for (const auto& path : obsolete) {
+        ::unlink(path.c_str());
+    }
+}
+
+AuditStoreWriter::Segment AuditStoreWriter::writeSegment(const char* kind, std::vector<AuditIndexEntry>& entries) {
+    std::sort(entries.begin(), entries.end());
+    Segment segment{next_segment_id_++, entries.size()};
+    std::string path = segmentPath(dir_, kind, segment.id);
+    int fd = createFile(path);
+    try {
+        writeAll(fd, entries.data(), entries.size() * sizeof(AuditIndexEntry));
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    syncAndClose(fd, path);
+    entries.clear();
+    return segment;
+}
+
+void AuditStoreWriter::mergeSegments(const char* kind, std::vector<Segment>& segments, std::vector<std::string>& obsolete) {
+    // Merge the newest two while the older one is no more than twice the size of the newer
+    while (segments.size() >= 2 && segments[segments.size() - 2].entries <= 2 * segments.back().entries) {
+        Segment newer = segments.back();
+        segments.pop_back();
+        Segment older = segments.back();
+        segments.pop_back();
+
+        std::vector<AuditIndexEntry> a(older.entries), b(newer.entries);
+        std::string older_path = segmentPath(dir_, kind, older.id);
+        std::string newer_path = segmentPath(dir_, kind, newer.id);
+        for (auto [path, entries] : {std::make_pair(&older_path, &a), std::make_pair(&newer_path, &b)}) {
+            std::ifstream in(*path, std::ios::binary);
+            if (!in.read(reinterpret_cast<char*>(entries->data()), static_cast<std::streamsize>(entries->size() * sizeof(AuditIndexEntry)))) {
+                throw std::runtime_error("cannot read index segment " + *path);
+            }
+        }
+
+        Segment merged{next_segment_id_++, older.entries + newer.entries};
+        std::string merged_path = segmentPath(dir_, kind, merged.id);
+        int fd = createFile(merged_path);
+        try {
+            std::vector<AuditIndexEntry> out;
+            out.reserve(MERGE_BUFFER);
+            auto ia = a.begin(), ib = b.begin();
+            while (ia != a.end() || ib != b.end()) {
+                if (ib == b.end() || (ia != a.end() && *ia < *ib)) {
+                    out.push_back(*ia++);
+                } else {
+                    out.push_back(*ib++);
+                }
+                if (out.size() == MERGE_BUFFER) {
+                    writeAll(fd, out.data(), out.size() * sizeof(AuditIndexEntry));
+                    out.clear();
+                }
+            }
+            writeAll(fd, out.data(), out.size() * sizeof(AuditIndexEntry));
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        syncAndClose(fd, merged_path);
+
+        segments.push_back(merged);
+        obsolete.push_back(older_path);
+        obsolete.push_back(newer_path);
+    }
+}
+
+void AuditStoreWriter::writeManifest(uint64_t indexed_events) {
+    std::ostringstream oss;
+    oss << "indexed " << indexed_events << "\n";
+    oss << "next " << next_segment_id_ << "\n";
+    for (const auto& segment : order_segments_) {
+        oss << "order " << segment.id << " " << segment.entries << "\n";
+    }
+    for (const auto& segment : account_segments_) {
+        oss << "account " << segment.id << " " << segment.entries << "\n";
+    }
+
+    // Write-then-rename so readers only ever see a complete manifest
+    std::string tmp = manifestPath(dir_) + ".tmp";
+    std::string contents = oss.str();
+    int fd = createFile(tmp);
+    try {
+        writeAll(fd, contents.data(), contents.size());
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    syncAndClose(fd, tmp);
+    if (::rename(tmp.c_str(), manifestPath(dir_).c_str()) != 0) {
+        throw systemError("cannot replace " + manifestPath(dir_));
+    }
+}
+
+// =============================================================================
+// AuditStoreReader
+// =============================================================================
+
+AuditStoreReader::AuditStoreReader(const std::string& dir)
+    : dir_(dir) {
+    refresh();
+}
+
+AuditStoreReader::~AuditStoreReader() {
+    unmapAll();
+}
+
+AuditStoreReader::Mapping AuditStoreReader::map(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw systemError("cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw systemError("cannot stat " + path);
+    }
+    Mapping mapping;
+    mapping.size = static_cast<size_t>(st.st_size);
+    if (mapping.size > 0) {
+        void* data = ::mmap(nullptr, mapping.size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw systemError("cannot map " + path);
+        }
+        mapping.data = static_cast<const char*>(data);
+    }
+    ::close(fd);
+    return mapping;
+}
+
+void AuditStoreReader::unmap(Mapping& mapping) {
+    if (mapping.data) {
+        ::munmap(const_cast<char*>(mapping.data), mapping.size);
+    }
+    mapping = Mapping{};
+}
+
+void AuditStoreReader::unmapAll() {
+    unmap(events_);
+    for (auto& segment : order_segments_) unmap(segment);
+    for (auto& segment : account_segments_) unmap(segment);
+    order_segments_.clear();
+    account_segments_.clear();
+}
+
+void AuditStoreReader::refresh() {
+    // The writer may merge away a segment between reading the manifest and opening it; retry
+    for (int attempt = 0;; ++attempt) {
+        unmapAll();
+        Manifest manifest;
+        readManifest(dir_, manifest);
+        try {
+            // Manifest first: events.log is synced before any manifest that covers it
+            for (const auto& [kind, segment] : manifest.segments) {
+                auto& segments = (kind == "order") ? order_segments_ : account_segments_;
+                segments.push_back(map(segmentPath(dir_, kind, segment.first)));
+            }
+            events_ = map(eventsPath(dir_));
+        } catch (const std::runtime_error&) {
+            if (attempt < 3) continue;
+            unmapAll();
+            throw;
+        }
+        indexed_events_ = manifest.indexed_events;
+        event_count_ = events_.size / sizeof(OrderEvent);
+        return;
+    }
+}
+
+const OrderEvent* AuditStoreReader::eventAt(uint64_t index) const {
+    return reinterpret_cast<const OrderEvent*>(events_.data) + index; // mmap is page aligned
+}
+
+std::vector<OrderEvent> AuditStoreReader::lookup(const std::vector<Mapping>& segments, uint64_t key, bool by_account, size_t max_events) const {
+    std::vector<uint64_t> positions;
+
+    // Indexed part: one binary search per segment
+    auto key_less = [](const AuditIndexEntry& a, const AuditIndexEntry& b) { return a.key < b.key; };
+    for (const auto& segment : segments) {
+        auto* begin = reinterpret_cast<const AuditIndexEntry*>(segment.data);
+        auto* end = begin + segment.size / sizeof(AuditIndexEntry);
+        auto range = std::equal_range(begin, end, AuditIndexEntry{key, 0}, key_less);
+        for (auto* it = range.first; it != range.second; ++it) {
+            positions.push_back(it->event);
+        }
+    }
+    // Unindexed tail: a short linear scan
+    for (uint64_t i = indexed_events_; i < event_count_; ++i) {
+        const OrderEvent* event = eventAt(i);
+        if ((by_account ? event->account : event->order_id) == key) {
+            positions.push_back(i);
+        }
+    }
+
+    std::sort(positions.begin(), positions.end());
+    if (positions.size() > max_events) {
+        positions.erase(positions.begin(), positions.end() - static_cast<std::ptrdiff_t>(max_events));
+    }
+    std::vector<OrderEvent> events;
+    events.reserve(positions.size());
+    for (uint64_t position : positions) {
+        if (position < event_count_) {
+            events.push_back(*eventAt(position));
+        }
+    }
+    return events;
+}
+
+std::vector<OrderEvent> AuditStoreReader::getOrderHistory(OrderId order_id) const {
+    return lookup(order_segments_, order_id, false, SIZE_MAX);
+}
+
+std::vector<OrderEvent> AuditStoreReader::getAccountHistory(AccountId account, size_t max_events) const {
+    return lookup(account_segments_, account, true, max_events);
+}
+
+} // namespace matching_engine
@@ -0,0 +1,270 @@
+#include "matching_engine/book_history.hpp"
+#include "matching_engine/snapshot.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr size_t REPLAY_BATCH = 4096; // journal records read per pread
+
+std::string indexPath(const std::string& dir) { return dir + "/checkpoints.idx"; }
+std::string dataPath(const std::string& dir) { return dir + "/checkpoints.dat"; }
+
+std::vector<CheckpointIndexEntry> readIndex(const std::string& dir) {
+    std::vector<CheckpointIndexEntry> index;
+    std::ifstream in(indexPath(dir), std::ios::binary);
+    if (!in) {
+        return index; // no checkpoints yet
+    }
+    CheckpointIndexEntry entry;
+    while (in.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        index.push_back(entry); // a torn trailing entry is ignored
+    }
+    return index;
+}
+
+} // namespace
+
+// =============================================================================
+// Replay
+// =============================================================================
+
+void BookHistory::applyRecord(OrderBook& book, const JournalRecord& record) {
+    switch (record.command) {
+        case JournalCommand::NEW_ORDER: {
+            Order order(record.order_id, record.getSymbol(), record.side, record.order_type, record.price, record.quantity);
+            order.setAccount(record.account);
+            book.addOrder(order);
+            break;
+        }
+        case JournalCommand::CANCEL_ORDER:
+            book.cancelOrder(record.order_id);
+            break;
+        case JournalCommand::MODIFY_ORDER: {
+            std::vector<Trade> trades;
+            book.replaceOrder(record.order_id, record.price, record.quantity, trades);
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown journal command at sequence " + std::to_string(record.sequence));
+    }
+}
+
+// =============================================================================
+// Checkpoint Builder
+// =============================================================================
+
+size_t BookHistory::buildCheckpoints(const std::string& journal_path, const std::string& history_dir,
+                                     const CheckpointOptions& options) {
+    std::filesystem::create_directories(history_dir);
+    JournalReader journal(journal_path);
+    std::vector<CheckpointIndexEntry> index = readIndex(history_dir);
+
+    std::map<std::string, std::unique_ptr<OrderBook>> books; // sorted, like the snapshot directory
+    uint64_t next_sequence = 1;
+    uint64_t last_sequence = 0;
+    int64_t last_timestamp = 0;
+    uint64_t data_size = 0;
+
+    // Resume from the newest checkpoint rather than replaying the whole journal again
+    if (!index.empty()) {
+        const CheckpointIndexEntry& last = index.back();
+        std::string image(last.size, '\0');
+        std::ifstream in(dataPath(history_dir), std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(last.offset));
+        if (!in.read(image.data(), static_cast<std::streamsize>(image.size()))) {
+            throw std::runtime_error("Checkpoint data shorter than its index: " + dataPath(history_dir));
+        }
+        SnapshotView view(image.data(), image.size());
+        for (const auto& symbol : view.getSymbols()) {
+            auto book = std::make_unique<OrderBook>(options.analytics_depth);
+            view.restoreBook(symbol, *book);
+            books[symbol] = std::move(book);
+        }
+        next_sequence = last.sequence + 1;
+        last_sequence = last.sequence;
+        last_timestamp = last.timestamp_ns;
+        data_size = last.offset + last.size;
+    }
+
+    // Drop anything a previous run wrote past its last complete index entry
+    {
+        std::ofstream rewrite(indexPath(history_dir), std::ios::binary | std::ios::trunc);
+        rewrite.write(reinterpret_cast<const char*>(index.data()),
+                      static_cast<std::streamsize>(index.size() * sizeof(CheckpointIndexEntry)));
+    }
+    if (std::filesystem::exists(dataPath(history_dir))) {
+        std::filesystem::resize_file(dataPath(history_dir), data_size);
+    }
+
+    std::ofstream data(dataPath(history_dir), std::ios::binary | std::ios::app);
+    std::ofstream idx(indexPath(history_dir), std::ios::binary | std::ios::app);
+    if (!data || !idx) {
+        throw std::runtime_error("Cannot open checkpoint files in " + history_dir);
+    }
+
+    std::vector<JournalRecord> batch(REPLAY_BATCH);
+    size_t written = 0;
+    size_t count;
+    while ((count = journal.read(next_sequence, batch.data(), batch.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            const JournalRecord& record = batch[i];
+            auto& book = books[record.getSymbol()];
+            if (!book) {
+                book = std::make_unique<OrderBook>(options.analytics_depth);
+            }
+            applyRecord(*book, record);
+
+            if (last_sequence == 0 && last_timestamp == 0) {
+                last_timestamp = record.timestamp_ns; // time interval counts from the first command
+            }
+            bool due = (options.interval_commands > 0 && record.sequence - last_sequence >= options.interval_commands) ||
+                       (options.interval_ns > 0 && record.timestamp_ns - last_timestamp >= options.interval_ns);
+            if (!due) continue;
+
+            std::vector<std::pair<std::string, const OrderBook*>> views;
+            views.reserve(books.size());
+            for (const auto& [symbol, symbol_book] : books) {
+                views.emplace_back(symbol, symbol_book.get());
+            }
+            std::string image = encodeSnapshot(record.sequence, record.timestamp_ns, views);
+
+            // Data first, so the index never points past what is on disk
+            data.write(image.data(), static_cast<std::streamsize>(image.size()));
+            data.flush();
+            CheckpointIndexEntry entry{record.sequence, record.timestamp_ns, data_size, image.size()};
+            idx.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            idx.flush();
+            if (!data || !idx) {
+                throw std::runtime_error("Failed writing checkpoint at sequence " + std::to_string(record.sequence));
+            }
+
+            data_size += image.size();
+            last_sequence = record.sequence;
+            last_timestamp = record.timestamp_ns;
+            written++;
+        }
+        next_sequence += count;
+    }
+    return written;
+}
+
+// =============================================================================
+// Queries
+// =============================================================================
+
+BookHistory::BookHistory(const std::string& journal_path, const std::string& history_dir, size_t analytics_depth)
+    : journal_path_(journal_path)
+    , history_dir_(history_dir)
+    , analytics_depth_(analytics_depth) {
+    JournalReader probe(journal_path_); // fail early on a missing or foreign journal
+    reload();
+}
+
+BookHistory::~BookHistory() {
+    unmap();
+}
+
+void BookHistory::unmap() {
+    if (checkpoints_) {
+        ::munmap(const_cast<char*>(checkpoints_), checkpoints_size_);
+        checkpoints_ = nullptr;
+        checkpoints_size_ = 0;
+    }
+}
+
+void BookHistory::reload() {
+    unmap();
+    index_ = readIndex(history_dir_);
+    if (index_.empty()) {
+        return;
+    }
+
+    int fd = ::open(dataPath(history_dir_).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + dataPath(history_dir_) + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + dataPath(history_dir_));
+    }
+    void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + dataPath(history_dir_) + ": " + std::strerror(errno));
+    }
+    checkpoints_ = static_cast<const char*>(mapped);
+    checkpoints_size_ = static_cast<size_t>(st.st_size);
+
+    // Entries whose data isn't fully on disk yet (builder running concurrently) are ignored
+    while (!index_.empty() && index_.back().offset + index_.back().size > checkpoints_size_) {
+        index_.pop_back();
+    }
+}
+
+HistoricalBook BookHistory::bookAtTime(const std::string& symbol, int64_t timestamp_ns) const {
+    auto it = std::upper_bound(index_.begin(), index_.end(), timestamp_ns,
+                               [](int64_t t, const CheckpointIndexEntry& e) { return t < e.timestamp_ns; });
+    return replay(symbol, static_cast<size_t>(it - index_.begin()), std::numeric_limits<uint64_t>::max(), timestamp_ns);
+}
+
+HistoricalBook BookHistory::bookAtSequence(const std::string& symbol, uint64_t sequence) const {
+    auto it = std::upper_bound(index_.begin(), index_.end(), sequence,
+                               [](uint64_t s, const CheckpointIndexEntry& e) { return s < e.sequence; });
+    return replay(symbol, static_cast<size_t>(it - index_.begin()), sequence, std::numeric_limits<int64_t>::max());
+}
+
+HistoricalBook BookHistory::replay(const std::string& symbol, size_t position, uint64_t max_sequence, int64_t max_timestamp_ns) const {
+    HistoricalBook result;
+    result.book = std::make_unique<OrderBook>(analytics_depth_);
+
+    uint64_t next_sequence = 1;
+    if (position > 0) {
+        const CheckpointIndexEntry& checkpoint = index_[position - 1];
+        SnapshotView view(checkpoints_ + checkpoint.offset, checkpoint.size);
+        view.restoreBook(symbol, *result.book);
+        result.sequence = checkpoint.sequence;
+        result.timestamp_ns = checkpoint.timestamp_ns;
+        result.checkpoint_sequence = checkpoint.sequence;
+        next_sequence = checkpoint.sequence + 1;
+    }
+
+    JournalRecord key;
+    key.setSymbol(symbol);
+
+    // Replay the delta; only the requested symbol's commands touch the book
+    JournalReader journal(journal_path_);
+    std::vector<JournalRecord> batch(REPLAY_BATCH);
+    size_t count;
+    while ((count = journal.read(next_sequence, batch.data(), batch.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            const JournalRecord& record = batch[i];
+            if (record.sequence > max_sequence || record.timestamp_ns > max_timestamp_ns) {
+                return result;
+            }
+            if (std::memcmp(record.symbol, key.symbol, sizeof(key.symbol)) == 0) {
+                applyRecord(*result.book, record);
+            }
+            result.sequence = record.sequence;
+            result.timestamp_ns = record.timestamp_ns;
+            result.replayed_commands++;
+        }
+        next_sequence += count;
+    }
+    return result;
+}
+
+} // namespace matching_engine
@@ -0,0 +1,267 @@
+#include "matching_engine/journal.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace matching_engine {
+
+namespace {
+
+// File header: magic, format version, record size
+constexpr char JOURNAL_MAGIC[8] = {'M', 'E', 'J', 'R', 'N', 'L', '0', '1'};
+constexpr uint32_t JOURNAL_VERSION = 2; // 2: account per record
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+static_assert(sizeof(JournalHeader) == JOURNAL_HEADER_SIZE, "JournalHeader size");
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("journal write failed");
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// Complete records in a journal of this size, less trailing block padding (sequence 0 records)
+uint64_t countRecords(int fd, uint64_t file_size) {
+    uint64_t records = (file_size - JOURNAL_HEADER_SIZE) / sizeof(JournalRecord);
+    JournalRecord tail[64];
+    while (records > 0) {
+        uint64_t batch = std::min<uint64_t>(records, 64);
+        off_t offset = static_cast<off_t>(JOURNAL_HEADER_SIZE + (records - batch) * sizeof(JournalRecord));
+        ssize_t bytes = static_cast<ssize_t>(batch * sizeof(JournalRecord));
+        if (::pread(fd, tail, static_cast<size_t>(bytes), offset) != bytes) {
+            break;
+        }
+        uint64_t kept = batch;
+        while (kept > 0 && tail[kept - 1].sequence == 0) {
+            --kept;
+        }
+        records -= batch - kept;
+        if (kept > 0) {
+            break;
+        }
+    }
+    return records;
+}
+
+// Validates the header of an open journal and returns the number of complete records
+uint64_t checkHeader(int fd, const std::string& path) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        throw systemError("cannot stat journal " + path);
+    }
+    JournalHeader header;
+    if (st.st_size < static_cast<off_t>(sizeof(header)) ||
+        ::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        throw std::runtime_error("not a journal file: " + path);
+    }
+    if (header.version != JOURNAL_VERSION || header.record_size != sizeof(JournalRecord)) {
+        throw std::runtime_error("unsupported journal version: " + path);
+    }
+    // A torn final record (crash mid-write) is ignored, and so is direct I/O padding
+    return countRecords(fd, static_cast<uint64_t>(st.st_size));
+}
+
+} // namespace
+
+// =============================================================================
+// JournalRecord
+// =============================================================================
+
+std::string JournalRecord::getSymbol() const {
+    return std::string(symbol, strnlen(symbol, sizeof(symbol)));
+}
+
+void JournalRecord::setSymbol(const std::string& value) {
+    if (value.size() > sizeof(symbol)) {
+        throw std::invalid_argument("Symbol too long for journal: " + value);
+    }
+    std::memset(symbol, 0, sizeof(symbol));
+    std::memcpy(symbol, value.data(), value.size());
+}
+
+int64_t wallClockNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// =============================================================================
+// FileJournalStorage
+// =============================================================================
+
+FileJournalStorage::FileJournalStorage(const std::string& path)
+    : fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)) {
+    if (fd_ < 0) {
+        throw systemError("cannot open journal " + path);
+    }
+}
+
+FileJournalStorage::~FileJournalStorage() {
+    ::close(fd_);
+}
+
+void FileJournalStorage::write(const void* data, size_t size) {
+    writeAll(fd_, data, size);
+}
+
+void FileJournalStorage::sync() {
+    if (::fdatasync(fd_) != 0) {
+        throw systemError("journal sync failed");
+    }
+}
+
+// =============================================================================
+// JournalWriter
+// =============================================================================
+
+JournalWriter::JournalWriter(std::unique_ptr<JournalStorage> storage, uint64_t next_sequence, size_t buffer_capacity)
+    : storage_(std::move(storage))
+    , buffer_capacity_(std::max<size_t>(1, buffer_capacity))
+    , next_sequence_(next_sequence) {
+    buffer_.reserve(buffer_capacity_);
+}
+
+JournalWriter::~JournalWriter() {
+    try {
+        flush();
+    } catch (...) {
+        // Nothing sensible to do from a destructor; callers wanting durability use commit()
+    }
+}
+
+std::shared_ptr<JournalWriter> JournalWriter::open(const std::string& path, const StorageFactory& make_storage) {
+    auto openStorage = [&]() -> std::unique_ptr<JournalStorage> {
+        if (make_storage) return make_storage(path);
+        return std::make_unique<FileJournalStorage>(path);
+    };
+    uint64_t existing = 0;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat st;
+        bool empty = ::fstat(fd, &st) == 0 && st.st_size == 0;
+        try {
+            if (!empty) existing = checkHeader(fd, path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        if (!empty) {
+            // Drop a torn trailing record (or padding) so appends stay aligned to the record grid
+            off_t aligned = static_cast<off_t>(JOURNAL_HEADER_SIZE + existing * sizeof(JournalRecord));
+            if (::truncate(path.c_str(), aligned) != 0) {
+                throw systemError("cannot truncate journal " + path);
+            }
+            return std::make_shared<JournalWriter>(openStorage(), existing + 1);
+        }
+    }
+
+    auto storage = openStorage();
+    JournalHeader header{};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    header.version = JOURNAL_VERSION;
+    header.record_size = sizeof(JournalRecord);
+    storage->write(&header, sizeof(header));
+    return std::make_shared<JournalWriter>(std::move(storage), 1);
+}
+
+uint64_t JournalWriter::append(JournalRecord record) {
+    record.sequence = next_sequence_++;
+    buffer_.push_back(record);
+    if (buffer_.size() >= buffer_capacity_) {
+        flush();
+    }
+    return record.sequence;
+}
+
+void JournalWriter::flush() {
+    if (buffer_.empty()) return;
+    storage_->write(buffer_.data(), buffer_.size() * sizeof(JournalRecord));
+    buffer_.clear();
+}
+
+void JournalWriter::commit() {
+    flush();
+    storage_->sync();
+}
+
+void JournalWriter::commitAsync(std::function<void(uint64_t)> on_durable) {
+    flush();
+    uint64_t sequence = getLastSequence();
+    storage_->syncAsync([on_durable = std::move(on_durable), sequence] { on_durable(sequence); });
+}
+
+// =============================================================================
+// JournalReader
+// =============================================================================
+
+JournalReader::JournalReader(const std::string& path)
+    : fd_(::open(path.c_str(), O_RDONLY | O_CLOEXEC))
+    , record_count_(0) {
+    if (fd_ < 0) {
+        throw systemError("cannot open journal " + path);
+    }
+    try {
+        record_count_ = checkHeader(fd_, path);
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+JournalReader::~JournalReader() {
+    ::close(fd_);
+}
+
+void JournalReader::refresh() {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        throw systemError("cannot stat journal");
+    }
+    record_count_ = countRecords(fd_, static_cast<uint64_t>(st.st_size));
+}
+
+size_t JournalReader::read(uint64_t first_sequence, JournalRecord* out, size_t max_records) const {
+    if (first_sequence == 0 || first_sequence > record_count_) {
+        return 0;
+    }
+    size_t count = static_cast<size_t>(std::min<uint64_t>(max_records, record_count_ - first_sequence + 1));
+    off_t offset = static_cast<off_t>(JOURNAL_HEADER_SIZE + (first_sequence - 1) * sizeof(JournalRecord));
+
+    char* dest = reinterpret_cast<char*>(out);
+    size_t remaining = count * sizeof(JournalRecord);
+    while (remaining > 0) {
+        ssize_t n = ::pread(fd_, dest, remaining, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("journal read failed");
+        }
+        if (n == 0) break;
+        dest += n;
+        offset += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return (count * sizeof(JournalRecord) - remaining) / sizeof(JournalRecord); //whole records only
+}
+
+} // namespace matching_engine
@@ -0,0 +1,160 @@
+#include "matching_engine/reference_data.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr char REFERENCE_MAGIC[8] = {'M', 'E', 'R', 'E', 'F', 'D', '0', '1'};
+constexpr uint32_t REFERENCE_VERSION = 1;
+
+bool symbolLess(const ReferenceRecord& a, const ReferenceRecord& b) {
+    return std::memcmp(a.symbol, b.symbol, sizeof(a.symbol)) < 0;
+}
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+std::string ReferenceRecord::getSymbol() const {
+    return std::string(symbol, strnlen(symbol, sizeof(symbol)));
+}
+
+void ReferenceRecord::setSymbol(const std::string& value) {
+    if (value.empty() || value.size() > sizeof(symbol)) {
+        throw std::invalid_argument("Reference data symbols are 1 to 8 characters: '" + value + "'");
+    }
+    std::memset(symbol, 0, sizeof(symbol));
+    std::memcpy(symbol, value.data(), value.size());
+}
+
+InstrumentRules ReferenceRecord::getRules() const {
+    InstrumentRules rules;
+    rules.tick_size = tick_size;
+    rules.lot_size = lot_size;
+    rules.band_low = band_low;
+    rules.band_high = band_high;
+    rules.policy = policy;
+    return rules;
+}
+
+void writeReferenceData(const std::string& path, std::vector<ReferenceRecord> records) {
+    std::sort(records.begin(), records.end(), symbolLess);
+    auto duplicate = std::adjacent_find(records.begin(), records.end(),
+                                        [](const ReferenceRecord& a, const ReferenceRecord& b) { return !symbolLess(a, b); });
+    if (duplicate != records.end()) {
+        throw std::invalid_argument("Symbol listed twice in reference data: " + duplicate->getSymbol());
+    }
+
+    ReferenceDataHeader header{};
+    std::memcpy(header.magic, REFERENCE_MAGIC, sizeof(header.magic));
+    header.version = REFERENCE_VERSION;
+    header.record_size = sizeof(ReferenceRecord);
+    header.symbol_count = records.size();
+
+    // Written beside the target and renamed over it, so a process mapping the old file never sees a partial one
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw systemError("Cannot create " + temporary);
+    }
+    const char* parts[] = {reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(records.data())};
+    size_t sizes[] = {sizeof(header), records.size() * sizeof(ReferenceRecord)};
+    for (int part = 0; part < 2; ++part) {
+        const char* bytes = parts[part];
+        size_t remaining = sizes[part];
+        while (remaining > 0) {
+            ssize_t written = ::write(fd, bytes, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                int error = errno;
+                ::close(fd);
+                ::unlink(temporary.c_str());
+                errno = error;
+                throw systemError("Cannot write " + temporary);
+            }
+            bytes += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    }
+    ::close(fd);
+    if (::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw systemError("Cannot rename " + temporary + " to " + path);
+    }
+}
+
+ReferenceDataFile::ReferenceDataFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw systemError("Cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw systemError("Cannot stat " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ < sizeof(ReferenceDataHeader)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a reference data file (too short)");
+    }
+    // Read front to back once: populate now rather than fault page by page
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw systemError("Cannot map " + path);
+    }
+    data_ = static_cast<const char*>(mapped);
+
+    ReferenceDataHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    const char* problem = nullptr;
+    if (std::memcmp(header.magic, REFERENCE_MAGIC, sizeof(header.magic)) != 0) {
+        problem = "not a reference data file";
+    } else if (header.version != REFERENCE_VERSION || header.record_size != sizeof(ReferenceRecord)) {
+        problem = "unsupported reference data version";
+    } else if (header.symbol_count > (size_ - sizeof(header)) / sizeof(ReferenceRecord)) {
+        problem = "truncated";
+    }
+    if (!problem) {
+        records_ = reinterpret_cast<const ReferenceRecord*>(data_ + sizeof(header));
+        count_ = static_cast<size_t>(header.symbol_count);
+        for (size_t i = 1; i < count_ && !problem; ++i) {
+            if (!symbolLess(records_[i - 1], records_[i])) {
+                problem = "records not sorted by symbol or listed twice";
+            }
+        }
+    }
+    if (problem) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error(path + ": " + problem);
+    }
+}
+
+ReferenceDataFile::~ReferenceDataFile() {
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+const ReferenceRecord* ReferenceDataFile::find(const std::string& symbol) const {
+    return findReferenceRecord(begin(), end(), symbol);
+}
+
+const ReferenceRecord* findReferenceRecord(const ReferenceRecord* begin, const ReferenceRecord* end, const std::string& symbol) {
+    if (symbol.empty() || symbol.size() > sizeof(ReferenceRecord::symbol)) return nullptr;
+    ReferenceRecord key;
+    std::memcpy(key.symbol, symbol.data(), symbol.size());
+    const ReferenceRecord* it = std::lower_bound(begin, end, key, symbolLess);
+    if (it == end || symbolLess(key, *it)) return nullptr;
+    return it;
+}
+
+} // namespace matching_engine
@@ -0,0 +1,155 @@
+#include "matching_engine/snapshot.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'M', 'E', 'S', 'N', 'A', 'P', '0', '1'};
+constexpr uint32_t SNAPSHOT_VERSION = 2; // 2: account per order
+
+// Symbols are stored zero-padded so they compare as fixed 8-byte keys
+void packSymbol(char (&dest)[8], const std::string& symbol) {
+    if (symbol.size() > sizeof(dest)) {
+        throw std::invalid_argument("Symbol too long for snapshot: " + symbol);
+    }
+    std::memset(dest, 0, sizeof(dest));
+    std::memcpy(dest, symbol.data(), symbol.size());
+}
+
+std::string unpackSymbol(const char (&src)[8]) {
+    return std::string(src, strnlen(src, sizeof(src)));
+}
+
+} // namespace
+
+std::string encodeSnapshot(uint64_t sequence, int64_t timestamp_ns,
+                           const std::vector<std::pair<std::string, const OrderBook*>>& books) {
+    std::vector<std::pair<std::string, const OrderBook*>> sorted(books);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<SnapshotBookEntry> entries;
+    std::vector<SnapshotOrder> orders;
+    entries.reserve(sorted.size());
+    for (const auto& [symbol, book] : sorted) {
+        SnapshotBookEntry entry{};
+        packSymbol(entry.symbol, symbol);
+        entry.first_order = orders.size();
+        entry.last_trade_id = book->getLastTradeId();
+        for (const auto& order : book->getRestingOrders()) {
+            SnapshotOrder out{};
+            out.order_id = order.getId();
+            out.price = order.getPrice();
+            out.quantity = order.getQuantity();
+            out.remaining_quantity = order.getRemainingQuantity();
+            out.account = order.getAccount();
+            out.side = order.getSide();
+            orders.push_back(out);
+        }
+        entry.order_count = orders.size() - entry.first_order;
+        entries.push_back(entry);
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.book_count = static_cast<uint32_t>(entries.size());
+    header.sequence = sequence;
+    header.timestamp_ns = timestamp_ns;
+    header.total_size = sizeof(SnapshotHeader) + entries.size() * sizeof(SnapshotBookEntry) +
+                        orders.size() * sizeof(SnapshotOrder);
+
+    std::string image;
+    image.reserve(header.total_size);
+    image.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    image.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SnapshotBookEntry));
+    image.append(reinterpret_cast<const char*>(orders.data()), orders.size() * sizeof(SnapshotOrder));
+    return image;
+}
+
+// =============================================================================
+// SnapshotView
+// =============================================================================
+
+SnapshotView::SnapshotView(const void* data, size_t size)
+    : data_(static_cast<const char*>(data))
+    , size_(size) {
+    if (size_ < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot truncated");
+    }
+    std::memcpy(&header_, data_, sizeof(header_)); // the image may sit at any alignment
+    if (std::memcmp(header_.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header_.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Not a snapshot image");
+    }
+    if (header_.total_size > size_ ||
+        header_.total_size < sizeof(SnapshotHeader) + header_.book_count * sizeof(SnapshotBookEntry)) {
+        throw std::runtime_error("Snapshot truncated");
+    }
+}
+
+SnapshotBookEntry SnapshotView::entryAt(size_t index) const {
+    SnapshotBookEntry entry;
+    std::memcpy(&entry, data_ + sizeof(SnapshotHeader) + index * sizeof(SnapshotBookEntry), sizeof(entry));
+    return entry;
+}
+
+std::vector<std::string> SnapshotView::getSymbols() const {
+    std::vector<std::string> symbols;
+    symbols.reserve(header_.book_count);
+    for (size_t i = 0; i < header_.book_count; ++i) {
+        symbols.push_back(unpackSymbol(entryAt(i).symbol));
+    }
+    return symbols;
+}
+
+bool SnapshotView::restoreBook(const std::string& symbol, OrderBook& book) const {
+    char key[8];
+    packSymbol(key, symbol);
+
+    // Binary search the sorted directory
+    size_t lo = 0, hi = header_.book_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (std::memcmp(entryAt(mid).symbol, key, sizeof(key)) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == header_.book_count) {
+        book.clear();
+        return false;
+    }
+    SnapshotBookEntry entry = entryAt(lo);
+    if (std::memcmp(entry.symbol, key, sizeof(key)) != 0) {
+        book.clear();
+        return false;
+    }
+
+    size_t orders_start = sizeof(SnapshotHeader) + header_.book_count * sizeof(SnapshotBookEntry);
+    if (orders_start + (entry.first_order + entry.order_count) * sizeof(SnapshotOrder) > header_.total_size) {
+        throw std::runtime_error("Snapshot book entry out of range: " + symbol);
+    }
+
+    std::vector<Order> orders;
+    orders.reserve(entry.order_count);
+    const char* cursor = data_ + orders_start + entry.first_order * sizeof(SnapshotOrder);
+    for (uint64_t i = 0; i < entry.order_count; ++i, cursor += sizeof(SnapshotOrder)) {
+        SnapshotOrder in;
+        std::memcpy(&in, cursor, sizeof(in));
+        Order order(in.order_id, symbol, in.side, OrderType::LIMIT, in.price, in.quantity);
+        order.setAccount(in.account);
+        if (in.remaining_quantity < in.quantity) {
+            order.fill(in.quantity - in.remaining_quantity);
+        }
+        orders.push_back(std::move(order));
+    }
+    book.restore(orders, entry.last_trade_id);
+    return true;
+}
+
+} // namespace matching_engine
@@ -0,0 +1,415 @@
+#include "matching_engine/journal.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace matching_engine {
+
+namespace {
+
+constexpr size_t DIRECT_IO_BLOCK = 4096; // O_DIRECT alignment of buffers, offsets and lengths
+constexpr unsigned RING_ENTRIES = 8;
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+char* allocateBlocks(size_t bytes) {
+    void* memory = std::aligned_alloc(DIRECT_IO_BLOCK, bytes);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    std::memset(memory, 0, bytes);
+    return static_cast<char*>(memory);
+}
+
+} // namespace
+
+// =============================================================================
+// io_uring
+// =============================================================================
+
+/**
+ * @brief Submission and completion rings of one io_uring, set up with the raw system calls
+ */
+struct UringJournalStorage::Ring {
+    int fd = -1;
+    void* sq_map = MAP_FAILED;
+    size_t sq_map_size = 0;
+    void* cq_map = MAP_FAILED;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned local_tail = 0;   // SQ tail including entries not yet published
+
+    explicit Ring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            throw systemError("io_uring_setup failed");
+        }
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+        sq_map = ::mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            release();
+            throw systemError("io_uring ring mmap failed");
+        }
+        cq_map = (params.features & IORING_FEAT_SINGLE_MMAP)
+                     ? sq_map
+                     : ::mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqe_map = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (cq_map == MAP_FAILED || sqe_map == MAP_FAILED) {
+            if (sqe_map != MAP_FAILED) ::munmap(sqe_map, sqes_size);
+            release();
+            throw systemError("io_uring ring mmap failed");
+        }
+        sqes = static_cast<io_uring_sqe*>(sqe_map);
+
+        char* sq = static_cast<char*>(sq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        local_tail = *sq_tail;
+    }
+
+    ~Ring() {
+        if (sqes) ::munmap(sqes, sqes_size);
+        release();
+    }
+
+    void release() {
+        if (cq_map != MAP_FAILED && cq_map != sq_map) ::munmap(cq_map, cq_map_size);
+        if (sq_map != MAP_FAILED) ::munmap(sq_map, sq_map_size);
+        if (fd >= 0) ::close(fd);
+    }
+
+    // Next free submission entry, cleared (visible to the kernel after publish())
+    io_uring_sqe* prepare() {
+        unsigned index = local_tail & *sq_mask;
+        sq_array[index] = index;
+        local_tail++;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    void publish() { __atomic_store_n(sq_tail, local_tail, __ATOMIC_RELEASE); }
+
+    // Submit what is published and wait for wait_for completions; returns the io_uring_enter calls made
+    uint64_t submitAndWait(unsigned wait_for, std::vector<io_uring_cqe>& completions) {
+        uint64_t enters = 0;
+        completions.clear();
+        while (completions.size() < wait_for) {
+            unsigned to_submit = local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+            unsigned min_complete = wait_for - static_cast<unsigned>(completions.size());
+            enters++;
+            if (::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                throw systemError("io_uring_enter failed");
+            }
+            unsigned head = *cq_head;
+            unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                completions.push_back(cqes[head & *cq_mask]);
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return enters;
+    }
+};
+
+// =============================================================================
+// UringJournalStorage
+// =============================================================================
+
+UringJournalStorage::UringJournalStorage(const std::string& path, const UringJournalOptions& options)
+    : fd_(-1), options_(options), direct_(options.direct), fill_(nullptr, std::free), flight_(nullptr, std::free) {
+    if (options_.group_bytes == 0) {
+        throw std::invalid_argument("Journal group size must be positive");
+    }
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC;
+    if (direct_) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd_ < 0 && errno == EINVAL) {
+            direct_ = false; //file system without direct I/O
+        }
+    }
+    if (fd_ < 0) {
+        fd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        throw systemError("cannot open journal " + path);
+    }
+
+    try {
+        ring_ = std::make_unique<Ring>(RING_ENTRIES);
+        buffer_bytes_ = roundUp(std::max(options_.buffer_bytes, 2 * DIRECT_IO_BLOCK), DIRECT_IO_BLOCK);
+        fill_.reset(allocateBlocks(buffer_bytes_));
+        flight_.reset(allocateBlocks(buffer_bytes_));
+
+        // Stage the partial block at the end of the file: the next group rewrites it whole
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            throw systemError("cannot stat journal " + path);
+        }
+        written_ = durable_ = opened_length_ = static_cast<uint64_t>(st.st_size);
+        fill_offset_ = written_ / DIRECT_IO_BLOCK * DIRECT_IO_BLOCK;
+        fill_size_ = static_cast<size_t>(written_ - fill_offset_);
+        if (fill_size_ > 0 &&
+            ::pread(fd_, fill_.get(), DIRECT_IO_BLOCK, static_cast<off_t>(fill_offset_)) < static_cast<ssize_t>(fill_size_)) {
+            throw systemError("cannot read the end of journal " + path);
+        }
+    } catch (...) {
+        ring_.reset();
+        ::close(fd_);
+        throw;
+    }
+    committer_ = std::thread(&UringJournalStorage::run, this);
+}
+
+UringJournalStorage::~UringJournalStorage() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    committer_.join();
+    if (error_.empty() && ::ftruncate(fd_, static_cast<off_t>(written_)) != 0) {
+        std::cerr << "UringJournalStorage: cannot trim the block padding: " << std::strerror(errno) << std::endl;
+    }
+    ring_.reset();
+    ::close(fd_);
+}
+
+void UringJournalStorage::throwIfFailed() const {
+    if (!error_.empty()) {
+        throw std::runtime_error(error_);
+    }
+}
+
+void UringJournalStorage::write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    std::unique_lock<std::mutex> lock(mutex_);
+    throwIfFailed();
+    while (size > 0) {
+        if (fill_size_ == buffer_bytes_) {
+            // Full: commit it now and wait for the buffers to swap
+            buffer_waits_.fetch_add(1, std::memory_order_relaxed);
+            commit_now_ = true;
+            wake_.notify_one();
+            progress_.wait(lock, [this] { return fill_size_ < buffer_bytes_ || !error_.empty(); });
+            throwIfFailed();
+            continue;
+        }
+        size_t chunk = std::min(size, buffer_bytes_ - fill_size_);
+        std::memcpy(fill_.get() + fill_size_, bytes, chunk);
+        fill_size_ += chunk;
+        written_ += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+    if (groupReady()) {
+        wake_.notify_one();
+    }
+}
+
+void UringJournalStorage::sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    throwIfFailed();
+    uint64_t target = written_;
+    if (durable_ >= target) {
+        return;
+    }
+    commit_now_ = true;
+    wake_.notify_one();
+    progress_.wait(lock, [&] { return durable_ >= target || !error_.empty(); });
+    throwIfFailed();
+    commits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UringJournalStorage::syncAsync(std::function<void()> on_durable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    throwIfFailed();
+    acks_.push_back(std::move(on_durable));
+    if (!group_open_) {
+        group_open_ = true;
+        group_opened_ = std::chrono::steady_clock::now();
+        wake_.notify_one(); //the commit thread starts timing the window
+    } else if (groupReady()) {
+        wake_.notify_one();
+    }
+}
+
+UringJournalStatistics UringJournalStorage::getStatistics() const {
+    UringJournalStatistics stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.bytes = durable_ - opened_length_;
+    }
+    stats.groups = groups_.load(std::memory_order_relaxed);
+    stats.commits = commits_.load(std::memory_order_relaxed);
+    stats.enters = enters_.load(std::memory_order_relaxed);
+    stats.device_bytes = device_bytes_.load(std::memory_order_relaxed);
+    stats.buffer_waits = buffer_waits_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// =============================================================================
+// Group Commit
+// =============================================================================
+
+bool UringJournalStorage::groupReady() const {
+    if (commit_now_) {
+        return true;
+    }
+    if (!group_open_) {
+        return false;
+    }
+    if (fill_size_ >= options_.group_bytes || options_.group_window.count() == 0) {
+        return true;
+    }
+    return std::chrono::steady_clock::now() >= group_opened_ + options_.group_window;
+}
+
+void UringJournalStorage::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (!stopping_ && !groupReady()) {
+            if (group_open_) {
+                wake_.wait_until(lock, group_opened_ + options_.group_window);
+            } else {
+                wake_.wait(lock);
+            }
+            continue;
+        }
+        if (written_ == durable_ && acks_.empty()) {
+            commit_now_ = false;
+            if (stopping_) {
+                return; //everything written is durable
+            }
+            continue;
+        }
+
+        // Take the group: swap buffers, carrying the partial last block over to the next group
+        std::vector<std::function<void()>> acks;
+        acks.swap(acks_);
+        group_open_ = false;
+        commit_now_ = false;
+        uint64_t target = written_;
+        bool has_bytes = target > durable_;
+        uint64_t offset = fill_offset_;
+        size_t size = fill_size_;
+        size_t whole = size / DIRECT_IO_BLOCK * DIRECT_IO_BLOCK;
+        std::swap(fill_, flight_);
+        fill_size_ = size - whole;
+        fill_offset_ = offset + whole;
+        std::memcpy(fill_.get(), flight_.get() + whole, fill_size_);
+        progress_.notify_all();
+        lock.unlock();
+
+        size_t length = 0;
+        std::string failure;
+        if (has_bytes) {
+            length = size;
+            if (direct_) {
+                length = roundUp(size, DIRECT_IO_BLOCK);
+                std::memset(flight_.get() + size, 0, length - size); //padding reads as sequence 0 records
+            }
+            try {
+                writeGroup(length, offset);
+            } catch (const std::exception& e) {
+                failure = e.what();
+            }
+        }
+
+        lock.lock();
+        if (!failure.empty()) {
+            error_ = failure;
+            progress_.notify_all();
+            std::cerr << "UringJournalStorage: " << failure << std::endl;
+            return; //nothing after a failed group can be acknowledged
+        }
+        durable_ = std::max(durable_, target);
+        if (has_bytes) {
+            groups_.fetch_add(1, std::memory_order_relaxed);
+            device_bytes_.fetch_add(length, std::memory_order_relaxed);
+        }
+        commits_.fetch_add(acks.size(), std::memory_order_relaxed);
+        progress_.notify_all();
+        lock.unlock();
+        for (auto& ack : acks) {
+            try {
+                ack();
+            } catch (const std::exception& e) {
+                std::cerr << "UringJournalStorage: commit callback failed: " << e.what() << std::endl;
+            }
+        }
+        lock.lock();
+    }
+}
+
+void UringJournalStorage::writeGroup(size_t size, uint64_t offset) {
+    // The write and its fdatasync in one submission; the link runs the sync only after the write
+    io_uring_sqe* write = ring_->prepare();
+    write->opcode = IORING_OP_WRITE;
+    write->flags = IOSQE_IO_LINK;
+    write->fd = fd_;
+    write->addr = reinterpret_cast<uint64_t>(flight_.get());
+    write->len = static_cast<uint32_t>(size);
+    write->off = offset;
+    write->user_data = 1;
+    io_uring_sqe* sync = ring_->prepare();
+    sync->opcode = IORING_OP_FSYNC;
+    sync->fd = fd_;
+    sync->fsync_flags = IORING_FSYNC_DATASYNC;
+    sync->user_data = 2;
+    ring_->publish();
+
+    std::vector<io_uring_cqe> completions;
+    enters_.fetch_add(ring_->submitAndWait(2, completions), std::memory_order_relaxed);
+    for (const auto& completion : completions) {
+        if (completion.user_data == 1 && completion.res != static_cast<int32_t>(size)) {
+            throw std::runtime_error(completion.res < 0 ? std::string("journal write failed: ") + std::strerror(-completion.res)
+                                                        : std::string("journal write was short"));
+        }
+        if (completion.user_data == 2 && completion.res < 0) {
+            throw std::runtime_error(std::string("journal sync failed: ") + std::strerror(-completion.res));
+        }
+    }
+}
+
+} // namespace matching_engine
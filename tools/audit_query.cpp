@@ -0,0 +1,65 @@
+// Order lifecycle lookups against an audit store directory.
+//
+//   audit_query <store-dir> order <order-id>
+//   audit_query <store-dir> account <account-id> [--limit N]
+
+#include "matching_engine/audit_store.hpp"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace matching_engine;
+
+namespace {
+
+void print(const OrderEvent& event) {
+    std::time_t seconds = static_cast<std::time_t>(event.timestamp_ns / 1000000000LL);
+    std::tm tm{};
+    gmtime_r(&seconds, &tm);
+    std::cout << std::put_time(&tm, "%H:%M:%S") << '.' << std::setw(9) << std::setfill('0')
+              << event.timestamp_ns % 1000000000LL << std::setfill(' ')
+              << "  #" << std::left << std::setw(10) << event.sequence
+              << std::setw(17) << toString(event.type) << std::right
+              << " order " << event.order_id
+              << " acct " << event.account
+              << " " << event.getSymbol()
+              << " " << (event.side == OrderSide::BUY ? "BUY" : "SELL")
+              << " " << event.quantity << " @ " << std::fixed << std::setprecision(3) << event.price
+              << " remaining " << event.remaining_quantity;
+    if (event.trade_id != 0) {
+        std::cout << " trade " << event.trade_id;
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() < 3 || (args[1] != "order" && args[1] != "account")) {
+        std::cerr << "usage: audit_query <store-dir> order <order-id>\n"
+                  << "       audit_query <store-dir> account <account-id> [--limit N]\n";
+        return 2;
+    }
+    try {
+        AuditStoreReader reader(args[0]);
+        uint64_t key = std::stoull(args[2]);
+        size_t limit = (args.size() >= 5 && args[3] == "--limit") ? std::stoull(args[4]) : SIZE_MAX;
+
+        auto start = std::chrono::steady_clock::now();
+        auto events = args[1] == "order" ? reader.getOrderHistory(key) : reader.getAccountHistory(key, limit);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        for (const auto& event : events) {
+            print(event);
+        }
+        std::cerr << events.size() << " events of " << reader.getEventCount() << " in " << elapsed.count() << " us" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "audit_query: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}